@@ -35,10 +35,14 @@ public:
 	int  m_nPayloadRead;    // Num read bytes from input buffer.
 	int  m_nFailedAttempts; // Num failed authentication attempts.
 	int  m_nIgnoredMessage; // Count how many times client ignored the no-auth message.
+	int  m_nPendingRequests; // Num requests queued for the main thread.
 	bool m_bValidated;      // Revalidates netconsole if false.
 	bool m_bAuthorized;     // Set to true after successful netconsole auth.
 	bool m_bInputOnly;      // If set, don't send spew to this net console.
 	std::vector<uint8_t> m_RecvBuffer;
+	std::string m_svSendBuf; // Output the socket hasn't accepted yet.
+	size_t m_nSendOffset;    // Num bytes of the above already sent.
+	size_t m_nDroppedLogs;   // Num log lines dropped while over the send high-water mark.
 
 	CConnectedNetConsoleData(SocketHandle_t hSocket = -1)
 	{
@@ -47,9 +51,12 @@ public:
 		m_nPayloadRead = 0;
 		m_nFailedAttempts = 0;
 		m_nIgnoredMessage = 0;
+		m_nPendingRequests = 0;
 		m_bValidated = false;
 		m_bAuthorized = false;
 		m_bInputOnly = false;
+		m_nSendOffset = 0;
+		m_nDroppedLogs = 0;
 		m_RecvBuffer.resize(sizeof(int)); // Reserve enough for length-prefix.
 	}
 };
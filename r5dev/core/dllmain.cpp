@@ -11,6 +11,8 @@
 #include "windows/system.h"
 #include "mathlib/mathlib.h"
 #include "launcher/launcher.h"
+#include "networksystem/pylon.h"
+#include "tier0/threadpool.h"
 
 //#############################################################################
 // INITIALIZATION
@@ -40,6 +42,7 @@ void SDK_Init()
     Console_Init();
 #endif // !DEDICATED
     SpdLog_Init();
+    LogQueue_Init();
     spdlog::info("\n");
     for (size_t i = 0; i < SDK_ARRAYSIZE(R5R_EMBLEM); i++)
     {
@@ -71,6 +74,9 @@ void SDK_Shutdown()
     }
     bShutDown = true;
     spdlog::info("Shutdown GameSDK\n");
+    g_pMasterServer->Shutdown();
+    g_pThreadPool->Shutdown();
+    LogQueue_Shutdown();
 
     WinSock_Shutdown();
     Systems_Shutdown();
@@ -15,6 +15,7 @@
 #include "tier0/cpu.h"
 #include "tier0/commandline.h"
 #include "tier0/platform_internal.h"
+#include "public/utility/sigscan.h"
 #include "tier1/cmd.h"
 #include "tier1/IConVar.h"
 #include "tier1/cvar.h"
@@ -459,10 +460,80 @@ void CheckCPU() // Respawn's engine and our SDK utilize POPCNT, SSE3 and SSSE3 (
 	}
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: runs one scan method of a detour while g_SigBatch collects
+// Input  : *pDetour - 
+//          pfnScan - 
+// Output : false if the scan dereferenced a null result, other faults are
+//          not handled here
+//-----------------------------------------------------------------------------
+static bool DetourCollectScan(const IDetour* pDetour, void (IDetour::*pfnScan)(void) const)
+{
+	__try
+	{
+		(pDetour->*pfnScan)();
+	}
+	__except (GetExceptionCode() == EXCEPTION_ACCESS_VIOLATION ? EXCEPTION_EXECUTE_HANDLER : EXCEPTION_CONTINUE_SEARCH)
+	{
+		return false;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: runs the detour's scans while g_SigBatch collects signatures
+// Input  : *pDetour - 
+// Output : number of scans that faulted
+// Note   : every scan returns null while collecting; detours that dereference
+//          their results fault here and simply scan the rest on demand later.
+//-----------------------------------------------------------------------------
+static size_t DetourCollect(const IDetour* pDetour)
+{
+	static const std::pair<void (IDetour::*)(void) const, const char*> scans[] =
+	{
+		{ &IDetour::GetCon, "GetCon" },
+		{ &IDetour::GetFun, "GetFun" },
+		{ &IDetour::GetVar, "GetVar" }
+	};
+
+	size_t nFaults = 0;
+	for (const auto& scan : scans)
+	{
+		if (!DetourCollectScan(pDetour, scan.first))
+		{
+			nFaults++;
+			spdlog::debug("Detour '{:s}' faulted in {:s}() while collecting; remaining signatures are scanned on demand\n",
+				typeid(*pDetour).name(), scan.second);
+		}
+	}
+
+	return nFaults;
+}
+
 void DetourInit() // Run the sigscan
 {
 	bool bLogAdr = (strstr(GetCommandLineA(), "-sig_toconsole") != nullptr);
+	bool bBatch = (strstr(GetCommandLineA(), "-sig_nobatch") == nullptr);
+	bool bCache = (strstr(GetCommandLineA(), "-sig_nocache") == nullptr);
 	bool bInitDivider = false;
+	size_t nCollectFaults = 0;
+
+	CSigCache sigCache;
+
+	if (bBatch) // Collect all signatures first, then scan each section once.
+	{
+		g_SigBatch.Begin();
+		if (bCache) // Results of the code section persist for as long as the executable doesn't change.
+		{
+			g_SigBatch.SetCache(&sigCache, fs::path("platform\\cache") / (g_GameDll.GetModuleName() + ".sigcache"),
+				g_GameDll.m_ExecutableCode.m_pSectionBase, g_GameDll.m_ExecutableCode.m_nSectionSize);
+		}
+		for (const IDetour* pDetour : vDetour)
+		{
+			nCollectFaults += DetourCollect(pDetour);
+		}
+		g_SigBatch.Resolve(1); // Single threaded, this runs from DllMain where waiting on a thread deadlocks.
+	}
 
 	for (const IDetour* pDetour : vDetour)
 	{
@@ -480,6 +551,22 @@ void DetourInit() // Run the sigscan
 			pDetour->GetAdr();
 		}
 	}
+
+	if (bBatch)
+	{
+		if (bLogAdr)
+		{
+			spdlog::debug("+----------------------------------------------------------------+\n");
+			spdlog::debug("Batched '{:d}' signatures over '{:d}' region(s); '{:d}' scanned on demand, '{:d}' collect fault(s)\n",
+				g_SigBatch.GetPatternCount(), g_SigBatch.GetRegionCount(), g_SigBatch.GetMissCount(), nCollectFaults);
+			if (bCache)
+			{
+				spdlog::debug("Signature cache: '{:d}' hits, '{:d}' misses, '{:.3f}' seconds saved\n",
+					g_SigBatch.GetCacheHits(), g_SigBatch.GetCacheMisses(), g_SigBatch.GetCacheTimeSaved() / 1000000.0);
+			}
+		}
+		g_SigBatch.End();
+	}
 }
 void DetourAddress() // Test the sigscan results
 {
@@ -11,6 +11,7 @@
 #include "protoc/sv_rcon.pb.h"
 #include "protoc/cl_rcon.pb.h"
 #include "engine/client/cl_rcon.h"
+#include "tier2/framedecoder.h"
 #include "engine/net.h"
 #include "squirrel/sqvm.h"
 #include "common/igameserverdata.h"
@@ -221,55 +222,17 @@ void CRConClient::Recv(void)
 //-----------------------------------------------------------------------------
 void CRConClient::ProcessBuffer(const char* pRecvBuf, int nRecvLen, CConnectedNetConsoleData* pData)
 {
-	while (nRecvLen > 0)
-	{
-		if (pData->m_nPayloadLen)
-		{
-			if (pData->m_nPayloadRead < pData->m_nPayloadLen)
-			{
-				pData->m_RecvBuffer[pData->m_nPayloadRead++] = *pRecvBuf;
-
-				pRecvBuf++;
-				nRecvLen--;
-			}
-			if (pData->m_nPayloadRead == pData->m_nPayloadLen)
-			{
-				this->ProcessMessage(this->Deserialize(std::string(
-					reinterpret_cast<char*>(pData->m_RecvBuffer.data()), pData->m_nPayloadLen)));
-
-				pData->m_nPayloadLen = 0;
-				pData->m_nPayloadRead = 0;
-			}
-		}
-		else if (pData->m_nPayloadRead < sizeof(int)) // Read size field.
+	const NetConFrameStatus_t nStatus = NetCon_DecodeFrames(pData, pRecvBuf, nRecvLen, INT_MAX,
+		[this](const char* pFrame, int nFrameLen)
 		{
-			pData->m_RecvBuffer[pData->m_nPayloadRead++] = *pRecvBuf;
+			this->ProcessMessage(this->Deserialize(pFrame, nFrameLen));
+			return true;
+		});
 
-			pRecvBuf++;
-			nRecvLen--;
-		}
-		else // Build prefix.
-		{
-			pData->m_nPayloadLen = static_cast<int>(
-				pData->m_RecvBuffer[0] << 24 |
-				pData->m_RecvBuffer[1] << 16 |
-				pData->m_RecvBuffer[2] << 8  |
-				pData->m_RecvBuffer[3]);
-			pData->m_nPayloadRead = 0;
-
-			if (pData->m_nPayloadLen < 0 ||
-				pData->m_nPayloadLen > pData->m_RecvBuffer.max_size())
-			{
-				Error(eDLL_T::CLIENT, NO_ERROR, "RCON Cmd: sync error (%d)\n", pData->m_nPayloadLen);
-				this->Disconnect(); // Out of sync (irrecoverable).
-
-				break;
-			}
-			else
-			{
-				pData->m_RecvBuffer.resize(pData->m_nPayloadLen);
-			}
-		}
+	if (nStatus == NetConFrameStatus_t::NETCON_FRAME_INVALID_SIZE)
+	{
+		Error(eDLL_T::CLIENT, NO_ERROR, "RCON Cmd: sync error (%d)\n", pData->m_nPayloadLen);
+		this->Disconnect(); // Out of sync (irrecoverable).
 	}
 }
 
@@ -347,13 +310,14 @@ std::string CRConClient::Serialize(const std::string& svReqBuf, const std::strin
 
 //-----------------------------------------------------------------------------
 // Purpose: de-serializes input
-// Input  : *svBuf - 
+// Input  : *pszBuf - 
+//			nLen - 
 // Output : de-serialized object
 //-----------------------------------------------------------------------------
-sv_rcon::response CRConClient::Deserialize(const std::string& svBuf) const
+sv_rcon::response CRConClient::Deserialize(const char* pszBuf, int nLen) const
 {
 	sv_rcon::response sv_response;
-	sv_response.ParseFromArray(svBuf.data(), static_cast<int>(svBuf.size()));
+	sv_response.ParseFromArray(pszBuf, nLen);
 
 	return sv_response;
 }
@@ -211,6 +211,7 @@ void CClient::Clear(void)
 {
 #ifndef CLIENT_DLL
 	g_ServerPlayer[GetUserID()].Reset(); // Reset ServerPlayer slot.
+	g_pClientIndex->Remove(this);
 #endif // !CLIENT_DLL
 	v_CClient_Clear(this);
 }
@@ -223,6 +224,7 @@ void CClient::VClear(CClient* pClient)
 {
 #ifndef CLIENT_DLL
 	g_ServerPlayer[pClient->GetUserID()].Reset(); // Reset ServerPlayer slot.
+	g_pClientIndex->Remove(pClient);
 #endif // !CLIENT_DLL
 	v_CClient_Clear(pClient);
 }
@@ -258,6 +260,11 @@ bool CClient::VConnect(CClient* pClient, const char* szName, void* pNetChannel,
 	bool bResult = v_CClient_Connect(pClient, szName, pNetChannel, bFakePlayer, a5, szMessage, nMessageSize);
 #ifndef CLIENT_DLL
 	g_ServerPlayer[pClient->GetUserID()].Reset(); // Reset ServerPlayer slot.
+	if (bResult)
+	{
+		CNetChan* pNetChan = pClient->GetNetChan();
+		g_pClientIndex->Add(pClient, pNetChan ? pNetChan->GetName() : szName);
+	}
 #endif // !CLIENT_DLL
 	return bResult;
 }
@@ -332,7 +339,126 @@ bool CClient::VProcessStringCmd(CClient* pClient, NET_StringCmd* pMsg)
 	return v_CClient_ProcessStringCmd(pClient, pMsg);
 }
 
-///////////////////////////////////////////////////////////////////////////////////
+//---------------------------------------------------------------------------------
+// Purpose: gets the slot of a client in the client buffer
+// Input  : *pClient - 
+//---------------------------------------------------------------------------------
+int CClientIndex::GetSlot(const CClient* pClient)
+{
+	return static_cast<int>((reinterpret_cast<uintptr_t>(pClient) - reinterpret_cast<uintptr_t>(g_pClient)) / sizeof(CClient));
+}
+
+//---------------------------------------------------------------------------------
+// Purpose: indexes a client, replacing what was indexed for its slot
+// Input  : *pClient - 
+//			*szName - name of its net channel
+//---------------------------------------------------------------------------------
+void CClientIndex::Add(CClient* pClient, const char* szName)
+{
+	const int nSlot = GetSlot(pClient);
+	if (nSlot < 0 || nSlot >= MAX_PLAYERS)
+		return;
+
+	Remove(pClient);
+	Slot_t& slot = m_Slots[nSlot];
+
+	slot.m_bIndexed = true;
+	slot.m_nNucleusID = pClient->GetNucleusID();
+	slot.m_nHandle = pClient->GetHandle();
+	slot.m_svName = szName ? szName : "";
+
+	if (slot.m_nNucleusID) // Fake clients have none.
+		m_mNucleusID.emplace(slot.m_nNucleusID, nSlot);
+
+	m_mHandle.emplace(slot.m_nHandle, nSlot);
+
+	if (!slot.m_svName.empty())
+		m_mName.emplace(slot.m_svName, nSlot);
+}
+
+//---------------------------------------------------------------------------------
+// Purpose: removes a client from the index
+// Input  : *pClient - 
+//---------------------------------------------------------------------------------
+void CClientIndex::Remove(CClient* pClient)
+{
+	const int nSlot = GetSlot(pClient);
+	if (nSlot < 0 || nSlot >= MAX_PLAYERS || !m_Slots[nSlot].m_bIndexed)
+		return;
+
+	Slot_t& slot = m_Slots[nSlot];
+
+	auto fnErase = [nSlot](auto& mIndex, const auto& key)
+	{
+		auto range = mIndex.equal_range(key);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (it->second == nSlot)
+			{
+				mIndex.erase(it);
+				return;
+			}
+		}
+	};
+
+	fnErase(m_mNucleusID, slot.m_nNucleusID);
+	fnErase(m_mHandle, slot.m_nHandle);
+	fnErase(m_mName, slot.m_svName);
+
+	slot = Slot_t();
+}
+
+//---------------------------------------------------------------------------------
+// Purpose: finds the connected clients with given NucleusID
+// Input  : nNucleusID - 
+//			&vClients - 
+//---------------------------------------------------------------------------------
+void CClientIndex::FindByNucleusID(uint64_t nNucleusID, vector<CClient*>& vClients) const
+{
+	auto range = m_mNucleusID.equal_range(nNucleusID);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		CClient* pClient = g_pClient->GetClient(it->second);
+		if (pClient->GetNetChan() && pClient->GetNucleusID() == nNucleusID)
+			vClients.push_back(pClient);
+	}
+}
+
+//---------------------------------------------------------------------------------
+// Purpose: finds the connected clients with given handle
+// Input  : nHandle - 
+//			&vClients - 
+//---------------------------------------------------------------------------------
+void CClientIndex::FindByHandle(uint16_t nHandle, vector<CClient*>& vClients) const
+{
+	auto range = m_mHandle.equal_range(nHandle);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		CClient* pClient = g_pClient->GetClient(it->second);
+		if (pClient->GetNetChan() && pClient->GetHandle() == nHandle)
+			vClients.push_back(pClient);
+	}
+}
+
+//---------------------------------------------------------------------------------
+// Purpose: finds the connected clients with given name
+// Input  : &svName - 
+//			&vClients - 
+//---------------------------------------------------------------------------------
+void CClientIndex::FindByName(const string& svName, vector<CClient*>& vClients) const
+{
+	auto range = m_mName.equal_range(svName);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		CClient* pClient = g_pClient->GetClient(it->second);
+		CNetChan* pNetChan = pClient->GetNetChan();
+
+		if (pNetChan && svName.compare(pNetChan->GetName()) == NULL)
+			vClients.push_back(pClient);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
 void CBaseClient_Attach()
 {
 	DetourAttach((LPVOID*)&v_CClient_Clear, &CClient::VClear);
@@ -347,4 +473,5 @@ void CBaseClient_Detach()
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-CClient* g_pClient = nullptr;
\ No newline at end of file
+CClient* g_pClient = nullptr;
+CClientIndex* g_pClientIndex = new CClientIndex();
\ No newline at end of file
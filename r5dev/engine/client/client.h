@@ -96,6 +96,39 @@ static_assert(sizeof(CClient) == 0x4A440);
 static_assert(sizeof(CClient) == 0x4A4C0);
 #endif
 
+//-----------------------------------------------------------------------------
+// Live index of connected client slots by NucleusID, handle and name,
+// updated as clients connect and get cleared. Lookups only return clients
+// that still match the key and have a net channel.
+//-----------------------------------------------------------------------------
+class CClientIndex
+{
+public:
+	void Add(CClient* pClient, const char* szName);
+	void Remove(CClient* pClient);
+
+	void FindByNucleusID(uint64_t nNucleusID, vector<CClient*>& vClients) const;
+	void FindByHandle(uint16_t nHandle, vector<CClient*>& vClients) const;
+	void FindByName(const string& svName, vector<CClient*>& vClients) const;
+
+	static int GetSlot(const CClient* pClient);
+
+private:
+	struct Slot_t
+	{
+		bool     m_bIndexed = false;
+		uint64_t m_nNucleusID = 0;
+		uint16_t m_nHandle = 0;
+		string   m_svName;
+	};
+
+	Slot_t m_Slots[MAX_PLAYERS];
+	std::unordered_multimap<uint64_t, int> m_mNucleusID;
+	std::unordered_multimap<uint16_t, int> m_mHandle;
+	std::unordered_multimap<string, int>   m_mName;
+};
+extern CClientIndex* g_pClientIndex;
+
 
 /* ==== CBASECLIENT ===================================================================================================================================================== */
 inline CMemory p_CClient_Connect;
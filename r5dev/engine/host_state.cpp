@@ -214,7 +214,6 @@ FORCEINLINE void CHostState::Setup(void)
 FORCEINLINE void CHostState::Think(void) const
 {
 	static bool bInitialized = false;
-	static CFastTimer banListTimer;
 	static CFastTimer pylonTimer;
 	static CFastTimer reloadTimer;
 	static CFastTimer statsTimer;
@@ -222,7 +221,6 @@ FORCEINLINE void CHostState::Think(void) const
 	if (!bInitialized) // Initialize clocks.
 	{
 #ifndef CLIENT_DLL
-		banListTimer.Start();
 #ifdef DEDICATED
 		pylonTimer.Start();
 #endif // DEDICATED
@@ -232,11 +230,7 @@ FORCEINLINE void CHostState::Think(void) const
 		bInitialized = true;
 	}
 #ifndef CLIENT_DLL
-	if (banListTimer.GetDurationInProgress().GetSeconds() > sv_banlistRefreshRate->GetDouble())
-	{
-		g_pBanSystem->BanListCheck();
-		banListTimer.Start();
-	}
+	g_pBanSystem->BanListCheck(); // Removes refused clients, if any are queued.
 #endif // !CLIENT_DLL
 #ifdef DEDICATED
 	if (pylonTimer.GetDurationInProgress().GetSeconds() > sv_pylonRefreshRate->GetDouble())
@@ -260,7 +254,10 @@ FORCEINLINE void CHostState::Think(void) const
 				).count()
 		};
 
-		std::thread(&CPylon::KeepAlive, g_pMasterServer, netGameServer).detach();
+		g_pMasterServer->QueueRequest("keepAlive", [netGameServer](httplib::Client& htClient)
+			{
+				g_pMasterServer->KeepAlive(netGameServer, &htClient);
+			});
 		pylonTimer.Start();
 	}
 #endif // DEDICATED
@@ -82,8 +82,39 @@ bool CServer::AuthClient(user_creds_s* pChallenge)
 
 	if (g_bCheckCompBanDB)
 	{
-		std::thread th(SV_IsClientBanned, svIpAddress, pChallenge->m_nNucleusID);
-		th.detach();
+		const uint64_t nNucleusID = pChallenge->m_nNucleusID;
+
+		bool bCompBanned;
+		string svReason;
+
+		if (g_pMasterServer->GetCachedBanVerdict(svIpAddress, nNucleusID, bCompBanned, svReason))
+		{
+			if (bCompBanned)
+			{
+				RejectConnection(m_Socket, pChallenge, svReason.c_str());
+				if (sv_showconnecting->GetBool())
+					Warning(eDLL_T::SERVER, "Connection rejected for '%s' ('%llu' is banned from the master server!)\n", svIpAddress.c_str(), nNucleusID);
+
+				return false;
+			}
+		}
+		else
+		{
+			// One check per NucleusID at a time, connection floods reuse it.
+			// Ban checks get a larger share of the queue, but the NucleusID
+			// comes from the client so it is still capped; when the check
+			// can't be queued, don't let anyone in unchecked.
+			if (!g_pMasterServer->QueueRequest(fmt::format("isBanned:{:d}", nNucleusID), [svIpAddress, nNucleusID](httplib::Client& htClient)
+				{
+					SV_IsClientBanned(htClient, svIpAddress, nNucleusID);
+				}, true))
+			{
+				RejectConnection(m_Socket, pChallenge, "Unable to verify ban status, please try again later.");
+				Warning(eDLL_T::SERVER, "Connection rejected for '%s' ('%llu' could not be checked against the master server!)\n", svIpAddress.c_str(), nNucleusID);
+
+				return false;
+			}
+		}
 	}
 
 	return true;
@@ -101,6 +132,14 @@ CClient* CServer::ConnectClient(CServer* pServer, user_creds_s* pChallenge)
 	if (pServer->AuthClient(pChallenge))
 	{
 		CClient* pClient = v_CServer_ConnectClient(pServer, pChallenge);
+		if (pClient)
+		{
+			// Reindex, as the NucleusID may only be assigned after CClient::Connect.
+			CNetChan* pNetChan = pClient->GetNetChan();
+			g_pClientIndex->Add(pClient, pNetChan ? pNetChan->GetName() : pClient->GetClientName());
+
+			g_pBanSystem->OnClientConnected(pClient);
+		}
 		return pClient;
 	}
 
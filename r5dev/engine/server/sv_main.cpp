@@ -7,12 +7,15 @@
 
 //-----------------------------------------------------------------------------
 // Purpose: checks if particular client is banned on the comp server
+// Input  : &htClient - 
+//			&svIPAddr - 
+//			nNucleusID - 
 //-----------------------------------------------------------------------------
-void SV_IsClientBanned(const string& svIPAddr, const uint64_t nNucleusID)
+void SV_IsClientBanned(httplib::Client& htClient, const string& svIPAddr, const uint64_t nNucleusID)
 {
 	string svError;
 
-	bool bCompBanned = g_pMasterServer->CheckForBan(svIPAddr, nNucleusID, svError);
+	bool bCompBanned = g_pMasterServer->CheckForBan(svIPAddr, nNucleusID, svError, &htClient);
 	if (bCompBanned)
 	{
 		if (!ThreadInMainThread())
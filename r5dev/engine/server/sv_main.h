@@ -21,7 +21,7 @@ inline bool* s_bDedicated = nullptr;
 
 ///////////////////////////////////////////////////////////////////////////////
 
-void SV_IsClientBanned(const string& svIPAddr, const uint64_t nNucleusID);
+void SV_IsClientBanned(httplib::Client& htClient, const string& svIPAddr, const uint64_t nNucleusID);
 ///////////////////////////////////////////////////////////////////////////////
 
 ///////////////////////////////////////////////////////////////////////////////
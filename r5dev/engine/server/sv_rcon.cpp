@@ -10,6 +10,7 @@
 #include "tier1/IConVar.h"
 #include "tier1/NetAdr2.h"
 #include "tier2/socketcreator.h"
+#include "tier2/framedecoder.h"
 #include "engine/net.h"
 #include "engine/server/sv_rcon.h"
 #include "protoc/sv_rcon.pb.h"
@@ -24,6 +25,10 @@
 CRConServer::CRConServer(void)
 	: m_bInitialized(false)
 	, m_nConnIndex(0)
+	, m_bNetThreadRunning(false)
+	, m_nPendingLogSize(0)
+	, m_nOverflowLogs(0)
+	, m_flLastLogFlush(0.0)
 {
 	m_pAdr2 = new CNetAdr2();
 	m_pSocket = new CSocketCreator();
@@ -34,6 +39,8 @@ CRConServer::CRConServer(void)
 //-----------------------------------------------------------------------------
 CRConServer::~CRConServer(void)
 {
+	this->StopNetThread();
+
 	delete m_pAdr2;
 	delete m_pSocket;
 }
@@ -51,11 +58,17 @@ void CRConServer::Init(void)
 		}
 	}
 
-	m_pAdr2->SetIPAndPort(rcon_address->GetString(), hostport->GetString());
-	m_pSocket->CreateListenSocket(*m_pAdr2, false);
+	{
+		std::lock_guard<std::recursive_mutex> l(m_SocketMutex);
+
+		m_pAdr2->SetIPAndPort(rcon_address->GetString(), hostport->GetString());
+		m_pSocket->CreateListenSocket(*m_pAdr2, false);
+	}
 
 	DevMsg(eDLL_T::SERVER, "Remote server access initialized\n");
 	m_bInitialized = true;
+
+	this->StartNetThread();
 }
 
 //-----------------------------------------------------------------------------
@@ -63,6 +76,9 @@ void CRConServer::Init(void)
 //-----------------------------------------------------------------------------
 void CRConServer::Shutdown(void)
 {
+	this->StopNetThread();
+	std::lock_guard<std::recursive_mutex> l(m_SocketMutex);
+
 	if (m_pSocket->IsListening())
 	{
 		m_pSocket->CloseListenSocket();
@@ -112,7 +128,12 @@ void CRConServer::Think(void)
 bool CRConServer::SetPassword(const char* pszPassword)
 {
 	m_bInitialized = false;
-	m_pSocket->CloseAllAcceptedSockets();
+	{
+		std::lock_guard<std::recursive_mutex> l(m_SocketMutex);
+
+		m_pSocket->CloseAllAcceptedSockets();
+		m_vPendingRequests.clear();
+	}
 
 	size_t nLen = std::strlen(pszPassword);
 	if (nLen < 8)
@@ -140,36 +161,144 @@ void CRConServer::RunFrame(void)
 {
 	if (m_bInitialized)
 	{
-		m_pSocket->RunFrame();
+		std::lock_guard<std::recursive_mutex> l(m_SocketMutex);
+
 		this->Think();
-		this->Recv();
+		this->ProcessRequests();
+		this->SendLogs();
+		this->FlushSendBuffers();
 	}
 }
 
 //-----------------------------------------------------------------------------
-// Purpose: send message to all connected sockets
-// Input  : *svMessage - 
+// Purpose: starts the network thread
+//-----------------------------------------------------------------------------
+void CRConServer::StartNetThread(void)
+{
+	if (m_bNetThreadRunning.exchange(true))
+	{
+		return;
+	}
+	m_NetThread = std::thread(&CRConServer::NetThread, this);
+}
+
 //-----------------------------------------------------------------------------
-void CRConServer::Send(const std::string& svMessage) const
+// Purpose: stops the network thread (m_SocketMutex must not be held)
+//-----------------------------------------------------------------------------
+void CRConServer::StopNetThread(void)
 {
-	if (int nCount = m_pSocket->GetAcceptedSocketCount())
+	m_bNetThreadRunning = false;
+	if (m_NetThread.joinable())
 	{
-		std::ostringstream ssSendBuf;
+		m_NetThread.join();
+	}
+}
 
-		ssSendBuf << static_cast<uint8_t>(static_cast<int>(svMessage.size()) >> 24);
-		ssSendBuf << static_cast<uint8_t>(static_cast<int>(svMessage.size()) >> 16);
-		ssSendBuf << static_cast<uint8_t>(static_cast<int>(svMessage.size()) >> 8 );
-		ssSendBuf << static_cast<uint8_t>(static_cast<int>(svMessage.size()));
-		ssSendBuf << svMessage;
+//-----------------------------------------------------------------------------
+// Purpose: waits for socket events and accepts new connections and reads
+//          incoming data as they arrive, so idle connections cost nothing
+//-----------------------------------------------------------------------------
+void CRConServer::NetThread(void)
+{
+	std::vector<WSAPOLLFD> vPollFds;
 
-		for (int i = nCount - 1; i >= 0; i--)
+	while (m_bNetThreadRunning)
+	{
 		{
-			CConnectedNetConsoleData* pData = m_pSocket->GetAcceptedSocketData(i);
+			std::lock_guard<std::recursive_mutex> l(m_SocketMutex);
+			m_pSocket->GetPollSet(vPollFds);
+		}
 
-			if (pData->m_bAuthorized)
+		if (vPollFds.empty())
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(RCON_POLL_TIMEOUT));
+			continue;
+		}
+
+		const int nReady = ::WSAPoll(vPollFds.data(), static_cast<ULONG>(vPollFds.size()), RCON_POLL_TIMEOUT);
+		if (nReady == SOCKET_ERROR)
+		{
+			// A socket in the set was closed while polling, rebuild it.
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			continue;
+		}
+		if (nReady == 0)
+		{
+			continue;
+		}
+
+		std::lock_guard<std::recursive_mutex> l(m_SocketMutex);
+		for (const WSAPOLLFD& pollFd : vPollFds)
+		{
+			if (!pollFd.revents)
+			{
+				continue;
+			}
+
+			if (static_cast<SocketHandle_t>(pollFd.fd) == m_pSocket->m_hListenSocket)
+			{
+				// Accept everything that is pending, and turn banned addresses away right away.
+				int nIndex;
+				while ((nIndex = m_pSocket->ProcessAccept()) != SOCKET_ERROR)
+				{
+					m_nConnIndex = nIndex;
+					this->CloseIfBanned();
+				}
+				continue;
+			}
+
+			// The socket could have been closed by the main thread while polling.
+			m_nConnIndex = m_pSocket->FindAcceptedSocket(static_cast<SocketHandle_t>(pollFd.fd));
+			if (m_nConnIndex == SOCKET_ERROR)
+			{
+				continue;
+			}
+
+			if (pollFd.revents & (POLLRDNORM | POLLHUP | POLLERR))
 			{
-				::send(pData->m_hSocket, ssSendBuf.str().data(), static_cast<int>(ssSendBuf.str().size()), MSG_NOSIGNAL);
+				this->Recv(m_pSocket->GetAcceptedSocketData(m_nConnIndex));
 			}
+			else if (pollFd.revents & POLLNVAL)
+			{
+				this->CloseConnection();
+			}
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: appends a length-prefixed message to a send buffer
+// Input  : &svSendBuf - 
+//			&svMessage - 
+//-----------------------------------------------------------------------------
+static void RCON_AppendFrame(std::string& svSendBuf, const std::string& svMessage)
+{
+	const int nLen = static_cast<int>(svMessage.size());
+
+	svSendBuf.push_back(static_cast<char>(nLen >> 24));
+	svSendBuf.push_back(static_cast<char>(nLen >> 16));
+	svSendBuf.push_back(static_cast<char>(nLen >> 8 ));
+	svSendBuf.push_back(static_cast<char>(nLen));
+	svSendBuf.append(svMessage);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: send message to all connected sockets
+// Input  : *svMessage - 
+//-----------------------------------------------------------------------------
+void CRConServer::Send(const std::string& svMessage)
+{
+	std::lock_guard<std::recursive_mutex> l(m_SocketMutex);
+	for (int i = m_pSocket->GetAcceptedSocketCount() - 1; i >= 0; i--)
+	{
+		CConnectedNetConsoleData* pData = m_pSocket->GetAcceptedSocketData(i);
+
+		if (pData->m_bAuthorized)
+		{
+			// Failed connections are closed by FlushSendBuffers(), as this
+			// can be called while 'm_nConnIndex' is in use.
+			RCON_AppendFrame(pData->m_svSendBuf, svMessage);
+			this->FlushSendBuffer(pData);
 		}
 	}
 }
@@ -179,17 +308,60 @@ void CRConServer::Send(const std::string& svMessage) const
 // Input  : hSocket - 
 //			*svMessage - 
 //-----------------------------------------------------------------------------
-void CRConServer::Send(SocketHandle_t hSocket, const std::string& svMessage) const
+void CRConServer::Send(SocketHandle_t hSocket, const std::string& svMessage)
+{
+	std::lock_guard<std::recursive_mutex> l(m_SocketMutex);
+
+	const int nIndex = m_pSocket->FindAcceptedSocket(hSocket);
+	if (nIndex == SOCKET_ERROR)
+	{
+		return;
+	}
+
+	// Queued behind any pending output, so it never lands in the middle of a partially sent message.
+	CConnectedNetConsoleData* pData = m_pSocket->GetAcceptedSocketData(nIndex);
+	RCON_AppendFrame(pData->m_svSendBuf, svMessage);
+
+	// Failed connections are closed by FlushSendBuffers().
+	this->FlushSendBuffer(pData);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: sends as much of the pending output as the socket accepts without
+//          blocking (m_SocketMutex must be held)
+// Input  : *pData - 
+// Output : false if the connection failed, true otherwise
+//-----------------------------------------------------------------------------
+bool CRConServer::FlushSendBuffer(CConnectedNetConsoleData* pData)
 {
-	std::ostringstream ssSendBuf;
+	while (pData->m_nSendOffset < pData->m_svSendBuf.size())
+	{
+		const int nLen = static_cast<int>(std::min<size_t>(pData->m_svSendBuf.size() - pData->m_nSendOffset, INT_MAX));
+		const int nSent = ::send(pData->m_hSocket, pData->m_svSendBuf.data() + pData->m_nSendOffset, nLen, MSG_NOSIGNAL);
+
+		if (nSent == SOCKET_ERROR)
+		{
+			if (!m_pSocket->IsSocketBlocking())
+			{
+				return false;
+			}
 
-	ssSendBuf << static_cast<uint8_t>(static_cast<int>(svMessage.size()) >> 24);
-	ssSendBuf << static_cast<uint8_t>(static_cast<int>(svMessage.size()) >> 16);
-	ssSendBuf << static_cast<uint8_t>(static_cast<int>(svMessage.size()) >> 8 );
-	ssSendBuf << static_cast<uint8_t>(static_cast<int>(svMessage.size()));
-	ssSendBuf << svMessage;
+			// Drop the sent part once it dominates the buffer, so a slow
+			// connection that never fully drains doesn't grow it forever.
+			if (pData->m_nSendOffset >= pData->m_svSendBuf.size() / 2)
+			{
+				pData->m_svSendBuf.erase(0, pData->m_nSendOffset);
+				pData->m_nSendOffset = 0;
+			}
+			return true; // Try again next frame.
+		}
+		pData->m_nSendOffset += nSent;
+	}
 
-	::send(hSocket, ssSendBuf.str().data(), static_cast<int>(ssSendBuf.str().size()), MSG_NOSIGNAL);
+	pData->m_svSendBuf.clear();
+	pData->m_nSendOffset = 0;
+
+	return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -232,57 +404,219 @@ void CRConServer::Send(SocketHandle_t hSocket, const std::string& svRspBuf, cons
 }
 
 //-----------------------------------------------------------------------------
-// Purpose: receive message
+// Purpose: queues console logs for the next frame (thread safe)
+// Input  : &vLines - log lines and their context, emptied on return
+// Note   : lines past RCON_MAX_PENDING_LOGS are counted and reported by
+//          SendLogs(). Lines queued after the last frame ran, such as the
+//          ones written after LogQueue_Shutdown()'s final flush, are never
+//          sent to the net consoles.
 //-----------------------------------------------------------------------------
-void CRConServer::Recv(void)
+void CRConServer::QueueLogs(std::vector<std::pair<std::string, int>>& vLines)
 {
-	int nCount = m_pSocket->GetAcceptedSocketCount();
-	static char szRecvBuf[1024];
+	if (!m_bInitialized)
+	{
+		vLines.clear();
+		return;
+	}
+
+	std::lock_guard<std::mutex> l(m_LogMutex);
+	for (std::pair<std::string, int>& line : vLines)
+	{
+		if (m_vPendingLogs.size() >= RCON_MAX_PENDING_LOGS)
+		{
+			m_nOverflowLogs++;
+			continue;
+		}
+		m_nPendingLogSize += line.first.size();
+		m_vPendingLogs.emplace_back(std::move(line));
+	}
+	vLines.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: serializes the queued console logs once and appends them to the
+//          output of every authenticated connection, connections that are
+//          over the high-water mark skip them and get a summary once they
+//          have caught up (m_SocketMutex must be held)
+//-----------------------------------------------------------------------------
+void CRConServer::SendLogs(void)
+{
+	static std::vector<std::pair<std::string, int>> vLines;
+	static std::string svBatch;
+	static std::string svMessage;
+	static sv_rcon::response sv_response;
 
-	for (m_nConnIndex = nCount - 1; m_nConnIndex >= 0; m_nConnIndex--)
+	const double flTime = Plat_FloatTime();
+	uint64_t nOverflowLogs;
+	{
+		std::lock_guard<std::mutex> l(m_LogMutex);
+		if (m_vPendingLogs.empty())
+		{
+			return;
+		}
+
+		// Coalesce small amounts of output over several frames.
+		if (m_nPendingLogSize < RCON_LOG_FLUSH_SIZE && flTime - m_flLastLogFlush < RCON_LOG_FLUSH_INTERVAL)
+		{
+			return;
+		}
+
+		vLines.swap(m_vPendingLogs);
+		m_nPendingLogSize = 0;
+
+		nOverflowLogs = m_nOverflowLogs;
+		m_nOverflowLogs = 0;
+	}
+	m_flLastLogFlush = flTime;
+
+	if (nOverflowLogs) // Queued through the log queue like any other line, so it reaches the net consoles next flush.
+	{
+		Warning(eDLL_T::SERVER, "RCON log queue overflow: dropped %llu lines\n", nOverflowLogs);
+	}
+
+	if (!sv_rcon_sendlogs->GetBool() || !m_pSocket->GetAcceptedSocketCount())
+	{
+		vLines.clear();
+		return;
+	}
+
+	svBatch.clear();
+	sv_response.set_responsetype(sv_rcon::response_t::SERVERDATA_RESPONSE_CONSOLE_LOG);
+	sv_response.clear_responseval();
+
+	for (const std::pair<std::string, int>& line : vLines)
+	{
+		sv_response.set_responseid(line.second);
+		sv_response.set_responsebuf(line.first);
+		sv_response.SerializeToString(&svMessage);
+
+		RCON_AppendFrame(svBatch, svMessage);
+	}
+
+	for (m_nConnIndex = m_pSocket->GetAcceptedSocketCount() - 1; m_nConnIndex >= 0; m_nConnIndex--)
 	{
 		CConnectedNetConsoleData* pData = m_pSocket->GetAcceptedSocketData(m_nConnIndex);
-		{//////////////////////////////////////////////
-			if (this->CheckForBan(pData))
-			{
-				this->Send(pData->m_hSocket, this->Serialize(s_pszBannedMessage, "", sv_rcon::response_t::SERVERDATA_RESPONSE_AUTH, static_cast<int>(EGlobalContext_t::NETCON_S)));
-				this->CloseConnection();
-				continue;
-			}
+		if (!pData->m_bAuthorized || pData->m_bInputOnly)
+		{
+			continue;
+		}
 
-			int nPendingLen = ::recv(pData->m_hSocket, szRecvBuf, sizeof(char), MSG_PEEK);
-			if (nPendingLen == SOCKET_ERROR && m_pSocket->IsSocketBlocking())
-			{
-				continue;
-			}
-			if (nPendingLen <= 0) // EOF or error.
-			{
-				this->CloseConnection();
-				continue;
-			}
-		}//////////////////////////////////////////////
+		if (pData->m_svSendBuf.size() - pData->m_nSendOffset >= RCON_SEND_HIGH_WATER)
+		{
+			pData->m_nDroppedLogs += vLines.size();
+			continue;
+		}
 
-		u_long nReadLen; // Find out how much we have to read.
-		::ioctlsocket(pData->m_hSocket, FIONREAD, &nReadLen);
+		if (pData->m_nDroppedLogs)
+		{
+			const std::string svSummary = fmt::format("Net console can't keep up, dropped '{:d}' log lines\n", pData->m_nDroppedLogs);
+			RCON_AppendFrame(pData->m_svSendBuf, this->Serialize(svSummary, "",
+				sv_rcon::response_t::SERVERDATA_RESPONSE_CONSOLE_LOG, static_cast<int>(EGlobalContext_t::NETCON_S)));
+
+			pData->m_nDroppedLogs = 0;
+		}
+		pData->m_svSendBuf.append(svBatch);
+	}
+	vLines.clear();
+}
 
-		while (nReadLen > 0)
+//-----------------------------------------------------------------------------
+// Purpose: sends pending output of every connection without blocking
+//          (m_SocketMutex must be held)
+//-----------------------------------------------------------------------------
+void CRConServer::FlushSendBuffers(void)
+{
+	for (m_nConnIndex = m_pSocket->GetAcceptedSocketCount() - 1; m_nConnIndex >= 0; m_nConnIndex--)
+	{
+		CConnectedNetConsoleData* pData = m_pSocket->GetAcceptedSocketData(m_nConnIndex);
+		if (pData->m_svSendBuf.empty())
 		{
-			int nRecvLen = ::recv(pData->m_hSocket, szRecvBuf, MIN(sizeof(szRecvBuf), nReadLen), MSG_NOSIGNAL);
-			if (nRecvLen == 0) // Socket was closed.
-			{
-				this->CloseConnection();
-				break;
-			}
-			if (nRecvLen < 0 && !m_pSocket->IsSocketBlocking())
+			continue;
+		}
+
+		if (!this->FlushSendBuffer(pData))
+		{
+			this->CloseConnection();
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: reads everything available on the connection at m_nConnIndex
+//          (network thread, m_SocketMutex must be held)
+// Input  : *pData - 
+//-----------------------------------------------------------------------------
+void CRConServer::Recv(CConnectedNetConsoleData* pData)
+{
+	static char szRecvBuf[4096];
+	const SocketHandle_t hSocket = pData->m_hSocket;
+
+	for (;;)
+	{
+		int nRecvLen = ::recv(hSocket, szRecvBuf, sizeof(szRecvBuf), MSG_NOSIGNAL);
+		if (nRecvLen == 0) // Socket was closed.
+		{
+			this->CloseConnection();
+			return;
+		}
+		if (nRecvLen < 0)
+		{
+			if (!m_pSocket->IsSocketBlocking())
 			{
 				Error(eDLL_T::SERVER, NO_ERROR, "RCON Cmd: recv error (%s)\n", NET_ErrorString(WSAGetLastError()));
-				break;
+				this->CloseConnection();
 			}
+			return;
+		}
+
+		this->ProcessBuffer(szRecvBuf, nRecvLen, pData);
+
+		// Closed while processing the buffer.
+		if (m_pSocket->FindAcceptedSocket(hSocket) == SOCKET_ERROR)
+		{
+			return;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: processes all requests queued by the network thread
+//          (main thread, m_SocketMutex must be held)
+//-----------------------------------------------------------------------------
+void CRConServer::ProcessRequests(void)
+{
+	if (m_vPendingRequests.empty())
+	{
+		return;
+	}
+
+	static std::vector<std::pair<SocketHandle_t, cl_rcon::request>> vRequests;
+	vRequests.swap(m_vPendingRequests);
+
+	for (const std::pair<SocketHandle_t, cl_rcon::request>& request : vRequests)
+	{
+		m_nConnIndex = m_pSocket->FindAcceptedSocket(request.first);
+		if (m_nConnIndex == SOCKET_ERROR)
+		{
+			continue;
+		}
 
-			nReadLen -= nRecvLen; // Process what we've got.
-			this->ProcessBuffer(szRecvBuf, nRecvLen, pData);
+		m_pSocket->GetAcceptedSocketData(m_nConnIndex)->m_nPendingRequests--;
+		if (this->CloseIfBanned())
+		{
+			continue;
+		}
+
+		this->ProcessMessage(request.second);
+
+		// Authentication failures take effect right away rather than on the next request.
+		m_nConnIndex = m_pSocket->FindAcceptedSocket(request.first);
+		if (m_nConnIndex != SOCKET_ERROR)
+		{
+			this->CloseIfBanned();
 		}
 	}
+	vRequests.clear();
 }
 
 //-----------------------------------------------------------------------------
@@ -323,13 +657,14 @@ std::string CRConServer::Serialize(const std::string& svRspBuf, const std::strin
 
 //-----------------------------------------------------------------------------
 // Purpose: de-serializes input
-// Input  : *svBuf - 
+// Input  : *pszBuf - 
+//			nLen - 
 // Output : de-serialized object
 //-----------------------------------------------------------------------------
-cl_rcon::request CRConServer::Deserialize(const std::string& svBuf) const
+cl_rcon::request CRConServer::Deserialize(const char* pszBuf, int nLen) const
 {
 	cl_rcon::request cl_request;
-	cl_request.ParseFromArray(svBuf.data(), static_cast<int>(svBuf.size()));
+	cl_request.ParseFromArray(pszBuf, nLen);
 
 	return cl_request;
 }
@@ -402,64 +737,42 @@ bool CRConServer::Comparator(std::string svPassword) const
 //-----------------------------------------------------------------------------
 void CRConServer::ProcessBuffer(const char* pRecvBuf, int nRecvLen, CConnectedNetConsoleData* pData)
 {
-	while (nRecvLen > 0)
+	// Don't let unauthenticated connections send large messages.
+	const auto fnMaxSize = [pData]()
 	{
-		if (pData->m_nPayloadLen)
+		return pData->m_bAuthorized ? INT_MAX : MAX_NETCONSOLE_INPUT_LEN;
+	};
+
+	const NetConFrameStatus_t nStatus = NetCon_DecodeFrames(pData, pRecvBuf, nRecvLen, fnMaxSize,
+		[this, pData](const char* pFrame, int nFrameLen)
 		{
-			if (pData->m_nPayloadRead < pData->m_nPayloadLen)
+			// Nor flood the main thread with requests before they authenticated.
+			if (!pData->m_bAuthorized && pData->m_nPendingRequests >= RCON_MAX_PENDING_UNAUTH_REQUESTS)
 			{
-				pData->m_RecvBuffer[pData->m_nPayloadRead++] = *pRecvBuf;
-
-				pRecvBuf++;
-				nRecvLen--;
+				return false;
 			}
-			if (pData->m_nPayloadRead == pData->m_nPayloadLen)
-			{
-				this->ProcessMessage(this->Deserialize(std::string(
-					reinterpret_cast<char*>(pData->m_RecvBuffer.data()), pData->m_nPayloadLen)));
 
-				pData->m_nPayloadLen = 0;
-				pData->m_nPayloadRead = 0;
-			}
-		}
-		else if (pData->m_nPayloadRead < sizeof(int)) // Read size field.
-		{
-			pData->m_RecvBuffer[pData->m_nPayloadRead++] = *pRecvBuf;
+			m_vPendingRequests.emplace_back(pData->m_hSocket, this->Deserialize(pFrame, nFrameLen));
+			pData->m_nPendingRequests++;
+			return true;
+		});
 
-			pRecvBuf++;
-			nRecvLen--;
+	if (nStatus == NetConFrameStatus_t::NETCON_FRAME_INVALID_SIZE)
+	{
+		if (pData->m_nPayloadLen < 0)
+		{
+			Error(eDLL_T::SERVER, NO_ERROR, "RCON Cmd: sync error (%d)\n", pData->m_nPayloadLen);
 		}
-		else // Build prefix.
+		this->CloseConnection(); // Out of sync (irrecoverable).
+	}
+	else if (nStatus == NetConFrameStatus_t::NETCON_FRAME_ABORTED)
+	{
+		if (sv_rcon_debug->GetBool())
 		{
-			pData->m_nPayloadLen = static_cast<int>(
-				pData->m_RecvBuffer[0] << 24 |
-				pData->m_RecvBuffer[1] << 16 |
-				pData->m_RecvBuffer[2] << 8  |
-				pData->m_RecvBuffer[3]);
-			pData->m_nPayloadRead = 0;
-
-			if (!pData->m_bAuthorized)
-			{
-				if (pData->m_nPayloadLen > MAX_NETCONSOLE_INPUT_LEN)
-				{
-					this->CloseConnection(); // Sending large messages while not authenticated.
-					break;
-				}
-			}
-
-			if (pData->m_nPayloadLen < 0 ||
-				pData->m_nPayloadLen > pData->m_RecvBuffer.max_size())
-			{
-				Error(eDLL_T::SERVER, NO_ERROR, "RCON Cmd: sync error (%d)\n", pData->m_nPayloadLen);
-				this->CloseConnection(); // Out of sync (irrecoverable).
-
-				break;
-			}
-			else
-			{
-				pData->m_RecvBuffer.resize(pData->m_nPayloadLen);
-			}
+			CNetAdr2 netAdr2 = m_pSocket->GetAcceptedSocketAddress(m_nConnIndex);
+			DevMsg(eDLL_T::SERVER, "Closing RCON connection from '%s': too many requests before authentication\n", netAdr2.GetIPAndPort().c_str());
 		}
+		this->CloseConnection(); // Sending requests faster than they are processed while not authenticated.
 	}
 }
 
@@ -580,6 +893,22 @@ bool CRConServer::CheckForBan(CConnectedNetConsoleData* pData)
 	return false;
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: closes the connection at m_nConnIndex if it has been banned
+// Output : true if the connection has been closed, false otherwise
+//-----------------------------------------------------------------------------
+bool CRConServer::CloseIfBanned(void)
+{
+	CConnectedNetConsoleData* pData = m_pSocket->GetAcceptedSocketData(m_nConnIndex);
+	if (this->CheckForBan(pData))
+	{
+		this->Send(pData->m_hSocket, this->Serialize(s_pszBannedMessage, "", sv_rcon::response_t::SERVERDATA_RESPONSE_AUTH, static_cast<int>(EGlobalContext_t::NETCON_S)));
+		this->CloseConnection();
+		return true;
+	}
+	return false;
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: close specific connection
 //-----------------------------------------------------------------------------
@@ -9,6 +9,13 @@ constexpr char s_pszWrongPwMessage[] = "Admin password incorrect.\n";
 constexpr char s_pszBannedMessage[]  = "Go away.\n";
 constexpr char s_pszAuthMessage[]    = "Authentication successful.\n";
 
+constexpr size_t RCON_MAX_PENDING_LOGS = 4096; // Console logs kept for the next frame before newer ones are dropped.
+constexpr int    RCON_POLL_TIMEOUT     = 50;   // Milliseconds the network thread waits for socket events.
+constexpr size_t RCON_LOG_FLUSH_SIZE   = 16 * 1024;   // Queued log bytes that are sent right away.
+constexpr double RCON_LOG_FLUSH_INTERVAL = 0.05;      // Seconds smaller amounts of log output are held back.
+constexpr size_t RCON_SEND_HIGH_WATER  = 1024 * 1024; // Unsent bytes after which a connection stops receiving logs.
+constexpr int    RCON_MAX_PENDING_UNAUTH_REQUESTS = 8; // Queued requests after which an unauthenticated connection is closed.
+
 class CRConServer
 {
 public:
@@ -22,23 +29,31 @@ public:
 	void Think(void);
 	void RunFrame(void);
 
-	void Send(const std::string& svMessage) const;
-	void Send(SocketHandle_t hSocket, const std::string& svMessage) const;
+	void Send(const std::string& svMessage);
+	void Send(SocketHandle_t hSocket, const std::string& svMessage);
 	void Send(const std::string& svRspBuf, const std::string& svRspVal, sv_rcon::response_t responseType, int nResponseId = -4);
 	void Send(SocketHandle_t hSocket, const std::string& svRspBuf, const std::string& svRspVal, sv_rcon::response_t responseType, int nResponseId = -4);
-	void Recv(void);
+	void Recv(CConnectedNetConsoleData* pData);
+
+	void QueueLogs(std::vector<std::pair<std::string, int>>& vLines);
+	void SendLogs(void);
+
+	bool FlushSendBuffer(CConnectedNetConsoleData* pData);
+	void FlushSendBuffers(void);
 
 	std::string Serialize(const std::string& svRspBuf, const std::string& svRspVal, sv_rcon::response_t responseType, int nResponseId = -4) const;
-	cl_rcon::request Deserialize(const std::string& svBuf) const;
+	cl_rcon::request Deserialize(const char* pszBuf, int nLen) const;
 
 	void Authenticate(const cl_rcon::request& cl_request, CConnectedNetConsoleData* pData);
 	bool Comparator(std::string svPassword) const;
 
 	void ProcessBuffer(const char* pszIn, int nRecvLen, CConnectedNetConsoleData* pData);
+	void ProcessRequests(void);
 	void ProcessMessage(const cl_rcon::request& cl_request);
 
 	void Execute(const cl_rcon::request& cl_request, bool bConVar) const;
 	bool CheckForBan(CConnectedNetConsoleData* pData);
+	bool CloseIfBanned(void);
 
 	void CloseConnection(void);
 	void CloseNonAuthConnection(void);
@@ -46,6 +61,9 @@ public:
 	bool IsInitialized(void) const;
 
 private:
+	void StartNetThread(void);
+	void StopNetThread(void);
+	void NetThread(void);
 
 	bool                     m_bInitialized;
 	int                      m_nConnIndex;
@@ -53,6 +71,20 @@ private:
 	CSocketCreator*          m_pSocket;
 	std::vector<std::string> m_vBannedAddress;
 	std::string              m_svPasswordHash;
+
+	std::mutex               m_LogMutex;
+	std::vector<std::pair<std::string, int>> m_vPendingLogs; // Console logs queued by the log thread.
+	size_t                   m_nPendingLogSize;
+	uint64_t                 m_nOverflowLogs;  // Logs dropped since the last report because the queue was full.
+	double                   m_flLastLogFlush;
+
+	// Accepted sockets are read on the network thread, which queues every
+	// complete request for the main thread. m_SocketMutex guards m_pSocket,
+	// the connection data and m_vPendingRequests between the two.
+	std::recursive_mutex     m_SocketMutex;
+	std::thread              m_NetThread;
+	std::atomic<bool>        m_bNetThreadRunning;
+	std::vector<std::pair<SocketHandle_t, cl_rcon::request>> m_vPendingRequests;
 };
 extern CRConServer* g_pRConServer;
 CRConServer* RCONServer();
\ No newline at end of file
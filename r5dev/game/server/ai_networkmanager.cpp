@@ -6,6 +6,7 @@
 
 #include "core/stdafx.h"
 #include "tier0/fasttimer.h"
+#include "tier0/threadpool.h"
 #include "tier1/cvar.h"
 #include "tier1/cmd.h"
 #include "mathlib/crc32.h"
@@ -16,11 +17,42 @@
 #include "game/server/ai_node.h"
 #include "game/server/ai_network.h"
 #include "game/server/ai_networkmanager.h"
+#include "game/server/ai_nodegrid.h"
 
 constexpr int AINET_SCRIPT_VERSION_NUMBER = 21;
 constexpr int AINET_VERSION_NUMBER        = 57;
 constexpr int AINET_MIN_FILE_SIZE         = 82;
 
+//-----------------------------------------------------------------------------
+// Purpose: copies a value to the graph buffer and advances the cursor
+// Input  : *&pCursor - 
+//          &value - 
+//-----------------------------------------------------------------------------
+template <typename T>
+static void AIGraph_Put(uint8_t*& pCursor, const T& value)
+{
+	memcpy(pCursor, &value, sizeof(T));
+	pCursor += sizeof(T);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: returns the number of links that originate from this node, only
+//          these are written as a link is shared between both of its nodes
+// Input  : *pNode - 
+//-----------------------------------------------------------------------------
+static int AIGraph_GetOwnedLinkCount(const CAI_Node* pNode)
+{
+	int nCount = 0;
+	for (int j = 0; j < pNode->m_nNumLinks; j++)
+	{
+		if (pNode->links[j]->m_iSrcID == pNode->m_nIndex)
+		{
+			nCount++;
+		}
+	}
+	return nCount;
+}
+
 /*
 ==============================
 CAI_NetworkBuilder::BuildFile
@@ -49,19 +81,8 @@ void CAI_NetworkBuilder::SaveNetworkGraph(CAI_Network* pNetwork)
 	masterTimer.Start();
 	timer.Start();
 
-	FileHandle_t pAIGraph = FileSystem()->Open(fsGraphPath.relative_path().u8string().c_str(), "wb", "GAME");
-	if (!pAIGraph)
-	{
-		Error(eDLL_T::SERVER, NO_ERROR, "%s - Unable to write to '%s' (read-only?)\n", __FUNCTION__, fsGraphPath.relative_path().u8string().c_str());
-		return;
-	}
-
-	DevMsg(eDLL_T::SERVER, "+- Writing header...\n");
-	DevMsg(eDLL_T::SERVER, " |-- AINet version: '%d'\n", AINET_VERSION_NUMBER);
-	FileSystem()->Write(&AINET_VERSION_NUMBER, sizeof(int), pAIGraph);
-
-	DevMsg(eDLL_T::SERVER, " |-- Map version: '%d'\n", g_ServerGlobalVariables->m_nMapVersion);
-	FileSystem()->Write(&g_ServerGlobalVariables->m_nMapVersion, sizeof(int), pAIGraph);
+	const bool bVerbose = ai_ainDebugWrite->GetBool();
+	const int nNumNodes = pNetwork->m_pAInode ? pNetwork->m_iNumNodes : 0;
 
 	FileHandle_t pNavMesh = FileSystem()->Open(fsMeshPath.relative_path().u8string().c_str(), "rb", "GAME");
 	uint32_t nNavMeshHash = NULL;
@@ -82,13 +103,68 @@ void CAI_NetworkBuilder::SaveNetworkGraph(CAI_Network* pNetwork)
 		MemAllocSingleton()->Free(pBuf);
 	}
 
+	// Count the links first, every node's links go at a known offset
+	// so the nodes can be serialized in parallel.
+	vector<int> vLinkStart(static_cast<size_t>(nNumNodes) + 1, 0);
+	int nCalculatedLinkcount = 0;
+
+	g_pThreadPool->ParallelFor(0, nNumNodes, 0, [&](size_t nStart, size_t nEnd)
+		{
+			for (size_t i = nStart; i < nEnd; i++)
+			{
+				vLinkStart[i + 1] = AIGraph_GetOwnedLinkCount(pNetwork->m_pAInode[i]);
+			}
+		});
+	for (int i = 0; i < nNumNodes; i++)
+	{
+		vLinkStart[i + 1] += vLinkStart[i];
+		nCalculatedLinkcount += pNetwork->m_pAInode[i]->m_nNumLinks;
+	}
+
+	const int nNumLinks = vLinkStart[nNumNodes];
+	const int nNumClusters = *g_nAiNodeClusters;
+	const int nNumClusterLinks = *g_nAiNodeClusterLinks;
+
+	size_t nClusterSize = 0;
+	for (int i = 0; i < nNumClusters; i++)
+	{
+		const AINodeClusters* nodeClusters = (*g_pppAiNodeClusters)[i];
+		nClusterSize += sizeof(nodeClusters->m_nIndex) + sizeof(nodeClusters->unk1) + sizeof(nodeClusters->m_vOrigin)
+			+ sizeof(nodeClusters->unkcount0) + sizeof(short) * std::max<int>(nodeClusters->unkcount0, 0)
+			+ sizeof(nodeClusters->unkcount1) + sizeof(short) * std::max<int>(nodeClusters->unkcount1, 0)
+			+ sizeof(nodeClusters->unk5);
+	}
+
+	// Lay out the whole file, sections follow each other without padding.
+	const size_t nHeaderSize      = sizeof(int) * 3 + sizeof(uint32_t);
+	const size_t nNodeOffset      = nHeaderSize;
+	const size_t nLinkCountOffset = nNodeOffset + sizeof(CAI_NodeDisk) * nNumNodes;
+	const size_t nLinkOffset      = nLinkCountOffset + sizeof(int);
+	const size_t nHullOffset      = nLinkOffset + sizeof(CAI_NodeLinkDisk) * nNumLinks;
+	const size_t nClusterOffset   = nHullOffset + sizeof(uint32_t) * std::max<int>(pNetwork->m_iNumNodes, 0) + sizeof(short) + (MAX_HULLS * 8);
+	const size_t nClusterLinkOffset = nClusterOffset + sizeof(int) + nClusterSize;
+	const size_t nScriptNodeOffset  = nClusterLinkOffset + sizeof(int) + sizeof(AINodeClusterLinks) * nNumClusterLinks + sizeof(pNetwork->unk5);
+	const size_t nHintOffset      = nScriptNodeOffset + sizeof(pNetwork->m_iNumScriptNodes) + sizeof(CAI_ScriptNode) * pNetwork->m_iNumScriptNodes;
+	const size_t nFileSize        = nHintOffset + sizeof(pNetwork->m_iNumHints) + sizeof(pNetwork->m_Hints[0]) * pNetwork->m_iNumHints;
+
+	vector<uint8_t> vGraph(nFileSize, 0); // Zero filled, the unused blocks are left as is.
+	uint8_t* const pBase = vGraph.data();
+	uint8_t* pCursor = pBase;
+
+	DevMsg(eDLL_T::SERVER, "+- Writing header...\n");
+	DevMsg(eDLL_T::SERVER, " |-- AINet version: '%d'\n", AINET_VERSION_NUMBER);
+	AIGraph_Put(pCursor, AINET_VERSION_NUMBER);
+
+	DevMsg(eDLL_T::SERVER, " |-- Map version: '%d'\n", g_ServerGlobalVariables->m_nMapVersion);
+	AIGraph_Put(pCursor, g_ServerGlobalVariables->m_nMapVersion);
+
 	// Large NavMesh CRC.
 	DevMsg(eDLL_T::SERVER, " |-- NavMesh CRC: '%lx'\n", nNavMeshHash);
-	FileSystem()->Write(&nNavMeshHash, sizeof(uint32_t), pAIGraph);
+	AIGraph_Put(pCursor, nNavMeshHash);
 
 	// Path nodes.
 	DevMsg(eDLL_T::SERVER, " |-- Node count: '%d'\n", pNetwork->m_iNumNodes);
-	FileSystem()->Write(&pNetwork->m_iNumNodes, sizeof(int), pAIGraph);
+	AIGraph_Put(pCursor, pNetwork->m_iNumNodes);
 
 	timer.End();
 	DevMsg(eDLL_T::SERVER, "...done writing header. %lf seconds\n", timer.GetDuration().GetSeconds());
@@ -96,42 +172,68 @@ void CAI_NetworkBuilder::SaveNetworkGraph(CAI_Network* pNetwork)
 	timer.Start();
 	DevMsg(eDLL_T::SERVER, "+- Writing node positions...\n");
 
-	int nCalculatedLinkcount = 0;
-
-	if (pNetwork->m_pAInode)
-	{
-		for (int i = 0; i < pNetwork->m_iNumNodes; i++)
+	g_pThreadPool->ParallelFor(0, nNumNodes, 0, [&](size_t nStart, size_t nEnd)
 		{
-			// Construct on-disk node struct.
-			CAI_NodeDisk diskNode{};
-			diskNode.m_vOrigin.x = pNetwork->m_pAInode[i]->m_vOrigin.x;
-			diskNode.m_vOrigin.y = pNetwork->m_pAInode[i]->m_vOrigin.y;
-			diskNode.m_vOrigin.z = pNetwork->m_pAInode[i]->m_vOrigin.z;
-			diskNode.m_flYaw = pNetwork->m_pAInode[i]->m_flYaw;
-			memcpy(diskNode.hulls, pNetwork->m_pAInode[i]->m_fHulls, sizeof(diskNode.hulls));
-			diskNode.unk0 = static_cast<char>(pNetwork->m_pAInode[i]->unk0);
-			diskNode.unk1 = pNetwork->m_pAInode[i]->unk1;
-
-			for (int j = 0; j < MAX_HULLS; j++)
+			for (size_t i = nStart; i < nEnd; i++)
 			{
-				diskNode.unk2[j] = static_cast<short>(pNetwork->m_pAInode[i]->unk2[j]);
-			}
+				const CAI_Node* pNode = pNetwork->m_pAInode[i];
+
+				// Construct on-disk node struct.
+				CAI_NodeDisk diskNode{};
+				diskNode.m_vOrigin.x = pNode->m_vOrigin.x;
+				diskNode.m_vOrigin.y = pNode->m_vOrigin.y;
+				diskNode.m_vOrigin.z = pNode->m_vOrigin.z;
+				diskNode.m_flYaw = pNode->m_flYaw;
+				memcpy(diskNode.hulls, pNode->m_fHulls, sizeof(diskNode.hulls));
+				diskNode.unk0 = static_cast<char>(pNode->unk0);
+				diskNode.unk1 = pNode->unk1;
+
+				for (int j = 0; j < MAX_HULLS; j++)
+				{
+					diskNode.unk2[j] = static_cast<short>(pNode->unk2[j]);
+				}
 
-			memcpy(diskNode.unk3, pNetwork->m_pAInode[i]->unk3, sizeof(diskNode.unk3));
-			diskNode.unk4 = pNetwork->m_pAInode[i]->unk6;
-			diskNode.unk5 = -1; // aiNetwork->nodes[i]->unk8; // This field is wrong, however it's always -1 in original navmeshes anyway.
-			memcpy(diskNode.unk6, pNetwork->m_pAInode[i]->unk10, sizeof(diskNode.unk6));
+				memcpy(diskNode.unk3, pNode->unk3, sizeof(diskNode.unk3));
+				diskNode.unk4 = pNode->unk6;
+				diskNode.unk5 = -1; // aiNetwork->nodes[i]->unk8; // This field is wrong, however it's always -1 in original navmeshes anyway.
+				memcpy(diskNode.unk6, pNode->unk10, sizeof(diskNode.unk6));
 
+				memcpy(pBase + nNodeOffset + sizeof(CAI_NodeDisk) * i, &diskNode, sizeof(CAI_NodeDisk));
 
-			DevMsg(eDLL_T::SERVER, " |-- Copying node '#%d' from '0x%p' to '0x%zX'\n", pNetwork->m_pAInode[i]->m_nIndex, reinterpret_cast<void*>(pNetwork->m_pAInode[i]), FileSystem()->Tell(pAIGraph));
-			FileSystem()->Write(&diskNode, sizeof(CAI_NodeDisk), pAIGraph);
+				// Links originating from this node.
+				uint8_t* pLink = pBase + nLinkOffset + sizeof(CAI_NodeLinkDisk) * vLinkStart[i];
+				for (int j = 0; j < pNode->m_nNumLinks; j++)
+				{
+					const CAI_NodeLink* pNodeLink = pNode->links[j];
+					if (pNodeLink->m_iSrcID != pNode->m_nIndex)
+					{
+						continue;
+					}
+
+					CAI_NodeLinkDisk diskLink{};
+					diskLink.m_iSrcID = pNodeLink->m_iSrcID;
+					diskLink.m_iDestID = pNodeLink->m_iDestID;
+					diskLink.unk0 = pNodeLink->unk1;
+					memcpy(diskLink.m_bHulls, pNodeLink->m_bHulls, sizeof(diskLink.m_bHulls));
+
+					AIGraph_Put(pLink, diskLink);
+				}
+			}
+		});
+	pCursor = pBase + nLinkCountOffset;
 
-			nCalculatedLinkcount += pNetwork->m_pAInode[i]->m_nNumLinks;
+	if (bVerbose)
+	{
+		for (int i = 0; i < nNumNodes; i++)
+		{
+			DevMsg(eDLL_T::SERVER, " |-- Copying node '#%d' from '0x%p' to '0x%zX'\n", pNetwork->m_pAInode[i]->m_nIndex,
+				reinterpret_cast<void*>(pNetwork->m_pAInode[i]), nNodeOffset + sizeof(CAI_NodeDisk) * i);
 		}
 	}
+
 	timer.End();
 	DevMsg(eDLL_T::SERVER, "...done writing node positions. %lf seconds\n", timer.GetDuration().GetSeconds());
-	
+
 	timer.Start();
 	DevMsg(eDLL_T::SERVER, "+- Writing links...\n");
 
@@ -147,31 +249,17 @@ void CAI_NetworkBuilder::SaveNetworkGraph(CAI_Network* pNetwork)
 		}
 	}
 
-	FileSystem()->Write(&nCalculatedLinkcount, sizeof(int), pAIGraph);
+	AIGraph_Put(pCursor, nCalculatedLinkcount);
 
-	if (pNetwork->m_pAInode)
+	if (bVerbose)
 	{
-		for (int i = 0; i < pNetwork->m_iNumNodes; i++)
+		for (int i = 0; i < nNumLinks; i++)
 		{
-			for (int j = 0; j < pNetwork->m_pAInode[i]->m_nNumLinks; j++)
-			{
-				// Skip links that don't originate from current node.
-				if (pNetwork->m_pAInode[i]->links[j]->m_iSrcID != pNetwork->m_pAInode[i]->m_nIndex)
-				{
-					continue;
-				}
-
-				CAI_NodeLinkDisk diskLink{};
-				diskLink.m_iSrcID = pNetwork->m_pAInode[i]->links[j]->m_iSrcID;
-				diskLink.m_iDestID = pNetwork->m_pAInode[i]->links[j]->m_iDestID;
-				diskLink.unk0 = pNetwork->m_pAInode[i]->links[j]->unk1;
-				memcpy(diskLink.m_bHulls, pNetwork->m_pAInode[i]->links[j]->m_bHulls, sizeof(diskLink.m_bHulls));
-
-				DevMsg(eDLL_T::SERVER, "  |-- Writing link '%h' => '%h' to '0x%zX'\n", diskLink.m_iSrcID, diskLink.m_iDestID, FileSystem()->Tell(pAIGraph));
-				FileSystem()->Write(&diskLink, sizeof(CAI_NodeLinkDisk), pAIGraph);
-			}
+			const CAI_NodeLinkDisk* pDiskLink = reinterpret_cast<const CAI_NodeLinkDisk*>(pCursor) + i;
+			DevMsg(eDLL_T::SERVER, "  |-- Writing link '%hd' => '%hd' to '0x%zX'\n", pDiskLink->m_iSrcID, pDiskLink->m_iDestID, nLinkOffset + sizeof(CAI_NodeLinkDisk) * i);
 		}
 	}
+	pCursor = pBase + nHullOffset;
 
 	timer.End();
 	DevMsg(eDLL_T::SERVER, "...done writing links. %lf seconds (%d links)\n", timer.GetDuration().GetSeconds(), nCalculatedLinkcount);
@@ -179,29 +267,18 @@ void CAI_NetworkBuilder::SaveNetworkGraph(CAI_Network* pNetwork)
 	timer.Start();
 	DevMsg(eDLL_T::SERVER, "+- Writing hull data...\n");
 	// Don't know what this is, it's likely a block from tf1 that got deprecated? should just be 1 int per node.
-	DevMsg(eDLL_T::SERVER, " |-- Writing '%d' bytes for node block at '0x%zX'\n", pNetwork->m_iNumNodes * sizeof(uint32_t), FileSystem()->Tell(pAIGraph));
-
-	if (pNetwork->m_iNumNodes > 0)
-	{
-		uint32_t* unkNodeBlock = MemAllocSingleton()->Alloc<uint32_t>(pNetwork->m_iNumNodes * sizeof(uint32_t));
-		memset(&unkNodeBlock, '\0', pNetwork->m_iNumNodes * sizeof(uint32_t));
-
-		FileSystem()->Write(&*unkNodeBlock, pNetwork->m_iNumNodes * sizeof(uint32_t), pAIGraph);
-		MemAllocSingleton()->Free(unkNodeBlock);
-	}
+	DevMsg(eDLL_T::SERVER, " |-- Writing '%zu' bytes for node block at '0x%zX'\n", sizeof(uint32_t) * std::max<int>(pNetwork->m_iNumNodes, 0), static_cast<size_t>(pCursor - pBase));
+	pCursor += sizeof(uint32_t) * std::max<int>(pNetwork->m_iNumNodes, 0);
 
 	// TODO: This is traverse nodes i think? these aren't used in r2 ains so we can get away with just writing count=0 and skipping
 	// but ideally should actually dump these.
-	DevMsg(eDLL_T::SERVER, " |-- Writing '%d' traversal nodes at '0x%zX'\n", 0, FileSystem()->Tell(pAIGraph));
+	DevMsg(eDLL_T::SERVER, " |-- Writing '%d' traversal nodes at '0x%zX'\n", 0, static_cast<size_t>(pCursor - pBase));
 	short traverseNodeCount = 0; // Only write count since count=0 means we don't have to actually do anything here.
-	FileSystem()->Write(&traverseNodeCount, sizeof(short), pAIGraph);
+	AIGraph_Put(pCursor, traverseNodeCount);
 
 	// TODO: Ideally these should be actually dumped, but they're always 0 in r2 from what i can tell.
-	DevMsg(eDLL_T::SERVER, " |-- Writing '%d' bytes for hull data block at '0x%zX'\n", (MAX_HULLS * 8), FileSystem()->Tell(pAIGraph));
-	for (int i = 0; i < (MAX_HULLS * 8); i++)
-	{
-		FileSystem()->Write("\0", sizeof(char), pAIGraph);
-	}
+	DevMsg(eDLL_T::SERVER, " |-- Writing '%d' bytes for hull data block at '0x%zX'\n", (MAX_HULLS * 8), static_cast<size_t>(pCursor - pBase));
+	pCursor += (MAX_HULLS * 8);
 
 	timer.End();
 	DevMsg(eDLL_T::SERVER, "...done writing hull data. %lf seconds\n", timer.GetDuration().GetSeconds());
@@ -209,67 +286,78 @@ void CAI_NetworkBuilder::SaveNetworkGraph(CAI_Network* pNetwork)
 	timer.Start();
 	DevMsg(eDLL_T::SERVER, "+- Writing clusters...\n");
 
-	FileSystem()->Write(&*g_nAiNodeClusters, sizeof(*g_nAiNodeClusters), pAIGraph);
-	for (int i = 0; i < *g_nAiNodeClusters; i++)
+	AIGraph_Put(pCursor, nNumClusters);
+	for (int i = 0; i < nNumClusters; i++)
 	{
-		DevMsg(eDLL_T::SERVER, " |-- Writing cluster '#%d' at '0x%zX'\n", i, FileSystem()->Tell(pAIGraph));
-		AINodeClusters* nodeClusters = (*g_pppAiNodeClusters)[i];
+		if (bVerbose)
+		{
+			DevMsg(eDLL_T::SERVER, " |-- Writing cluster '#%d' at '0x%zX'\n", i, static_cast<size_t>(pCursor - pBase));
+		}
+		const AINodeClusters* nodeClusters = (*g_pppAiNodeClusters)[i];
 
-		FileSystem()->Write(&nodeClusters->m_nIndex, sizeof(nodeClusters->m_nIndex), pAIGraph);
-		FileSystem()->Write(&nodeClusters->unk1, sizeof(nodeClusters->unk1), pAIGraph);
+		AIGraph_Put(pCursor, nodeClusters->m_nIndex);
+		AIGraph_Put(pCursor, nodeClusters->unk1);
 
-		FileSystem()->Write(&nodeClusters->m_vOrigin.x, sizeof(nodeClusters->m_vOrigin.x), pAIGraph);
-		FileSystem()->Write(&nodeClusters->m_vOrigin.y, sizeof(nodeClusters->m_vOrigin.y), pAIGraph);
-		FileSystem()->Write(&nodeClusters->m_vOrigin.z, sizeof(nodeClusters->m_vOrigin.z), pAIGraph);
+		AIGraph_Put(pCursor, nodeClusters->m_vOrigin.x);
+		AIGraph_Put(pCursor, nodeClusters->m_vOrigin.y);
+		AIGraph_Put(pCursor, nodeClusters->m_vOrigin.z);
 
-		FileSystem()->Write(&nodeClusters->unkcount0, sizeof(nodeClusters->unkcount0), pAIGraph);
+		AIGraph_Put(pCursor, nodeClusters->unkcount0);
 		for (int j = 0; j < nodeClusters->unkcount0; j++)
 		{
-			short unk2Short = static_cast<short>(nodeClusters->unk2[j]);
-			FileSystem()->Write(&unk2Short, sizeof(unk2Short), pAIGraph);
+			AIGraph_Put(pCursor, static_cast<short>(nodeClusters->unk2[j]));
 		}
 
-		FileSystem()->Write(&nodeClusters->unkcount1, sizeof(nodeClusters->unkcount1), pAIGraph);
+		AIGraph_Put(pCursor, nodeClusters->unkcount1);
 		for (int j = 0; j < nodeClusters->unkcount1; j++)
 		{
-			short unk3Short = static_cast<short>(nodeClusters->unk3[j]);
-			FileSystem()->Write(&unk3Short, sizeof(unk3Short), pAIGraph);
+			AIGraph_Put(pCursor, static_cast<short>(nodeClusters->unk3[j]));
 		}
 
-		FileSystem()->Write(&nodeClusters->unk5, sizeof(nodeClusters->unk5), pAIGraph);
+		AIGraph_Put(pCursor, nodeClusters->unk5);
 	}
 
 	timer.End();
-	DevMsg(eDLL_T::SERVER, "...done writing clusters. %lf seconds (%d clusters)\n", timer.GetDuration().GetSeconds(), *g_nAiNodeClusters);
+	DevMsg(eDLL_T::SERVER, "...done writing clusters. %lf seconds (%d clusters)\n", timer.GetDuration().GetSeconds(), nNumClusters);
 
 	timer.Start();
 	DevMsg(eDLL_T::SERVER, "+- Writing cluster links...\n");
 
-	FileSystem()->Write(&*g_nAiNodeClusterLinks, sizeof(*g_nAiNodeClusterLinks), pAIGraph);
-	for (int i = 0; i < *g_nAiNodeClusterLinks; i++)
+	AIGraph_Put(pCursor, nNumClusterLinks);
+	for (int i = 0; i < nNumClusterLinks; i++)
 	{
 		// Disk and memory structs are literally identical here so just directly write.
-		DevMsg(eDLL_T::SERVER, " |-- Writing cluster link '#%d' at '0x%zX'\n", i, FileSystem()->Tell(pAIGraph));
-		FileSystem()->Write(&*g_pppAiNodeClusterLinks[i], sizeof(*(*g_pppAiNodeClusterLinks)[i]), pAIGraph);
+		if (bVerbose)
+		{
+			DevMsg(eDLL_T::SERVER, " |-- Writing cluster link '#%d' at '0x%zX'\n", i, static_cast<size_t>(pCursor - pBase));
+		}
+		AIGraph_Put(pCursor, *(*g_pppAiNodeClusterLinks)[i]);
 	}
 
 	timer.End();
-	DevMsg(eDLL_T::SERVER, "...done writing cluster links. %lf seconds (%d cluster links)\n", timer.GetDuration().GetSeconds(), *g_nAiNodeClusterLinks);
+	DevMsg(eDLL_T::SERVER, "...done writing cluster links. %lf seconds (%d cluster links)\n", timer.GetDuration().GetSeconds(), nNumClusterLinks);
 
 	// This is always set to '-1'. Likely a field for maintaining compatibility.
-	FileSystem()->Write(&pNetwork->unk5, sizeof(pNetwork->unk5), pAIGraph);
+	AIGraph_Put(pCursor, pNetwork->unk5);
 
 	// AIN v57 and above only (not present in r1, static array in r2, pointer to dynamic array in r5).
 	timer.Start();
 	DevMsg(eDLL_T::SERVER, "+- Writing script nodes...\n");
 
-	FileSystem()->Write(&pNetwork->m_iNumScriptNodes, sizeof(pNetwork->m_iNumScriptNodes), pAIGraph);
-	for (int i = 0; i < pNetwork->m_iNumScriptNodes; i++)
+	// Disk and memory structs for script nodes are identical.
+	AIGraph_Put(pCursor, pNetwork->m_iNumScriptNodes);
+	if (pNetwork->m_iNumScriptNodes > 0)
 	{
-		// Disk and memory structs for script nodes are identical.
-		DevMsg(eDLL_T::SERVER, " |-- Writing script node '#%d' at '0x%zX'\n", i, FileSystem()->Tell(pAIGraph));
-		FileSystem()->Write(&pNetwork->m_ScriptNode[i], sizeof(CAI_ScriptNode), pAIGraph);
+		memcpy(pCursor, pNetwork->m_ScriptNode, sizeof(CAI_ScriptNode) * pNetwork->m_iNumScriptNodes);
+	}
+	if (bVerbose)
+	{
+		for (int i = 0; i < pNetwork->m_iNumScriptNodes; i++)
+		{
+			DevMsg(eDLL_T::SERVER, " |-- Writing script node '#%d' at '0x%zX'\n", i, static_cast<size_t>(pCursor - pBase) + sizeof(CAI_ScriptNode) * i);
+		}
 	}
+	pCursor = pBase + nHintOffset;
 
 	timer.End();
 	DevMsg(eDLL_T::SERVER, "...done writing script nodes. %lf seconds (%d nodes)\n", timer.GetDuration().GetSeconds(), pNetwork->m_iNumScriptNodes);
@@ -277,18 +365,43 @@ void CAI_NetworkBuilder::SaveNetworkGraph(CAI_Network* pNetwork)
 	timer.Start();
 	DevMsg(eDLL_T::SERVER, "+- Writing hint data...\n");
 
-	FileSystem()->Write(&pNetwork->m_iNumHints, sizeof(pNetwork->m_iNumHints), pAIGraph);
-	for (int i = 0; i < pNetwork->m_iNumHints; i++)
+	AIGraph_Put(pCursor, pNetwork->m_iNumHints);
+	if (pNetwork->m_iNumHints > 0)
 	{
-		DevMsg(eDLL_T::SERVER, " |-- Writing hint data '#%d' at '0x%zX'\n", i, FileSystem()->Tell(pAIGraph));
-		FileSystem()->Write(&pNetwork->m_Hints[i], sizeof(pNetwork->m_Hints[i]), pAIGraph);
+		memcpy(pCursor, pNetwork->m_Hints, sizeof(pNetwork->m_Hints[0]) * pNetwork->m_iNumHints);
+	}
+	if (bVerbose)
+	{
+		for (int i = 0; i < pNetwork->m_iNumHints; i++)
+		{
+			DevMsg(eDLL_T::SERVER, " |-- Writing hint data '#%d' at '0x%zX'\n", i, static_cast<size_t>(pCursor - pBase) + sizeof(pNetwork->m_Hints[0]) * i);
+		}
 	}
 
 	timer.End();
 	DevMsg(eDLL_T::SERVER, "...done writing hint data. %lf seconds (%d hints)\n", timer.GetDuration().GetSeconds(), pNetwork->m_iNumHints);
 
+	timer.Start();
+	DevMsg(eDLL_T::SERVER, "+- Writing '%zu' bytes to disk...\n", nFileSize);
+
+	FileHandle_t pAIGraph = FileSystem()->Open(fsGraphPath.relative_path().u8string().c_str(), "wb", "GAME");
+	if (!pAIGraph)
+	{
+		Error(eDLL_T::SERVER, NO_ERROR, "%s - Unable to write to '%s' (read-only?)\n", __FUNCTION__, fsGraphPath.relative_path().u8string().c_str());
+		return;
+	}
+
+	const int nWritten = FileSystem()->Write(pBase, static_cast<int>(nFileSize), pAIGraph);
 	FileSystem()->Close(pAIGraph);
 
+	if (nWritten != static_cast<int>(nFileSize))
+	{
+		Error(eDLL_T::SERVER, NO_ERROR, "%s - Wrote '%d' of '%zu' bytes to '%s'\n", __FUNCTION__, nWritten, nFileSize, fsGraphPath.relative_path().u8string().c_str());
+	}
+
+	timer.End();
+	DevMsg(eDLL_T::SERVER, "...done writing to disk. %lf seconds\n", timer.GetDuration().GetSeconds());
+
 	masterTimer.End();
 	DevMsg(eDLL_T::SERVER, "...done writing AI node graph. %lf seconds\n", masterTimer.GetDuration().GetSeconds());
 	DevMsg(eDLL_T::SERVER, "++++--------------------------------------------------------------------------------------------------------------------------++++\n");
@@ -400,13 +513,37 @@ void CAI_NetworkManager::LoadNetworkGraphEx(CAI_NetworkManager* pAINetworkManage
 	CAI_NetworkManager__LoadNetworkGraph(pAINetworkManager, pBuffer, szAIGraphFile);
 #endif
 
+	CAI_Network* pNetwork = *(CAI_Network**)(reinterpret_cast<char*>(pAINetworkManager) + AINETWORK_OFFSET);
+	CAI_NetworkManager::BuildNetworkIndex(pNetwork);
+	LoadNavMeshReachability();
+
 	if (ai_ainDumpOnLoad->GetBool())
 	{
 		DevMsg(eDLL_T::SERVER, "Reparsing AI Network '%s'\n", szAIGraphFile);
-		CAI_NetworkBuilder::SaveNetworkGraph(*(CAI_Network**)(reinterpret_cast<char*>(pAINetworkManager) + AINETWORK_OFFSET));
+		CAI_NetworkBuilder::SaveNetworkGraph(pNetwork);
 	}
 }
 
+/*
+==============================
+CAI_NetworkManager::BuildNetworkIndex
+
+  Index the node positions
+  for nearest node queries
+==============================
+*/
+void CAI_NetworkManager::BuildNetworkIndex(const CAI_Network* pNetwork)
+{
+	CFastTimer timer;
+	timer.Start();
+
+	g_pAINetworkIndex->Build(pNetwork);
+
+	timer.End();
+	DevMsg(eDLL_T::SERVER, "Indexed '%d' script nodes and '%d' path nodes in '%lf' seconds\n",
+		g_pAINetworkIndex->GetScriptNodes().GetNodeCount(), g_pAINetworkIndex->GetPathNodes().GetNodeCount(), timer.GetDuration().GetSeconds());
+}
+
 /*
 ==============================
 CAI_NetworkBuilder::Build
@@ -418,6 +555,7 @@ CAI_NetworkBuilder::Build
 void CAI_NetworkBuilder::Build(CAI_NetworkBuilder* pBuilder, CAI_Network* pAINetwork, void* a3, int a4)
 {
 	CAI_NetworkBuilder__Build(pBuilder, pAINetwork, a3, a4);
+	CAI_NetworkManager::BuildNetworkIndex(pAINetwork);
 	CAI_NetworkBuilder::SaveNetworkGraph(pAINetwork);
 }
 
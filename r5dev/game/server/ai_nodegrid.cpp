@@ -0,0 +1,654 @@
+//=============================================================================//
+//
+// Purpose: Spatial index over AI network nodes
+//
+//=============================================================================//
+
+#include "core/stdafx.h"
+#include "tier0/threadpool.h"
+#include "mathlib/vector.h"
+#include "game/server/ai_node.h"
+#include "game/server/ai_network.h"
+#include "game/server/ai_nodegrid.h"
+#include "game/shared/ai_utility_shared.h"
+#include "public/utility/benchmark.h"
+
+constexpr float AI_NODEGRID_NODES_PER_CELL = 8.0f;
+constexpr int   AI_NODEGRID_BATCH_GRAIN    = 256;
+
+//-----------------------------------------------------------------------------
+// Purpose: 
+//-----------------------------------------------------------------------------
+CAI_NodeGrid::CAI_NodeGrid(void)
+	: m_flMinX(0.0f)
+	, m_flMinY(0.0f)
+	, m_flCellSize(1.0f)
+	, m_flInvCellSize(1.0f)
+	, m_nCellsX(0)
+	, m_nCellsY(0)
+	, m_nNodes(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: builds the grid, the cell size is picked from the node density
+// Input  : &vOrigins - node origins, indexed by node
+//-----------------------------------------------------------------------------
+void CAI_NodeGrid::Build(const vector<Vector3D>& vOrigins)
+{
+	Clear();
+
+	m_nNodes = static_cast<int>(vOrigins.size());
+	if (!m_nNodes)
+		return;
+
+	float flMaxX = vOrigins[0].x;
+	float flMaxY = vOrigins[0].y;
+
+	m_flMinX = flMaxX;
+	m_flMinY = flMaxY;
+
+	for (const Vector3D& vOrigin : vOrigins)
+	{
+		m_flMinX = std::min<float>(m_flMinX, vOrigin.x);
+		m_flMinY = std::min<float>(m_flMinY, vOrigin.y);
+		flMaxX = std::max<float>(flMaxX, vOrigin.x);
+		flMaxY = std::max<float>(flMaxY, vOrigin.y);
+	}
+
+	const float flWidth = flMaxX - m_flMinX;
+	const float flHeight = flMaxY - m_flMinY;
+
+	// The second term bounds the cell count when the nodes lie on a line.
+	m_flCellSize = std::max<float>(sqrtf(flWidth * flHeight * AI_NODEGRID_NODES_PER_CELL / m_nNodes),
+		std::max<float>(std::max<float>(flWidth, flHeight) / m_nNodes, 1.0f));
+	m_flInvCellSize = 1.0f / m_flCellSize;
+
+	m_nCellsX = static_cast<int>(flWidth * m_flInvCellSize) + 1;
+	m_nCellsY = static_cast<int>(flHeight * m_flInvCellSize) + 1;
+
+	// Counting sort of the nodes by cell, stable so that the nodes of a cell
+	// are in ascending order.
+	vector<int32_t> vNodeCell(m_nNodes);
+	m_vCellStart.assign(static_cast<size_t>(m_nCellsX) * m_nCellsY + 1, 0);
+
+	for (int i = 0; i < m_nNodes; i++)
+	{
+		const int nCell = GetCell(vOrigins[i].y, m_flMinY, m_nCellsY) * m_nCellsX + GetCell(vOrigins[i].x, m_flMinX, m_nCellsX);
+
+		vNodeCell[i] = nCell;
+		m_vCellStart[nCell + 1]++;
+	}
+	for (size_t i = 1; i < m_vCellStart.size(); i++)
+	{
+		m_vCellStart[i] += m_vCellStart[i - 1];
+	}
+
+	m_vX.assign(m_nNodes + 3, 0.0f);
+	m_vY.assign(m_nNodes + 3, 0.0f);
+	m_vZ.assign(m_nNodes + 3, 0.0f);
+	m_vNode.assign(m_nNodes + 3, NO_NODE);
+
+	vector<int32_t> vFill(m_vCellStart.begin(), m_vCellStart.end() - 1);
+	for (int i = 0; i < m_nNodes; i++)
+	{
+		const int32_t nSlot = vFill[vNodeCell[i]]++;
+
+		m_vX[nSlot] = vOrigins[i].x;
+		m_vY[nSlot] = vOrigins[i].y;
+		m_vZ[nSlot] = vOrigins[i].z;
+		m_vNode[nSlot] = i;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: 
+//-----------------------------------------------------------------------------
+void CAI_NodeGrid::Clear(void)
+{
+	m_nCellsX = 0;
+	m_nCellsY = 0;
+	m_nNodes = 0;
+
+	m_vCellStart.clear();
+	m_vX.clear();
+	m_vY.clear();
+	m_vZ.clear();
+	m_vNode.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: gets the cell of a coordinate, clamped to the grid
+// Input  : flValue - 
+//          flMin - 
+//          nCells - 
+//-----------------------------------------------------------------------------
+int CAI_NodeGrid::GetCell(float flValue, float flMin, int nCells) const
+{
+	const float flCell = (flValue - flMin) * m_flInvCellSize;
+
+	if (!(flCell > 0.0f)) // Also catches NaN.
+		return 0;
+	if (flCell >= static_cast<float>(nCells - 1))
+		return nCells - 1;
+
+	return static_cast<int>(flCell);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: gets a lower bound of the squared horizontal distance to the nodes
+//          of a cell, the cell is grown by a small margin to absorb rounding
+// Input  : &vPos - 
+//          nCellX - 
+//          nCellY - 
+//-----------------------------------------------------------------------------
+float CAI_NodeGrid::GetCellDistSqr(const Vector3D& vPos, int nCellX, int nCellY) const
+{
+	const float flMargin = m_flCellSize * (1.0f / 1024.0f);
+
+	// Edge cells also hold the nodes that were clamped into them.
+	const float flMinX = nCellX == 0 ? -FLT_MAX : m_flMinX + nCellX * m_flCellSize - flMargin;
+	const float flMaxX = nCellX == m_nCellsX - 1 ? FLT_MAX : m_flMinX + (nCellX + 1) * m_flCellSize + flMargin;
+	const float flMinY = nCellY == 0 ? -FLT_MAX : m_flMinY + nCellY * m_flCellSize - flMargin;
+	const float flMaxY = nCellY == m_nCellsY - 1 ? FLT_MAX : m_flMinY + (nCellY + 1) * m_flCellSize + flMargin;
+
+	const float flDX = std::max<float>(std::max<float>(flMinX - vPos.x, vPos.x - flMaxX), 0.0f);
+	const float flDY = std::max<float>(std::max<float>(flMinY - vPos.y, vPos.y - flMaxY), 0.0f);
+
+	return flDX * flDX + flDY * flDY;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: visits the cells in rings of growing distance around a position,
+//          skipping cells that can't hold a node closer than the current best
+// Input  : &vPos - 
+//          flMaxDist - 
+//          fnScan - float(int nStart, int nEnd), scans a cell's slots and
+//                   returns the squared distance a node has to beat
+//-----------------------------------------------------------------------------
+template <typename ScanFn>
+void CAI_NodeGrid::ScanRings(const Vector3D& vPos, float flMaxDist, ScanFn&& fnScan) const
+{
+	const int nCenterX = GetCell(vPos.x, m_flMinX, m_nCellsX);
+	const int nCenterY = GetCell(vPos.y, m_flMinY, m_nCellsY);
+
+	const int nLastRing = std::max<int>(std::max<int>(nCenterX, m_nCellsX - 1 - nCenterX),
+		std::max<int>(nCenterY, m_nCellsY - 1 - nCenterY));
+
+	float flBound = flMaxDist * flMaxDist;
+
+	auto ScanCell = [&](int x, int y)
+	{
+		if (GetCellDistSqr(vPos, x, y) > flBound)
+			return;
+
+		const int nCell = y * m_nCellsX + x;
+		if (m_vCellStart[nCell] != m_vCellStart[nCell + 1])
+		{
+			flBound = fnScan(m_vCellStart[nCell], m_vCellStart[nCell + 1]);
+		}
+	};
+
+	for (int r = 0; r <= nLastRing; r++)
+	{
+		// Every cell of this ring is at least 'r - 1' cells away.
+		if (r > 1)
+		{
+			const float flRingDist = (r - 1) * m_flCellSize * (1.0f - 1.0f / 1024.0f);
+			if (flRingDist * flRingDist > flBound)
+				break;
+		}
+
+		const int nMinX = std::max<int>(nCenterX - r, 0);
+		const int nMaxX = std::min<int>(nCenterX + r, m_nCellsX - 1);
+
+		for (int y = std::max<int>(nCenterY - r, 0), nMaxY = std::min<int>(nCenterY + r, m_nCellsY - 1); y <= nMaxY; y++)
+		{
+			if (y == nCenterY - r || y == nCenterY + r) // Top and bottom rows.
+			{
+				for (int x = nMinX; x <= nMaxX; x++)
+				{
+					ScanCell(x, y);
+				}
+			}
+			else // Left and right columns.
+			{
+				if (nCenterX - r >= 0)
+					ScanCell(nCenterX - r, y);
+				if (nCenterX + r < m_nCellsX)
+					ScanCell(nCenterX + r, y);
+			}
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: finds the nearest node
+// Input  : &vPos - 
+//          flMaxDist - only nodes closer than this are considered
+// Output : node index, NO_NODE if none is in range
+//-----------------------------------------------------------------------------
+int CAI_NodeGrid::FindNearest(const Vector3D& vPos, float flMaxDist) const
+{
+	if (!m_nNodes)
+		return NO_NODE;
+
+	const __m128 xPosX = _mm_set1_ps(vPos.x);
+	const __m128 xPosY = _mm_set1_ps(vPos.y);
+	const __m128 xPosZ = _mm_set1_ps(vPos.z);
+	const __m128i xLane = _mm_setr_epi32(0, 1, 2, 3);
+
+	__m128 xBest = _mm_set1_ps(flMaxDist * flMaxDist);
+	__m128i xBestNode = _mm_set1_epi32(NO_NODE);
+
+	ScanRings(vPos, flMaxDist, [&](int nStart, int nEnd)
+		{
+			const __m128i xEnd = _mm_set1_epi32(nEnd);
+			for (int i = nStart; i < nEnd; i += 4)
+			{
+				// Same operation order as the linear scan, so the distances
+				// and thus the chosen node are identical.
+				const __m128 xDX = _mm_sub_ps(_mm_loadu_ps(&m_vX[i]), xPosX);
+				const __m128 xDY = _mm_sub_ps(_mm_loadu_ps(&m_vY[i]), xPosY);
+				const __m128 xDZ = _mm_sub_ps(_mm_loadu_ps(&m_vZ[i]), xPosZ);
+				const __m128 xDist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xDY, xDY), _mm_mul_ps(xDX, xDX)), _mm_mul_ps(xDZ, xDZ));
+
+				const __m128i xNode = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&m_vNode[i]));
+				const __m128i xInCell = _mm_cmplt_epi32(_mm_add_epi32(_mm_set1_epi32(i), xLane), xEnd);
+				const __m128i xTie = _mm_and_si128(_mm_castps_si128(_mm_cmpeq_ps(xDist, xBest)), _mm_cmplt_epi32(xNode, xBestNode));
+				const __m128i xTake = _mm_and_si128(_mm_or_si128(_mm_castps_si128(_mm_cmplt_ps(xDist, xBest)), xTie), xInCell);
+
+				xBest = _mm_or_ps(_mm_and_ps(_mm_castsi128_ps(xTake), xDist), _mm_andnot_ps(_mm_castsi128_ps(xTake), xBest));
+				xBestNode = _mm_or_si128(_mm_and_si128(xTake, xNode), _mm_andnot_si128(xTake, xBestNode));
+			}
+
+			const __m128 xMin = _mm_min_ps(xBest, _mm_shuffle_ps(xBest, xBest, _MM_SHUFFLE(2, 3, 0, 1)));
+			return _mm_cvtss_f32(_mm_min_ps(xMin, _mm_shuffle_ps(xMin, xMin, _MM_SHUFFLE(1, 0, 3, 2))));
+		});
+
+	float flBest[4];
+	int32_t nBestNode[4];
+
+	_mm_storeu_ps(flBest, xBest);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(nBestNode), xBestNode);
+
+	int nNearest = NO_NODE;
+	float flNearest = 0.0f;
+
+	for (int i = 0; i < 4; i++)
+	{
+		if (nBestNode[i] == NO_NODE)
+			continue;
+
+		if (nNearest == NO_NODE || flBest[i] < flNearest || (flBest[i] == flNearest && nBestNode[i] < nNearest))
+		{
+			nNearest = nBestNode[i];
+			flNearest = flBest[i];
+		}
+	}
+
+	return nNearest;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: finds the nearest nodes, closest first
+// Input  : &vPos - 
+//          flMaxDist - only nodes closer than this are considered
+//          nCount - 
+//          *pOutNodes - receives up to 'nCount' node indices
+//          *pOutDistSqr - optionally receives the squared distances
+// Output : number of nodes found
+//-----------------------------------------------------------------------------
+int CAI_NodeGrid::FindNearestK(const Vector3D& vPos, float flMaxDist, int nCount, int* pOutNodes, float* pOutDistSqr) const
+{
+	if (!m_nNodes || nCount <= 0)
+		return 0;
+
+	typedef std::pair<float, int32_t> Candidate_t; // Ordered by distance, then by node.
+
+	vector<Candidate_t> vHeap; // Max heap, the worst candidate on top.
+	vHeap.reserve(nCount);
+
+	const float flMaxDistSqr = flMaxDist * flMaxDist;
+
+	ScanRings(vPos, flMaxDist, [&](int nStart, int nEnd)
+		{
+			for (int i = nStart; i < nEnd; i++)
+			{
+				const float flDX = m_vX[i] - vPos.x;
+				const float flDY = m_vY[i] - vPos.y;
+				const float flDZ = m_vZ[i] - vPos.z;
+				const Candidate_t candidate((flDY * flDY + flDX * flDX) + flDZ * flDZ, m_vNode[i]);
+
+				if (!(candidate.first < flMaxDistSqr))
+					continue;
+
+				if (vHeap.size() < static_cast<size_t>(nCount))
+				{
+					vHeap.push_back(candidate);
+					std::push_heap(vHeap.begin(), vHeap.end());
+				}
+				else if (candidate < vHeap.front())
+				{
+					std::pop_heap(vHeap.begin(), vHeap.end());
+					vHeap.back() = candidate;
+					std::push_heap(vHeap.begin(), vHeap.end());
+				}
+			}
+
+			return vHeap.size() < static_cast<size_t>(nCount) ? flMaxDistSqr : vHeap.front().first;
+		});
+
+	std::sort_heap(vHeap.begin(), vHeap.end());
+
+	for (size_t i = 0; i < vHeap.size(); i++)
+	{
+		pOutNodes[i] = vHeap[i].second;
+		if (pOutDistSqr)
+			pOutDistSqr[i] = vHeap[i].first;
+	}
+
+	return static_cast<int>(vHeap.size());
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: finds all nodes within a radius
+// Input  : &vPos - 
+//          flRadius - 
+//          &vOutNodes - receives the node indices in ascending order
+//-----------------------------------------------------------------------------
+void CAI_NodeGrid::FindInRadius(const Vector3D& vPos, float flRadius, vector<int>& vOutNodes) const
+{
+	vOutNodes.clear();
+
+	if (!m_nNodes || !(flRadius >= 0.0f))
+		return;
+
+	const float flRadiusSqr = flRadius * flRadius;
+
+	const int nMinX = GetCell(vPos.x - flRadius, m_flMinX, m_nCellsX);
+	const int nMaxX = GetCell(vPos.x + flRadius, m_flMinX, m_nCellsX);
+	const int nMinY = GetCell(vPos.y - flRadius, m_flMinY, m_nCellsY);
+	const int nMaxY = GetCell(vPos.y + flRadius, m_flMinY, m_nCellsY);
+
+	for (int y = nMinY; y <= nMaxY; y++)
+	{
+		for (int x = nMinX; x <= nMaxX; x++)
+		{
+			if (GetCellDistSqr(vPos, x, y) > flRadiusSqr)
+				continue;
+
+			const int nCell = y * m_nCellsX + x;
+			for (int i = m_vCellStart[nCell], j = m_vCellStart[nCell + 1]; i < j; i++)
+			{
+				const float flDX = m_vX[i] - vPos.x;
+				const float flDY = m_vY[i] - vPos.y;
+				const float flDZ = m_vZ[i] - vPos.z;
+
+				if ((flDY * flDY + flDX * flDX) + flDZ * flDZ <= flRadiusSqr)
+				{
+					vOutNodes.push_back(m_vNode[i]);
+				}
+			}
+		}
+	}
+
+	std::sort(vOutNodes.begin(), vOutNodes.end());
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: finds the nearest node for many positions, the positions are
+//          visited in cell order and split over the thread pool
+// Input  : *pPositions - 
+//          nCount - 
+//          flMaxDist - 
+//          *pOutNodes - receives a node index or NO_NODE per position
+//-----------------------------------------------------------------------------
+void CAI_NodeGrid::FindNearestBatch(const Vector3D* pPositions, int nCount, float flMaxDist, int* pOutNodes) const
+{
+	if (nCount <= 0)
+		return;
+
+	if (!m_nNodes)
+	{
+		std::fill(pOutNodes, pOutNodes + nCount, NO_NODE);
+		return;
+	}
+
+	// Queries that start in the same cell scan the same nodes, running them
+	// back to back keeps those nodes in cache.
+	vector<std::pair<int32_t, int32_t>> vOrder(nCount); // Cell, position index.
+	for (int i = 0; i < nCount; i++)
+	{
+		vOrder[i].first = GetCell(pPositions[i].y, m_flMinY, m_nCellsY) * m_nCellsX + GetCell(pPositions[i].x, m_flMinX, m_nCellsX);
+		vOrder[i].second = i;
+	}
+	std::sort(vOrder.begin(), vOrder.end());
+
+	g_pThreadPool->ParallelFor(0, vOrder.size(), AI_NODEGRID_BATCH_GRAIN, [&](size_t nStart, size_t nEnd)
+		{
+			for (size_t i = nStart; i < nEnd; i++)
+			{
+				const int nIndex = vOrder[i].second;
+				pOutNodes[nIndex] = FindNearest(pPositions[nIndex], flMaxDist);
+			}
+		});
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: nearest script node by testing every node like the engine does,
+//          the reference the grid is verified against
+// Input  : *pNetwork - 
+//          &vPos - 
+// Output : node index, NO_NODE if none is in range
+//-----------------------------------------------------------------------------
+static int AI_GetNearestNodeLinear(const CAI_Network* pNetwork, const Vector3D& vPos)
+{
+	float flBest = AI_NEAREST_NODE_MAX_DIST * AI_NEAREST_NODE_MAX_DIST;
+	int nBest = NO_NODE;
+
+	for (int i = 0; i < pNetwork->m_iNumScriptNodes; i++)
+	{
+		const Vector3D& vOrigin = pNetwork->m_ScriptNode[i].m_vOrigin;
+		const float flDX = vOrigin.x - vPos.x;
+		const float flDY = vOrigin.y - vPos.y;
+		const float flDZ = vOrigin.z - vPos.z;
+		const float flDist = (flDY * flDY + flDX * flDX) + flDZ * flDZ;
+
+		if (flDist < flBest)
+		{
+			flBest = flDist;
+			nBest = i;
+		}
+	}
+
+	return nBest;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: 
+//-----------------------------------------------------------------------------
+CAI_NetworkIndex::CAI_NetworkIndex(void)
+	: m_pNetwork(nullptr)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: indexes the script nodes and path nodes of a network
+// Input  : *pNetwork - 
+//-----------------------------------------------------------------------------
+void CAI_NetworkIndex::Build(const CAI_Network* pNetwork)
+{
+	Clear();
+
+	if (!pNetwork)
+		return;
+
+	vector<Vector3D> vOrigins(std::max<int>(pNetwork->m_iNumScriptNodes, 0));
+	for (size_t i = 0; i < vOrigins.size(); i++)
+	{
+		vOrigins[i] = pNetwork->m_ScriptNode[i].m_vOrigin;
+	}
+	m_ScriptNodes.Build(vOrigins);
+
+	vOrigins.assign(pNetwork->m_pAInode ? std::max<int>(pNetwork->m_iNumNodes, 0) : 0, Vector3D());
+	for (size_t i = 0; i < vOrigins.size(); i++)
+	{
+		vOrigins[i] = pNetwork->m_pAInode[i]->m_vOrigin;
+	}
+	m_PathNodes.Build(vOrigins);
+
+	m_pNetwork = pNetwork;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: 
+//-----------------------------------------------------------------------------
+void CAI_NetworkIndex::Clear(void)
+{
+	m_pNetwork = nullptr;
+	m_ScriptNodes.Clear();
+	m_PathNodes.Clear();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: checks whether the grids are up to date with the network
+// Input  : *pNetwork - 
+//-----------------------------------------------------------------------------
+bool CAI_NetworkIndex::IsBuiltFor(const CAI_Network* pNetwork) const
+{
+	return pNetwork && pNetwork == m_pNetwork
+		&& pNetwork->m_iNumScriptNodes == m_ScriptNodes.GetNodeCount()
+		&& (pNetwork->m_pAInode ? pNetwork->m_iNumNodes : 0) == m_PathNodes.GetNodeCount();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: times the script node grid against the linear scan on the indexed
+//          network and verifies every grid query
+// Input  : &bench - 
+//          nQueries - 
+// Output : true if every query matched
+//-----------------------------------------------------------------------------
+bool CAI_NetworkIndex::Benchmark(CBenchmark& bench, int nQueries) const
+{
+	const int nNodes = m_ScriptNodes.GetNodeCount();
+	if (!m_pNetwork || !nNodes)
+	{
+		bench.Warn("The indexed AI network has no script nodes");
+		return false;
+	}
+
+	const int nVerified = std::min<int>(nQueries, 1000); // K nearest and radius queries checked against a brute force scan.
+	const int nNearestK = 8;
+	const float flRadius = 512.0f;
+	const float flMaxDistSqr = AI_NEAREST_NODE_MAX_DIST * AI_NEAREST_NODE_MAX_DIST;
+
+	// Queries start at random nodes and are moved up to twice the search
+	// range, so some of them have no node in range.
+	std::mt19937 rng(BENCH_RANDOM_SEED);
+	std::uniform_real_distribution<float> offset(-2.0f * AI_NEAREST_NODE_MAX_DIST, 2.0f * AI_NEAREST_NODE_MAX_DIST);
+
+	vector<Vector3D> vPositions(nQueries);
+	for (Vector3D& vPos : vPositions)
+	{
+		const Vector3D& vOrigin = m_pNetwork->m_ScriptNode[rng() % nNodes].m_vOrigin;
+		vPos = Vector3D(vOrigin.x + offset(rng), vOrigin.y + offset(rng), vOrigin.z + offset(rng) * 0.25f);
+	}
+
+	vector<int> vLinear(nQueries);
+	vector<int> vGrid(nQueries);
+	vector<int> vBatch(nQueries);
+
+	const double flLinearTime = CBenchmark::Time([&]()
+		{
+			for (int i = 0; i < nQueries; i++)
+			{
+				vLinear[i] = AI_GetNearestNodeLinear(m_pNetwork, vPositions[i]);
+			}
+		});
+	const double flGridTime = CBenchmark::Time([&]()
+		{
+			for (int i = 0; i < nQueries; i++)
+			{
+				vGrid[i] = m_ScriptNodes.FindNearest(vPositions[i], AI_NEAREST_NODE_MAX_DIST);
+			}
+		});
+	const double flBatchTime = CBenchmark::Time([&]()
+		{
+			m_ScriptNodes.FindNearestBatch(vPositions.data(), nQueries, AI_NEAREST_NODE_MAX_DIST, vBatch.data());
+		});
+
+	size_t nFound = 0;
+	for (int i = 0; i < nQueries; i++)
+	{
+		if (vLinear[i] != NO_NODE)
+			nFound++;
+
+		bench.Verify(vGrid[i] == vLinear[i] && vBatch[i] == vLinear[i], "Nearest node to '(%f, %f, %f)': linear '%d', grid '%d', batch '%d'",
+			vPositions[i].x, vPositions[i].y, vPositions[i].z, vLinear[i], vGrid[i], vBatch[i]);
+	}
+
+	// Brute force references for the queries the engine has no linear
+	// version of, distances use the same operation order as the grid.
+	vector<std::pair<float, int>> vAll(nNodes);
+	vector<int> vExpected;
+	vector<int> vActual;
+	int nKNodes[nNearestK];
+
+	double flKTime = 0.0;
+	double flRadiusTime = 0.0;
+
+	for (int i = 0; i < nVerified; i++)
+	{
+		const Vector3D& vPos = vPositions[i];
+
+		for (int n = 0; n < nNodes; n++)
+		{
+			const Vector3D& vOrigin = m_pNetwork->m_ScriptNode[n].m_vOrigin;
+			const float flDX = vOrigin.x - vPos.x;
+			const float flDY = vOrigin.y - vPos.y;
+			const float flDZ = vOrigin.z - vPos.z;
+
+			vAll[n] = std::make_pair((flDY * flDY + flDX * flDX) + flDZ * flDZ, n);
+		}
+		std::sort(vAll.begin(), vAll.end());
+
+		vExpected.clear();
+		for (int n = 0; n < nNodes && static_cast<int>(vExpected.size()) < nNearestK && vAll[n].first < flMaxDistSqr; n++)
+		{
+			vExpected.push_back(vAll[n].second);
+		}
+
+		int nKFound = 0;
+		flKTime += CBenchmark::Time([&]() { nKFound = m_ScriptNodes.FindNearestK(vPos, AI_NEAREST_NODE_MAX_DIST, nNearestK, nKNodes); });
+
+		vActual.assign(nKNodes, nKNodes + nKFound);
+		bench.Verify(vActual == vExpected, "Nearest '%d' nodes to '(%f, %f, %f)' disagree with the brute force scan ('%d' vs '%zu' found)",
+			nNearestK, vPos.x, vPos.y, vPos.z, nKFound, vExpected.size());
+
+		vExpected.clear();
+		for (int n = 0; n < nNodes && vAll[n].first <= flRadius * flRadius; n++)
+		{
+			vExpected.push_back(vAll[n].second);
+		}
+		std::sort(vExpected.begin(), vExpected.end());
+
+		flRadiusTime += CBenchmark::Time([&]() { m_ScriptNodes.FindInRadius(vPos, flRadius, vActual); });
+
+		bench.Verify(vActual == vExpected, "Nodes within '%.0f' of '(%f, %f, %f)' disagree with the brute force scan ('%zu' vs '%zu' found)",
+			flRadius, vPos.x, vPos.y, vPos.z, vActual.size(), vExpected.size());
+	}
+
+	bench.Msg("Nearest node over '%d' script nodes, '%d' queries ('%zu' found):", nNodes, nQueries, nFound);
+	bench.Msg("Linear : '%.3f' milliseconds ('%.3f' microseconds per query)", flLinearTime * 1e3, flLinearTime * 1e6 / nQueries);
+	bench.Msg("Grid   : '%.3f' milliseconds ('%.3f' microseconds per query, %.1fx)",
+		flGridTime * 1e3, flGridTime * 1e6 / nQueries, flGridTime > 0.0 ? flLinearTime / flGridTime : 0.0);
+	bench.Msg("Batch  : '%.3f' milliseconds ('%.3f' microseconds per query, %.1fx)",
+		flBatchTime * 1e3, flBatchTime * 1e6 / nQueries, flBatchTime > 0.0 ? flLinearTime / flBatchTime : 0.0);
+	bench.Msg("Nearest '%d': '%.3f' microseconds per query, within '%.0f': '%.3f' microseconds per query ('%d' verified)",
+		nNearestK, flKTime * 1e6 / nVerified, flRadius, flRadiusTime * 1e6 / nVerified, nVerified);
+
+	return bench.Summarize("grid queries", "the linear scan");
+}
+
+CAI_NetworkIndex* g_pAINetworkIndex = new CAI_NetworkIndex();
@@ -0,0 +1,75 @@
+#ifndef AI_NODEGRID_H
+#define AI_NODEGRID_H
+
+class CAI_Network;
+class CBenchmark;
+
+//-----------------------------------------------------------------------------
+// Uniform 2D grid over node origins. Nodes are stored per cell as separate
+// x, y and z arrays so a cell is scanned four nodes at a time. Queries return
+// node indices into the array the grid was built from; equally distant nodes
+// resolve to the lowest index, like the linear scan the grid replaces.
+//-----------------------------------------------------------------------------
+class CAI_NodeGrid
+{
+public:
+	CAI_NodeGrid(void);
+
+	void Build(const vector<Vector3D>& vOrigins);
+	void Clear(void);
+
+	int  FindNearest(const Vector3D& vPos, float flMaxDist) const;
+	int  FindNearestK(const Vector3D& vPos, float flMaxDist, int nCount, int* pOutNodes, float* pOutDistSqr = nullptr) const;
+	void FindInRadius(const Vector3D& vPos, float flRadius, vector<int>& vOutNodes) const;
+	void FindNearestBatch(const Vector3D* pPositions, int nCount, float flMaxDist, int* pOutNodes) const;
+
+	int  GetNodeCount(void) const { return m_nNodes; }
+
+private:
+	int  GetCell(float flValue, float flMin, int nCells) const;
+	float GetCellDistSqr(const Vector3D& vPos, int nCellX, int nCellY) const;
+
+	template <typename ScanFn>
+	void ScanRings(const Vector3D& vPos, float flMaxDist, ScanFn&& fnScan) const;
+
+	float            m_flMinX;
+	float            m_flMinY;
+	float            m_flCellSize;
+	float            m_flInvCellSize;
+	int              m_nCellsX;
+	int              m_nCellsY;
+	int              m_nNodes;
+
+	vector<int32_t>  m_vCellStart; // Per cell: first slot in the arrays below, one past the last cell at the end.
+	vector<float>    m_vX;         // Padded with 3 slots so the last cell can be loaded 4 at a time.
+	vector<float>    m_vY;
+	vector<float>    m_vZ;
+	vector<int32_t>  m_vNode;      // Node index per slot, ascending within a cell.
+};
+
+//-----------------------------------------------------------------------------
+// Grids over the script nodes and the path nodes of the loaded AI network,
+// rebuilt every time a network is loaded or built.
+//-----------------------------------------------------------------------------
+class CAI_NetworkIndex
+{
+public:
+	CAI_NetworkIndex(void);
+
+	void Build(const CAI_Network* pNetwork);
+	void Clear(void);
+
+	bool IsBuiltFor(const CAI_Network* pNetwork) const;
+	bool Benchmark(CBenchmark& bench, int nQueries) const;
+
+	const CAI_NodeGrid& GetScriptNodes(void) const { return m_ScriptNodes; }
+	const CAI_NodeGrid& GetPathNodes(void) const { return m_PathNodes; }
+
+private:
+	const CAI_Network* m_pNetwork;
+	CAI_NodeGrid       m_ScriptNodes;
+	CAI_NodeGrid       m_PathNodes;
+};
+
+extern CAI_NetworkIndex* g_pAINetworkIndex;
+#endif // AI_NODEGRID_H
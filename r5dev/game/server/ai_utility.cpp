@@ -15,6 +15,20 @@ inline uint32_t g_pHullMasks[10] = // Hull mask table [r5apex_ds.exe + 131a2f8].
     0xfffffffb, 0xfffffffa, 0xfffffff9, 0xfffffff8, 0x00040200
 };
 
+//-----------------------------------------------------------------------------
+// Poly group reachability of a loaded navmesh, bit 'goal' of row 'from' is set
+// if poly group 'goal' can be reached from poly group 'from'.
+//-----------------------------------------------------------------------------
+struct NavMeshReachability_t
+{
+    const dtNavMesh* m_pNavMesh;
+    int m_nGroupCount;
+    int m_nRowWords;
+    const uint32_t* m_pTable; // Owned by the navmesh.
+};
+
+static NavMeshReachability_t s_NavMeshReachability[ARRAYSIZE(SHULL_SIZE)];
+
 //-----------------------------------------------------------------------------
 // Purpose: gets the navmesh by hull from global array [small, med_short, medium, large, extra_large]
 // input  : hull - 
@@ -50,9 +64,83 @@ uint8_t IsGoalPolyReachable(dtNavMesh* nav, dtPolyRef fromRef, dtPolyRef goalRef
 	if (navmesh_always_reachable->GetBool())
 		return true;
 
+    for (const NavMeshReachability_t& reachability : s_NavMeshReachability)
+    {
+        if (reachability.m_pNavMesh != nav)
+            continue;
+
+        const int nFromGroup = GetPolyGroup(nav, fromRef);
+        const int nGoalGroup = GetPolyGroup(nav, goalRef);
+
+        if (nFromGroup < reachability.m_nGroupCount && nGoalGroup < reachability.m_nGroupCount)
+            return (reachability.m_pTable[nFromGroup * reachability.m_nRowWords + nGoalGroup / 32] >> (nGoalGroup & 31)) & 1;
+
+        break; // Poly refs that don't resolve are left to the engine.
+    }
+
     return v_dtNavMesh__isPolyReachable(nav, fromRef, goalRef, hullId);
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: gets the disjoint poly group of a poly
+// Input  : *nav - 
+//          polyRef - 
+// Output : group index, INT_MAX if the reference is invalid
+//-----------------------------------------------------------------------------
+int GetPolyGroup(const dtNavMesh* nav, dtPolyRef polyRef)
+{
+    unsigned int salt, it, ip;
+    nav->decodePolyId(polyRef, salt, it, ip);
+
+    if (it >= static_cast<unsigned int>(nav->m_maxTiles))
+        return INT_MAX;
+
+    const dtMeshTile* tile = &nav->m_tiles[it];
+    if (tile->salt != salt || !tile->header || ip >= static_cast<unsigned int>(tile->header->polyCount))
+        return INT_MAX;
+
+    return tile->polys[ip].disjointSetId;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: looks up the reachability tables the engine loaded with the
+//          navmeshes, navmeshes without a valid table are left to the engine
+//-----------------------------------------------------------------------------
+void LoadNavMeshReachability(void)
+{
+    for (int i = 0; i < static_cast<int>(ARRAYSIZE(s_NavMeshReachability)); i++)
+    {
+        NavMeshReachability_t& reachability = s_NavMeshReachability[i];
+
+        reachability.m_pNavMesh = nullptr;
+        reachability.m_nGroupCount = 0;
+        reachability.m_nRowWords = 0;
+        reachability.m_pTable = nullptr;
+
+        const dtNavMesh* nav = GetNavMeshForHull(i);
+        if (!nav || !nav->m_setTables || !nav->m_setTables[0])
+            continue;
+
+        const dtNavMeshParams& params = nav->m_params;
+        if (params.disjointPolyGroupCount <= 0 || params.reachabilityTableCount <= 0)
+            continue;
+
+        const int nGroupCount = params.disjointPolyGroupCount;
+        const int nRowWords = (nGroupCount + 31) / 32;
+
+        // Older files carry a placeholder table of a different size.
+        if (static_cast<int64_t>(nRowWords) * nGroupCount * sizeof(uint32_t) != params.reachabilityTableSize)
+            continue;
+
+        reachability.m_pNavMesh = nav;
+        reachability.m_nGroupCount = nGroupCount;
+        reachability.m_nRowWords = nRowWords;
+        reachability.m_pTable = reinterpret_cast<const uint32_t*>(nav->m_setTables[0]); // Every table holds the same links.
+
+        DevMsg(eDLL_T::SERVER, "Using %s NavMesh reachability table ('%d' poly groups)\n", SHULL_SIZE[i].c_str(), nGroupCount);
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void CAI_Utility_Attach()
 {
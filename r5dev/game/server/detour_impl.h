@@ -38,6 +38,8 @@ inline dtNavMeshQuery* g_pNavMeshQuery = nullptr;
 
 dtNavMesh* GetNavMeshForHull(int hullSize);
 uint32_t GetHullMaskById(int hullId);
+int GetPolyGroup(const dtNavMesh* nav, dtPolyRef polyRef);
+void LoadNavMeshReachability(void);
 ///////////////////////////////////////////////////////////////////////////////
 class VRecast : public IDetour
 {
@@ -16,6 +16,7 @@
 #include "game/server/ai_utility.h"
 #include "game/server/ai_networkmanager.h"
 #include "game/server/ai_network.h"
+#include "game/server/ai_nodegrid.h"
 #include "game/client/view.h"
 #include "thirdparty/recast/detour/include/detourcommon.h"
 #include "thirdparty/recast/detour/include/detournavmesh.h"
@@ -469,6 +470,23 @@ uint64_t CAI_Utility::PackNodeLink(uint32_t a, uint32_t b) const
 // Output : node index ('NO_NODE' if no node has been found)
 //------------------------------------------------------------------------------
 int64_t CAI_Utility::GetNearestNodeToPos(const CAI_Network* pAINetwork, const Vector3D* vPos) const
+{
+    if (pAINetwork && g_pAINetworkIndex->IsBuiltFor(pAINetwork))
+    {
+        return g_pAINetworkIndex->GetScriptNodes().FindNearest(*vPos, AI_NEAREST_NODE_MAX_DIST);
+    }
+
+    return GetNearestNodeToPosLinear(pAINetwork, vPos);
+}
+
+//------------------------------------------------------------------------------
+// Purpose: gets the nearest node index to position by testing every node,
+//          used when the network hasn't been indexed
+// Input  : *vPos       - 
+//          *pAINetwork - 
+// Output : node index ('NO_NODE' if no node has been found)
+//------------------------------------------------------------------------------
+int64_t CAI_Utility::GetNearestNodeToPosLinear(const CAI_Network* pAINetwork, const Vector3D* vPos) const
 {
     __int64 result; // rax
     unsigned int v3; // er10
@@ -9,6 +9,8 @@ class CAI_Network;
 class Vector3D;
 class Color;
 
+constexpr float AI_NEAREST_NODE_MAX_DIST = 800.0f; // Range of the engine's linear scan (squared: 640000).
+
 //------------------------------------------------------------------------------
 // 
 //------------------------------------------------------------------------------
@@ -23,6 +25,7 @@ public:
 	void DrawNavMeshPolyBoundaries(dtNavMesh* mesh = nullptr) const;
 	uint64_t PackNodeLink(uint32_t a, uint32_t b) const;
 	int64_t GetNearestNodeToPos(const CAI_Network* pAINetwork, const Vector3D* vec) const;
+	int64_t GetNearestNodeToPosLinear(const CAI_Network* pAINetwork, const Vector3D* vec) const;
 
 private:
 	Color m_BoxColor;
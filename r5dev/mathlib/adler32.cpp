@@ -1,9 +1,33 @@
 #include "core/stdafx.h"
 #include "mathlib/adler32.h"
+#include "tier0/cpu.h"
+#include "public/utility/benchmark.h"
+#include <tmmintrin.h>
+
+static const uint32_t ADLER32_MOD  = 65521;
+static const size_t   ADLER32_NMAX = 5552; // Max bytes before the sums can overflow 32 bits.
+
+//-----------------------------------------------------------------------------
+// Purpose: computes the adler32 of a buffer
+// Input  : adler - adler of the preceding data, 0 to start
+//          *ptr - 
+//          buf_len - 
+// Output : adler32, 0 if ptr is null
+//-----------------------------------------------------------------------------
+uint32_t adler32::update(uint32_t adler, const void* ptr, size_t buf_len)
+{
+    static const bool s_bSSSE3 = has_ssse3();
+
+    if (s_bSSSE3)
+    {
+        return update_ssse3(adler, ptr, buf_len);
+    }
+    return update_scalar(adler, ptr, buf_len);
+}
 
 // Mark Adler's compact Adler32 hashing algorithm
 // Originally from the public domain stb.h header.
-uint32_t adler32::update(uint32_t adler, const void* ptr, size_t buf_len)
+uint32_t adler32::update_scalar(uint32_t adler, const void* ptr, size_t buf_len)
 {
     if (!ptr)
     {
@@ -45,3 +69,122 @@ uint32_t adler32::update(uint32_t adler, const void* ptr, size_t buf_len)
     }
     return (s2 << 16) + s1;
 }
+
+//-----------------------------------------------------------------------------
+// Purpose: computes the adler32 of a buffer 32 bytes at a time, per block
+//          s1 gains the byte sum and s2 the sum weighted by the distance to
+//          the end of the block (maddubs against 32..1) plus 32 times s1 at
+//          the start of the block
+//-----------------------------------------------------------------------------
+uint32_t adler32::update_ssse3(uint32_t adler, const void* ptr, size_t buf_len)
+{
+    if (!ptr)
+    {
+        return NULL;
+    }
+
+    const size_t BLOCK_SIZE = 32;
+    if (buf_len < BLOCK_SIZE)
+    {
+        return update_scalar(adler, ptr, buf_len);
+    }
+
+    const uint8_t* buffer = static_cast<const uint8_t*>(ptr);
+
+    uint32_t s1 = (adler & 0xffff) % ADLER32_MOD;
+    uint32_t s2 = (adler >> 16) % ADLER32_MOD;
+
+    const __m128i tap1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+    const __m128i tap2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+
+    size_t blocks = buf_len / BLOCK_SIZE;
+    buf_len -= blocks * BLOCK_SIZE;
+
+    while (blocks)
+    {
+        size_t n = std::min<size_t>(ADLER32_NMAX / BLOCK_SIZE, blocks);
+        blocks -= n;
+
+        // 'v_ps' sums s1 at the start of every block, it's scaled by the
+        // block size once the run is done.
+        __m128i v_ps = _mm_set_epi32(0, 0, 0, static_cast<int>(s1 * n));
+        __m128i v_s2 = _mm_set_epi32(0, 0, 0, static_cast<int>(s2));
+        __m128i v_s1 = _mm_setzero_si128();
+
+        do
+        {
+            const __m128i bytes1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer));
+            const __m128i bytes2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + 16));
+
+            v_ps = _mm_add_epi32(v_ps, v_s1);
+
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes1, zero));
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_maddubs_epi16(bytes1, tap1), ones));
+
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes2, zero));
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_maddubs_epi16(bytes2, tap2), ones));
+
+            buffer += BLOCK_SIZE;
+        } while (--n);
+
+        v_s2 = _mm_add_epi32(v_s2, _mm_slli_epi32(v_ps, 5));
+
+        // Horizontal sums, _mm_sad_epu8 only fills the low dword of each half.
+        v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(1, 0, 3, 2)));
+        s1 += static_cast<uint32_t>(_mm_cvtsi128_si32(v_s1));
+
+        v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(2, 3, 0, 1)));
+        v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(1, 0, 3, 2)));
+        s2 = static_cast<uint32_t>(_mm_cvtsi128_si32(v_s2));
+
+        s1 %= ADLER32_MOD;
+        s2 %= ADLER32_MOD;
+    }
+
+    return update_scalar((s2 << 16) | s1, buffer, buf_len);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: checks if the processor supports SSSE3
+//-----------------------------------------------------------------------------
+bool adler32::has_ssse3(void)
+{
+    return GetCPUInformation().m_bSSSE3;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: measures the throughput of every kernel the processor supports and
+//          verifies them against the scalar loop
+// Input  : &bench - 
+//          *ptr - 
+//          buf_len - 
+//          repeats - runs chain the checksum of the previous repeat, so the
+//                    result covers every byte processed
+//          *size_name - 
+//-----------------------------------------------------------------------------
+void adler32::benchmark(CBenchmark& bench, const uint8_t* ptr, size_t buf_len, size_t repeats, const char* size_name)
+{
+    auto chain = [=](uint32_t(*fn)(uint32_t, const void*, size_t))
+    {
+        return [=]() -> uint64_t
+        {
+            uint32_t adler = 0;
+            for (size_t i = 0; i < repeats; i++)
+            {
+                adler = fn(adler, ptr, buf_len);
+            }
+            return adler;
+        };
+    };
+
+    const BenchKernel_t kernels[] =
+    {
+        { "adler32 scalar", chain(update_scalar), true },
+        { "adler32 ssse3", chain(update_ssse3), has_ssse3() },
+        { "adler32 update", chain(update), true },
+    };
+
+    bench.CompareKernels(kernels, std::size(kernels), 3, double(buf_len) * repeats, size_name);
+}
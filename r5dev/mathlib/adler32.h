@@ -1,7 +1,17 @@
 #pragma once
 
+class CBenchmark;
+
 class adler32
 {
 public:
     static uint32_t update(uint32_t adler, const void* ptr, size_t buf_len);
+
+    // Implementations, 'update' picks the fastest one the processor supports.
+    static uint32_t update_scalar(uint32_t adler, const void* ptr, size_t buf_len);
+    static uint32_t update_ssse3(uint32_t adler, const void* ptr, size_t buf_len);
+
+    static bool has_ssse3(void);
+
+    static void benchmark(CBenchmark& bench, const uint8_t* ptr, size_t buf_len, size_t repeats, const char* size_name);
 };
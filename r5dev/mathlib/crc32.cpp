@@ -1,22 +1,267 @@
 #include "core/stdafx.h"
 #include "mathlib/crc32.h"
+#include "public/utility/benchmark.h"
+#ifndef PAKDECOMP
+#include "tier0/cpu.h"
+#endif // !PAKDECOMP
+#include <wmmintrin.h>
 
-// Karl Malbrain's compact CRC-32, with pre and post conditioning. 
-// See "A compact CCITT crc16 and crc32 C implementation that balances processor cache usage against speed": 
-// http://www.geocities.com/malbrain/
+// Reflected CRC-32 (polynomial 0xEDB88320), with pre and post conditioning.
+static const uint32_t CRC32_POLYNOMIAL = 0xEDB88320;
+
+//-----------------------------------------------------------------------------
+// Slicing-by-16 tables, table 'n' advances a byte through 'n' more zero bytes.
+//-----------------------------------------------------------------------------
+struct Crc32Tables_t
+{
+	uint32_t m_nTable[16][256];
+
+	Crc32Tables_t(void)
+	{
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t c = i;
+			for (int k = 0; k < 8; k++)
+			{
+				c = (c >> 1) ^ (CRC32_POLYNOMIAL & (0 - (c & 1)));
+			}
+			m_nTable[0][i] = c;
+		}
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			for (int t = 1; t < 16; t++)
+			{
+				const uint32_t c = m_nTable[t - 1][i];
+				m_nTable[t][i] = (c >> 8) ^ m_nTable[0][c & 0xFF];
+			}
+		}
+	}
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: computes the crc32 of a buffer
+// Input  : crc - crc of the preceding data, 0 to start
+//          *ptr - 
+//          buf_len - 
+// Output : crc32, 0 if ptr is null
+//-----------------------------------------------------------------------------
 uint32_t crc32::update(uint32_t crc, const uint8_t* ptr, size_t buf_len)
+{
+	static const bool s_bPCLMUL = has_pclmul();
+
+	if (s_bPCLMUL && buf_len >= 64)
+	{
+		return update_pclmul(crc, ptr, buf_len);
+	}
+	return update_slice16(crc, ptr, buf_len);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: computes the crc32 of a buffer 16 bytes at a time with tables
+//-----------------------------------------------------------------------------
+uint32_t crc32::update_slice16(uint32_t crc, const uint8_t* ptr, size_t buf_len)
 {
 	if (!ptr)
 	{
 		return NULL;
 	}
 
+	return ~slice16(~crc, ptr, buf_len);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: computes the crc32 of a buffer by folding 64 bytes at a time with
+//          carry-less multiplies, the final 128 bits go through the tables
+//          instead of a Barrett reduction, which gives the same remainder.
+//          Constants are x^(n) mod P for the reflected polynomial, see Intel's
+//          "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ".
+//-----------------------------------------------------------------------------
+uint32_t crc32::update_pclmul(uint32_t crc, const uint8_t* ptr, size_t buf_len)
+{
+	if (!ptr)
+	{
+		return NULL;
+	}
+
+	crc = ~crc;
+	if (buf_len < 64)
+	{
+		return ~slice16(crc, ptr, buf_len);
+	}
+
+	const __m128i k1k2 = _mm_set_epi64x(0x01C6E41596, 0x0154442BD4); // Fold by 512 bits.
+	const __m128i k3k4 = _mm_set_epi64x(0x00CCAA009E, 0x01751997D0); // Fold by 128 bits.
+
+	__m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 0x00));
+	__m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 0x10));
+	__m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 0x20));
+	__m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 0x30));
+
+	x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+
+	ptr += 64;
+	buf_len -= 64;
+
+	while (buf_len >= 64)
+	{
+		const __m128i x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+		const __m128i x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+		const __m128i x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+		const __m128i x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+
+		x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+		x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+		x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+		x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 0x00)));
+		x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 0x10)));
+		x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 0x20)));
+		x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 0x30)));
+
+		ptr += 64;
+		buf_len -= 64;
+	}
+
+	// Fold the 4 lanes into one, then any remaining 16 byte blocks.
+	__m128i x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+	x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x11), x5), x2);
+
+	x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+	x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x11), x5), x3);
+
+	x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+	x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x11), x5), x4);
+
+	while (buf_len >= 16)
+	{
+		x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+		x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x11), x5),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)));
+
+		ptr += 16;
+		buf_len -= 16;
+	}
+
+	// The folded value has the same remainder as the data consumed so far.
+	alignas(16) uint8_t folded[16];
+	_mm_store_si128(reinterpret_cast<__m128i*>(folded), x1);
+
+	crc = slice16(0, folded, sizeof(folded));
+	return ~slice16(crc, ptr, buf_len);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: checks if the processor supports carry-less multiplication
+//-----------------------------------------------------------------------------
+bool crc32::has_pclmul(void)
+{
+#ifndef PAKDECOMP
+	return (GetCPUInformation().m_nFeatures[1] >> 1) & 1;
+#else
+	int regs[4];
+	__cpuid(regs, 1);
+	return (regs[2] >> 1) & 1;
+#endif // !PAKDECOMP
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: byte at a time crc32 with its own table, the reference the
+//          optimized kernels are verified against
+//-----------------------------------------------------------------------------
+static uint32_t crc32_reference(uint32_t crc, const uint8_t* ptr, size_t buf_len)
+{
+	static const struct Crc32Table_t
+	{
+		uint32_t m_nTable[256];
+
+		Crc32Table_t(void)
+		{
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				uint32_t c = i;
+				for (int k = 0; k < 8; k++)
+				{
+					c = (c >> 1) ^ (CRC32_POLYNOMIAL & (0 - (c & 1)));
+				}
+				m_nTable[i] = c;
+			}
+		}
+	} s_crc32Table;
+
 	crc = ~crc;
 	while (buf_len--)
 	{
-		uint8_t b = *ptr++;
-		crc = (crc >> 4) ^ s_crc32[(crc & 0xF) ^ (b & 0xF)];
-		crc = (crc >> 4) ^ s_crc32[(crc & 0xF) ^ (b >> 4)];
+		crc = (crc >> 8) ^ s_crc32Table.m_nTable[(crc ^ *ptr++) & 0xFF];
 	}
 	return ~crc;
 }
+
+//-----------------------------------------------------------------------------
+// Purpose: measures the throughput of every kernel the processor supports and
+//          verifies them against the reference
+// Input  : &bench - 
+//          *ptr - 
+//          buf_len - 
+//          repeats - runs chain the crc of the previous repeat, so the result
+//                    covers every byte processed and can't be optimized away
+//          *size_name - 
+//-----------------------------------------------------------------------------
+void crc32::benchmark(CBenchmark& bench, const uint8_t* ptr, size_t buf_len, size_t repeats, const char* size_name)
+{
+	auto chain = [=](uint32_t(*fn)(uint32_t, const uint8_t*, size_t))
+	{
+		return [=]() -> uint64_t
+		{
+			uint32_t crc = 0;
+			for (size_t i = 0; i < repeats; i++)
+			{
+				crc = fn(crc, ptr, buf_len);
+			}
+			return crc;
+		};
+	};
+
+	const BenchKernel_t kernels[] =
+	{
+		{ "crc32 reference", chain(crc32_reference), true },
+		{ "crc32 slice16", chain(update_slice16), true },
+		{ "crc32 pclmul", chain(update_pclmul), has_pclmul() },
+		{ "crc32 update", chain(update), true },
+	};
+
+	bench.CompareKernels(kernels, std::size(kernels), 3, double(buf_len) * repeats, size_name);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: slicing-by-16 without conditioning
+//-----------------------------------------------------------------------------
+uint32_t crc32::slice16(uint32_t crc, const uint8_t* ptr, size_t buf_len)
+{
+	static const Crc32Tables_t s_crc32Tables; // Built on first use, safe from static initializers.
+	const uint32_t(*t)[256] = s_crc32Tables.m_nTable;
+
+	while (buf_len >= 16)
+	{
+		uint32_t a, b, c, d;
+		memcpy(&a, ptr + 0x0, sizeof(a));
+		memcpy(&b, ptr + 0x4, sizeof(b));
+		memcpy(&c, ptr + 0x8, sizeof(c));
+		memcpy(&d, ptr + 0xC, sizeof(d));
+
+		a ^= crc;
+		crc = t[15][a & 0xFF] ^ t[14][(a >> 8) & 0xFF] ^ t[13][(a >> 16) & 0xFF] ^ t[12][a >> 24]
+			^ t[11][b & 0xFF] ^ t[10][(b >> 8) & 0xFF] ^ t[9][(b >> 16) & 0xFF] ^ t[8][b >> 24]
+			^ t[7][c & 0xFF] ^ t[6][(c >> 8) & 0xFF] ^ t[5][(c >> 16) & 0xFF] ^ t[4][c >> 24]
+			^ t[3][d & 0xFF] ^ t[2][(d >> 8) & 0xFF] ^ t[1][(d >> 16) & 0xFF] ^ t[0][d >> 24];
+
+		ptr += 16;
+		buf_len -= 16;
+	}
+
+	while (buf_len--)
+	{
+		crc = (crc >> 8) ^ t[0][(crc ^ *ptr++) & 0xFF];
+	}
+	return crc;
+}
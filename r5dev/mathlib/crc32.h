@@ -1,13 +1,21 @@
 #pragma once
 #include <stdint.h>
 
+class CBenchmark;
+
 class crc32
 {
-	static inline uint32_t s_crc32[16] =
-	{
-	   0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
-	   0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
-	};
 public:
 	static uint32_t update(uint32_t crc, const uint8_t* ptr, size_t buf_len);
-};
\ No newline at end of file
+
+	// Implementations, 'update' picks the fastest one the processor supports.
+	static uint32_t update_slice16(uint32_t crc, const uint8_t* ptr, size_t buf_len);
+	static uint32_t update_pclmul(uint32_t crc, const uint8_t* ptr, size_t buf_len);
+
+	static bool has_pclmul(void);
+
+	static void benchmark(CBenchmark& bench, const uint8_t* ptr, size_t buf_len, size_t repeats, const char* size_name);
+
+private:
+	static uint32_t slice16(uint32_t crc, const uint8_t* ptr, size_t buf_len);
+};
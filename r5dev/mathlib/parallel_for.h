@@ -1,7 +1,4 @@
-#include <algorithm>
-#include <thread>
-#include <functional>
-#include <vector>
+#include "tier0/threadpool.h"
 
 /// @param[in] nb_elements : size of your for loop
 /// @param[in] functor(start, end) :
@@ -14,44 +11,22 @@
 /// @endcode
 /// @param use_threads : enable / disable threads.
 ///
+/// Runs on the process wide thread pool, chunks are balanced dynamically.
 ///
 static
 void parallel_for(unsigned nb_elements,
                   std::function<void (int start, int end)> functor,
                   bool use_threads = true)
 {
-    // -------
-    unsigned nb_threads_hint = std::thread::hardware_concurrency();
-    unsigned nb_threads = nb_threads_hint == 0 ? 8 : (nb_threads_hint);
-
-    unsigned batch_size = nb_elements / nb_threads;
-    unsigned batch_remainder = nb_elements % nb_threads;
-
-    std::vector< std::thread > my_threads(nb_threads);
-
-    if( use_threads )
-    {
-        // Multithread execution
-        for(unsigned i = 0; i < nb_threads; ++i)
-        {
-            int start = i * batch_size;
-            my_threads[i] = std::thread(functor, start, start+batch_size);
-        }
-    }
-    else
+    if( !use_threads )
     {
         // Single thread execution (for easy debugging)
-        for(unsigned i = 0; i < nb_threads; ++i){
-            int start = i * batch_size;
-            functor( start, start+batch_size );
-        }
+        functor( 0, nb_elements );
+        return;
     }
 
-    // Deform the elements left
-    int start = nb_threads * batch_size;
-    functor( start, start+batch_remainder);
-
-    // Wait for the other thread to finish their task
-    if( use_threads )
-        std::for_each(my_threads.begin(), my_threads.end(), std::mem_fn(&std::thread::join));
+    g_pThreadPool->ParallelFor(0, nb_elements, 0, [&functor](size_t start, size_t end)
+        {
+            functor( static_cast<int>(start), static_cast<int>(end) );
+        });
 }
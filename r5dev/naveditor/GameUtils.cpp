@@ -98,73 +98,132 @@ void unpatchTileGame(dtMeshTile* t)
 	}
 }
 
-void buildLinkTable(dtNavMesh* mesh, LinkTableData& data)
+bool buildLinkTable(dtNavMesh* mesh, LinkTableData& data)
 {
-	//clear all labels
+	//number the polys of all tiles
+	std::vector<int> tileBase(mesh->getMaxTiles(), -1);
+	int polyCount = 0;
 	for (int i = 0; i < mesh->getMaxTiles(); ++i)
 	{
 		dtMeshTile* tile = mesh->getTile(i);
 		if (!tile || !tile->header || !tile->dataSize) continue;
-		int pcount = tile->header->polyCount;
-		for (int j = 0; j < pcount; j++)
-		{
-			dtPoly& poly = tile->polys[j];
-			poly.disjointSetId = -1;
-		}
+		tileBase[i] = polyCount;
+		polyCount += tile->header->polyCount;
 	}
-	//first pass
-	std::set<int> nlabels;
+	data.init(polyCount);
+	//collect the links as (from, to) poly pairs
+	std::vector<std::pair<int, int>> links;
 	for (int i = 0; i < mesh->getMaxTiles(); ++i)
 	{
+		if (tileBase[i] == -1) continue;
 		dtMeshTile* tile = mesh->getTile(i);
-		if (!tile || !tile->header || !tile->dataSize) continue;
 		int pcount = tile->header->polyCount;
 		for (int j = 0; j < pcount; j++)
 		{
-			dtPoly& poly = tile->polys[j];
-			unsigned int plink = poly.firstLink;
+			unsigned int plink = tile->polys[j].firstLink;
 			while (plink != DT_NULL_LINK)
 			{
-				const dtLink l = tile->links[plink];
-				const dtMeshTile* t;
-				const dtPoly* p;
-				mesh->getTileAndPolyByRefUnsafe(l.ref, &t, &p);
+				const dtLink& l = tile->links[plink];
+				unsigned int salt, it, ip;
+				mesh->decodePolyId(l.ref, salt, it, ip);
 
-				if (p->disjointSetId != (unsigned short)-1)
-					nlabels.insert(p->disjointSetId);
+				if (it < tileBase.size() && tileBase[it] != -1)
+					links.emplace_back(tileBase[i] + j, tileBase[it] + ip);
 				plink = l.next;
 			}
-			if (nlabels.empty())
-			{
-				poly.disjointSetId = data.insert_new();
-			}
-			else
-			{
-				auto l = *nlabels.begin();
-				poly.disjointSetId = l;
-				for (auto nl : nlabels)
-					data.set_union(l, nl);
-			}
-			nlabels.clear();
 		}
 	}
-	//second pass
+	std::sort(links.begin(), links.end());
+	links.erase(std::unique(links.begin(), links.end()), links.end());
+	//join the polys of links that go both ways, one-way links (off-mesh
+	//connections) only make their target group reachable
+	std::vector<std::pair<int, int>> oneWayLinks;
+	for (const auto& l : links)
+	{
+		if (std::binary_search(links.begin(), links.end(), std::make_pair(l.second, l.first)))
+			data.set_union(l.first, l.second);
+		else
+			oneWayLinks.push_back(l);
+	}
+	//number the groups in poly order after the reserved ids, which keep
+	//their (empty) rows in the table
+	std::vector<int> setIds(polyCount, -1);
+	for (int i = 0; i < polyCount; i++)
+	{
+		int& id = setIds[data.find(i)];
+		if (id == -1)
+			id = data.setCount++;
+	}
+	//the ids would wrap in 'disjointSetId', leave the polys untouched
+	if (data.setCount > DISJOINT_SET_MAX_COUNT)
+		return false;
+	//label the polys with their group
 	for (int i = 0; i < mesh->getMaxTiles(); ++i)
 	{
+		if (tileBase[i] == -1) continue;
 		dtMeshTile* tile = mesh->getTile(i);
-		if (!tile || !tile->header || !tile->dataSize) continue;
 		int pcount = tile->header->polyCount;
 		for (int j = 0; j < pcount; j++)
+			tile->polys[j].disjointSetId = (unsigned short)setIds[data.find(tileBase[i] + j)];
+	}
+	data.groupLinks.clear();
+	for (const auto& l : oneWayLinks)
+	{
+		int from = setIds[data.find(l.first)];
+		int to = setIds[data.find(l.second)];
+		if (from != to)
+			data.groupLinks.emplace_back(from, to);
+	}
+	std::sort(data.groupLinks.begin(), data.groupLinks.end());
+	data.groupLinks.erase(std::unique(data.groupLinks.begin(), data.groupLinks.end()), data.groupLinks.end());
+	return true;
+}
+void buildReachabilityTable(const LinkTableData& data, std::vector<int>& table)
+{
+	const int count = data.setCount;
+	const int w = calcReachabilityRowWords(count);
+	table.assign(w * count, 0);
+
+	//groups linked from each group, 'groupLinks' is sorted by source group
+	std::vector<int> linkStart(count + 1, 0);
+	for (const auto& l : data.groupLinks)
+		linkStart[l.first + 1]++;
+	for (int i = 0; i < count; i++)
+		linkStart[i + 1] += linkStart[i];
+
+	//every group reaches itself and whatever its one-way links lead to
+	std::vector<int> stack;
+	for (int i = 0; i < count; i++)
+	{
+		int* row = &table[i * w];
+		row[i / 32] |= 1 << (i & 0x1f);
+		stack.push_back(i);
+		while (!stack.empty())
 		{
-			dtPoly& poly = tile->polys[j];
-			int id = data.find(poly.disjointSetId);
-			poly.disjointSetId = id;
+			int g = stack.back();
+			stack.pop_back();
+			for (int k = linkStart[g]; k < linkStart[g + 1]; k++)
+			{
+				int to = data.groupLinks[k].second;
+				if (row[to / 32] & (1 << (to & 0x1f)))
+					continue;
+				row[to / 32] |= 1 << (to & 0x1f);
+				stack.push_back(to);
+			}
 		}
 	}
 }
+int calcReachabilityRowWords(int count)
+{
+	return (count + 31) / 32;
+}
+int calcReachabilityTableSize(int count)
+{
+	return calcReachabilityRowWords(count) * count * sizeof(int);
+}
 void setReachable(std::vector<int>& data, int count, int id1, int id2, bool value)
 {
-	int w = ((count + 31) / 32);
+	int w = calcReachabilityRowWords(count);
 	auto& cell = data[id1 * w + id2 / 32];
 	uint32_t value_mask = ~(1 << (id2 & 0x1f));
 	if (!value)
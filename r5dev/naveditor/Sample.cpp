@@ -415,6 +415,21 @@ void Sample::saveAll(std::string path, dtNavMesh* mesh)
 	char buffer[256];
 	sprintf(buffer, "%s_%s.nm", path.c_str(), m_navmeshName);
 
+	LinkTableData linkData;
+	if (!buildLinkTable(mesh, linkData))
+	{
+		m_ctx->log(RC_LOG_ERROR, "saveAll: Navmesh has '%d' poly groups, more than the '%d' a poly can refer to; '%s' was not saved.",
+			linkData.setCount - DISJOINT_SET_FIRST_ID, DISJOINT_SET_MAX_COUNT - DISJOINT_SET_FIRST_ID, buffer);
+		return;
+	}
+
+	const int reachabilityTableSize = calcReachabilityTableSize(linkData.setCount);
+	if (reachabilityTableSize > REACHABILITY_TABLE_WARN_SIZE)
+	{
+		m_ctx->log(RC_LOG_WARNING, "saveAll: Navmesh has '%d' poly groups, its reachability tables take '%lld' bytes.",
+			linkData.setCount - DISJOINT_SET_FIRST_ID, static_cast<long long>(reachabilityTableSize) * m_reachabilityTableCount);
+	}
+
 	FILE* fp = fopen(buffer, "wb");
 	if (!fp)
 		return;
@@ -435,35 +450,12 @@ void Sample::saveAll(std::string path, dtNavMesh* mesh)
 	}
 	memcpy(&header.params, mesh->getParams(), sizeof(dtNavMeshParams));
 
-	//LinkTableData linkData;
-	//buildLinkTable(mesh, linkData);
-	//int tableSize = ((linkData.setCount + 31) / 32) * linkData.setCount * 32;
-
-	//std::vector<int> reachability(tableSize, 0);
-	//for (int i = 0; i < linkData.setCount; i++)
-	//	setReachable(reachability, linkData.setCount, i, i, true);
-
-	//if (reachability.size() > 0)
-	//{
-	//	for (size_t i = reachability.size() - 1; i >= 0; i--)
-	//	{
-	//		if (reachability[i] == 0)
-	//		{
-	//			reachability.erase(reachability.begin() + i);
-	//			tableSize--;
-	//		}
-	//		else
-	//			break;
-	//	}
-	//}
-
-	//header.params.disjointPolyGroupCount = linkData.setCount;
-	//header.params.reachabilityTableCount = m_reachabilityTableCount;
-	//header.params.reachabilityTableSize = tableSize;
-
-	header.params.disjointPolyGroupCount = 4;
+	std::vector<int> reachability;
+	buildReachabilityTable(linkData, reachability);
+
+	header.params.disjointPolyGroupCount = linkData.setCount;
 	header.params.reachabilityTableCount = m_reachabilityTableCount;
-	header.params.reachabilityTableSize = ((header.params.disjointPolyGroupCount + 31) / 32) * header.params.disjointPolyGroupCount * 32;
+	header.params.reachabilityTableSize = reachabilityTableSize;
 
 	fwrite(&header, sizeof(NavMeshSetHeader), 1, fp);
 
@@ -482,23 +474,13 @@ void Sample::saveAll(std::string path, dtNavMesh* mesh)
 		fwrite(tile->data, tile->dataSize, 1, fp);
 	}
 
-	////still dont know what this thing is...
-	//int header_sth = 0;
-	//for (int i = 0; i < linkData.setCount; i++)
-	//	fwrite(&header_sth, sizeof(int), 1, fp);
-
-	//for (int i = 0; i < header.params.reachabilityTableCount; i++)
-	//	fwrite(reachability.data(), sizeof(int), tableSize, fp);
-
-	int header_sth[4] = { 0,0,0 };
-	fwrite(header_sth, sizeof(int), 4, fp);
-
-	unsigned int reachability[32 * 4];
-	for (int i = 0; i < 32 * 4; i++)
-		reachability[i] = 0xffffffff;
+	//still dont know what this thing is...
+	std::vector<int> header_sth(linkData.setCount, 0);
+	fwrite(header_sth.data(), sizeof(int), header_sth.size(), fp);
 
+	//same table for every traverse type, it only follows the navmesh links
 	for (int i = 0; i < header.params.reachabilityTableCount; i++)
-		fwrite(reachability, sizeof(int), (header.params.reachabilityTableSize / 4), fp);
+		fwrite(reachability.data(), sizeof(int), reachability.size(), fp);
 
 	fclose(fp);
 }
\ No newline at end of file
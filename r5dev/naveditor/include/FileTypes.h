@@ -4,6 +4,9 @@
 
 static const int NAVMESHSET_MAGIC = 'M' << 24 | 'S' << 16 | 'E' << 8 | 'T'; //'MSET';
 static const int NAVMESHSET_VERSION = 8;
+static const int DISJOINT_SET_FIRST_ID = 2; // Poly group 0 is invalid and 1 is special to the engine, see dtCreateNavMeshData.
+static const int DISJOINT_SET_MAX_COUNT = 0xFFFF; // Group ids are stored in 'dtPoly::disjointSetId', an unsigned short.
+static const int REACHABILITY_TABLE_WARN_SIZE = 16 * 1024 * 1024; // Tables grow with the square of the group count.
 
 struct NavMeshSetHeader
 {
@@ -21,28 +24,29 @@ struct NavMeshTileHeader
 
 struct LinkTableData
 {
-	//disjoint set algo from some crappy site because i'm too lazy to think
-	int setCount = 0;
+	// Union-find over all polys of the mesh, 'setCount' is the number of
+	// poly group ids once 'buildLinkTable' has numbered the groups, the
+	// reserved ids below 'DISJOINT_SET_FIRST_ID' included.
+	int setCount = DISJOINT_SET_FIRST_ID;
 	std::vector<int> rank;
 	std::vector<int> parent;
+	std::vector<std::pair<int, int>> groupLinks; // One-way links between groups, (from, to) sorted.
 	void init(int size)
 	{
-		rank.resize(size);
+		setCount = DISJOINT_SET_FIRST_ID;
+		rank.assign(size, 0);
 		parent.resize(size);
 
 		for (int i = 0; i < parent.size(); i++)
 			parent[i] = i;
 	}
-	int insert_new()
-	{
-		rank.push_back(0);
-		parent.push_back(setCount);
-		return setCount++;
-	}
 	int find(int id)
 	{
-		if (parent[id] != id)
-			return find(parent[id]);
+		while (parent[id] != id)
+		{
+			parent[id] = parent[parent[id]]; // Path halving.
+			id = parent[id];
+		}
 		return id;
 	}
 	void set_union(int x, int y)
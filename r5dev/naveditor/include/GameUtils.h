@@ -14,7 +14,10 @@ void unpatchHeaderGame(NavMeshSetHeader& h);
 void patchTileGame(dtMeshTile* t);
 void unpatchTileGame(dtMeshTile* t);
 
-void buildLinkTable(dtNavMesh* mesh, LinkTableData& data);
+bool buildLinkTable(dtNavMesh* mesh, LinkTableData& data);
+void buildReachabilityTable(const LinkTableData& data, std::vector<int>& table);
+int calcReachabilityRowWords(int count);
+int calcReachabilityTableSize(int count);
 void setReachable(std::vector<int>& data, int count, int id1, int id2, bool value);
 
 #endif // GAMEUTILS_H
\ No newline at end of file
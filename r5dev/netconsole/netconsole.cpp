@@ -8,9 +8,11 @@
 #include "core/termutil.h"
 #include "tier1/NetAdr2.h"
 #include "tier2/socketcreator.h"
+#include "tier2/framedecoder.h"
 #include "protoc/sv_rcon.pb.h"
 #include "protoc/cl_rcon.pb.h"
 #include "public/utility/utility.h"
+#include "public/utility/benchmark.h"
 #include "engine/net.h"
 #include "netconsole/netconsole.h"
 
@@ -343,55 +345,17 @@ void CNetCon::Recv(void)
 //-----------------------------------------------------------------------------
 void CNetCon::ProcessBuffer(const char* pRecvBuf, int nRecvLen, CConnectedNetConsoleData* pData)
 {
-	while (nRecvLen > 0)
-	{
-		if (pData->m_nPayloadLen)
-		{
-			if (pData->m_nPayloadRead < pData->m_nPayloadLen)
-			{
-				pData->m_RecvBuffer[pData->m_nPayloadRead++] = *pRecvBuf;
-
-				pRecvBuf++;
-				nRecvLen--;
-			}
-			if (pData->m_nPayloadRead == pData->m_nPayloadLen)
-			{
-				this->ProcessMessage(this->Deserialize(std::string(
-					reinterpret_cast<char*>(pData->m_RecvBuffer.data()), pData->m_nPayloadLen)));
-
-				pData->m_nPayloadLen = 0;
-				pData->m_nPayloadRead = 0;
-			}
-		}
-		else if (pData->m_nPayloadRead < sizeof(int)) // Read size field.
-		{
-			pData->m_RecvBuffer[pData->m_nPayloadRead++] = *pRecvBuf;
-
-			pRecvBuf++;
-			nRecvLen--;
-		}
-		else // Build prefix.
+	const NetConFrameStatus_t nStatus = NetCon_DecodeFrames(pData, pRecvBuf, nRecvLen, INT_MAX,
+		[this](const char* pFrame, int nFrameLen)
 		{
-			pData->m_nPayloadLen = static_cast<int>(
-				pData->m_RecvBuffer[0] << 24 |
-				pData->m_RecvBuffer[1] << 16 |
-				pData->m_RecvBuffer[2] << 8  |
-				pData->m_RecvBuffer[3]);
-			pData->m_nPayloadRead = 0;
-
-			if (pData->m_nPayloadLen < 0 ||
-				pData->m_nPayloadLen > pData->m_RecvBuffer.max_size())
-			{
-				std::cout << "RCON Cmd: sync error (" << pData->m_nPayloadLen << ")" << std::endl;
-				this->Disconnect(); // Out of sync (irrecoverable).
+			this->ProcessMessage(this->Deserialize(pFrame, nFrameLen));
+			return true;
+		});
 
-				break;
-			}
-			else
-			{
-				pData->m_RecvBuffer.resize(pData->m_nPayloadLen);
-			}
-		}
+	if (nStatus == NetConFrameStatus_t::NETCON_FRAME_INVALID_SIZE)
+	{
+		std::cout << "RCON Cmd: sync error (" << pData->m_nPayloadLen << ")" << std::endl;
+		this->Disconnect(); // Out of sync (irrecoverable).
 	}
 }
 
@@ -472,13 +436,14 @@ std::string CNetCon::Serialize(const std::string& svReqBuf, const std::string& s
 
 //-----------------------------------------------------------------------------
 // Purpose: de-serializes input
-// Input  : *svBuf - 
+// Input  : *pszBuf - 
+//			nLen - 
 // Output : de-serialized object
 //-----------------------------------------------------------------------------
-sv_rcon::response CNetCon::Deserialize(const std::string& svBuf) const
+sv_rcon::response CNetCon::Deserialize(const char* pszBuf, int nLen) const
 {
 	sv_rcon::response sv_response;
-	sv_response.ParseFromArray(svBuf.data(), static_cast<int>(svBuf.size()));
+	sv_response.ParseFromArray(pszBuf, nLen);
 
 	return sv_response;
 }
@@ -490,6 +455,17 @@ sv_rcon::response CNetCon::Deserialize(const std::string& svBuf) const
 //-----------------------------------------------------------------------------
 int main(int argc, char* argv[])
 {
+	if (argc >= 2 && strcmp(argv[1], "-framebench") == 0)
+	{
+		const int nIterations = argc >= 3 ? std::max<int>(atoi(argv[2]), 1) : 8;
+		CBenchmark bench([](bool bWarning, const char* pszLine)
+			{
+				(bWarning ? std::cerr : std::cout) << pszLine << std::endl;
+			});
+
+		return NetCon_BenchmarkDecoder(bench, nIterations) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
 	CNetCon* pNetCon = new CNetCon();
 	std::cout << "R5Reloaded TCP net console [Version " << NETCON_VERSION << "]" << std::endl;
 
@@ -9,19 +9,561 @@
 #include "engine/net.h"
 #include "engine/client/client.h"
 #include "filesystem/filesystem.h"
+#include "public/utility/benchmark.h"
+#include "public/utility/binstream.h"
 #include "networksystem/bansystem.h"
 
 //-----------------------------------------------------------------------------
-// Purpose: loads and parses the banned list
+// Purpose: returns the address bit at given position (0 is the most significant)
+// Input  : nBit - 
+//-----------------------------------------------------------------------------
+int BanAddress_t::GetBit(int nBit) const
+{
+	return nBit < 64
+		? static_cast<int>((m_nHigh >> (63 - nBit)) & 1)
+		: static_cast<int>((m_nLow >> (127 - nBit)) & 1);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: returns the address with all bits after the prefix cleared
+// Input  : nPrefixLen - 
+//-----------------------------------------------------------------------------
+BanAddress_t BanAddress_t::Masked(int nPrefixLen) const
+{
+	BanAddress_t out;
+
+	out.m_nHigh = nPrefixLen >= 64 ? m_nHigh : (nPrefixLen ? m_nHigh & (~0ull << (64 - nPrefixLen)) : 0);
+	out.m_nLow = nPrefixLen >= 128 ? m_nLow : (nPrefixLen > 64 ? m_nLow & (~0ull << (128 - nPrefixLen)) : 0);
+
+	return out;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: checks if the address is within given (masked) prefix
+// Input  : &prefix - 
+//			nPrefixLen - 
+//-----------------------------------------------------------------------------
+bool BanAddress_t::IsInPrefix(const BanAddress_t& prefix, int nPrefixLen) const
+{
+	return Masked(nPrefixLen) == prefix;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: returns the number of leading bits both addresses have in common
+// Input  : &a - 
+//			&b - 
+//			nMaxLen - 
+//-----------------------------------------------------------------------------
+int BanAddress_t::CommonPrefixLen(const BanAddress_t& a, const BanAddress_t& b, int nMaxLen)
+{
+	unsigned long nIndex;
+	int nLen;
+
+	if (uint64_t nDiff = a.m_nHigh ^ b.m_nHigh)
+	{
+		_BitScanReverse64(&nIndex, nDiff);
+		nLen = 63 - static_cast<int>(nIndex);
+	}
+	else if (uint64_t nDiff = a.m_nLow ^ b.m_nLow)
+	{
+		_BitScanReverse64(&nIndex, nDiff);
+		nLen = 127 - static_cast<int>(nIndex);
+	}
+	else
+	{
+		nLen = 128;
+	}
+
+	return std::min<int>(nLen, nMaxLen);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: parses an IPv4 or IPv6 address with an optional '/bits' prefix
+// Input  : &svAddress - 
+//			&outAddress - masked to the prefix
+//			&nPrefixLen - in bits of the IPv6 (or IPv4-mapped) address
+// Output : true on success, false otherwise
+//-----------------------------------------------------------------------------
+bool BanAddress_t::Parse(const string& svAddress, BanAddress_t& outAddress, int& nPrefixLen)
+{
+	char szBase[INET6_ADDRSTRLEN];
+	const size_t nSlash = svAddress.find('/');
+	const size_t nBaseLen = std::min<size_t>(svAddress.size(), nSlash);
+
+	if (!nBaseLen || nBaseLen >= sizeof(szBase))
+		return false;
+
+	memcpy(szBase, svAddress.data(), nBaseLen);
+	szBase[nBaseLen] = '\0';
+
+	int nMaxLen;
+	uint8_t addr[16] = {};
+
+	if (inet_pton(AF_INET, szBase, &addr[12]) == 1)
+	{
+		addr[10] = 0xFF; // IPv4-mapped.
+		addr[11] = 0xFF;
+		nMaxLen = 32;
+	}
+	else if (inet_pton(AF_INET6, szBase, addr) == 1)
+	{
+		nMaxLen = 128;
+	}
+	else
+	{
+		return false;
+	}
+
+	int nBits = nMaxLen;
+	if (nSlash != string::npos)
+	{
+		const string svBits = svAddress.substr(nSlash + 1);
+		if (svBits.empty() || svBits.size() > 3 || !StringIsDigit(svBits))
+			return false;
+
+		nBits = std::stoi(svBits);
+		if (nBits > nMaxLen)
+			return false;
+	}
+
+	BanAddress_t address;
+	address.m_nHigh = 0;
+	address.m_nLow = 0;
+
+	for (int i = 0; i < 8; i++)
+	{
+		address.m_nHigh = (address.m_nHigh << 8) | addr[i];
+		address.m_nLow = (address.m_nLow << 8) | addr[i + 8];
+	}
+
+	nPrefixLen = nBits + (128 - nMaxLen);
+	if (!nPrefixLen) // Would match every address.
+		return false;
+
+	outAddress = address.Masked(nPrefixLen);
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: hashes a binary address
+// Input  : &address - 
+//-----------------------------------------------------------------------------
+size_t BanAddressHash_t::operator()(const BanAddress_t& address) const
+{
+	uint64_t nHash = address.m_nHigh * 0x9E3779B97F4A7C15ull ^ address.m_nLow;
+
+	nHash ^= nHash >> 33;
+	nHash *= 0xFF51AFD7ED558CCDull;
+	nHash ^= nHash >> 33;
+
+	return static_cast<size_t>(nHash);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: 
+//-----------------------------------------------------------------------------
+CBanPrefixTree::CBanPrefixTree(void)
+{
+	Clear();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: removes all prefixes
+//-----------------------------------------------------------------------------
+void CBanPrefixTree::Clear(void)
+{
+	m_vNodes.clear();
+	m_nCount = 0;
+
+	NewNode(BanAddress_t{ 0, 0 }, 0, 0);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: allocates a new node
+// Input  : &prefix - 
+//			nPrefixLen - 
+//			nRefs - 
+// Output : index of the new node
+//-----------------------------------------------------------------------------
+int32_t CBanPrefixTree::NewNode(const BanAddress_t& prefix, int nPrefixLen, uint32_t nRefs)
+{
+	Node_t node;
+
+	node.m_Prefix = prefix;
+	node.m_nChild[0] = -1;
+	node.m_nChild[1] = -1;
+	node.m_nPrefixLen = nPrefixLen;
+	node.m_nRefs = nRefs;
+
+	m_vNodes.push_back(node);
+	return static_cast<int32_t>(m_vNodes.size() - 1);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: adds a banned prefix
+// Input  : &prefix - masked to nPrefixLen
+//			nPrefixLen - 
+//-----------------------------------------------------------------------------
+void CBanPrefixTree::Insert(const BanAddress_t& prefix, int nPrefixLen)
+{
+	m_nCount++;
+
+	for (int32_t n = 0;;)
+	{
+		// 'prefix' matches this node up to its length here.
+		if (m_vNodes[n].m_nPrefixLen == nPrefixLen)
+		{
+			m_vNodes[n].m_nRefs++;
+			return;
+		}
+
+		const int nBit = prefix.GetBit(m_vNodes[n].m_nPrefixLen);
+		const int32_t c = m_vNodes[n].m_nChild[nBit];
+
+		if (c < 0)
+		{
+			const int32_t nLeaf = NewNode(prefix, nPrefixLen, 1);
+			m_vNodes[n].m_nChild[nBit] = nLeaf;
+			return;
+		}
+
+		const Node_t& child = m_vNodes[c];
+		const int nCommon = BanAddress_t::CommonPrefixLen(prefix, child.m_Prefix, std::min<int>(nPrefixLen, child.m_nPrefixLen));
+
+		if (nCommon == child.m_nPrefixLen)
+		{
+			n = c;
+			continue;
+		}
+
+		const int nChildBit = child.m_Prefix.GetBit(nCommon);
+		int32_t nSplit;
+
+		if (nCommon == nPrefixLen) // New prefix contains the child.
+		{
+			nSplit = NewNode(prefix, nPrefixLen, 1);
+		}
+		else // Diverges, branch at the common part.
+		{
+			nSplit = NewNode(prefix.Masked(nCommon), nCommon, 0);
+			const int32_t nLeaf = NewNode(prefix, nPrefixLen, 1);
+			m_vNodes[nSplit].m_nChild[!nChildBit] = nLeaf;
+		}
+
+		m_vNodes[nSplit].m_nChild[nChildBit] = c;
+		m_vNodes[n].m_nChild[nBit] = nSplit;
+		return;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: removes a banned prefix, nodes are kept until the tree is cleared
+// Input  : &prefix - masked to nPrefixLen
+//			nPrefixLen - 
+// Output : true if the prefix was banned, false otherwise
+//-----------------------------------------------------------------------------
+bool CBanPrefixTree::Remove(const BanAddress_t& prefix, int nPrefixLen)
+{
+	for (int32_t n = 0; n >= 0;)
+	{
+		Node_t& node = m_vNodes[n];
+
+		if (node.m_nPrefixLen > nPrefixLen || !prefix.IsInPrefix(node.m_Prefix, node.m_nPrefixLen))
+			break;
+
+		if (node.m_nPrefixLen == nPrefixLen)
+		{
+			if (!node.m_nRefs)
+				break;
+
+			node.m_nRefs--;
+			m_nCount--;
+
+			return true;
+		}
+
+		n = node.m_nChild[prefix.GetBit(node.m_nPrefixLen)];
+	}
+
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: checks if the address is within any of the banned prefixes
+// Input  : &address - 
+//-----------------------------------------------------------------------------
+bool CBanPrefixTree::Contains(const BanAddress_t& address) const
+{
+	for (int32_t n = 0; n >= 0;)
+	{
+		const Node_t& node = m_vNodes[n];
+
+		if (!address.IsInPrefix(node.m_Prefix, node.m_nPrefixLen))
+			break;
+
+		if (node.m_nRefs)
+			return true;
+
+		if (node.m_nPrefixLen == 128)
+			break;
+
+		n = node.m_nChild[address.GetBit(node.m_nPrefixLen)];
+	}
+
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: 
+//-----------------------------------------------------------------------------
+CBanSystem::CBanSystem(void)
+	: m_nQueuedRecords(0)
+	, m_nJournalRecords(0)
+	, m_nGeneration(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: 
+//-----------------------------------------------------------------------------
+CBanSystem::~CBanSystem(void)
+{
+	if (m_CompactThread.joinable())
+		m_CompactThread.join();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: appends a ban list record to a buffer
+// Input  : &svBuf - 
+//			nOperation - BanListOp_t, or -1 for snapshot records
+//			&svIpAddress - 
+//			nNucleusID - 
+//-----------------------------------------------------------------------------
+static void BanList_WriteRecord(string& svBuf, int nOperation, const string& svIpAddress, uint64_t nNucleusID)
+{
+	const uint16_t nLen = static_cast<uint16_t>(std::min<size_t>(svIpAddress.size(), UINT16_MAX));
+
+	if (nOperation >= 0)
+		svBuf.push_back(static_cast<char>(nOperation));
+
+	svBuf.append(reinterpret_cast<const char*>(&nNucleusID), sizeof(nNucleusID));
+	svBuf.append(reinterpret_cast<const char*>(&nLen), sizeof(nLen));
+	svBuf.append(svIpAddress.data(), nLen);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: reads a value from a ban list file buffer
+// Input  : &vData - 
+//			&nPos - advanced past the value on success
+//			&outValue - 
+// Output : false if the buffer is truncated
+//-----------------------------------------------------------------------------
+template <typename T>
+static bool BanList_Read(const vector<uint8_t>& vData, size_t& nPos, T& outValue)
+{
+	if (vData.size() - nPos < sizeof(T))
+		return false;
+
+	memcpy(&outValue, &vData[nPos], sizeof(T));
+	nPos += sizeof(T);
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: reads the NucleusID and address of a ban list record
+// Input  : &vData - 
+//			&nPos - advanced past the record on success
+//			&svIpAddress - 
+//			&nNucleusID - 
+// Output : false if the buffer is truncated
+//-----------------------------------------------------------------------------
+static bool BanList_ReadRecord(const vector<uint8_t>& vData, size_t& nPos, string& svIpAddress, uint64_t& nNucleusID)
+{
+	uint16_t nLen;
+	if (!BanList_Read(vData, nPos, nNucleusID) || !BanList_Read(vData, nPos, nLen))
+		return false;
+
+	if (!nLen || vData.size() - nPos < nLen)
+		return false;
+
+	svIpAddress.assign(reinterpret_cast<const char*>(&vData[nPos]), nLen);
+	nPos += nLen;
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: writes a snapshot of the banned list
+// Input  : &fsPath - 
+//			&vEntries - 
+//			nGeneration - 
+// Output : true on success, false otherwise
+//-----------------------------------------------------------------------------
+static bool BanList_WriteSnapshot(const fs::path& fsPath, const vector<std::pair<string, uint64_t>>& vEntries, uint64_t nGeneration)
+{
+	const fs::path fsTempPath = fs::path(fsPath).concat(".tmp");
+	{
+		CIOStream writer;
+		if (!writer.Open(fsTempPath, CIOStream::Mode_t::WRITE))
+			return false;
+
+		writer.Write<uint32_t>(BANLIST_MAGIC);
+		writer.Write<uint32_t>(BANLIST_VERSION);
+		writer.Write<uint64_t>(nGeneration);
+		writer.Write<uint32_t>(static_cast<uint32_t>(vEntries.size()));
+
+		string svBuf;
+		for (const std::pair<string, uint64_t>& entry : vEntries)
+		{
+			BanList_WriteRecord(svBuf, -1, entry.first, entry.second);
+			if (svBuf.size() >= 64 * 1024)
+			{
+				writer.Write(svBuf.data(), svBuf.size());
+				svBuf.clear();
+			}
+		}
+
+		writer.Write(svBuf.data(), svBuf.size());
+		writer.Write<uint32_t>(BANLIST_MAGIC); // Trailer, so truncated files are rejected.
+		writer.Flush();
+
+		if (!writer.IsWritable())
+			return false;
+	}
+
+	// Only replace the previous snapshot once this one is complete.
+	std::error_code ec;
+	fs::rename(fsTempPath, fsPath, ec);
+
+	return !ec;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: loads the banned list
 //-----------------------------------------------------------------------------
 void CBanSystem::Load(void)
 {
-	if (IsBanListValid())
-		m_vBanList.clear();
+	if (m_CompactThread.joinable())
+		m_CompactThread.join();
+
+	Clear();
+	m_JournalStream.close();
+	m_svJournalQueue.clear();
+	m_nJournalRecords = 0;
+
+	std::error_code ec;
+	fs::create_directories(fs::path(BANLIST_SNAPSHOT_PATH).parent_path(), ec);
+
+	uint64_t nGeneration;
+	if (!LoadSnapshot(nGeneration))
+	{
+		const bool bHadSnapshot = fs::exists(BANLIST_SNAPSHOT_PATH, ec);
+		if (bHadSnapshot) // Keep it around for inspection.
+			fs::rename(BANLIST_SNAPSHOT_PATH, BANLIST_SNAPSHOT_PATH ".bad", ec);
+
+		// Writing the new snapshot starts a new journal, keep copies of the
+		// current ones so the bans made since the lost snapshot survive.
+		vector<string> vBackups;
+		for (const char* pszPath : { BANLIST_JOURNAL_OLD_PATH, BANLIST_JOURNAL_PATH })
+		{
+			const string svBackup = string(pszPath) + ".bad";
+			if (fs::exists(pszPath, ec) && fs::copy_file(pszPath, svBackup, fs::copy_options::overwrite_existing, ec))
+				vBackups.push_back(svBackup);
+		}
+
+		// No snapshot yet, convert the banned list of older versions.
+		if (!ImportJson())
+		{
+			m_nGeneration = NewGeneration();
+			RewriteSnapshot();
+		}
 
+		if (!bHadSnapshot && vBackups.empty())
+			return;
+
+		// The generation of the lost snapshot is unknown, so replay the
+		// journals of any generation, oldest first.
+		size_t nRecovered = 0;
+		for (const string& svBackup : vBackups)
+		{
+			size_t nRecords;
+			if (ReplayJournal(svBackup.c_str(), 0, false, nRecords))
+				nRecovered += nRecords;
+		}
+
+		if (nRecovered)
+		{
+			m_nGeneration = NewGeneration();
+			RewriteSnapshot();
+		}
+
+		Warning(eDLL_T::SERVER, "%s: Rebuilt the banned list with '%zu' entries; replayed '%zu' journal records from '%zu' journal(s) (kept as '.bad')\n",
+			__FUNCTION__, m_vBanList.size(), nRecovered, vBackups.size());
+		return;
+	}
+
+	// A compaction that didn't finish leaves the previous journal behind,
+	// the current one then belongs to the snapshot that was never written.
+	// Replay both and write the result right away.
+	size_t nRecords;
+	const bool bRecovered = ReplayJournal(BANLIST_JOURNAL_OLD_PATH, nGeneration, true, nRecords);
+	const bool bJournalValid = ReplayJournal(BANLIST_JOURNAL_PATH, nGeneration, !bRecovered, nRecords);
+
+	m_nGeneration = nGeneration;
+
+	if (bRecovered)
+	{
+		m_nGeneration = NewGeneration();
+		RewriteSnapshot();
+	}
+	else if (!OpenJournal(!bJournalValid))
+	{
+		Error(eDLL_T::SERVER, NO_ERROR, "%s - Unable to write to '%s' (read-only?)\n", __FUNCTION__, BANLIST_JOURNAL_PATH);
+	}
+	else if (bJournalValid)
+	{
+		m_nJournalRecords = nRecords;
+	}
+
+	fs::remove(BANLIST_JOURNAL_OLD_PATH, ec);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: appends all changes since the last call to the journal
+//-----------------------------------------------------------------------------
+void CBanSystem::Save(void)
+{
+	if (m_svJournalQueue.empty())
+		return;
+
+	if (!m_JournalStream.is_open() && !OpenJournal(false))
+	{
+		Error(eDLL_T::SERVER, NO_ERROR, "%s - Unable to write to '%s' (read-only?)\n", __FUNCTION__, BANLIST_JOURNAL_PATH);
+		return;
+	}
+
+	m_JournalStream.write(m_svJournalQueue.data(), m_svJournalQueue.size());
+	m_JournalStream.flush();
+
+	m_nJournalRecords += m_nQueuedRecords;
+	m_svJournalQueue.clear();
+	m_nQueuedRecords = 0;
+
+	if (m_nJournalRecords >= std::max<size_t>(BANLIST_COMPACT_RECORDS, m_vBanList.size() / 4))
+		Compact();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: replaces the banned list with the one in 'banlist.json'
+// Output : true on success, false otherwise
+//-----------------------------------------------------------------------------
+bool CBanSystem::ImportJson(void)
+{
 	FileHandle_t pFile = FileSystem()->Open("banlist.json", "rt");
 	if (!pFile)
-		return;
+		return false;
 
 	uint32_t nLen = FileSystem()->Size(pFile);
 	char* pBuf = MemAllocSingleton()->Alloc<char>(nLen);
@@ -30,6 +572,14 @@ void CBanSystem::Load(void)
 	FileSystem()->Close(pFile);
 
 	pBuf[nRead] = '\0'; // Null terminate the string buffer containing our banned list.
+	bool bSuccess = true;
+
+	if (m_CompactThread.joinable())
+		m_CompactThread.join();
+
+	Clear();
+	m_svJournalQueue.clear();
+	m_nQueuedRecords = 0;
 
 	try
 	{
@@ -42,6 +592,7 @@ void CBanSystem::Load(void)
 				nTotalBans = jsIn["totalBans"].get<size_t>();
 		}
 
+		m_vBanList.reserve(nTotalBans);
 		for (size_t i = 0; i < nTotalBans; i++)
 		{
 			nlohmann::json jsEntry = jsIn[std::to_string(i)];
@@ -50,22 +601,28 @@ void CBanSystem::Load(void)
 				string  svIpAddress = jsEntry["ipAddress"].get<string>();
 				uint64_t nNucleusID = jsEntry["nucleusId"].get<uint64_t>();
 
-				m_vBanList.push_back(std::make_pair(svIpAddress, nNucleusID));
+				InsertEntry(svIpAddress, nNucleusID);
 			}
 		}
 	}
 	catch (const std::exception& ex)
 	{
 		Warning(eDLL_T::SERVER, "%s: Exception while parsing banned list:\n%s\n", __FUNCTION__, ex.what());
+		bSuccess = false;
 	}
 
 	MemAllocSingleton()->Free(pBuf);
+
+	m_nGeneration = NewGeneration();
+	RewriteSnapshot();
+
+	return bSuccess;
 }
 
 //-----------------------------------------------------------------------------
-// Purpose: saves the banned list
+// Purpose: writes the banned list to 'banlist.json'
 //-----------------------------------------------------------------------------
-void CBanSystem::Save(void) const
+void CBanSystem::ExportJson(void) const
 {
 	FileHandle_t pFile = FileSystem()->Open("banlist.json", "wt", "PLATFORM");
 	if (!pFile)
@@ -79,8 +636,8 @@ void CBanSystem::Save(void) const
 		nlohmann::json jsOut;
 		for (size_t i = 0; i < m_vBanList.size(); i++)
 		{
-			jsOut[std::to_string(i)]["ipAddress"] = m_vBanList[i].first;
-			jsOut[std::to_string(i)]["nucleusId"] = m_vBanList[i].second;
+			jsOut[std::to_string(i)]["ipAddress"] = m_vBanList[i].m_svIpAddress;
+			jsOut[std::to_string(i)]["nucleusId"] = m_vBanList[i].m_nNucleusID;
 		}
 
 		jsOut["totalBans"] = m_vBanList.size();
@@ -93,88 +650,368 @@ void CBanSystem::Save(void) const
 		Warning(eDLL_T::SERVER, "%s: Exception while parsing banned list:\n%s\n", __FUNCTION__, ex.what());
 	}
 
-	FileSystem()->Close(pFile);
+	FileSystem()->Close(pFile);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: adds a banned player entry to the banned list
+// Input  : &svIpAddress - address, or prefix in CIDR notation
+//			nNucleusID - 
+//-----------------------------------------------------------------------------
+bool CBanSystem::AddEntry(const string& svIpAddress, const uint64_t nNucleusID)
+{
+	if (!InsertEntry(svIpAddress, nNucleusID))
+		return false;
+
+	BanList_WriteRecord(m_svJournalQueue, BANLIST_OP_ADD, svIpAddress, nNucleusID);
+	m_nQueuedRecords++;
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: deletes the first entry in the banned list matching either key
+// Input  : &svIpAddress - address, or prefix in CIDR notation
+//			nNucleusID - 
+//-----------------------------------------------------------------------------
+bool CBanSystem::DeleteEntry(const string& svIpAddress, const uint64_t nNucleusID)
+{
+	Assert(!svIpAddress.empty());
+
+	size_t nIndex = SIZE_MAX;
+	if (nNucleusID)
+	{
+		auto range = m_mNucleusIndex.equal_range(nNucleusID);
+		for (auto it = range.first; it != range.second; ++it)
+			nIndex = std::min<size_t>(nIndex, it->second);
+	}
+
+	BanAddress_t address;
+	int nPrefixLen;
+
+	if (BanAddress_t::Parse(svIpAddress, address, nPrefixLen))
+	{
+		auto range = m_mAddressIndex.equal_range(address);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (m_vBanList[it->second].m_nPrefixLen == nPrefixLen)
+				nIndex = std::min<size_t>(nIndex, it->second);
+		}
+	}
+
+	if (nIndex == SIZE_MAX)
+		return false;
+
+	const BanEntry_t& entry = m_vBanList[nIndex];
+
+	// Journaled by value, replaying it must remove this exact entry.
+	BanList_WriteRecord(m_svJournalQueue, BANLIST_OP_DELETE, entry.m_svIpAddress, entry.m_nNucleusID);
+	m_nQueuedRecords++;
+
+	DeleteConnectionRefuse(entry.m_nNucleusID);
+	EraseEntry(nIndex);
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: adds an entry to the banned list without journaling it
+// Input  : &svIpAddress - 
+//			nNucleusID - 
+// Output : true if added, false if it already exists
+//-----------------------------------------------------------------------------
+bool CBanSystem::InsertEntry(const string& svIpAddress, const uint64_t nNucleusID)
+{
+	Assert(!svIpAddress.empty());
+
+	if (FindEntry(svIpAddress, nNucleusID) != SIZE_MAX)
+		return false;
+
+	BanEntry_t entry;
+	entry.m_svIpAddress = svIpAddress;
+	entry.m_nNucleusID = nNucleusID;
+
+	if (!BanAddress_t::Parse(svIpAddress, entry.m_Address, entry.m_nPrefixLen))
+	{
+		entry.m_Address = BanAddress_t{ 0, 0 };
+		entry.m_nPrefixLen = 0; // Matches nothing, but kept so it isn't lost on save.
+	}
+
+	m_vBanList.push_back(std::move(entry));
+	IndexEntry(m_vBanList.size() - 1);
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: finds the entry with exactly given address and NucleusID
+// Input  : &svIpAddress - 
+//			nNucleusID - 
+// Output : position in the banned list, SIZE_MAX if not found
+//-----------------------------------------------------------------------------
+size_t CBanSystem::FindEntry(const string& svIpAddress, const uint64_t nNucleusID) const
+{
+	auto fnIsEqual = [&](const BanEntry_t& other)
+	{ return other.m_nNucleusID == nNucleusID && other.m_svIpAddress.compare(svIpAddress) == NULL; };
+
+	BanAddress_t address;
+	int nPrefixLen;
+
+	if (nNucleusID)
+	{
+		auto range = m_mNucleusIndex.equal_range(nNucleusID);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (fnIsEqual(m_vBanList[it->second]))
+				return it->second;
+		}
+	}
+	else if (BanAddress_t::Parse(svIpAddress, address, nPrefixLen))
+	{
+		auto range = m_mAddressIndex.equal_range(address);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (fnIsEqual(m_vBanList[it->second]))
+				return it->second;
+		}
+	}
+	else
+	{
+		auto it = std::find_if(m_vBanList.begin(), m_vBanList.end(), fnIsEqual);
+		if (it != m_vBanList.end())
+			return static_cast<size_t>(it - m_vBanList.begin());
+	}
+
+	return SIZE_MAX;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: loads the snapshot of the banned list
+// Input  : &nGeneration - generation of the snapshot
+// Output : true on success, false if missing or corrupt
+//-----------------------------------------------------------------------------
+bool CBanSystem::LoadSnapshot(uint64_t& nGeneration)
+{
+	CIOStream reader;
+	if (!reader.Open(BANLIST_SNAPSHOT_PATH, CIOStream::Mode_t::READ))
+		return false;
+
+	const vector<uint8_t>& vData = reader.GetVector();
+	size_t nPos = 0;
+
+	uint32_t nMagic, nVersion, nCount;
+	if (!BanList_Read(vData, nPos, nMagic) || nMagic != BANLIST_MAGIC ||
+		!BanList_Read(vData, nPos, nVersion) || nVersion != BANLIST_VERSION ||
+		!BanList_Read(vData, nPos, nGeneration) || !BanList_Read(vData, nPos, nCount))
+	{
+		Warning(eDLL_T::SERVER, "%s: Banned list snapshot '%s' is invalid\n", __FUNCTION__, BANLIST_SNAPSHOT_PATH);
+		return false;
+	}
+
+	m_vBanList.reserve(nCount);
+
+	string svIpAddress;
+	uint64_t nNucleusID;
+
+	for (uint32_t i = 0; i < nCount; i++)
+	{
+		if (!BanList_ReadRecord(vData, nPos, svIpAddress, nNucleusID))
+			break;
+
+		InsertEntry(svIpAddress, nNucleusID);
+	}
+
+	if (!BanList_Read(vData, nPos, nMagic) || nMagic != BANLIST_MAGIC) // Truncated.
+	{
+		Warning(eDLL_T::SERVER, "%s: Banned list snapshot '%s' is truncated\n", __FUNCTION__, BANLIST_SNAPSHOT_PATH);
+		Clear();
+
+		return false;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: applies the changes in a journal to the banned list
+// Input  : *pszPath - 
+//			nGeneration - generation of the loaded snapshot
+//			bMatch - if set the journal has to be of given generation, otherwise
+//			         of any other
+//			&nRecords - number of records replayed
+// Output : true if the journal was replayed, false otherwise
+//-----------------------------------------------------------------------------
+bool CBanSystem::ReplayJournal(const char* pszPath, uint64_t nGeneration, bool bMatch, size_t& nRecords)
+{
+	nRecords = 0;
+
+	CIOStream reader;
+	if (!reader.Open(pszPath, CIOStream::Mode_t::READ))
+		return false;
+
+	const vector<uint8_t>& vData = reader.GetVector();
+	size_t nPos = 0;
+
+	uint32_t nMagic, nVersion;
+	uint64_t nJournalGeneration;
+
+	if (!BanList_Read(vData, nPos, nMagic) || nMagic != BANJOURNAL_MAGIC ||
+		!BanList_Read(vData, nPos, nVersion) || nVersion != BANLIST_VERSION ||
+		!BanList_Read(vData, nPos, nJournalGeneration) || (nJournalGeneration == nGeneration) != bMatch)
+	{
+		return false;
+	}
+
+	string svIpAddress;
+	uint64_t nNucleusID;
+	uint8_t nOperation;
+
+	// A record cut off by a crash mid-append ends the journal.
+	while (BanList_Read(vData, nPos, nOperation) && BanList_ReadRecord(vData, nPos, svIpAddress, nNucleusID))
+	{
+		if (nOperation == BANLIST_OP_ADD)
+		{
+			InsertEntry(svIpAddress, nNucleusID);
+		}
+		else if (nOperation == BANLIST_OP_DELETE)
+		{
+			const size_t nIndex = FindEntry(svIpAddress, nNucleusID);
+			if (nIndex != SIZE_MAX)
+				EraseEntry(nIndex);
+		}
+		else
+		{
+			break;
+		}
+
+		nRecords++;
+	}
+
+	return true;
 }
 
 //-----------------------------------------------------------------------------
-// Purpose: adds a banned player entry to the banned list
-// Input  : &svIpAddress - 
-//			nNucleusID - 
+// Purpose: opens the journal for appending
+// Input  : bTruncate - start a new journal for the current generation
+// Output : true on success, false otherwise
 //-----------------------------------------------------------------------------
-bool CBanSystem::AddEntry(const string& svIpAddress, const uint64_t nNucleusID)
+bool CBanSystem::OpenJournal(bool bTruncate)
 {
-	Assert(!svIpAddress.empty());
+	m_JournalStream.close();
+	m_JournalStream.clear();
 
-	if (IsBanListValid())
-	{
-		auto it = std::find(m_vBanList.begin(), m_vBanList.end(), std::make_pair(svIpAddress, nNucleusID));
-		if (it == m_vBanList.end())
-		{
-			m_vBanList.push_back(std::make_pair(svIpAddress, nNucleusID));
-			return true;
-		}
-	}
-	else
+	std::error_code ec;
+	if (!bTruncate && fs::file_size(BANLIST_JOURNAL_PATH, ec) == 0)
+		bTruncate = true; // Missing or empty, write the header.
+
+	m_JournalStream.open(BANLIST_JOURNAL_PATH, std::ios::binary | (bTruncate ? std::ios::trunc : std::ios::app));
+	if (!m_JournalStream.is_open())
+		return false;
+
+	if (bTruncate)
 	{
-		m_vBanList.push_back(std::make_pair(svIpAddress, nNucleusID));
-		return true;
+		const uint32_t nMagic = BANJOURNAL_MAGIC;
+		const uint32_t nVersion = BANLIST_VERSION;
+
+		m_JournalStream.write(reinterpret_cast<const char*>(&nMagic), sizeof(nMagic));
+		m_JournalStream.write(reinterpret_cast<const char*>(&nVersion), sizeof(nVersion));
+		m_JournalStream.write(reinterpret_cast<const char*>(&m_nGeneration), sizeof(m_nGeneration));
+		m_JournalStream.flush();
+
+		m_nJournalRecords = 0;
 	}
 
-	return false;
+	return m_JournalStream.good();
 }
 
 //-----------------------------------------------------------------------------
-// Purpose: deletes an entry in the banned list
-// Input  : &svIpAddress - 
-//			nNucleusID - 
+// Purpose: returns a generation that no earlier snapshot or journal used
 //-----------------------------------------------------------------------------
-bool CBanSystem::DeleteEntry(const string& svIpAddress, const uint64_t nNucleusID)
+uint64_t CBanSystem::NewGeneration(void) const
 {
-	Assert(!svIpAddress.empty());
+	const uint64_t nTime = static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+	return std::max<uint64_t>(nTime, m_nGeneration + 1);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: folds the journal into a new snapshot on a background thread
+//-----------------------------------------------------------------------------
+void CBanSystem::Compact(void)
+{
+	if (m_CompactThread.joinable())
+		m_CompactThread.join();
+
+	std::error_code ec;
+	if (fs::exists(BANLIST_JOURNAL_OLD_PATH, ec))
+		return; // Previous compaction failed, recovered on the next load.
 
-	if (IsBanListValid())
+	// New changes go to a fresh journal on top of the new snapshot, the old
+	// one is kept until the snapshot that contains it has been written.
+	m_JournalStream.close();
+	fs::rename(BANLIST_JOURNAL_PATH, BANLIST_JOURNAL_OLD_PATH, ec);
+
+	if (ec)
 	{
-		auto it = std::find_if(m_vBanList.begin(), m_vBanList.end(),
-			[&](const pair<const string, const uint64_t>& element)
-			{ return (svIpAddress.compare(element.first) == NULL || element.second == nNucleusID); });
+		OpenJournal(false);
+		return;
+	}
 
-		if (it != m_vBanList.end())
+	m_nGeneration = NewGeneration();
+	OpenJournal(true);
+
+	vector<std::pair<string, uint64_t>> vEntries;
+	vEntries.reserve(m_vBanList.size());
+
+	for (const BanEntry_t& entry : m_vBanList)
+		vEntries.emplace_back(entry.m_svIpAddress, entry.m_nNucleusID);
+
+	m_CompactThread = std::thread([](vector<std::pair<string, uint64_t>> vEntries, uint64_t nGeneration)
 		{
-			DeleteConnectionRefuse(it->second);
-			m_vBanList.erase(it);
+			if (!BanList_WriteSnapshot(BANLIST_SNAPSHOT_PATH, vEntries, nGeneration))
+			{
+				Warning(eDLL_T::SERVER, "%s: Unable to write to '%s' (read-only?)\n", "CBanSystem::Compact", BANLIST_SNAPSHOT_PATH);
+				return;
+			}
 
-			return true;
-		}
+			std::error_code ec;
+			fs::remove(BANLIST_JOURNAL_OLD_PATH, ec);
+		}, std::move(vEntries), m_nGeneration);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: writes the banned list to a new snapshot and starts a new journal
+//-----------------------------------------------------------------------------
+void CBanSystem::RewriteSnapshot(void)
+{
+	vector<std::pair<string, uint64_t>> vEntries;
+	vEntries.reserve(m_vBanList.size());
+
+	for (const BanEntry_t& entry : m_vBanList)
+		vEntries.emplace_back(entry.m_svIpAddress, entry.m_nNucleusID);
+
+	if (!BanList_WriteSnapshot(BANLIST_SNAPSHOT_PATH, vEntries, m_nGeneration) || !OpenJournal(true))
+	{
+		Error(eDLL_T::SERVER, NO_ERROR, "%s - Unable to write to '%s' (read-only?)\n", __FUNCTION__, BANLIST_SNAPSHOT_PATH);
+		return;
 	}
 
-	return false;
+	std::error_code ec;
+	fs::remove(BANLIST_JOURNAL_OLD_PATH, ec);
 }
 
 //-----------------------------------------------------------------------------
-// Purpose: adds a connect refuse entry to the refused list
+// Purpose: adds a connect refuse entry to the refused list, connected clients
+//          with this NucleusID are removed on the next BanListCheck()
 // Input  : &svError - 
 //			nNucleusID - 
 //-----------------------------------------------------------------------------
 bool CBanSystem::AddConnectionRefuse(const string& svError, const uint64_t nNucleusID)
 {
-	if (IsRefuseListValid())
-	{
-		auto it = std::find_if(m_vRefuseList.begin(), m_vRefuseList.end(),
-			[&](const pair<const string, const uint64_t>& element) { return element.second == nNucleusID; });
-
-		if (it == m_vRefuseList.end())
-		{
-			m_vRefuseList.push_back(std::make_pair(svError, nNucleusID));
-			return true;
-		}
-	}
-	else
-	{
-		m_vRefuseList.push_back(std::make_pair(svError, nNucleusID));
-		return true;
-	}
+	if (!m_mRefuseList.emplace(nNucleusID, svError).second)
+		return false;
 
-	return false;
+	m_vRefuseQueue.push_back(nNucleusID);
+	return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -183,57 +1020,62 @@ bool CBanSystem::AddConnectionRefuse(const string& svError, const uint64_t nNucl
 //-----------------------------------------------------------------------------
 bool CBanSystem::DeleteConnectionRefuse(const uint64_t nNucleusID)
 {
-	if (IsRefuseListValid())
-	{
-		auto it = std::find_if(m_vRefuseList.begin(), m_vRefuseList.end(),
-			[&](const pair<const string, const uint64_t>& element) { return element.second == nNucleusID; });
+	return m_mRefuseList.erase(nNucleusID) != 0;
+}
 
-		if (it != m_vRefuseList.end())
-		{
-			m_vRefuseList.erase(it);
-			return true;
-		}
-	}
+//-----------------------------------------------------------------------------
+// Purpose: queues a newly connected client for removal if it has been refused
+// Input  : *pClient - 
+//-----------------------------------------------------------------------------
+void CBanSystem::OnClientConnected(CClient* pClient)
+{
+	const uint64_t nNucleusID = pClient->GetNucleusID();
 
-	return false;
+	if (nNucleusID && m_mRefuseList.find(nNucleusID) != m_mRefuseList.end())
+		m_vRefuseQueue.push_back(nNucleusID);
 }
 
 //-----------------------------------------------------------------------------
-// Purpose: Check refuse list and kill netchan connection.
+// Purpose: removes the connected clients queued by AddConnectionRefuse() and
+//          OnClientConnected(), and bans them
 //-----------------------------------------------------------------------------
 void CBanSystem::BanListCheck(void)
 {
-	if (IsRefuseListValid())
+	if (m_vRefuseQueue.empty())
+		return;
+
+	static vector<uint64_t> vQueue;
+	static vector<CClient*> vClients;
+
+	vQueue.swap(m_vRefuseQueue); // Disconnecting may queue again.
+	bool bSave = false;
+
+	for (const uint64_t nNucleusID : vQueue)
 	{
-		bool bSave = false;
-		for (size_t i = 0; i < m_vRefuseList.size(); i++)
-		{
-			for (int c = 0; c < MAX_PLAYERS; c++) // Loop through all possible client instances.
-			{
-				CClient* pClient = g_pClient->GetClient(c);
-				if (!pClient)
-					continue;
+		auto it = m_mRefuseList.find(nNucleusID);
+		if (it == m_mRefuseList.end()) // Unbanned in the meantime.
+			continue;
 
-				CNetChan* pNetChan = pClient->GetNetChan();
-				if (!pNetChan)
-					continue;
+		const string svReason = it->second;
 
-				if (pClient->GetNucleusID() != m_vRefuseList[i].second)
-					continue;
+		vClients.clear();
+		g_pClientIndex->FindByNucleusID(nNucleusID, vClients);
 
-				string svIpAddress = pNetChan->GetAddress();
+		for (CClient* pClient : vClients)
+		{
+			string svIpAddress = pClient->GetNetChan()->GetAddress();
 
-				Warning(eDLL_T::SERVER, "Removing client '%s' from slot '%i' ('%llu' is banned from this server!)\n", svIpAddress.c_str(), c, pClient->GetNucleusID());
-				if (AddEntry(svIpAddress, pClient->GetNucleusID()) && !bSave)
-					bSave = true;
+			Warning(eDLL_T::SERVER, "Removing client '%s' from slot '%i' ('%llu' is banned from this server!)\n", svIpAddress.c_str(), CClientIndex::GetSlot(pClient), nNucleusID);
+			if (AddEntry(svIpAddress, nNucleusID) && !bSave)
+				bSave = true;
 
-				pClient->Disconnect(Reputation_t::REP_MARK_BAD, m_vRefuseList[i].first.c_str());
-			}
+			pClient->Disconnect(Reputation_t::REP_MARK_BAD, svReason.c_str());
 		}
-
-		if (bSave)
-			Save(); // Save banned list to file.
 	}
+	vQueue.clear();
+
+	if (bSave)
+		Save(); // Save banned list to file.
 }
 
 //-----------------------------------------------------------------------------
@@ -244,25 +1086,104 @@ void CBanSystem::BanListCheck(void)
 //-----------------------------------------------------------------------------
 bool CBanSystem::IsBanned(const string& svIpAddress, const uint64_t nNucleusID) const
 {
-	for (size_t i = 0; i < m_vBanList.size(); i++)
+	if (nNucleusID && m_mNucleusIndex.find(nNucleusID) != m_mNucleusIndex.end())
+		return true;
+
+	BanAddress_t address;
+	int nPrefixLen;
+
+	if (!BanAddress_t::Parse(svIpAddress, address, nPrefixLen))
+		return false;
+
+	// Prefix entries are indexed by their masked address as well, so any
+	// hit here is either the address itself or a prefix containing it.
+	if (m_mAddressIndex.find(address) != m_mAddressIndex.end())
+		return true;
+
+	return m_PrefixTree.GetCount() && m_PrefixTree.Contains(address);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: clears the banned list and its indexes
+//-----------------------------------------------------------------------------
+void CBanSystem::Clear(void)
+{
+	m_vBanList.clear();
+	m_mNucleusIndex.clear();
+	m_mAddressIndex.clear();
+	m_PrefixTree.Clear();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: adds the entry at given position to the indexes
+// Input  : nIndex - 
+//-----------------------------------------------------------------------------
+void CBanSystem::IndexEntry(size_t nIndex)
+{
+	const BanEntry_t& entry = m_vBanList[nIndex];
+
+	if (entry.m_nNucleusID) // Cannot be null.
+		m_mNucleusIndex.emplace(entry.m_nNucleusID, nIndex);
+
+	if (entry.m_nPrefixLen)
 	{
-		string ipAddress = m_vBanList[i].first;
-		uint64_t nucleusID = m_vBanList[i].second;
+		m_mAddressIndex.emplace(entry.m_Address, nIndex);
 
-		if (ipAddress.empty() ||
-			!nucleusID) // Cannot be null.
-		{
-			continue;
-		}
+		if (entry.m_nPrefixLen < 128)
+			m_PrefixTree.Insert(entry.m_Address, entry.m_nPrefixLen);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: removes the entry at given position from the indexes
+// Input  : nIndex - 
+//-----------------------------------------------------------------------------
+void CBanSystem::UnindexEntry(size_t nIndex)
+{
+	const BanEntry_t& entry = m_vBanList[nIndex];
 
-		if (ipAddress.compare(svIpAddress) == NULL ||
-			nNucleusID == nucleusID)
+	auto fnErase = [nIndex](auto& mIndex, const auto& key)
+	{
+		auto range = mIndex.equal_range(key);
+		for (auto it = range.first; it != range.second; ++it)
 		{
-			return true;
+			if (it->second == nIndex)
+			{
+				mIndex.erase(it);
+				return;
+			}
 		}
+	};
+
+	if (entry.m_nNucleusID)
+		fnErase(m_mNucleusIndex, entry.m_nNucleusID);
+
+	if (entry.m_nPrefixLen)
+	{
+		fnErase(m_mAddressIndex, entry.m_Address);
+
+		if (entry.m_nPrefixLen < 128)
+			m_PrefixTree.Remove(entry.m_Address, entry.m_nPrefixLen);
 	}
+}
 
-	return false;
+//-----------------------------------------------------------------------------
+// Purpose: erases the entry at given position, the last entry takes its place
+// Input  : nIndex - 
+//-----------------------------------------------------------------------------
+void CBanSystem::EraseEntry(size_t nIndex)
+{
+	const size_t nLast = m_vBanList.size() - 1;
+
+	UnindexEntry(nIndex);
+	if (nIndex != nLast)
+	{
+		UnindexEntry(nLast);
+		m_vBanList[nIndex] = std::move(m_vBanList[nLast]);
+		IndexEntry(nIndex);
+	}
+
+	m_vBanList.pop_back();
 }
 
 //-----------------------------------------------------------------------------
@@ -270,7 +1191,7 @@ bool CBanSystem::IsBanned(const string& svIpAddress, const uint64_t nNucleusID)
 //-----------------------------------------------------------------------------
 bool CBanSystem::IsRefuseListValid(void) const
 {
-	return !m_vRefuseList.empty();
+	return !m_mRefuseList.empty();
 }
 
 //-----------------------------------------------------------------------------
@@ -281,6 +1202,39 @@ bool CBanSystem::IsBanListValid(void) const
 	return !m_vBanList.empty();
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: finds the connected clients by handle, nucleus id or ip address
+// Input  : &svHandle - 
+//			&vClients - 
+//-----------------------------------------------------------------------------
+void CBanSystem::FindClientsById(const string& svHandle, vector<CClient*>& vClients) const
+{
+	if (StringIsDigit(svHandle))
+	{
+		uint64_t nTargetID = static_cast<uint64_t>(std::stoll(svHandle));
+		if (nTargetID > static_cast<uint64_t>(MAX_PLAYERS)) // Is it a possible nucleusID?
+			g_pClientIndex->FindByNucleusID(nTargetID, vClients);
+		else // If its not try by handle.
+			g_pClientIndex->FindByHandle(static_cast<uint16_t>(nTargetID), vClients);
+
+		return;
+	}
+
+	for (int i = 0; i < MAX_PLAYERS; i++)
+	{
+		CClient* pClient = g_pClient->GetClient(i);
+		if (!pClient)
+			continue;
+
+		CNetChan* pNetChan = pClient->GetNetChan();
+		if (!pNetChan)
+			continue;
+
+		if (svHandle.compare(pNetChan->GetAddress()) == NULL)
+			vClients.push_back(pClient);
+	}
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: kicks a player by given name
 // Input  : &svPlayerName - 
@@ -290,20 +1244,11 @@ void CBanSystem::KickPlayerByName(const string& svPlayerName)
 	if (svPlayerName.empty())
 		return;
 
-	for (int i = 0; i < MAX_PLAYERS; i++)
-	{
-		if (CClient* pClient = g_pClient->GetClient(i))
-		{
-			if (CNetChan* pNetChan = pClient->GetNetChan())
-			{
-				if (strlen(pNetChan->GetName()) > 0)
-				{
-					if (svPlayerName.compare(pNetChan->GetName()) == NULL) // Our wanted name?
-						pClient->Disconnect(REP_MARK_BAD, "Kicked from server");
-				}
-			}
-		}
-	}
+	vector<CClient*> vClients;
+	g_pClientIndex->FindByName(svPlayerName, vClients);
+
+	for (CClient* pClient : vClients)
+		pClient->Disconnect(REP_MARK_BAD, "Kicked from server");
 }
 
 //-----------------------------------------------------------------------------
@@ -317,43 +1262,11 @@ void CBanSystem::KickPlayerById(const string& svHandle)
 
 	try
 	{
-		bool bOnlyDigits = StringIsDigit(svHandle);
-		for (int i = 0; i < MAX_PLAYERS; i++)
-		{
-			CClient* pClient = g_pClient->GetClient(i);
-			if (!pClient)
-				continue;
+		vector<CClient*> vClients;
+		FindClientsById(svHandle, vClients);
 
-			CNetChan* pNetChan = pClient->GetNetChan();
-			if (!pNetChan)
-				continue;
-
-			if (bOnlyDigits)
-			{
-				uint64_t nTargetID = static_cast<uint64_t>(std::stoll(svHandle));
-				if (nTargetID > MAX_PLAYERS) // Is it a possible nucleusID?
-				{
-					uint64_t nNucleusID = pClient->GetNucleusID();
-					if (nNucleusID != nTargetID)
-						continue;
-				}
-				else // If its not try by handle.
-				{
-					uint64_t nClientID = static_cast<uint64_t>(pClient->GetHandle());
-					if (nClientID != nTargetID)
-						continue;
-				}
-
-				pClient->Disconnect(REP_MARK_BAD, "Kicked from server");
-			}
-			else
-			{
-				if (svHandle.compare(pNetChan->GetAddress()) != NULL)
-					continue;
-
-				pClient->Disconnect(REP_MARK_BAD, "Kicked from server");
-			}
-		}
+		for (CClient* pClient : vClients)
+			pClient->Disconnect(REP_MARK_BAD, "Kicked from server");
 	}
 	catch (const std::exception& e)
 	{
@@ -371,26 +1284,16 @@ void CBanSystem::BanPlayerByName(const string& svPlayerName)
 	if (svPlayerName.empty())
 		return;
 
-	bool bSave = false;
+	vector<CClient*> vClients;
+	g_pClientIndex->FindByName(svPlayerName, vClients);
 
-	for (int i = 0; i < MAX_PLAYERS; i++)
+	bool bSave = false;
+	for (CClient* pClient : vClients)
 	{
-		if (CClient* pClient = g_pClient->GetClient(i))
-		{
-			if (CNetChan* pNetChan = pClient->GetNetChan())
-			{
-				if (strlen(pNetChan->GetName()) > 0)
-				{
-					if (svPlayerName.compare(pNetChan->GetName()) == NULL) // Our wanted name?
-					{
-						if (AddEntry(pNetChan->GetAddress(), pClient->GetNucleusID()) && !bSave)
-							bSave = true;
+		if (AddEntry(pClient->GetNetChan()->GetAddress(), pClient->GetNucleusID()) && !bSave)
+			bSave = true;
 
-						pClient->Disconnect(REP_MARK_BAD, "Banned from server");
-					}
-				}
-			}
-		}
+		pClient->Disconnect(REP_MARK_BAD, "Banned from server");
 	}
 
 	if (bSave)
@@ -408,52 +1311,16 @@ void CBanSystem::BanPlayerById(const string& svHandle)
 
 	try
 	{
-		bool bOnlyDigits = StringIsDigit(svHandle);
-		bool bSave = false;
+		vector<CClient*> vClients;
+		FindClientsById(svHandle, vClients);
 
-		for (int i = 0; i < MAX_PLAYERS; i++)
+		bool bSave = false;
+		for (CClient* pClient : vClients)
 		{
-			CClient* pClient = g_pClient->GetClient(i);
-			if (!pClient)
-				continue;
-
-			CNetChan* pNetChan = pClient->GetNetChan();
-			if (!pNetChan)
-				continue;
-
-			if (bOnlyDigits)
-			{
-				uint64_t nTargetID = static_cast<uint64_t>(std::stoll(svHandle));
-				if (nTargetID > static_cast<uint64_t>(MAX_PLAYERS)) // Is it a possible nucleusID?
-				{
-					uint64_t nNucleusID = pClient->GetNucleusID();
-					if (nNucleusID != nTargetID)
-						continue;
-				}
-				else // If its not try by handle.
-				{
-					uint64_t nClientID = static_cast<uint64_t>(pClient->GetHandle());
-					if (nClientID != nTargetID)
-						continue;
-				}
+			if (AddEntry(pClient->GetNetChan()->GetAddress(), pClient->GetNucleusID()) && !bSave)
+				bSave = true;
 
-				if (AddEntry(pNetChan->GetAddress(), pClient->GetNucleusID()) && !bSave)
-					bSave = true;
-
-				Save();
-				pClient->Disconnect(REP_MARK_BAD, "Banned from server");
-			}
-			else
-			{
-				if (svHandle.compare(pNetChan->GetAddress()) != NULL)
-					continue;
-
-				if (AddEntry(pNetChan->GetAddress(), pClient->GetNucleusID()) && !bSave)
-					bSave = true;
-
-				Save();
-				pClient->Disconnect(REP_MARK_BAD, "Banned from server");
-			}
+			pClient->Disconnect(REP_MARK_BAD, "Banned from server");
 		}
 
 		if (bSave)
@@ -496,5 +1363,143 @@ void CBanSystem::UnbanPlayer(const string& svCriteria)
 	}
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: builds a separate banned list of random addresses, NucleusIDs and
+//          prefixes, and times its lookups against a linear scan of the same
+//          entries, which must agree
+// Input  : &bench - 
+//          nEntries - 
+//          nLookups - 
+// Output : true if every verified lookup matched
+//-----------------------------------------------------------------------------
+bool CBanSystem::Benchmark(CBenchmark& bench, size_t nEntries, size_t nLookups)
+{
+	const size_t nPrefixes = 64;
+	const size_t nLinearLookups = std::min<size_t>(nLookups, 2000); // A linear scan over every entry is slow.
+
+	std::mt19937_64 rng(BENCH_RANDOM_SEED);
+	char szAddress[64];
+
+	auto fnRandomAddress = [&](bool bIPv6) -> string
+	{
+		if (bIPv6)
+		{
+			snprintf(szAddress, sizeof(szAddress), "2001:db8:%x:%x::%x", unsigned(rng() & 0xFFFF), unsigned(rng() & 0xFFFF), unsigned(rng() & 0xFFFF));
+		}
+		else
+		{
+			const uint32_t nAddress = static_cast<uint32_t>(rng());
+			snprintf(szAddress, sizeof(szAddress), "%u.%u.%u.%u", nAddress >> 24, (nAddress >> 16) & 0xFF, (nAddress >> 8) & 0xFF, nAddress & 0xFF);
+		}
+		return szAddress;
+	};
+
+	vector<std::pair<string, uint64_t>> vEntries;
+	vEntries.reserve(nEntries + nPrefixes);
+
+	for (size_t i = 0; i < nEntries; i++)
+	{
+		vEntries.emplace_back(fnRandomAddress(rng() % 10 == 0), (rng() % 8) ? (rng() | 1) : 0);
+	}
+	for (size_t i = 0; i < nPrefixes; i++)
+	{
+		snprintf(szAddress, sizeof(szAddress), "10.%u.0.0/16", unsigned(i * 3));
+		vEntries.emplace_back(szAddress, 0);
+	}
+
+	// Half the lookups hit an entry, some hit a prefix, the rest are random.
+	vector<std::pair<string, uint64_t>> vLookups;
+	vLookups.reserve(nLookups);
+
+	for (size_t i = 0; i < nLookups; i++)
+	{
+		const int nPick = static_cast<int>(rng() % 8);
+		if (nPick < 4)
+		{
+			const std::pair<string, uint64_t>& entry = vEntries[rng() % nEntries];
+			vLookups.emplace_back(nPick < 2 ? entry.first : fnRandomAddress(false), nPick < 2 ? rng() | 1 : entry.second);
+		}
+		else if (nPick < 5)
+		{
+			snprintf(szAddress, sizeof(szAddress), "10.%u.%u.%u", unsigned(rng() % 256), unsigned(rng() % 256), unsigned(rng() % 256));
+			vLookups.emplace_back(szAddress, rng() | 1);
+		}
+		else
+		{
+			vLookups.emplace_back(fnRandomAddress(rng() % 10 == 0), rng() | 1);
+		}
+	}
+
+	std::unique_ptr<CBanSystem> pBanSystem(new CBanSystem()); // Never saved, the actual banned list is left alone.
+	const double flAddTime = CBenchmark::Time([&]()
+		{
+			for (const std::pair<string, uint64_t>& entry : vEntries)
+			{
+				pBanSystem->AddEntry(entry.first, entry.second);
+			}
+		});
+
+	vector<BanEntry_t> vLinear;
+	vLinear.reserve(vEntries.size());
+
+	for (const std::pair<string, uint64_t>& entry : vEntries)
+	{
+		BanEntry_t linearEntry;
+		linearEntry.m_svIpAddress = entry.first;
+		linearEntry.m_nNucleusID = entry.second;
+
+		if (!BanAddress_t::Parse(entry.first, linearEntry.m_Address, linearEntry.m_nPrefixLen))
+		{
+			linearEntry.m_nPrefixLen = 0;
+		}
+		vLinear.push_back(std::move(linearEntry));
+	}
+
+	size_t nBanned = 0;
+	const double flIndexedTime = CBenchmark::Time([&]()
+		{
+			for (const std::pair<string, uint64_t>& lookup : vLookups)
+			{
+				nBanned += pBanSystem->IsBanned(lookup.first, lookup.second);
+			}
+		});
+
+	double flLinearTime = 0.0;
+	for (size_t i = 0; i < nLinearLookups; i++)
+	{
+		const std::pair<string, uint64_t>& lookup = vLookups[i];
+		bool bLinearBanned = false;
+
+		flLinearTime += CBenchmark::Time([&]()
+			{
+				BanAddress_t address;
+				int nPrefixLen;
+
+				const bool bParsed = BanAddress_t::Parse(lookup.first, address, nPrefixLen);
+				for (const BanEntry_t& entry : vLinear)
+				{
+					if ((lookup.second && entry.m_nNucleusID == lookup.second) ||
+						(bParsed && entry.m_nPrefixLen && address.IsInPrefix(entry.m_Address, entry.m_nPrefixLen)))
+					{
+						bLinearBanned = true;
+						break;
+					}
+				}
+			});
+
+		bench.Verify(bLinearBanned == pBanSystem->IsBanned(lookup.first, lookup.second),
+			"Lookup of '%s' ('%llu') disagrees with the linear scan", lookup.first.c_str(), lookup.second);
+	}
+
+	bench.Msg("Banned list of '%zu' entries ('%zu' prefixes) built in '%.3f' milliseconds",
+		vEntries.size(), nPrefixes, flAddTime * 1e3);
+	bench.Msg("Indexed: '%zu' lookups ('%zu' banned) in '%.3f' milliseconds ('%.3f' microseconds per lookup)",
+		nLookups, nBanned, flIndexedTime * 1e3, flIndexedTime * 1e6 / nLookups);
+	bench.Msg("Linear : '%zu' lookups in '%.3f' milliseconds ('%.3f' microseconds per lookup)",
+		nLinearLookups, flLinearTime * 1e3, flLinearTime * 1e6 / nLinearLookups);
+
+	return bench.Summarize("verified lookups", "the linear scan");
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 CBanSystem* g_pBanSystem = new CBanSystem();
@@ -1,10 +1,102 @@
 #pragma once
 
+class CClient;
+class CBenchmark;
+
+//-----------------------------------------------------------------------------
+// Binary IPv6 address, IPv4 addresses are stored IPv4-mapped (::ffff:a.b.c.d).
+//-----------------------------------------------------------------------------
+struct BanAddress_t
+{
+	uint64_t m_nHigh;
+	uint64_t m_nLow;
+
+	bool operator==(const BanAddress_t& other) const { return m_nHigh == other.m_nHigh && m_nLow == other.m_nLow; }
+	bool operator!=(const BanAddress_t& other) const { return !(*this == other); }
+
+	int  GetBit(int nBit) const;
+	bool IsInPrefix(const BanAddress_t& prefix, int nPrefixLen) const;
+	BanAddress_t Masked(int nPrefixLen) const;
+
+	static int CommonPrefixLen(const BanAddress_t& a, const BanAddress_t& b, int nMaxLen);
+	static bool Parse(const string& svAddress, BanAddress_t& outAddress, int& nPrefixLen);
+};
+
+struct BanAddressHash_t
+{
+	size_t operator()(const BanAddress_t& address) const;
+};
+
+//-----------------------------------------------------------------------------
+// Path compressed binary radix tree of banned address prefixes (CIDR).
+//-----------------------------------------------------------------------------
+class CBanPrefixTree
+{
+public:
+	CBanPrefixTree(void);
+
+	void Insert(const BanAddress_t& prefix, int nPrefixLen);
+	bool Remove(const BanAddress_t& prefix, int nPrefixLen);
+	bool Contains(const BanAddress_t& address) const;
+	void Clear(void);
+
+	size_t GetCount(void) const { return m_nCount; }
+
+private:
+	struct Node_t
+	{
+		BanAddress_t m_Prefix;     // Masked to m_nPrefixLen.
+		int32_t      m_nChild[2];  // Indexed by the bit following the prefix, -1 if none.
+		int32_t      m_nPrefixLen;
+		uint32_t     m_nRefs;      // Num bans on exactly this prefix, 0 for branch nodes.
+	};
+
+	int32_t NewNode(const BanAddress_t& prefix, int nPrefixLen, uint32_t nRefs);
+
+	vector<Node_t> m_vNodes; // Node 0 is the root (::/0).
+	size_t         m_nCount;
+};
+
+struct BanEntry_t
+{
+	string       m_svIpAddress;
+	uint64_t     m_nNucleusID;
+	BanAddress_t m_Address;    // Parsed m_svIpAddress, masked to m_nPrefixLen.
+	int32_t      m_nPrefixLen; // 128 for single addresses, 0 if m_svIpAddress doesn't parse.
+};
+
+#define BANLIST_MAGIC            (('N'<<24)+('A'<<16)+('B'<<8)+'R')
+#define BANJOURNAL_MAGIC         (('L'<<24)+('N'<<16)+('J'<<8)+'R')
+#define BANLIST_VERSION          1
+#define BANLIST_COMPACT_RECORDS  4096 // Journal records after which it's folded into the snapshot.
+
+#define BANLIST_SNAPSHOT_PATH    "platform\\banlist.dat"
+#define BANLIST_JOURNAL_PATH     "platform\\banlist.jnl"
+#define BANLIST_JOURNAL_OLD_PATH "platform\\banlist.jnl.old"
+
+enum BanListOp_t : uint8_t
+{
+	BANLIST_OP_ADD = 0,
+	BANLIST_OP_DELETE
+};
+
+//-----------------------------------------------------------------------------
+// The banned list is persisted as a binary snapshot and a journal of the
+// changes made since; the journal is folded into a new snapshot on a
+// background thread once it grows large. 'banlist.json' is only read when
+// there is no snapshot yet, or when explicitly imported.
+//-----------------------------------------------------------------------------
 class CBanSystem
 {
 public:
+	CBanSystem(void);
+	~CBanSystem(void);
+
 	void Load(void);
-	void Save(void) const;
+	void Save(void);
+
+	bool ImportJson(void);
+	void ExportJson(void) const;
 
 	bool AddEntry(const string& svIpAddress, const uint64_t nNucleusID);
 	bool DeleteEntry(const string& svIpAddress, const uint64_t nNucleusID);
@@ -12,6 +104,7 @@ public:
 	bool AddConnectionRefuse(const string& svError, const uint64_t nNucleusID);
 	bool DeleteConnectionRefuse(const uint64_t nNucleusID);
 
+	void OnClientConnected(CClient* pClient);
 	void BanListCheck(void);
 
 	bool IsBanned(const string& svIpAddress, const uint64_t nNucleusID) const;
@@ -26,9 +119,42 @@ public:
 
 	void UnbanPlayer(const string& svCriteria);
 
+	static bool Benchmark(CBenchmark& bench, size_t nEntries, size_t nLookups);
+
 private:
-	vector<std::pair<string, uint64_t>> m_vRefuseList = {};
-	vector<std::pair<string, uint64_t>> m_vBanList = {};
+	void FindClientsById(const string& svHandle, vector<CClient*>& vClients) const;
+
+	bool InsertEntry(const string& svIpAddress, const uint64_t nNucleusID);
+	size_t FindEntry(const string& svIpAddress, const uint64_t nNucleusID) const;
+
+	bool LoadSnapshot(uint64_t& nGeneration);
+	bool ReplayJournal(const char* pszPath, uint64_t nGeneration, bool bMatch, size_t& nRecords);
+	bool OpenJournal(bool bTruncate);
+	uint64_t NewGeneration(void) const;
+	void Compact(void);
+	void RewriteSnapshot(void);
+
+	void Clear(void);
+	void IndexEntry(size_t nIndex);
+	void UnindexEntry(size_t nIndex);
+	void EraseEntry(size_t nIndex);
+
+	std::unordered_map<uint64_t, string> m_mRefuseList; // NucleusID to reason.
+	vector<uint64_t> m_vRefuseQueue; // NucleusIDs to check against the connected clients.
+	vector<BanEntry_t> m_vBanList = {};
+
+	// Positions in m_vBanList, entries without a NucleusID or a parsable
+	// address are only matched on the key they do have.
+	std::unordered_multimap<uint64_t, size_t> m_mNucleusIndex;
+	std::unordered_multimap<BanAddress_t, size_t, BanAddressHash_t> m_mAddressIndex; // Keyed by the masked address.
+	CBanPrefixTree m_PrefixTree; // Entries with a prefix shorter than 128 bits.
+
+	std::ofstream m_JournalStream;
+	string        m_svJournalQueue;  // Records not yet appended by Save().
+	size_t        m_nQueuedRecords;
+	size_t        m_nJournalRecords; // Records in the journal on disk.
+	uint64_t      m_nGeneration;     // Of the snapshot the journal applies to.
+	std::thread   m_CompactThread;
 };
 
 extern CBanSystem* g_pBanSystem;
@@ -12,6 +12,34 @@
 #include <engine/server/server.h>
 #endif // !CLIENT_DLL
 
+//-----------------------------------------------------------------------------
+// Purpose: returns the given client, or a new one for this request only
+// Input  : *pClient - 
+//			&pLocalClient - owns the new client
+//-----------------------------------------------------------------------------
+static httplib::Client* Pylon_GetClient(httplib::Client* pClient, std::unique_ptr<httplib::Client>& pLocalClient)
+{
+    if (pClient)
+    {
+        return pClient;
+    }
+
+    pLocalClient = std::make_unique<httplib::Client>(pylon_matchmaking_hostname->GetString());
+    pLocalClient->set_connection_timeout(10);
+
+    return pLocalClient.get();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: 
+//-----------------------------------------------------------------------------
+CPylon::CPylon(void)
+    : m_pWorkerClient(nullptr)
+    , m_bWorkerRunning(false)
+    , m_bShutdown(false)
+{
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: returns a vector of hosted servers.
 //-----------------------------------------------------------------------------
@@ -231,9 +259,10 @@ bool CPylon::GetServerByToken(NetGameServer_t& slOutServer, string& svOutMessage
 // Input  : &svOutMessage - 
 //			&svOutToken - 
 //			&slServerListing - 
+//			*pClient - connection to reuse, if any
 // Output : Returns true on success, false on failure.
 //-----------------------------------------------------------------------------
-bool CPylon::PostServerHost(string& svOutMessage, string& svOutToken, const NetGameServer_t& slServerListing) const
+bool CPylon::PostServerHost(string& svOutMessage, string& svOutToken, const NetGameServer_t& slServerListing, httplib::Client* pClient) const
 {
     nlohmann::json jsRequestBody = nlohmann::json::object();
     jsRequestBody["name"] = slServerListing.m_svHostName;
@@ -258,8 +287,8 @@ bool CPylon::PostServerHost(string& svOutMessage, string& svOutToken, const NetG
         DevMsg(eDLL_T::ENGINE, "%s - Sending post host request to comp-server:\n%s\n", __FUNCTION__, svRequestBody.c_str());
     }
 
-    httplib::Client htClient(pylon_matchmaking_hostname->GetString()); htClient.set_connection_timeout(10);
-    httplib::Result htResult = htClient.Post("/servers/add", svRequestBody.c_str(), svRequestBody.length(), "application/json");
+    std::unique_ptr<httplib::Client> pLocalClient;
+    httplib::Result htResult = Pylon_GetClient(pClient, pLocalClient)->Post("/servers/add", svRequestBody.c_str(), svRequestBody.length(), "application/json");
 
     if (htResult && pylon_showdebuginfo->GetBool())
     {
@@ -339,9 +368,10 @@ bool CPylon::PostServerHost(string& svOutMessage, string& svOutToken, const NetG
 //-----------------------------------------------------------------------------
 // Purpose: Send keep alive request to Pylon Master Server.
 // Input  : &netGameServer - 
+//			*pClient - connection to reuse, if any
 // Output : Returns true on success, false otherwise.
 //-----------------------------------------------------------------------------
-bool CPylon::KeepAlive(const NetGameServer_t& netGameServer) const
+bool CPylon::KeepAlive(const NetGameServer_t& netGameServer, httplib::Client* pClient) const
 {
 #ifndef CLIENT_DLL
     if (g_pServer->IsActive() && sv_pylonVisibility->GetBool()) // Check for active game.
@@ -349,7 +379,7 @@ bool CPylon::KeepAlive(const NetGameServer_t& netGameServer) const
         string m_szHostToken;
         string m_szHostRequestMessage;
 
-        bool result = g_pMasterServer->PostServerHost(m_szHostRequestMessage, m_szHostToken, netGameServer);
+        bool result = g_pMasterServer->PostServerHost(m_szHostRequestMessage, m_szHostToken, netGameServer, pClient);
         return result;
     }
 #endif // !CLIENT_DLL
@@ -361,16 +391,19 @@ bool CPylon::KeepAlive(const NetGameServer_t& netGameServer) const
 // Input  : svIpAddress - 
 //			nNucleusID - 
 //			&svOutReason - 
+//			*pClient - connection to reuse, if any
 // Output : Returns true if banned, false if not banned.
 //-----------------------------------------------------------------------------
-bool CPylon::CheckForBan(const string& svIpAddress, const uint64_t nNucleusID, string& svOutReason) const
+bool CPylon::CheckForBan(const string& svIpAddress, const uint64_t nNucleusID, string& svOutReason, httplib::Client* pClient)
 {
     nlohmann::json jsRequestBody = nlohmann::json::object();
     jsRequestBody["id"] = nNucleusID;
     jsRequestBody["ip"] = svIpAddress;
 
-    httplib::Client htClient(pylon_matchmaking_hostname->GetString()); htClient.set_connection_timeout(10);
-    httplib::Result htResult = htClient.Post("/banlist/isBanned", jsRequestBody.dump(4).c_str(), jsRequestBody.dump(4).length(), "application/json");
+    string svRequestBody = jsRequestBody.dump(4);
+
+    std::unique_ptr<httplib::Client> pLocalClient;
+    httplib::Result htResult = Pylon_GetClient(pClient, pLocalClient)->Post("/banlist/isBanned", svRequestBody.c_str(), svRequestBody.length(), "application/json");
 
     try
     {
@@ -382,8 +415,13 @@ bool CPylon::CheckForBan(const string& svIpAddress, const uint64_t nNucleusID, s
                 if (jsResultBody["banned"].is_boolean() && jsResultBody["banned"].get<bool>())
                 {
                     svOutReason = jsResultBody.value("reason", "#DISCONNECT_BANNED");
+                    m_BanVerdictCache.Insert(svIpAddress, nNucleusID, true, svOutReason);
+
                     return true;
                 }
+
+                // Only cache clean verdicts the master server answered, not failed requests.
+                m_BanVerdictCache.Insert(svIpAddress, nNucleusID, false, "");
             }
         }
     }
@@ -393,5 +431,260 @@ bool CPylon::CheckForBan(const string& svIpAddress, const uint64_t nNucleusID, s
     }
     return false;
 }
+
+//-----------------------------------------------------------------------------
+// Purpose: gets the ban verdict of the last master server check on this
+//          NucleusID and address, if it hasn't expired yet
+// Input  : &svIpAddress - 
+//			nNucleusID - 
+//			&bOutBanned - 
+//			&svOutReason - 
+// Output : Returns true if a verdict was cached, false otherwise.
+//-----------------------------------------------------------------------------
+bool CPylon::GetCachedBanVerdict(const string& svIpAddress, const uint64_t nNucleusID, bool& bOutBanned, string& svOutReason)
+{
+    return m_BanVerdictCache.Lookup(svIpAddress, nNucleusID, bOutBanned, svOutReason);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: queues a request for the worker thread, which runs them in order
+//          over one persistent connection to the master server
+// Input  : &svKey - requests are merged into the one with the same key that
+//                   is queued or running, empty to always queue
+//			fnRequest - 
+//			bPriority - queue until PYLON_MAX_QUEUED_PRIORITY_REQUESTS are
+//			            queued rather than PYLON_MAX_QUEUED_REQUESTS
+// Output : Returns true if queued or merged, false if dropped.
+//-----------------------------------------------------------------------------
+bool CPylon::QueueRequest(const string& svKey, PylonRequest_t fnRequest, bool bPriority)
+{
+    std::lock_guard<std::mutex> l(m_Mutex);
+    if (m_bShutdown)
+    {
+        return false;
+    }
+
+    if (!svKey.empty() && m_PendingKeys.find(svKey) != m_PendingKeys.end())
+    {
+        return true;
+    }
+
+    if (m_vRequests.size() >= (bPriority ? PYLON_MAX_QUEUED_PRIORITY_REQUESTS : PYLON_MAX_QUEUED_REQUESTS))
+    {
+        Warning(eDLL_T::ENGINE, "%s - Request queue is full; dropped '%s'\n", __FUNCTION__, svKey.c_str());
+        return false;
+    }
+
+    if (!m_bWorkerRunning)
+    {
+        m_bWorkerRunning = true;
+
+        // Detached, Shutdown() is called from DllMain where waiting on a thread deadlocks.
+        std::thread(&CPylon::WorkerThread, this).detach();
+    }
+
+    if (!svKey.empty())
+    {
+        m_PendingKeys.insert(svKey);
+    }
+
+    m_vRequests.push_back(QueuedRequest_t{ svKey, std::move(fnRequest) });
+    m_Condition.notify_one();
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: aborts the request in progress, drops the queued ones and signals
+//          the worker thread to stop, without waiting for it
+//-----------------------------------------------------------------------------
+void CPylon::Shutdown(void)
+{
+    std::lock_guard<std::mutex> l(m_Mutex);
+
+    m_bShutdown = true;
+    m_vRequests.clear();
+
+    if (m_pWorkerClient)
+    {
+        m_pWorkerClient->stop();
+    }
+    m_Condition.notify_one();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: runs the queued requests, the connection is kept alive between
+//          them and only recreated when the master server hostname changes
+//-----------------------------------------------------------------------------
+void CPylon::WorkerThread(void)
+{
+    std::unique_ptr<httplib::Client> pClient;
+    string svHostName;
+
+    for (;;)
+    {
+        QueuedRequest_t request;
+        {
+            std::unique_lock<std::mutex> l(m_Mutex);
+            m_Condition.wait(l, [this] { return m_bShutdown || !m_vRequests.empty(); });
+
+            if (m_bShutdown)
+            {
+                m_pWorkerClient = nullptr;
+                return;
+            }
+
+            request = std::move(m_vRequests.front());
+            m_vRequests.erase(m_vRequests.begin());
+
+            const char* pszHostName = pylon_matchmaking_hostname->GetString();
+            if (!pClient || svHostName.compare(pszHostName) != NULL)
+            {
+                svHostName = pszHostName;
+
+                pClient = std::make_unique<httplib::Client>(svHostName.c_str());
+                pClient->set_connection_timeout(10);
+                pClient->set_keep_alive(true);
+            }
+            m_pWorkerClient = pClient.get();
+        }
+
+        request.m_fnRequest(*pClient);
+
+        std::lock_guard<std::mutex> l(m_Mutex);
+        m_pWorkerClient = nullptr;
+
+        if (!request.m_svKey.empty())
+        {
+            m_PendingKeys.erase(request.m_svKey);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: 
+//-----------------------------------------------------------------------------
+CBanVerdictCache::CBanVerdictCache(void)
+    : m_nHits(0)
+    , m_nMisses(0)
+    , m_nEvictions(0)
+    , m_nExpirations(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: gets a verdict and marks it as most recently used
+// Input  : &svIpAddress - 
+//			nNucleusID - 
+//			&bOutBanned - 
+//			&svOutReason - 
+// Output : Returns true on hit, false if missing or expired.
+//-----------------------------------------------------------------------------
+bool CBanVerdictCache::Lookup(const string& svIpAddress, const uint64_t nNucleusID, bool& bOutBanned, string& svOutReason)
+{
+    const string svKey = MakeKey(svIpAddress, nNucleusID);
+    const double flTime = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    std::lock_guard<std::mutex> l(m_Mutex);
+
+    auto it = m_mIndex.find(svKey);
+    if (it == m_mIndex.end())
+    {
+        m_nMisses++;
+        return false;
+    }
+
+    if (it->second->m_flExpireTime <= flTime)
+    {
+        m_Entries.erase(it->second);
+        m_mIndex.erase(it);
+
+        m_nExpirations++;
+        m_nMisses++;
+
+        return false;
+    }
+
+    m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+    m_nHits++;
+
+    bOutBanned = it->second->m_bBanned;
+    svOutReason = it->second->m_svReason;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: stores a verdict, evicting the least recently used ones if the
+//          cache is full
+// Input  : &svIpAddress - 
+//			nNucleusID - 
+//			bBanned - 
+//			&svReason - 
+//-----------------------------------------------------------------------------
+void CBanVerdictCache::Insert(const string& svIpAddress, const uint64_t nNucleusID, const bool bBanned, const string& svReason)
+{
+    const size_t nMaxEntries = static_cast<size_t>(std::max<int>(pylon_bancache_size->GetInt(), 0));
+    const float flTTL = bBanned
+        ? pylon_bancache_banned_ttl->GetFloat()
+        : pylon_bancache_clean_ttl->GetFloat();
+
+    std::lock_guard<std::mutex> l(m_Mutex);
+    const string svKey = MakeKey(svIpAddress, nNucleusID);
+
+    auto it = m_mIndex.find(svKey);
+    if (it != m_mIndex.end())
+    {
+        m_Entries.erase(it->second);
+        m_mIndex.erase(it);
+    }
+
+    if (!nMaxEntries || flTTL <= 0.f)
+    {
+        return;
+    }
+
+    while (m_Entries.size() >= nMaxEntries)
+    {
+        m_mIndex.erase(m_Entries.back().m_svKey);
+        m_Entries.pop_back();
+
+        m_nEvictions++;
+    }
+
+    const double flTime = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    m_Entries.push_front(Entry_t{ svKey, svReason, flTime + flTTL, bBanned });
+    m_mIndex.emplace(svKey, m_Entries.begin());
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: drops all verdicts, the counters are kept
+//-----------------------------------------------------------------------------
+void CBanVerdictCache::Clear(void)
+{
+    std::lock_guard<std::mutex> l(m_Mutex);
+
+    m_Entries.clear();
+    m_mIndex.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: 
+//-----------------------------------------------------------------------------
+BanVerdictCacheStats_t CBanVerdictCache::GetStats(void) const
+{
+    std::lock_guard<std::mutex> l(m_Mutex);
+    return BanVerdictCacheStats_t{ m_Entries.size(), m_nHits, m_nMisses, m_nEvictions, m_nExpirations };
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: 
+//-----------------------------------------------------------------------------
+string CBanVerdictCache::MakeKey(const string& svIpAddress, const uint64_t nNucleusID)
+{
+    return fmt::format("{:d}:{:s}", nNucleusID, svIpAddress);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 CPylon* g_pMasterServer(new CPylon());
@@ -1,13 +1,90 @@
 #pragma once
 #include "serverlisting.h"
 
+constexpr size_t PYLON_MAX_QUEUED_REQUESTS = 64; // Requests the worker holds before new ones are dropped.
+constexpr size_t PYLON_MAX_QUEUED_PRIORITY_REQUESTS = 1024; // Same for priority requests, keyed on client input so still bounded.
+
+typedef std::function<void(httplib::Client& htClient)> PylonRequest_t;
+
+struct BanVerdictCacheStats_t
+{
+	size_t m_nEntries;
+	size_t m_nHits;
+	size_t m_nMisses;
+	size_t m_nEvictions;  // Dropped to stay within pylon_bancache_size.
+	size_t m_nExpirations;
+};
+
+//-----------------------------------------------------------------------------
+// Bounded LRU cache of master server ban verdicts keyed on NucleusID and
+// address. Clean and banned verdicts expire after their own time to live.
+//-----------------------------------------------------------------------------
+class CBanVerdictCache
+{
+public:
+	CBanVerdictCache(void);
+
+	bool Lookup(const string& svIpAddress, const uint64_t nNucleusID, bool& bOutBanned, string& svOutReason);
+	void Insert(const string& svIpAddress, const uint64_t nNucleusID, const bool bBanned, const string& svReason);
+	void Clear(void);
+
+	BanVerdictCacheStats_t GetStats(void) const;
+
+private:
+	struct Entry_t
+	{
+		string m_svKey;
+		string m_svReason;
+		double m_flExpireTime;
+		bool   m_bBanned;
+	};
+
+	static string MakeKey(const string& svIpAddress, const uint64_t nNucleusID);
+
+	mutable std::mutex                                       m_Mutex;
+	std::list<Entry_t>                                       m_Entries; // Most recently used first.
+	std::unordered_map<string, std::list<Entry_t>::iterator> m_mIndex;
+
+	size_t m_nHits;
+	size_t m_nMisses;
+	size_t m_nEvictions;
+	size_t m_nExpirations;
+};
+
 class CPylon
 {
 public:
+	CPylon(void);
+
 	vector<NetGameServer_t> GetServerList(string& svOutMessage) const;
 	bool GetServerByToken(NetGameServer_t& slOutServer, string& svOutMessage, const string& svToken) const;
-	bool PostServerHost(string& svOutMessage, string& svOutToken, const NetGameServer_t& slServerListing) const;
-	bool KeepAlive(const NetGameServer_t& netGameServer) const;
-	bool CheckForBan(const string& svIpAddress, const uint64_t nNucleusID, string& svOutReason) const;
+	bool PostServerHost(string& svOutMessage, string& svOutToken, const NetGameServer_t& slServerListing, httplib::Client* pClient = nullptr) const;
+	bool KeepAlive(const NetGameServer_t& netGameServer, httplib::Client* pClient = nullptr) const;
+	bool CheckForBan(const string& svIpAddress, const uint64_t nNucleusID, string& svOutReason, httplib::Client* pClient = nullptr);
+	bool GetCachedBanVerdict(const string& svIpAddress, const uint64_t nNucleusID, bool& bOutBanned, string& svOutReason);
+
+	CBanVerdictCache& GetBanVerdictCache(void) { return m_BanVerdictCache; }
+
+	bool QueueRequest(const string& svKey, PylonRequest_t fnRequest, bool bPriority = false);
+	void Shutdown(void);
+
+private:
+	void WorkerThread(void);
+
+	struct QueuedRequest_t
+	{
+		string         m_svKey;
+		PylonRequest_t m_fnRequest;
+	};
+
+	std::mutex                   m_Mutex;
+	std::condition_variable      m_Condition;
+	vector<QueuedRequest_t>      m_vRequests;
+	std::set<string>             m_PendingKeys;    // Keys of queued and running requests.
+	httplib::Client*             m_pWorkerClient;  // Connection of the request in progress.
+	bool                         m_bWorkerRunning;
+	bool                         m_bShutdown;
+
+	CBanVerdictCache             m_BanVerdictCache;
 };
 extern CPylon* g_pMasterServer;
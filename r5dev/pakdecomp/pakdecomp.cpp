@@ -0,0 +1,288 @@
+//=====================================================================================//
+// 
+// Purpose: Standalone batch RPak decompressor.
+// 
+//=====================================================================================//
+
+#include "core/stdafx.h"
+#include "rtech/rtech_decomp.h"
+#include "mathlib/crc32.h"
+
+//-----------------------------------------------------------------------------
+// Purpose: prints the command line usage
+//-----------------------------------------------------------------------------
+static void PrintUsage(const char* pszProgram)
+{
+	std::cout << "Usage: " << pszProgram << " <input .rpak file or directory> <output directory> [options]" << std::endl;
+	std::cout << "  -threads <n> : number of worker threads (default: one per hardware thread)" << std::endl;
+	std::cout << "  -verify      : verify disk and decompressed sizes against the pak header" << std::endl;
+	std::cout << "  -crc         : print the crc32 of every decompressed pak" << std::endl;
+	std::cout << "Usage: " << pszProgram << " <input .rpak file or directory> -bench [iterations]" << std::endl;
+	std::cout << "  measures the throughput of the optimized and reference decoders in memory and verifies their output is identical" << std::endl;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: collects all compressed pak files from the input path
+// Input  : &fsInput - 
+//          &fsOutput - 
+// Output : decompression jobs
+//-----------------------------------------------------------------------------
+static vector<RPakDecompJob_t> GetJobs(const fs::path& fsInput, const fs::path& fsOutput)
+{
+	vector<RPakDecompJob_t> vJobs;
+	std::error_code ec;
+
+	if (fs::is_directory(fsInput, ec))
+	{
+		for (const fs::directory_entry& dirEntry : fs::directory_iterator(fsInput, ec))
+		{
+			if (dirEntry.is_regular_file(ec) && dirEntry.path().extension() == ".rpak")
+			{
+				RPakDecompJob_t job;
+				job.m_svPathIn = dirEntry.path().u8string();
+				job.m_svPathOut = (fsOutput / dirEntry.path().filename()).u8string();
+
+				vJobs.push_back(job);
+			}
+		}
+	}
+	else if (fs::is_regular_file(fsInput, ec))
+	{
+		RPakDecompJob_t job;
+		job.m_svPathIn = fsInput.u8string();
+		job.m_svPathOut = (fsOutput / fsInput.filename()).u8string();
+
+		vJobs.push_back(job);
+	}
+
+	// Decompress the largest paks first so one big pak doesn't end up running alone at the tail.
+	std::sort(vJobs.begin(), vJobs.end(), [](const RPakDecompJob_t& a, const RPakDecompJob_t& b)
+		{
+			std::error_code ec;
+			return fs::file_size(a.m_svPathIn, ec) > fs::file_size(b.m_svPathIn, ec);
+		});
+
+	return vJobs;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: decompresses the pak in memory and returns the fastest run
+// Input  : &vInput - 
+//          &vOutput - 
+//          nIterations - 
+//          nFlags - 
+//          &result - 
+// Output : best time in seconds, negative on failure
+//-----------------------------------------------------------------------------
+static double BenchDecoder(vector<uint8_t>& vInput, vector<uint8_t>& vOutput, int nIterations, int nFlags, RPakDecompResult_t& result)
+{
+	double flBest = -1.0;
+
+	for (int i = 0; i < nIterations; i++)
+	{
+		std::chrono::steady_clock::time_point tpStart = std::chrono::steady_clock::now();
+		const RPakDecompStatus_t nStatus = RTech_DecompressPak(vInput.data(), vInput.size() - RPAK_DECOMP_PADDING, vOutput.data(), vOutput.size(), result, nFlags);
+		const double flElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - tpStart).count();
+
+		if (nStatus != RPakDecompStatus_t::PAK_DECOMP_SUCCESS)
+			return -1.0;
+
+		if (flBest < 0.0 || flElapsed < flBest)
+			flBest = flElapsed;
+	}
+
+	return flBest;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: benchmarks the optimized decoder against the reference decoder
+// Input  : &vJobs - 
+//          nIterations - 
+// Output : number of paks that failed or whose outputs differ
+//-----------------------------------------------------------------------------
+static size_t RunBenchmark(const vector<RPakDecompJob_t>& vJobs, int nIterations)
+{
+	size_t nFailed = 0;
+	uint64_t nTotalOut = 0;
+	double flTotalFast = 0.0;
+	double flTotalRef = 0.0;
+
+	for (const RPakDecompJob_t& job : vJobs)
+	{
+		std::ifstream iStream(fs::u8path(job.m_svPathIn), std::ios::binary | std::ios::ate);
+		if (!iStream.is_open())
+		{
+			nFailed++;
+			std::cerr << "Failed '" << job.m_svPathIn << "': " << RPakDecompStatusToString.at(RPakDecompStatus_t::PAK_DECOMP_OPEN_FAILED) << std::endl;
+			continue;
+		}
+
+		const uint64_t nInputSize = static_cast<uint64_t>(iStream.tellg());
+		vector<uint8_t> vInput(nInputSize + RPAK_DECOMP_PADDING);
+
+		iStream.seekg(0, std::ios::beg);
+		iStream.read(reinterpret_cast<char*>(vInput.data()), nInputSize);
+		iStream.close();
+
+		RPakHeader_t header{};
+		const RPakDecompStatus_t nStatus = RTech_ReadPakHeader(vInput.data(), nInputSize, header, false);
+		if (nStatus == RPakDecompStatus_t::PAK_DECOMP_NOT_COMPRESSED)
+		{
+			std::cout << "Skipped '" << job.m_svPathIn << "' (not compressed)" << std::endl;
+			continue;
+		}
+		else if (nStatus != RPakDecompStatus_t::PAK_DECOMP_SUCCESS)
+		{
+			nFailed++;
+			std::cerr << "Failed '" << job.m_svPathIn << "': " << RPakDecompStatusToString.at(nStatus) << std::endl;
+			continue;
+		}
+
+		vector<uint8_t> vOutFast(header.m_nSizeMemory + RPAK_DECOMP_PADDING);
+		vector<uint8_t> vOutRef(header.m_nSizeMemory + RPAK_DECOMP_PADDING);
+
+		RPakDecompResult_t resFast;
+		RPakDecompResult_t resRef;
+
+		const double flFast = BenchDecoder(vInput, vOutFast, nIterations, 0, resFast);
+		const double flRef = BenchDecoder(vInput, vOutRef, nIterations, PAK_DECOMP_REFERENCE, resRef);
+
+		if (flFast < 0.0 || flRef < 0.0)
+		{
+			nFailed++;
+			std::cerr << "Failed '" << job.m_svPathIn << "': " << RPakDecompStatusToString.at(
+				flFast < 0.0 ? resFast.m_nStatus : resRef.m_nStatus) << std::endl;
+			continue;
+		}
+
+		// Both decoders must produce the exact same pak, byte for byte.
+		if (resFast.m_nDecompSize != resRef.m_nDecompSize || memcmp(vOutFast.data(), vOutRef.data(), resRef.m_nDecompSize) != 0)
+		{
+			nFailed++;
+			std::cerr << "Mismatch '" << job.m_svPathIn << "': optimized decoder output differs from the reference" << std::endl;
+			continue;
+		}
+
+		const double flMiB = resRef.m_nDecompSize / (1024.0 * 1024.0);
+
+		nTotalOut += resRef.m_nDecompSize;
+		flTotalFast += flFast;
+		flTotalRef += flRef;
+
+		std::cout << "Benchmarked '" << job.m_svPathIn << "' (" << resRef.m_nDecompSize << " bytes): optimized "
+			<< std::fixed << std::setprecision(1) << flMiB / flFast << " MiB/s, reference "
+			<< flMiB / flRef << " MiB/s (" << std::setprecision(2) << flRef / flFast << "x)" << std::endl;
+	}
+
+	if (flTotalFast > 0.0 && flTotalRef > 0.0)
+	{
+		const double flMiB = nTotalOut / (1024.0 * 1024.0);
+		std::cout << "Total " << std::fixed << std::setprecision(1) << flMiB << " MiB over " << nIterations << " iteration(s): optimized "
+			<< flMiB / flTotalFast << " MiB/s, reference " << flMiB / flTotalRef << " MiB/s ("
+			<< std::setprecision(2) << flTotalRef / flTotalFast << "x)" << std::endl;
+	}
+
+	return nFailed;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: entry point
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		PrintUsage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if (strcmp(argv[2], "-bench") == 0)
+	{
+		const int nIterations = argc > 3 ? std::max<int>(atoi(argv[3]), 1) : 5;
+
+		vector<RPakDecompJob_t> vJobs = GetJobs(fs::u8path(argv[1]), fs::path());
+		if (vJobs.empty())
+		{
+			std::cerr << "No pak files found in '" << argv[1] << "'" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		return RunBenchmark(vJobs, nIterations) ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+
+	int nThreads = 0;
+	int nFlags = 0;
+
+	for (int i = 3; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc)
+		{
+			nThreads = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-verify") == 0)
+		{
+			nFlags |= PAK_DECOMP_VERIFY_SIZE;
+		}
+		else if (strcmp(argv[i], "-crc") == 0)
+		{
+			nFlags |= PAK_DECOMP_COMPUTE_CRC;
+		}
+		else
+		{
+			PrintUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	vector<RPakDecompJob_t> vJobs = GetJobs(fs::u8path(argv[1]), fs::u8path(argv[2]));
+	if (vJobs.empty())
+	{
+		std::cerr << "No pak files found in '" << argv[1] << "'" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	size_t nFailed = 0;
+	size_t nSkipped = 0;
+	uint64_t nTotalOut = 0;
+
+	std::chrono::steady_clock::time_point tpStart = std::chrono::steady_clock::now();
+
+	RTech_DecompressPakBatch(vJobs, nThreads, nFlags, [&](const RPakDecompJob_t& job)
+		{
+			const RPakDecompResult_t& result = job.m_Result;
+			switch (result.m_nStatus)
+			{
+			case RPakDecompStatus_t::PAK_DECOMP_SUCCESS:
+			{
+				nTotalOut += result.m_nDecompSize;
+				std::cout << "Decompressed '" << job.m_svPathIn << "' (" << result.m_nInputSize << " -> " << result.m_nDecompSize << " bytes)";
+				if (nFlags & PAK_DECOMP_COMPUTE_CRC)
+				{
+					std::cout << " crc32: " << std::hex << std::uppercase << std::setw(8) << std::setfill('0') << result.m_nCrc32 << std::dec;
+				}
+				std::cout << std::endl;
+				break;
+			}
+			case RPakDecompStatus_t::PAK_DECOMP_NOT_COMPRESSED:
+			{
+				nSkipped++;
+				std::cout << "Skipped '" << job.m_svPathIn << "' (not compressed)" << std::endl;
+				break;
+			}
+			default:
+			{
+				nFailed++;
+				std::cerr << "Failed '" << job.m_svPathIn << "': " << RPakDecompStatusToString.at(result.m_nStatus) << std::endl;
+				break;
+			}
+			}
+		});
+
+	const double flElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - tpStart).count();
+
+	std::cout << "Processed " << vJobs.size() << " pak(s) in " << std::fixed << std::setprecision(3) << flElapsed << " seconds ("
+		<< (vJobs.size() - nFailed - nSkipped) << " decompressed, " << nSkipped << " skipped, " << nFailed << " failed, "
+		<< (flElapsed > 0.0 ? (nTotalOut / (1024.0 * 1024.0)) / flElapsed : 0.0) << " MiB/s)" << std::endl;
+
+	return nFailed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
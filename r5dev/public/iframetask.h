@@ -3,12 +3,18 @@
 
 struct ScheduledTasks_s
 {
-    int m_nDelayedFrames;
+    ScheduledTasks_s* m_pNext;
+    int m_nDelayedFrames;      // Frames to wait, or -1 if 'm_flDueTime' is used.
+    uint64_t m_nDueFrame;
+    double m_flDueTime;        // Seconds on the steady clock.
     std::function<void()> m_rFunctor;
     ScheduledTasks_s(int frames, std::function<void()> functor)
     {
+        m_pNext = nullptr;
         m_nDelayedFrames = frames;
-        m_rFunctor = functor;
+        m_nDueFrame = 0;
+        m_flDueTime = 0.0;
+        m_rFunctor = std::move(functor);
     }
 };
 
@@ -0,0 +1,172 @@
+#pragma once
+
+constexpr uint32_t BENCH_RANDOM_SEED  = 1337; // Inputs are generated from this so every run measures the same data.
+constexpr size_t   BENCH_MAX_REPORTED = 8;    // Mismatches described in full, the rest are only counted.
+
+typedef std::function<void(bool bWarning, const char* pszLine)> BenchPrintFn_t;
+
+//-----------------------------------------------------------------------------
+// One implementation of a routine, compared by CBenchmark::CompareKernels().
+//-----------------------------------------------------------------------------
+struct BenchKernel_t
+{
+	const char*               m_pszName;
+	std::function<uint64_t()> m_fnRun;      // Runs the kernel once and returns its result.
+	bool                      m_bSupported; // False if the processor lacks its instructions.
+};
+
+//-----------------------------------------------------------------------------
+// Harness for the benchmarks that time an optimized routine and verify its
+// results against a simpler reference. Output goes through the print
+// callback so the same benchmark runs from the console and from the tools.
+//-----------------------------------------------------------------------------
+class CBenchmark
+{
+public:
+	CBenchmark(BenchPrintFn_t fnPrint)
+		: m_fnPrint(std::move(fnPrint))
+		, m_nChecked(0)
+		, m_nMismatches(0)
+	{
+	}
+
+	//-----------------------------------------------------------------------------
+	// Purpose: prints a line of the results
+	//-----------------------------------------------------------------------------
+	void Msg(const char* pszFormat, ...)
+	{
+		va_list args;
+		va_start(args, pszFormat);
+		PrintV(false, pszFormat, args);
+		va_end(args);
+	}
+
+	//-----------------------------------------------------------------------------
+	// Purpose: prints a line about a failure that isn't a mismatch
+	//-----------------------------------------------------------------------------
+	void Warn(const char* pszFormat, ...)
+	{
+		va_list args;
+		va_start(args, pszFormat);
+		PrintV(true, pszFormat, args);
+		va_end(args);
+	}
+
+	//-----------------------------------------------------------------------------
+	// Purpose: counts a result checked against the reference, the first
+	//          BENCH_MAX_REPORTED mismatches are described
+	// Input  : bMatch - 
+	//          *pszFormat - describes the mismatch, only formatted when printed
+	// Output : bMatch
+	//-----------------------------------------------------------------------------
+	bool Verify(bool bMatch, const char* pszFormat, ...)
+	{
+		m_nChecked++;
+		if (bMatch)
+			return true;
+
+		if (m_nMismatches++ < BENCH_MAX_REPORTED)
+		{
+			va_list args;
+			va_start(args, pszFormat);
+			PrintV(true, pszFormat, args);
+			va_end(args);
+		}
+		return false;
+	}
+
+	//-----------------------------------------------------------------------------
+	// Purpose: prints how many of the verified results match the reference
+	// Input  : *pszResults - what was verified, e.g. "lookups"
+	//          *pszReference - what it was verified against
+	// Output : true if every result matched
+	//-----------------------------------------------------------------------------
+	bool Summarize(const char* pszResults, const char* pszReference)
+	{
+		if (m_nMismatches)
+			Warn("'%zu' of '%zu' %s disagree with %s", m_nMismatches, m_nChecked, pszResults, pszReference);
+		else
+			Msg("All '%zu' %s agree with %s", m_nChecked, pszResults, pszReference);
+
+		return !m_nMismatches;
+	}
+
+	//-----------------------------------------------------------------------------
+	// Purpose: times kernels that compute the same value from the same input
+	//          and verifies each against the first, which is the reference
+	// Input  : *pKernels - 
+	//          nKernels - 
+	//          nIterations - the fastest run of each kernel is reported
+	//          flBytes - bytes processed per run
+	//          *pszInput - describes the input
+	//-----------------------------------------------------------------------------
+	void CompareKernels(const BenchKernel_t* pKernels, size_t nKernels, int nIterations, double flBytes, const char* pszInput)
+	{
+		uint64_t nExpected = 0;
+
+		for (size_t i = 0; i < nKernels; i++)
+		{
+			const BenchKernel_t& kernel = pKernels[i];
+			if (!kernel.m_bSupported)
+			{
+				Msg("%-16s %s: not supported by this processor", kernel.m_pszName, pszInput);
+				continue;
+			}
+
+			uint64_t nResult = 0;
+			const double flBest = TimeBest(nIterations, [&](int) { nResult = kernel.m_fnRun(); });
+
+			if (i == 0)
+				nExpected = nResult;
+
+			Verify(nResult == nExpected, "%-16s %s: '%08llX' instead of '%08llX'", kernel.m_pszName, pszInput, nResult, nExpected);
+			Msg("%-16s %s: %6.2f GB/s (%08llX)", kernel.m_pszName, pszInput, flBest > 0.0 ? flBytes / flBest / 1e9 : 0.0, nResult);
+		}
+	}
+
+	size_t GetChecked(void) const { return m_nChecked; }
+	size_t GetMismatches(void) const { return m_nMismatches; }
+
+	//-----------------------------------------------------------------------------
+	// Purpose: runs the callback once
+	// Output : elapsed time in seconds
+	//-----------------------------------------------------------------------------
+	template <typename BenchFn>
+	static double Time(BenchFn&& fnBench)
+	{
+		const std::chrono::steady_clock::time_point tpStart = std::chrono::steady_clock::now();
+		fnBench();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - tpStart).count();
+	}
+
+	//-----------------------------------------------------------------------------
+	// Purpose: runs the callback a number of times
+	// Input  : nIterations - 
+	//          fnBench - void(int nIteration)
+	// Output : fastest run in seconds
+	//-----------------------------------------------------------------------------
+	template <typename BenchFn>
+	static double TimeBest(int nIterations, BenchFn&& fnBench)
+	{
+		double flBest = -1.0;
+		for (int i = 0; i < nIterations; i++)
+		{
+			const double flElapsed = Time([&]() { fnBench(i); });
+			if (flBest < 0.0 || flElapsed < flBest)
+				flBest = flElapsed;
+		}
+		return flBest;
+	}
+
+private:
+	void PrintV(bool bWarning, const char* pszFormat, va_list args)
+	{
+		char szLine[1024];
+		vsnprintf(szLine, sizeof(szLine), pszFormat, args);
+		m_fnPrint(bWarning, szLine);
+	}
+
+	BenchPrintFn_t m_fnPrint;
+	size_t         m_nChecked;    // Results verified against the reference.
+	size_t         m_nMismatches; // Of which didn't match.
+};
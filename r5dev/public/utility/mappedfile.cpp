@@ -0,0 +1,195 @@
+#include "core/stdafx.h"
+#include "public/utility/mappedfile.h"
+
+//-----------------------------------------------------------------------------
+// Purpose: CMappedFile constructors
+//-----------------------------------------------------------------------------
+CMappedFile::CMappedFile()
+	: m_hFile(INVALID_HANDLE_VALUE)
+	, m_hMapping(NULL)
+	, m_pData(nullptr)
+	, m_nSize(0)
+	, m_bWritable(false)
+{
+}
+CMappedFile::CMappedFile(const fs::path& fsFilePath)
+	: CMappedFile()
+{
+	Open(fsFilePath);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: CMappedFile destructor
+//-----------------------------------------------------------------------------
+CMappedFile::~CMappedFile()
+{
+	Close();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: maps the file into memory for reading
+// Input  : &fsFilePath - 
+// Output : true if operation is successful
+//-----------------------------------------------------------------------------
+bool CMappedFile::Open(const fs::path& fsFilePath)
+{
+	Close();
+
+	m_hFile = CreateFileW(fsFilePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (m_hFile == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER liFileSize;
+	if (!GetFileSizeEx(m_hFile, &liFileSize) || liFileSize.QuadPart == 0)
+	{
+		Close(); // Empty files can't be mapped.
+		return false;
+	}
+
+	m_hMapping = CreateFileMappingW(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!m_hMapping)
+	{
+		Close();
+		return false;
+	}
+
+	m_pData = reinterpret_cast<uint8_t*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+	if (!m_pData)
+	{
+		Close();
+		return false;
+	}
+
+	m_nSize = static_cast<size_t>(liFileSize.QuadPart);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: creates (or truncates) the file and maps it into memory for writing
+// Input  : &fsFilePath - 
+//          nSize - 
+// Output : true if operation is successful
+//-----------------------------------------------------------------------------
+bool CMappedFile::Create(const fs::path& fsFilePath, size_t nSize)
+{
+	Close();
+
+	if (!nSize)
+	{
+		return false; // Empty files can't be mapped.
+	}
+
+	m_hFile = CreateFileW(fsFilePath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (m_hFile == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER liFileSize;
+	liFileSize.QuadPart = static_cast<LONGLONG>(nSize);
+
+	m_hMapping = CreateFileMappingW(m_hFile, NULL, PAGE_READWRITE, liFileSize.HighPart, liFileSize.LowPart, NULL);
+	if (!m_hMapping)
+	{
+		Close();
+		return false;
+	}
+
+	m_pData = reinterpret_cast<uint8_t*>(MapViewOfFile(m_hMapping, FILE_MAP_WRITE, 0, 0, 0));
+	if (!m_pData)
+	{
+		Close();
+		return false;
+	}
+
+	m_nSize = nSize;
+	m_bWritable = true;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: unmaps a writable view, truncates the file to its final size 
+//          and closes all handles
+// Input  : nFileSize - 
+// Output : true if operation is successful
+//-----------------------------------------------------------------------------
+bool CMappedFile::Commit(size_t nFileSize)
+{
+	if (!m_bWritable || nFileSize > m_nSize)
+	{
+		Close();
+		return false;
+	}
+
+	UnmapViewOfFile(m_pData);
+	m_pData = nullptr;
+
+	CloseHandle(m_hMapping);
+	m_hMapping = NULL;
+
+	LARGE_INTEGER liFileSize;
+	liFileSize.QuadPart = static_cast<LONGLONG>(nFileSize);
+
+	const bool bResult = SetFilePointerEx(m_hFile, liFileSize, NULL, FILE_BEGIN) && SetEndOfFile(m_hFile);
+	Close();
+
+	return bResult;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: unmaps the view and closes all handles
+//-----------------------------------------------------------------------------
+void CMappedFile::Close()
+{
+	if (m_pData)
+	{
+		UnmapViewOfFile(m_pData);
+		m_pData = nullptr;
+	}
+	if (m_hMapping)
+	{
+		CloseHandle(m_hMapping);
+		m_hMapping = NULL;
+	}
+	if (m_hFile != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_hFile);
+		m_hFile = INVALID_HANDLE_VALUE;
+	}
+	m_nSize = 0;
+	m_bWritable = false;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: returns the mapped data
+//-----------------------------------------------------------------------------
+const uint8_t* CMappedFile::GetData() const
+{
+	return m_pData;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: returns the mapped data for writing (nullptr if mapped read-only)
+//-----------------------------------------------------------------------------
+uint8_t* CMappedFile::GetWritableData() const
+{
+	return m_bWritable ? m_pData : nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: returns the mapped data size
+//-----------------------------------------------------------------------------
+size_t CMappedFile::GetSize() const
+{
+	return m_nSize;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: checks if the file is mapped
+//-----------------------------------------------------------------------------
+bool CMappedFile::IsOpen() const
+{
+	return m_pData != nullptr;
+}
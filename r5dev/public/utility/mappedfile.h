@@ -0,0 +1,33 @@
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Memory mapped view of a file on disk
+//-----------------------------------------------------------------------------
+class CMappedFile
+{
+public:
+	CMappedFile();
+	CMappedFile(const fs::path& fsFilePath);
+	~CMappedFile();
+
+	CMappedFile(const CMappedFile&) = delete;
+	CMappedFile& operator=(const CMappedFile&) = delete;
+
+	bool Open(const fs::path& fsFilePath);
+	bool Create(const fs::path& fsFilePath, size_t nSize);
+	bool Commit(size_t nFileSize);
+	void Close();
+
+	const uint8_t* GetData() const;
+	uint8_t* GetWritableData() const;
+	size_t GetSize() const;
+
+	bool IsOpen() const;
+
+private:
+	HANDLE          m_hFile;    // File handle.
+	HANDLE          m_hMapping; // File mapping handle.
+	uint8_t*        m_pData;    // Mapped view base.
+	size_t          m_nSize;    // Mapped view size.
+	bool            m_bWritable; // Whether the view was created for writing.
+};
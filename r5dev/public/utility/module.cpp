@@ -6,6 +6,7 @@
 #include "core/stdafx.h"
 #include "public/utility/utility.h"
 #include "public/utility/memaddr.h"
+#include "public/utility/sigscan.h"
 
 //-----------------------------------------------------------------------------
 // Purpose: constructor
@@ -55,6 +56,12 @@ CMemory CModule::FindPatternSIMD(const uint8_t* szPattern, const char* szMask, c
 		nSize = static_cast<uint64_t>(moduleSection.m_nSectionSize);
 	}
 
+	uintptr_t nBatchResult;
+	if (nOccurrence == 0 && g_SigBatch.Find(static_cast<uintptr_t>(nBase), static_cast<size_t>(nSize), szPattern, szMask, nBatchResult))
+	{
+		return CMemory(nBatchResult); // Collected or already resolved by DetourInit().
+	}
+
 	const uint8_t* pData = reinterpret_cast<uint8_t*>(nBase);
 	const uint8_t* pEnd = pData + static_cast<uint32_t>(nSize) - strlen(szMask);
 
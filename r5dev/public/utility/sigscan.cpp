@@ -0,0 +1,838 @@
+//===========================================================================//
+//
+// Purpose: Batched multi-signature scanner.
+//
+//===========================================================================//
+#include "core/stdafx.h"
+#include "public/utility/benchmark.h"
+#include "public/utility/binstream.h"
+#include "public/utility/sigscan.h"
+
+// Don't bother splitting buffers smaller than this across threads.
+#define SIGSCAN_MIN_SLICE_SIZE 0x100000
+
+// Result keys start with the base and size of the region, cache keys don't.
+#define SIGBATCH_REGION_KEY_SIZE (sizeof(uintptr_t) + sizeof(size_t))
+
+CSigBatch g_SigBatch;
+
+//-----------------------------------------------------------------------------
+// Purpose: adds a masked signature to the scanner
+// Input  : *pPattern -
+//          *szMask -
+// Output : index of the pattern, used to query the result after a scan
+// Note   : like CModule::FindPatternSIMD, the first byte is always compared
+//          even if its mask character is a wildcard.
+//-----------------------------------------------------------------------------
+size_t CSigScanner::AddPattern(const uint8_t* pPattern, const char* szMask)
+{
+	Pattern_t pattern;
+	pattern.m_nLength = strlen(szMask);
+	pattern.m_bResolved = false;
+
+	const size_t nChunks = (pattern.m_nLength + 15) / 16;
+
+	pattern.m_vBytes.assign(nChunks * 16, 0);
+	pattern.m_vMasks.assign(nChunks, 0);
+
+	for (size_t i = 0; i < pattern.m_nLength; i++)
+	{
+		pattern.m_vBytes[i] = pPattern[i];
+
+		if (i == 0 || szMask[i] == 'x')
+		{
+			pattern.m_vMasks[i / 16] |= static_cast<uint16_t>(1 << (i % 16));
+		}
+	}
+
+	// Anchor on the first two adjacent bytes that have to match; the leading
+	// bytes of a signature are often wildcards or very common opcodes.
+	pattern.m_nAnchor = SIZE_MAX;
+	for (size_t i = 0; i + 1 < pattern.m_nLength; i++)
+	{
+		if ((pattern.m_vMasks[i / 16] & (1 << (i % 16))) && (pattern.m_vMasks[(i + 1) / 16] & (1 << ((i + 1) % 16))))
+		{
+			pattern.m_nAnchor = i;
+			break;
+		}
+	}
+
+	m_vPatterns.push_back(std::move(pattern));
+	m_vResults.push_back(nullptr);
+
+	return m_vPatterns.size() - 1;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: scans the buffer for all added patterns that aren't resolved yet
+// Input  : *pData -
+//          nSize -
+//          nThreads - number of slices to scan in parallel (0 = all cores),
+//                     slices past the first run on threads that are joined
+//-----------------------------------------------------------------------------
+void CSigScanner::Scan(const uint8_t* pData, size_t nSize, size_t nThreads)
+{
+	const size_t nPatterns = m_vPatterns.size();
+	const size_t nUnresolved = std::count_if(m_vPatterns.begin(), m_vPatterns.end(),
+		[](const Pattern_t& pattern) { return !pattern.m_bResolved; });
+
+	if (!nUnresolved || nSize < 2)
+		return;
+
+	BuildDispatch();
+
+	if (!nThreads)
+	{
+		nThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	}
+	nThreads = std::min<size_t>(nThreads, std::max<size_t>(nSize / SIGSCAN_MIN_SLICE_SIZE, 1));
+
+	// First match of every pattern within each slice, slices are in address order.
+	vector<vector<size_t>> vFirst(nThreads, vector<size_t>(nPatterns, SIZE_MAX));
+	const size_t nSliceSize = (nSize + nThreads - 1) / nThreads;
+
+	if (nThreads == 1)
+	{
+		ScanRange(pData, nSize, 0, nSize, vFirst[0]);
+	}
+	else
+	{
+		vector<std::thread> vThreads;
+		vThreads.reserve(nThreads);
+
+		for (size_t t = 0; t < nThreads; t++)
+		{
+			const size_t nBegin = t * nSliceSize;
+			const size_t nEnd = std::min<size_t>(nBegin + nSliceSize, nSize);
+
+			vThreads.emplace_back([this, pData, nSize, nBegin, nEnd, &vFirst, t]()
+				{
+					ScanRange(pData, nSize, nBegin, nEnd, vFirst[t]);
+				});
+		}
+		for (std::thread& thread : vThreads)
+		{
+			thread.join();
+		}
+	}
+
+	for (size_t i = 0; i < nPatterns; i++)
+	{
+		if (m_vPatterns[i].m_bResolved)
+			continue;
+
+		for (size_t t = 0; t < nThreads; t++)
+		{
+			if (vFirst[t][i] != SIZE_MAX)
+			{
+				m_vResults[i] = pData + vFirst[t][i];
+				break;
+			}
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: checks whether a pattern matches at the given offset
+// Input  : nIndex -
+//          *pData -
+//          nSize -
+//          nOffset -
+// Output : true if it matches and lies within the bounds a scan would accept
+//-----------------------------------------------------------------------------
+bool CSigScanner::IsMatch(size_t nIndex, const uint8_t* pData, size_t nSize, size_t nOffset) const
+{
+	const Pattern_t& pattern = m_vPatterns[nIndex];
+
+	if (!pattern.m_nLength || nOffset >= nSize || nOffset + pattern.m_nLength >= nSize)
+		return false;
+
+	return Compare(pattern, pData + nOffset, nSize - nOffset);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: sets the result of a pattern from elsewhere, Scan() skips it
+// Input  : nIndex -
+//          *pResult -
+//-----------------------------------------------------------------------------
+void CSigScanner::SetResult(size_t nIndex, const uint8_t* pResult)
+{
+	m_vPatterns[nIndex].m_bResolved = true;
+	m_vResults[nIndex] = pResult;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: removes all patterns and results
+//-----------------------------------------------------------------------------
+void CSigScanner::Clear(void)
+{
+	m_vPatterns.clear();
+	m_vResults.clear();
+	m_vPairBits.clear();
+	m_vPairStart.clear();
+	m_vPairItems.clear();
+	m_vByteStart.clear();
+	m_vByteItems.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: buckets all patterns by the bytes at their anchor
+//-----------------------------------------------------------------------------
+void CSigScanner::BuildDispatch(void)
+{
+	m_vPairBits.assign(0x10000 / 64, 0);
+	m_vPairStart.assign(0x10000 + 1, 0);
+	m_vByteStart.assign(0x100 + 1, 0);
+	m_nMaxAnchor = 0;
+
+	vector<Candidate_t> vCandidates;
+	vCandidates.reserve(m_vPatterns.size());
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(m_vPatterns.size()); i++)
+	{
+		const Pattern_t& pattern = m_vPatterns[i];
+		if (!pattern.m_nLength || pattern.m_bResolved)
+			continue;
+
+		Candidate_t candidate{ i, static_cast<uint32_t>(pattern.m_nAnchor == SIZE_MAX ? 0 : pattern.m_nAnchor), 0, 0 };
+		for (size_t j = 0; j < 4 && candidate.m_nAnchor + j < pattern.m_nLength; j++)
+		{
+			const size_t k = candidate.m_nAnchor + j;
+			if (pattern.m_vMasks[k / 16] & (1 << (k % 16)))
+			{
+				candidate.m_nValue |= uint32_t(pattern.m_vBytes[k]) << (j * 8);
+				candidate.m_nMask |= 0xFFu << (j * 8);
+			}
+		}
+
+		m_nMaxAnchor = std::max<size_t>(m_nMaxAnchor, candidate.m_nAnchor);
+		vCandidates.push_back(candidate);
+
+		if (pattern.m_nAnchor != SIZE_MAX)
+		{
+			const uint32_t nPair = candidate.m_nValue & 0xFFFF;
+			m_vPairBits[nPair / 64] |= 1ull << (nPair % 64);
+			m_vPairStart[nPair + 1]++;
+		}
+		else
+			m_vByteStart[(candidate.m_nValue & 0xFF) + 1]++;
+	}
+
+	// Prefix sum, then fill; keeps every bucket contiguous.
+	for (size_t i = 1; i < m_vPairStart.size(); i++)
+		m_vPairStart[i] += m_vPairStart[i - 1];
+	for (size_t i = 1; i < m_vByteStart.size(); i++)
+		m_vByteStart[i] += m_vByteStart[i - 1];
+
+	m_vPairItems.resize(m_vPairStart.back());
+	m_vByteItems.resize(m_vByteStart.back());
+
+	vector<uint32_t> vPairFill(m_vPairStart.begin(), m_vPairStart.end() - 1);
+	vector<uint32_t> vByteFill(m_vByteStart.begin(), m_vByteStart.end() - 1);
+
+	for (const Candidate_t& candidate : vCandidates)
+	{
+		if (m_vPatterns[candidate.m_nIndex].m_nAnchor != SIZE_MAX)
+			m_vPairItems[vPairFill[candidate.m_nValue & 0xFFFF]++] = candidate;
+		else
+			m_vByteItems[vByteFill[candidate.m_nValue & 0xFF]++] = candidate;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: finds the first match of every pattern starting in [nBegin, nEnd)
+// Input  : *pData -
+//          nSize -
+//          nBegin -
+//          nEnd -
+//          &vFirst -
+//-----------------------------------------------------------------------------
+void CSigScanner::ScanRange(const uint8_t* pData, size_t nSize, size_t nBegin, size_t nEnd, vector<size_t>& vFirst) const
+{
+	size_t nRemaining = m_vPairItems.size() + m_vByteItems.size();
+
+	// Anchors lie after the start of their match, so keep going past the end
+	// of the range. Matches have to end before the last byte of the buffer
+	// (see CModule::FindPatternSIMD), so every anchor has a byte after it.
+	const size_t nLast = std::min<size_t>(nEnd + m_nMaxAnchor, nSize - 1);
+	const bool bHasBytes = !m_vByteItems.empty();
+
+	for (size_t i = nBegin; i < nLast; i++)
+	{
+		const uint8_t* pCurrent = pData + i;
+		const bool bHasDword = (i + 4 <= nSize);
+		const uint32_t nDword = bHasDword
+			? *reinterpret_cast<const uint32_t*>(pCurrent)
+			: uint32_t(pCurrent[0]) | (uint32_t(pCurrent[1]) << 8);
+
+		// Most positions don't start any bucket; the bitmap stays in L1.
+		const uint32_t nPair = nDword & 0xFFFF;
+		if (m_vPairBits[nPair / 64] & (1ull << (nPair % 64)))
+		{
+			if (TestBucket(m_vPairItems, m_vPairStart[nPair], m_vPairStart[nPair + 1], pData, nSize, i, nBegin, nEnd, nDword, bHasDword, vFirst, nRemaining))
+				return;
+		}
+		if (bHasBytes)
+		{
+			const uint32_t nByte = nDword & 0xFF;
+			if (TestBucket(m_vByteItems, m_vByteStart[nByte], m_vByteStart[nByte + 1], pData, nSize, i, nBegin, nEnd, nDword, bHasDword, vFirst, nRemaining))
+				return;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: tests all candidates of a bucket at the given anchor position
+// Output : true once every pattern has been found
+//-----------------------------------------------------------------------------
+bool CSigScanner::TestBucket(const vector<Candidate_t>& vItems, uint32_t nFirst, uint32_t nLast, const uint8_t* pData, size_t nSize,
+	size_t nPosition, size_t nBegin, size_t nEnd, uint32_t nDword, bool bHasDword, vector<size_t>& vFirst, size_t& nRemaining) const
+{
+	for (uint32_t k = nFirst; k < nLast; k++)
+	{
+		const Candidate_t& candidate = vItems[k];
+
+		if (bHasDword && (nDword & candidate.m_nMask) != candidate.m_nValue)
+			continue;
+		if (vFirst[candidate.m_nIndex] != SIZE_MAX || nPosition < nBegin + candidate.m_nAnchor)
+			continue;
+
+		const size_t nStart = nPosition - candidate.m_nAnchor;
+		const Pattern_t& pattern = m_vPatterns[candidate.m_nIndex];
+
+		if (nStart >= nEnd || nStart + pattern.m_nLength >= nSize)
+			continue;
+
+		if (Compare(pattern, pData + nStart, nSize - nStart))
+		{
+			vFirst[candidate.m_nIndex] = nStart;
+
+			if (--nRemaining == 0)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: masked compare of a pattern against the data
+// Input  : &pattern -
+//          *pData -
+//          nAvailable - number of readable bytes at pData
+// Output : true if the pattern matches
+//-----------------------------------------------------------------------------
+bool CSigScanner::Compare(const Pattern_t& pattern, const uint8_t* pData, size_t nAvailable) const
+{
+	const size_t nChunks = pattern.m_vMasks.size();
+
+	if (nAvailable >= nChunks * 16)
+	{
+		for (size_t i = 0; i < nChunks; i++)
+		{
+			const __m128i xmmData = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + i * 16));
+			const __m128i xmmPattern = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern.m_vBytes.data() + i * 16));
+			const int nMask = pattern.m_vMasks[i];
+
+			if ((_mm_movemask_epi8(_mm_cmpeq_epi8(xmmData, xmmPattern)) & nMask) != nMask)
+				return false;
+		}
+		return true;
+	}
+
+	// Too close to the end of the buffer for full 16 byte loads.
+	for (size_t i = 0; i < pattern.m_nLength; i++)
+	{
+		if ((pattern.m_vMasks[i / 16] & (1 << (i % 16))) && pData[i] != pattern.m_vBytes[i])
+			return false;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: reference scan, the first offset the masked signature matches at
+// Input  : *pData -
+//          nSize -
+//          &vPattern -
+//          &svMask -
+// Output : offset of the match, SIZE_MAX if none
+//-----------------------------------------------------------------------------
+static size_t SigScan_FindLinear(const uint8_t* pData, size_t nSize, const vector<uint8_t>& vPattern, const string& svMask)
+{
+	const size_t nLength = svMask.size();
+
+	// Like CModule::FindPatternSIMD, a match has to end before the last byte.
+	for (size_t i = 0; i + nLength < nSize; i++)
+	{
+		size_t j = 0;
+		for (; j < nLength; j++)
+		{
+			if ((j == 0 || svMask[j] == 'x') && pData[i + j] != vPattern[j])
+				break;
+		}
+		if (j == nLength)
+			return i;
+	}
+
+	return SIZE_MAX;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: samples signatures from a code section, times the scanner on one
+//          and on all threads and verifies every result against a per
+//          signature linear scan
+// Input  : &bench -
+//          *pData - code to sample and scan
+//          nSize -
+//          nSignatures -
+//          nIterations -
+// Output : true if every signature matched
+//-----------------------------------------------------------------------------
+bool CSigScanner::Benchmark(CBenchmark& bench, const uint8_t* pData, size_t nSize, size_t nSignatures, int nIterations)
+{
+	if (nSize < 64)
+	{
+		bench.Warn("Code section of '%zu' bytes is too small to sample signatures from", nSize);
+		return false;
+	}
+
+	// Sample signatures the way they are written by hand: a few leading opcode
+	// bytes that always match, followed by wildcarded 4 byte displacements.
+	std::mt19937 rng(BENCH_RANDOM_SEED);
+	vector<vector<uint8_t>> vPatterns(nSignatures);
+	vector<string> vMasks(nSignatures);
+
+	for (size_t i = 0; i < nSignatures; i++)
+	{
+		const size_t nLength = 12 + rng() % 37;
+		const size_t nOffset = rng() % (nSize - nLength - 1);
+
+		vPatterns[i].assign(pData + nOffset, pData + nOffset + nLength);
+		vMasks[i].assign(nLength, 'x');
+
+		for (size_t j = 4; j + 4 <= nLength; j += 4)
+		{
+			if (rng() % 4 == 0)
+				vMasks[i].replace(j, 4, 4, '?');
+		}
+	}
+
+	CSigScanner scanner; // Results of the first multi-threaded run, verified below.
+	double flBatchTime[2]; // One thread, all threads.
+
+	for (size_t nThreads : { size_t(1), size_t(0) })
+	{
+		flBatchTime[nThreads == 0] = CBenchmark::TimeBest(nIterations, [&](int nIteration)
+			{
+				// Results are kept until Clear(), so rebuild the scanner every run.
+				CSigScanner runScanner;
+				for (size_t k = 0; k < nSignatures; k++)
+				{
+					runScanner.AddPattern(vPatterns[k].data(), vMasks[k].c_str());
+				}
+				runScanner.Scan(pData, nSize, nThreads);
+
+				if (nIteration == 0 && nThreads == 0)
+					scanner = std::move(runScanner);
+			});
+	}
+
+	size_t nFound = 0;
+	const double flLinearTime = CBenchmark::Time([&]()
+		{
+			for (size_t i = 0; i < nSignatures; i++)
+			{
+				const size_t nExpected = SigScan_FindLinear(pData, nSize, vPatterns[i], vMasks[i]);
+				const uint8_t* pResult = scanner.GetResult(i);
+				const size_t nActual = pResult ? size_t(pResult - pData) : SIZE_MAX;
+
+				if (nExpected != SIZE_MAX)
+					nFound++;
+
+				bench.Verify(nExpected == nActual, "Signature '%zu' '%s': linear '0x%zX', batched '0x%zX'", i, vMasks[i].c_str(), nExpected, nActual);
+			}
+		});
+
+	bench.Msg("Scanned '%zu' signature(s) over '%.1f' MiB ('%zu' found): linear '%.3f' seconds, batched '%.3f' seconds on one thread, '%.3f' seconds on all threads (%.1fx)",
+		nSignatures, nSize / (1024.0 * 1024.0), nFound, flLinearTime, flBatchTime[0], flBatchTime[1], flLinearTime / flBatchTime[1]);
+
+	return bench.Summarize("signatures", "the linear scan");
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: builds the lookup key of a signature in a given region
+//-----------------------------------------------------------------------------
+static string SigBatch_MakeKey(uintptr_t nBase, size_t nSize, const uint8_t* pPattern, const char* szMask)
+{
+	const size_t nLength = strlen(szMask);
+	string svKey;
+
+	svKey.reserve(sizeof(nBase) + sizeof(nSize) + nLength * 2);
+	svKey.append(reinterpret_cast<const char*>(&nBase), sizeof(nBase));
+	svKey.append(reinterpret_cast<const char*>(&nSize), sizeof(nSize));
+	svKey.append(szMask, nLength);
+
+	for (size_t i = 0; i < nLength; i++) // Wildcard bytes don't matter, zero them.
+	{
+		svKey.push_back((i == 0 || szMask[i] == 'x') ? static_cast<char>(pPattern[i]) : '\0');
+	}
+
+	return svKey;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: starts collecting signatures, every Find() returns a null result
+//          until Resolve() is called
+//-----------------------------------------------------------------------------
+void CSigBatch::Begin(void)
+{
+	End();
+	m_State = State_t::COLLECTING;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: scans every collected region once for all of its signatures
+// Input  : nThreads - number of slices to scan in parallel (0 = all cores),
+//                     must be 1 while the loader lock is held
+//-----------------------------------------------------------------------------
+void CSigBatch::Resolve(size_t nThreads)
+{
+	for (Region_t& region : m_vRegions)
+	{
+		if (m_pCache && region.m_nBase == m_nCacheBase && region.m_nSize == m_nCacheSize)
+			ResolveCached(region, nThreads);
+		else
+			region.m_Scanner.Scan(reinterpret_cast<const uint8_t*>(region.m_nBase), region.m_nSize, nThreads);
+
+		for (size_t i = 0; i < region.m_vKeys.size(); i++)
+		{
+			m_mResults[region.m_vKeys[i]] = reinterpret_cast<uintptr_t>(region.m_Scanner.GetResult(i));
+		}
+
+		region.m_Scanner.Clear();
+	}
+
+	m_State = State_t::RESOLVED;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: resolves the region from the cache, only scanning for signatures
+//          that aren't cached or whose cached result no longer matches
+// Input  : &region -
+//          nThreads -
+//-----------------------------------------------------------------------------
+void CSigBatch::ResolveCached(Region_t& region, size_t nThreads)
+{
+	const std::chrono::steady_clock::time_point tpStart = std::chrono::steady_clock::now();
+	const uint8_t* pBase = reinterpret_cast<const uint8_t*>(region.m_nBase);
+
+	for (size_t i = 0; i < region.m_vKeys.size(); i++)
+	{
+		uint32_t nOffset;
+		if (!m_pCache->Lookup(region.m_vKeys[i].substr(SIGBATCH_REGION_KEY_SIZE), nOffset))
+			continue;
+
+		// Misses are trusted as the section hash matched, hits get verified.
+		if (nOffset == SIGCACHE_NOT_FOUND)
+			region.m_Scanner.SetResult(i, nullptr);
+		else if (region.m_Scanner.IsMatch(i, pBase, region.m_nSize, nOffset))
+			region.m_Scanner.SetResult(i, pBase + nOffset);
+		else
+			continue;
+
+		m_nCacheHits++;
+	}
+
+	m_nCacheMisses = region.m_vKeys.size() - m_nCacheHits;
+	if (!m_nCacheMisses)
+	{
+		const int64_t nElapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tpStart).count();
+		m_nCacheTimeSaved += static_cast<int64_t>(m_pCache->GetScanTime()) - nElapsed;
+
+		return;
+	}
+
+	region.m_Scanner.Scan(pBase, region.m_nSize, nThreads);
+
+	for (size_t i = 0; i < region.m_vKeys.size(); i++)
+	{
+		const uint8_t* pResult = region.m_Scanner.GetResult(i);
+		m_pCache->Insert(region.m_vKeys[i].substr(SIGBATCH_REGION_KEY_SIZE),
+			pResult ? static_cast<uint32_t>(pResult - pBase) : SIGCACHE_NOT_FOUND);
+	}
+
+	// Only record the time of a (near) full scan, so the saved time stays meaningful.
+	if (m_nCacheMisses == region.m_vKeys.size())
+	{
+		m_pCache->SetScanTime(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tpStart).count());
+	}
+
+	if (!m_pCache->Save(m_fsCachePath))
+	{
+		spdlog::warn("Failed to write signature cache '{:s}'\n", m_fsCachePath.u8string());
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: stops batching and frees all results
+//-----------------------------------------------------------------------------
+void CSigBatch::End(void)
+{
+	m_State = State_t::IDLE;
+	m_vRegions.clear();
+	m_mResults.clear();
+	m_nMisses = 0;
+
+	m_pCache = nullptr;
+	m_fsCachePath.clear();
+	m_nCacheBase = 0;
+	m_nCacheSize = 0;
+	m_nCacheHits = 0;
+	m_nCacheMisses = 0;
+	m_nCacheTimeSaved = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: serves the signatures of one section from a persistent cache
+// Input  : *pCache -
+//          &fsPath -
+//          nBase - base of the section, usually the code section
+//          nSize -
+// Note   : if the file is missing or was written for different code, the
+//          section is fully scanned and the file is rewritten on Resolve().
+//-----------------------------------------------------------------------------
+void CSigBatch::SetCache(CSigCache* pCache, const fs::path& fsPath, uintptr_t nBase, size_t nSize)
+{
+	const std::chrono::steady_clock::time_point tpStart = std::chrono::steady_clock::now();
+	const uint64_t nCodeHash = CSigCache::HashData(reinterpret_cast<const uint8_t*>(nBase), nSize);
+
+	// Hashing is part of the cost of using the cache.
+	m_nCacheTimeSaved = -std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tpStart).count();
+
+	if (!pCache->Load(fsPath, nCodeHash))
+	{
+		pCache->Reset(nCodeHash);
+	}
+
+	m_pCache = pCache;
+	m_fsCachePath = fsPath;
+	m_nCacheBase = nBase;
+	m_nCacheSize = nSize;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: collects or looks up a signature
+// Input  : nBase -
+//          nSize -
+//          *pPattern -
+//          *szMask -
+//          &nResult -
+// Output : true if handled by the batch, false if the caller has to scan
+//-----------------------------------------------------------------------------
+bool CSigBatch::Find(uintptr_t nBase, size_t nSize, const uint8_t* pPattern, const char* szMask, uintptr_t& nResult)
+{
+	if (m_State == State_t::IDLE)
+		return false;
+
+	const string svKey = SigBatch_MakeKey(nBase, nSize, pPattern, szMask);
+
+	if (m_State == State_t::COLLECTING)
+	{
+		if (m_mResults.emplace(svKey, 0).second)
+		{
+			Region_t* pRegion = nullptr;
+			for (Region_t& region : m_vRegions)
+			{
+				if (region.m_nBase == nBase && region.m_nSize == nSize)
+				{
+					pRegion = &region;
+					break;
+				}
+			}
+			if (!pRegion)
+			{
+				m_vRegions.push_back({ nBase, nSize });
+				pRegion = &m_vRegions.back();
+			}
+
+			pRegion->m_Scanner.AddPattern(pPattern, szMask);
+			pRegion->m_vKeys.push_back(svKey);
+		}
+
+		nResult = 0;
+		return true;
+	}
+
+	const auto it = m_mResults.find(svKey);
+	if (it == m_mResults.end())
+	{
+		m_nMisses++;
+		return false;
+	}
+
+	nResult = it->second;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: loads the cache from disk
+// Input  : &fsPath -
+//          nCodeHash - hash of the code section the cache has to match
+// Output : true on success, false if missing, corrupt or outdated
+//-----------------------------------------------------------------------------
+bool CSigCache::Load(const fs::path& fsPath, uint64_t nCodeHash)
+{
+	CIOStream reader;
+	if (!reader.Open(fsPath, CIOStream::Mode_t::READ))
+		return false;
+
+	if (reader.Read<uint32_t>() != SIGCACHE_MAGIC || reader.Read<uint32_t>() != SIGCACHE_VERSION)
+		return false;
+
+	if (reader.Read<uint64_t>() != nCodeHash)
+		return false;
+
+	Reset(nCodeHash);
+	m_nScanTime = reader.Read<uint64_t>();
+
+	const uint32_t nEntries = reader.Read<uint32_t>();
+	for (uint32_t i = 0; i < nEntries; i++)
+	{
+		const uint16_t nKeyLength = reader.Read<uint16_t>();
+		if (!nKeyLength || !reader.IsReadable())
+		{
+			Reset(nCodeHash);
+			return false;
+		}
+
+		string svKey(nKeyLength, '\0');
+		reader.Read(svKey[0], nKeyLength);
+
+		m_mEntries[svKey] = reader.Read<uint32_t>();
+	}
+
+	if (reader.Read<uint32_t>() != SIGCACHE_MAGIC) // Truncated.
+	{
+		Reset(nCodeHash);
+		return false;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: writes the cache to disk
+// Input  : &fsPath -
+// Output : true on success
+//-----------------------------------------------------------------------------
+bool CSigCache::Save(const fs::path& fsPath) const
+{
+	std::error_code ec;
+	fs::create_directories(fsPath.parent_path(), ec);
+
+	CIOStream writer;
+	if (!writer.Open(fsPath, CIOStream::Mode_t::WRITE))
+		return false;
+
+	writer.Write<uint32_t>(SIGCACHE_MAGIC);
+	writer.Write<uint32_t>(SIGCACHE_VERSION);
+	writer.Write<uint64_t>(m_nCodeHash);
+	writer.Write<uint64_t>(m_nScanTime);
+	writer.Write<uint32_t>(static_cast<uint32_t>(m_mEntries.size()));
+
+	for (const auto& entry : m_mEntries)
+	{
+		writer.Write<uint16_t>(static_cast<uint16_t>(entry.first.size()));
+		writer.Write(entry.first.data(), entry.first.size());
+		writer.Write<uint32_t>(entry.second);
+	}
+
+	writer.Write<uint32_t>(SIGCACHE_MAGIC); // Trailer, so truncated files are rejected.
+	writer.Flush();
+
+	return writer.IsWritable();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: clears all entries and binds the cache to a new code hash
+// Input  : nCodeHash -
+//-----------------------------------------------------------------------------
+void CSigCache::Reset(uint64_t nCodeHash)
+{
+	m_nCodeHash = nCodeHash;
+	m_nScanTime = 0;
+	m_mEntries.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: looks up the cached section offset of a signature
+// Input  : &svKey -
+//          &nOffset - SIGCACHE_NOT_FOUND if the signature has no match
+// Output : true if cached
+//-----------------------------------------------------------------------------
+bool CSigCache::Lookup(const string& svKey, uint32_t& nOffset) const
+{
+	const auto it = m_mEntries.find(svKey);
+	if (it == m_mEntries.end())
+		return false;
+
+	nOffset = it->second;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: adds or updates the cached section offset of a signature
+// Input  : &svKey -
+//          nOffset -
+//-----------------------------------------------------------------------------
+void CSigCache::Insert(const string& svKey, uint32_t nOffset)
+{
+	m_mEntries[svKey] = nOffset;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: fast 64 bit hash of a large buffer; four independent lanes so the
+//          loop isn't bound by the latency of a single multiply chain
+// Input  : *pData -
+//          nSize -
+// Output : hash
+//-----------------------------------------------------------------------------
+uint64_t CSigCache::HashData(const uint8_t* pData, size_t nSize)
+{
+	const uint64_t nPrime1 = 0x9E3779B185EBCA87ull;
+	const uint64_t nPrime2 = 0xC2B2AE3D27D4EB4Full;
+
+	auto Rotl = [](uint64_t nValue, int nShift) { return (nValue << nShift) | (nValue >> (64 - nShift)); };
+
+	uint64_t nLanes[4] = { nPrime1 + nPrime2, nPrime2, 0, 0 - nPrime1 };
+	size_t i = 0;
+
+	for (; i + 32 <= nSize; i += 32)
+	{
+		for (size_t j = 0; j < 4; j++)
+		{
+			uint64_t nValue;
+			memcpy(&nValue, pData + i + j * 8, sizeof(nValue));
+
+			nLanes[j] = Rotl(nLanes[j] + nValue * nPrime2, 31) * nPrime1;
+		}
+	}
+
+	uint64_t nHash = static_cast<uint64_t>(nSize);
+	for (size_t j = 0; j < 4; j++)
+	{
+		nHash = (nHash ^ Rotl(nLanes[j] * nPrime2, 31) * nPrime1) * nPrime1 + nPrime2;
+	}
+	for (; i < nSize; i++)
+	{
+		nHash = Rotl(nHash ^ (pData[i] * nPrime1), 11) * nPrime2;
+	}
+
+	nHash ^= nHash >> 33;
+	nHash *= nPrime2;
+	nHash ^= nHash >> 29;
+	nHash *= nPrime1;
+	nHash ^= nHash >> 32;
+
+	return nHash;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+class CBenchmark;
+
+//-----------------------------------------------------------------------------
+// Single pass scanner for many masked signatures at once. Signatures are
+// dispatched on their first two non-wildcard bytes and confirmed with the
+// same 16 byte SSE mask compare as CModule::FindPatternSIMD. Works on any
+// byte buffer.
+//-----------------------------------------------------------------------------
+class CSigScanner
+{
+public:
+	size_t AddPattern(const uint8_t* pPattern, const char* szMask);
+	void   Scan(const uint8_t* pData, size_t nSize, size_t nThreads = 0);
+	void   Clear(void);
+
+	bool   IsMatch(size_t nIndex, const uint8_t* pData, size_t nSize, size_t nOffset) const;
+	void   SetResult(size_t nIndex, const uint8_t* pResult);
+
+	size_t         GetPatternCount(void) const { return m_vPatterns.size(); }
+	const uint8_t* GetResult(size_t nIndex) const { return m_vResults[nIndex]; }
+
+	static bool Benchmark(CBenchmark& bench, const uint8_t* pData, size_t nSize, size_t nSignatures, int nIterations);
+
+private:
+	struct Pattern_t
+	{
+		vector<uint8_t>  m_vBytes;  // Pattern bytes, padded to a multiple of 16.
+		vector<uint16_t> m_vMasks;  // Compare mask for each 16 byte chunk.
+		size_t           m_nLength; // Length of the signature in bytes.
+		size_t           m_nAnchor; // Offset of the first two non-wildcard bytes.
+		bool             m_bResolved; // Result was set with SetResult(), skip it.
+	};
+
+	struct Candidate_t
+	{
+		uint32_t m_nIndex;  // Pattern index.
+		uint32_t m_nAnchor; // Offset of the anchor within the pattern.
+		uint32_t m_nValue;  // Pattern dword at the anchor, wildcards zeroed.
+		uint32_t m_nMask;   // Byte mask of the above.
+	};
+
+	void BuildDispatch(void);
+	void ScanRange(const uint8_t* pData, size_t nSize, size_t nBegin, size_t nEnd, vector<size_t>& vFirst) const;
+	bool TestBucket(const vector<Candidate_t>& vItems, uint32_t nFirst, uint32_t nLast, const uint8_t* pData, size_t nSize,
+		size_t nPosition, size_t nBegin, size_t nEnd, uint32_t nDword, bool bHasDword, vector<size_t>& vFirst, size_t& nRemaining) const;
+	bool Compare(const Pattern_t& pattern, const uint8_t* pData, size_t nAvailable) const;
+
+	vector<Pattern_t>      m_vPatterns;
+	vector<const uint8_t*> m_vResults;
+	size_t                 m_nMaxAnchor = 0;
+
+	// Patterns bucketed by the two bytes at their anchor. Patterns without
+	// two adjacent non-wildcard bytes go in the bucket of their first byte.
+	vector<uint64_t>       m_vPairBits;  // One bit per non-empty pair bucket.
+	vector<uint32_t>       m_vPairStart; // 0x10000 + 1 offsets into m_vPairItems.
+	vector<Candidate_t>    m_vPairItems;
+	vector<uint32_t>       m_vByteStart; // 0x100 + 1 offsets into m_vByteItems.
+	vector<Candidate_t>    m_vByteItems;
+};
+
+#define SIGCACHE_MAGIC     (('C'<<24)+('G'<<16)+('I'<<8)+'S')
+#define SIGCACHE_VERSION   1
+#define SIGCACHE_NOT_FOUND UINT32_MAX
+
+//-----------------------------------------------------------------------------
+// Persistent signature results of one code section, only valid as long as
+// the hash of the section matches the one it was written with.
+//-----------------------------------------------------------------------------
+class CSigCache
+{
+public:
+	bool Load(const fs::path& fsPath, uint64_t nCodeHash);
+	bool Save(const fs::path& fsPath) const;
+	void Reset(uint64_t nCodeHash);
+
+	bool Lookup(const string& svKey, uint32_t& nOffset) const;
+	void Insert(const string& svKey, uint32_t nOffset);
+
+	uint64_t GetScanTime(void) const { return m_nScanTime; }
+	void     SetScanTime(uint64_t nMicroSeconds) { m_nScanTime = nMicroSeconds; }
+
+	static uint64_t HashData(const uint8_t* pData, size_t nSize);
+
+private:
+	uint64_t                             m_nCodeHash = 0;
+	uint64_t                             m_nScanTime = 0; // Microseconds the last full scan took.
+	std::unordered_map<string, uint32_t> m_mEntries;      // Signature key to section offset.
+};
+
+//-----------------------------------------------------------------------------
+// Defers CModule::FindPatternSIMD calls so that every signature requested
+// during DetourInit is resolved with one CSigScanner pass per section.
+//-----------------------------------------------------------------------------
+class CSigBatch
+{
+public:
+	void Begin(void);
+	void SetCache(CSigCache* pCache, const fs::path& fsPath, uintptr_t nBase, size_t nSize);
+	void Resolve(size_t nThreads);
+	void End(void);
+
+	bool Find(uintptr_t nBase, size_t nSize, const uint8_t* pPattern, const char* szMask, uintptr_t& nResult);
+
+	size_t GetPatternCount(void) const { return m_mResults.size(); }
+	size_t GetRegionCount(void) const { return m_vRegions.size(); }
+	size_t GetMissCount(void) const { return m_nMisses; }
+
+	size_t   GetCacheHits(void) const { return m_nCacheHits; }
+	size_t   GetCacheMisses(void) const { return m_nCacheMisses; }
+	int64_t  GetCacheTimeSaved(void) const { return m_nCacheTimeSaved; }
+
+private:
+	enum class State_t
+	{
+		IDLE = 0,
+		COLLECTING,
+		RESOLVED
+	};
+
+	struct Region_t
+	{
+		uintptr_t      m_nBase;
+		size_t         m_nSize;
+		CSigScanner    m_Scanner;
+		vector<string> m_vKeys; // Result key of every pattern in m_Scanner.
+	};
+
+	void ResolveCached(Region_t& region, size_t nThreads);
+
+	State_t                               m_State = State_t::IDLE;
+	vector<Region_t>                      m_vRegions;
+	std::unordered_map<string, uintptr_t> m_mResults;
+	size_t                                m_nMisses = 0;
+
+	CSigCache*                            m_pCache = nullptr;
+	fs::path                              m_fsCachePath;
+	uintptr_t                             m_nCacheBase = 0;
+	size_t                                m_nCacheSize = 0;
+	size_t                                m_nCacheHits = 0;
+	size_t                                m_nCacheMisses = 0;
+	int64_t                               m_nCacheTimeSaved = 0; // Microseconds.
+};
+
+extern CSigBatch g_SigBatch;
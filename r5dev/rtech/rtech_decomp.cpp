@@ -0,0 +1,1098 @@
+//=============================================================================//
+//
+// Purpose: RPak decompression library, free of engine dependencies so it can 
+//          be shared between the game and standalone tools.
+//
+//=============================================================================//
+#include "core/stdafx.h"
+#include "mathlib/crc32.h"
+#include "public/utility/mappedfile.h"
+#include "rtech/rtech_decomp.h"
+
+//-----------------------------------------------------------------------------
+// Purpose: calculate 'decompressed' size and commit parameters
+//-----------------------------------------------------------------------------
+uint64_t RTech_DecompressPakFileInit(RPakDecompState_t* state, uint8_t* fileBuffer, uint64_t fileSize, uint64_t offNoHeader, uint64_t headerSize)
+{
+	int64_t input_byte_pos_init;         // r9
+	uint64_t byte_init;                  // r11
+	int32_t decompressed_size_bits;      // ecx
+	int64_t byte_1_low;                  // rdi
+	uint64_t input_byte_pos_1;           // r10
+	uint32_t bit_pos_final;              // ebp
+	uint64_t byte_1;                     // rdi
+	uint32_t brih_bits;                  // er11
+	uint64_t inv_mask_in;                // r8
+	uint64_t byte_final_full;            // rbx
+	uint64_t bit_pos_final_1;            // rax
+	int32_t byte_bit_offset_final;       // ebp
+	uint64_t input_byte_pos_final;       // r10
+	uint64_t byte_final;                 // rbx
+	uint32_t brih_bytes;                 // er11
+	uint64_t byte_tmp;                   // rdx
+	uint64_t stream_len_needed;          // r14
+	uint64_t result;                     // rax
+	uint64_t inv_mask_out;               // r8
+	uint64_t qw70;                       // rcx
+	uint64_t stream_compressed_size_new; // rdx
+
+	const uintptr_t mask = UINT64_MAX;
+	const uintptr_t file_buf = uintptr_t(fileBuffer);
+
+	state->m_nInputBuf = file_buf;
+	state->m_nOut = 0i64;
+	state->m_nOutMask = 0i64;
+	state->dword44 = 0;
+	state->m_nTotalFileLen = fileSize + offNoHeader;
+	state->m_nMask = mask;
+	input_byte_pos_init = offNoHeader + headerSize + 8;
+	byte_init = *(uint64_t*)((mask & (offNoHeader + headerSize)) + file_buf);
+	state->m_nDecompPosition = headerSize;
+	decompressed_size_bits = byte_init & 0x3F;
+	byte_init >>= 6;
+	state->input_byte_pos = input_byte_pos_init;
+	state->m_nDecompSize = byte_init & ((1i64 << decompressed_size_bits) - 1) | (1i64 << decompressed_size_bits);
+	byte_1_low = *(uint64_t*)((mask & input_byte_pos_init) + file_buf) << (64
+		- ((uint8_t)decompressed_size_bits
+			+ 6));
+	input_byte_pos_1 = input_byte_pos_init + ((uint64_t)(uint32_t)(decompressed_size_bits + 6) >> 3);
+	state->input_byte_pos = input_byte_pos_1;
+	bit_pos_final = ((decompressed_size_bits + 6) & 7) + 13;
+	byte_1 = (0xFFFFFFFFFFFFFFFFui64 >> ((decompressed_size_bits + 6) & 7)) & ((byte_init >> decompressed_size_bits) | byte_1_low);
+	brih_bits = (((uint8_t)byte_1 - 1) & 0x3F) + 1;
+	inv_mask_in = 0xFFFFFFFFFFFFFFFFui64 >> (64 - (uint8_t)brih_bits);
+	state->m_nInvMaskIn = inv_mask_in;
+	state->m_nInvMaskOut = 0xFFFFFFFFFFFFFFFFui64 >> (63 - (((byte_1 >> 6) - 1) & 0x3F));
+	byte_final_full = (byte_1 >> 13) | (*(uint64_t*)((mask & input_byte_pos_1) + file_buf) << (64
+		- (uint8_t)bit_pos_final));
+	bit_pos_final_1 = bit_pos_final;
+	byte_bit_offset_final = bit_pos_final & 7;
+	input_byte_pos_final = (bit_pos_final_1 >> 3) + input_byte_pos_1;
+	byte_final = (0xFFFFFFFFFFFFFFFFui64 >> byte_bit_offset_final) & byte_final_full;
+	state->input_byte_pos = input_byte_pos_final;
+	if (inv_mask_in == -1i64)
+	{
+		state->header_skip_bytes_bs = 0;
+		stream_len_needed = fileSize;
+	}
+	else
+	{
+		brih_bytes = brih_bits >> 3;
+		state->header_skip_bytes_bs = brih_bytes + 1;
+		byte_tmp = *(uint64_t*)((mask & input_byte_pos_final) + file_buf);
+		state->input_byte_pos = input_byte_pos_final + brih_bytes + 1;
+		stream_len_needed = byte_tmp & ((1i64 << (8 * ((uint8_t)brih_bytes + 1))) - 1);
+	}
+	result = state->m_nDecompSize;
+	inv_mask_out = state->m_nInvMaskOut;
+	qw70 = offNoHeader + state->m_nInvMaskIn - 6i64;
+	state->m_nLengthNeeded = stream_len_needed + offNoHeader;
+	state->qword70 = qw70;
+	state->byte = byte_final;
+	state->byte_bit_offset = byte_bit_offset_final;
+	state->dword6C = 0;
+	state->m_nCompressedStreamSize = stream_len_needed + offNoHeader;
+	state->m_nDecompStreamSize = result;
+	if (result - 1 > inv_mask_out)
+	{
+		stream_compressed_size_new = stream_len_needed + offNoHeader - state->header_skip_bytes_bs;
+		state->m_nDecompStreamSize = inv_mask_out + 1;
+		state->m_nCompressedStreamSize = stream_compressed_size_new;
+	}
+
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: decompress input data (reference decoder, supports ring buffers)
+//-----------------------------------------------------------------------------
+uint8_t RTech_DecompressPakFileRef(RPakDecompState_t* state, uint64_t inLen, uint64_t outLen)
+{
+	uint64_t decompressed_position;        // r15
+	uint32_t byte_bit_offset;              // ebp
+	uint64_t byte;                         // rsi
+	uint64_t input_byte_pos;               // rdi
+	uint64_t some_size;                    // r12
+	uint32_t dword6C;                      // ecx MAPDST
+	uint64_t v12;                          // rsi
+	uint64_t i;                            // rax
+	uint64_t dword6c_shl8;                 // r8
+	int64_t dword6c_old;                   // r9
+	int32_t LUT_200_val;                   // ecx
+	uint64_t v17;                          // rax
+	uint64_t byte_new;                     // rsi
+	int64_t  LUT_0_VAL;                    // r14
+	int32_t byte_4bits_1;                  // ecx
+	uint64_t v21;                          // r11
+	int32_t v22;                           // edx
+	uint64_t out_mask;                     // rax
+	int32_t v24;                           // er8
+	uint32_t LUT_400_seek_backwards;       // er13
+	uint64_t out_seek_back;                // r10
+	uint64_t out_seekd_1;                  // rax
+	uint64_t* out_seekd_back;              // r10
+	uint64_t decompressed_size;            // r9
+	uint64_t inv_mask_in;                  // r10
+	uint64_t header_skip_bytes_bs;         // r8
+	uint64_t v32;                          // rax
+	uint64_t v33;                          // rax
+	uint64_t v34;                          // rax
+	uint64_t stream_decompressed_size_new; // rcx
+	int64_t  v36;                          // rdx
+	uint64_t len_needed_new;               // r14
+	uint64_t stream_compressed_size_new;   // r11
+	char v39;                                   // cl MAPDST
+	uint64_t v40;                          // rsi MAPDST
+	uint64_t v46;                               // rcx
+	int64_t v47;                           // r9
+	int64_t m;                             // r8
+	uint32_t v49;                          // er9
+	int64_t v50;                           // r8
+	int64_t v51;                           // rdx
+	int64_t k;                             // r8
+	char* v53;                                  // r10
+	int64_t  v54;                          // rdx
+	uint32_t lut0_val_abs;                 // er14
+	int64_t* in_seekd;                     // rdx
+	int64_t* out_seekd;                    // r8
+	int64_t  byte_3bits;                   // rax MAPDST
+	uint64_t byte_new_tmp;                 // r9 MAPDST
+	int32_t LUT_4D0_480;                   // er10 MAPDST
+	uint8_t LUT_4D8_4C0_nBits;             // cl MAPDST
+	uint64_t byte_4bits;                   // rax MAPDST
+	uint32_t copy_bytes_ammount;           // er14
+	uint32_t j;                            // ecx
+	int64_t v67;                           // rax
+	uint64_t v68;                          // rcx
+	uint8_t result;                        // al
+
+	if (inLen < state->m_nLengthNeeded)
+		return 0;
+
+	decompressed_position = state->m_nDecompPosition;
+	if (outLen < state->m_nInvMaskOut + (decompressed_position & ~state->m_nInvMaskOut) + 1 && outLen < state->m_nDecompSize)
+		return 0;
+
+	byte_bit_offset = state->byte_bit_offset; // Keeping copy since we increment it down below.
+	byte = state->byte; // Keeping copy since its getting overwritten down below.
+	input_byte_pos = state->input_byte_pos; // Keeping copy since we increment it down below.
+	some_size = state->qword70;
+	if (state->m_nCompressedStreamSize < some_size)
+		some_size = state->m_nCompressedStreamSize;
+	dword6C = state->dword6C;
+
+	if (!byte_bit_offset)
+		goto LABEL_9;
+
+	v12 = (*(uint64_t*)((input_byte_pos & state->m_nMask) + state->m_nInputBuf) << (64 - (uint8_t)byte_bit_offset)) | byte;
+	for (i = byte_bit_offset; ; i = byte_bit_offset)
+	{
+		byte_bit_offset &= 7u;
+		input_byte_pos += i >> 3;
+		byte = (0xFFFFFFFFFFFFFFFFui64 >> byte_bit_offset) & v12;
+	LABEL_9:
+		dword6c_shl8 = (uint64_t)dword6C << 8;
+		dword6c_old = dword6C;
+		LUT_200_val = LUT_200[(uint8_t)byte + dword6c_shl8];// LUT_200 - u8 - amount of bits
+		v17 = (uint8_t)byte + dword6c_shl8;
+		byte_bit_offset += LUT_200_val;
+		byte_new = byte >> LUT_200_val;
+		LUT_0_VAL = LUT_0[v17];// LUT_0 - i32 - signed, amount of bytes
+
+		if (LUT_0_VAL < 0)
+		{
+			lut0_val_abs = -(int32_t)LUT_0_VAL;
+			in_seekd = (int64_t*)(state->m_nInputBuf + (input_byte_pos & state->m_nMask));
+			dword6C = 1;
+			out_seekd = (int64_t*)(state->m_nOut + (decompressed_position & state->m_nOutMask));
+			if (lut0_val_abs == LUT_4E0[dword6c_old])
+			{
+				if ((~input_byte_pos & state->m_nInvMaskIn) < 0xF
+					|| (state->m_nInvMaskOut & ~decompressed_position) < 0xF
+					|| state->m_nDecompSize - decompressed_position < 0x10)
+				{
+					lut0_val_abs = 1;
+				}
+
+				v39 = byte_new;
+				v40 = byte_new >> 3;
+				byte_3bits = v39 & 7;
+				byte_new_tmp = v40;
+
+				if (byte_3bits)
+				{
+					LUT_4D0_480 = LUT_4D0[byte_3bits];// LUT_4D0 - u8
+					LUT_4D8_4C0_nBits = LUT_4D8[byte_3bits];// LUT_4D8 - u8 - amount of bits
+				}
+				else
+				{
+					byte_new_tmp = v40 >> 4;
+					byte_4bits = v40 & 15;
+					byte_bit_offset += 4;
+					LUT_4D0_480 = LUT_480[byte_4bits];// LUT_480 - u32
+					LUT_4D8_4C0_nBits = LUT_4C0[byte_4bits]; // LUT_4C0 - u8 - amount of bits???
+				}
+
+				byte_bit_offset += LUT_4D8_4C0_nBits + 3;
+				byte_new = byte_new_tmp >> LUT_4D8_4C0_nBits;
+				copy_bytes_ammount = LUT_4D0_480 + (byte_new_tmp & ((1 << LUT_4D8_4C0_nBits) - 1)) + lut0_val_abs;
+
+				for (j = copy_bytes_ammount >> 3; j; --j)// copy by 8 bytes
+				{
+					v67 = *in_seekd++;
+					*out_seekd++ = v67;
+				}
+
+				if ((copy_bytes_ammount & 4) != 0)    // copy by 4
+				{
+					*(uint32_t*)out_seekd = *(uint32_t*)in_seekd;
+					out_seekd = (int64_t*)((char*)out_seekd + 4);
+					in_seekd = (int64_t*)((char*)in_seekd + 4);
+				}
+
+				if ((copy_bytes_ammount & 2) != 0)    // copy by 2
+				{
+					*(uint16_t*)out_seekd = *(uint16_t*)in_seekd;
+					out_seekd = (int64_t*)((char*)out_seekd + 2);
+					in_seekd = (int64_t*)((char*)in_seekd + 2);
+				}
+
+				if ((copy_bytes_ammount & 1) != 0)    // copy by 1
+					*(uint8_t*)out_seekd = *(uint8_t*)in_seekd;
+
+				input_byte_pos += copy_bytes_ammount;
+				decompressed_position += copy_bytes_ammount;
+			}
+			else
+			{
+				*out_seekd = *in_seekd;
+				out_seekd[1] = in_seekd[1];
+				input_byte_pos += lut0_val_abs;
+				decompressed_position += lut0_val_abs;
+			}
+		}
+		else
+		{
+			byte_4bits_1 = byte_new & 0xF;
+			dword6C = 0;
+			v21 = ((uint64_t)(uint32_t)byte_new >> (((uint32_t)(byte_4bits_1 + 0xFFFFFFE1) >> 3) & 6)) & 0x3F;// 6 bits after shift for who knows how much???
+			v22 = 1 << (byte_4bits_1 + ((byte_new >> 4) & ((24 * (((uint32_t)(byte_4bits_1 + 0xFFFFFFE1) >> 3) & 2)) >> 4)));// amount of bits to read???
+			byte_bit_offset += (((uint32_t)(byte_4bits_1 + 0xFFFFFFE1) >> 3) & 6)// shit shit gets shifted by amount of bits it read or something
+				+ LUT_440[v21]
+				+ byte_4bits_1
+				+ ((byte_new >> 4) & ((24 * (((uint32_t)(byte_4bits_1 + 0xFFFFFFE1) >> 3) & 2)) >> 4));
+			out_mask = state->m_nOutMask;
+			v24 = 16
+				* (v22
+					+ ((v22 - 1) & (byte_new >> ((((uint32_t)(byte_4bits_1 + 0xFFFFFFE1) >> 3) & 6)
+						+ LUT_440[v21]))));
+			byte_new >>= (((uint32_t)(byte_4bits_1 + 0xFFFFFFE1) >> 3) & 6)
+				+ LUT_440[v21]
+				+ byte_4bits_1
+				+ ((byte_new >> 4) & ((24 * (((uint32_t)(byte_4bits_1 + 0xFFFFFFE1) >> 3) & 2)) >> 4));
+			LUT_400_seek_backwards = v24 + LUT_400[v21] - 16;// LUT_400 - u8 - seek backwards
+			out_seek_back = out_mask & (decompressed_position - LUT_400_seek_backwards);
+			out_seekd_1 = state->m_nOut + (decompressed_position & out_mask);
+			out_seekd_back = (uint64_t*)(state->m_nOut + out_seek_back);
+			if ((int32_t)LUT_0_VAL == 17)
+			{
+				v39 = byte_new;
+				v40 = byte_new >> 3;
+				byte_3bits = v39 & 7;
+				byte_new_tmp = v40;
+				if (byte_3bits)
+				{
+					LUT_4D0_480 = LUT_4D0[byte_3bits];
+					LUT_4D8_4C0_nBits = LUT_4D8[byte_3bits];
+				}
+				else
+				{
+					byte_bit_offset += 4;
+					byte_4bits = v40 & 0xF;
+					byte_new_tmp = v40 >> 4;
+					LUT_4D0_480 = LUT_480[byte_4bits];
+					LUT_4D8_4C0_nBits = LUT_4C0[byte_4bits];
+					if (state->m_nInputBuf && byte_bit_offset + LUT_4D8_4C0_nBits >= 0x3D)
+					{
+						v46 = input_byte_pos++ & state->m_nMask;
+						byte_new_tmp |= (uint64_t) * (uint8_t*)(v46 + state->m_nInputBuf) << (61
+							- (uint8_t)byte_bit_offset);
+						byte_bit_offset -= 8;
+					}
+				}
+				byte_bit_offset += LUT_4D8_4C0_nBits + 3;
+				byte_new = byte_new_tmp >> LUT_4D8_4C0_nBits;
+				v47 = ((uint32_t)byte_new_tmp & ((1 << LUT_4D8_4C0_nBits) - 1)) + LUT_4D0_480 + 17;
+				decompressed_position += v47;
+				if (LUT_400_seek_backwards < 8)
+				{
+					v49 = v47 - 13;
+					decompressed_position -= 13i64;
+					if (LUT_400_seek_backwards == 1)    // 1 means copy v49 qwords?
+					{
+						v50 = *(uint8_t*)out_seekd_back;
+						v51 = 0i64;
+						for (k = 0x101010101010101i64 * v50; (uint32_t)v51 < v49; v51 = (uint32_t)(v51 + 8))
+							*(uint64_t*)(v51 + out_seekd_1) = k;
+					}
+					else
+					{
+						if (v49)
+						{
+							v53 = (char*)out_seekd_back - out_seekd_1;
+							v54 = v49;
+							do
+							{
+								*(uint8_t*)out_seekd_1 = v53[out_seekd_1];// seeked = seek_back; increment ptrs
+								++out_seekd_1;
+								--v54;
+							} while (v54);
+						}
+					}
+				}
+				else
+				{
+					for (m = 0i64; (uint32_t)m < (uint32_t)v47; m = (uint32_t)(m + 8))
+						*(uint64_t*)(m + out_seekd_1) = *(uint64_t*)((char*)out_seekd_back + m);
+				}
+			}
+			else
+			{
+				decompressed_position += LUT_0_VAL;
+				*(uint64_t*)out_seekd_1 = *out_seekd_back;
+				*(uint64_t*)(out_seekd_1 + 8) = out_seekd_back[1];
+			}
+		}
+		if (input_byte_pos >= some_size)
+			break;
+
+	LABEL_26:
+		v12 = (*(uint64_t*)((input_byte_pos & state->m_nMask) + state->m_nInputBuf) << (64 - (uint8_t)byte_bit_offset)) | byte_new;
+	}
+
+	if (decompressed_position != state->m_nDecompStreamSize)
+		goto LABEL_22;
+
+	decompressed_size = state->m_nDecompSize;
+	if (decompressed_position == decompressed_size)
+	{
+		state->input_byte_pos = input_byte_pos;
+		result = 1;
+		state->m_nDecompPosition = decompressed_position;
+		return result;
+	}
+
+	inv_mask_in = state->m_nInvMaskIn;
+	header_skip_bytes_bs = state->header_skip_bytes_bs;
+	v32 = inv_mask_in & -(int64_t)input_byte_pos;
+	byte_new >>= 1;
+	++byte_bit_offset;
+
+	if (header_skip_bytes_bs > v32)
+	{
+		input_byte_pos += v32;
+		v33 = state->qword70;
+		if (input_byte_pos > v33)
+			state->qword70 = inv_mask_in + v33 + 1;
+	}
+
+	v34 = input_byte_pos & state->m_nMask;
+	input_byte_pos += header_skip_bytes_bs;
+	stream_decompressed_size_new = decompressed_position + state->m_nInvMaskOut + 1;
+	v36 = *(uint64_t*)(v34 + state->m_nInputBuf) & ((1LL << (8 * (uint8_t)header_skip_bytes_bs)) - 1);
+	len_needed_new = v36 + state->m_nLengthNeeded;
+	stream_compressed_size_new = v36 + state->m_nCompressedStreamSize;
+	state->m_nLengthNeeded = len_needed_new;
+	state->m_nCompressedStreamSize = stream_compressed_size_new;
+
+	if (stream_decompressed_size_new >= decompressed_size)
+	{
+		stream_decompressed_size_new = decompressed_size;
+		state->m_nCompressedStreamSize = header_skip_bytes_bs + stream_compressed_size_new;
+	}
+
+	state->m_nDecompStreamSize = stream_decompressed_size_new;
+
+	if (inLen >= len_needed_new && outLen >= stream_decompressed_size_new)
+	{
+	LABEL_22:
+		some_size = state->qword70;
+		if (input_byte_pos >= some_size)
+		{
+			input_byte_pos = ~state->m_nInvMaskIn & (input_byte_pos + 7);
+			some_size += state->m_nInvMaskIn + 1;
+			state->qword70 = some_size;
+		}
+		if (state->m_nCompressedStreamSize < some_size)
+			some_size = state->m_nCompressedStreamSize;
+		goto LABEL_26;
+	}
+
+	v68 = state->qword70;
+
+	if (input_byte_pos >= v68)
+	{
+		input_byte_pos = ~inv_mask_in & (input_byte_pos + 7);
+		state->qword70 = v68 + inv_mask_in + 1;
+	}
+
+	state->dword6C = dword6C;
+	result = 0;
+	state->input_byte_pos = input_byte_pos;
+	state->m_nDecompPosition = decompressed_position;
+	state->byte = byte_new;
+	state->byte_bit_offset = byte_bit_offset;
+
+	return result;
+}
+
+
+//-----------------------------------------------------------------------------
+// Decoder tables repacked from the LUT_* arrays above so that everything the
+// hot loop touches is adjacent and fits in a handful of cache lines.
+//-----------------------------------------------------------------------------
+struct RPakDecodeTables_t
+{
+	struct Token_t
+	{
+		int8_t  m_nLength; // LUT_0: < 0 literal run, >= 0 match length (17 = long match).
+		uint8_t m_nBits;   // LUT_200: bits consumed by the token.
+	};
+	struct Distance_t
+	{
+		uint8_t m_nLow;    // LUT_400: low bits of the match distance.
+		uint8_t m_nBits;   // LUT_440: bits consumed by the distance selector.
+	};
+	struct Length_t
+	{
+		uint32_t m_nBase;  // LUT_4D0/LUT_480: length base.
+		uint32_t m_nBits;  // LUT_4D8/LUT_4C0: extra length bits.
+	};
+
+	Token_t    m_Token[512];   // Indexed by '(dword6C << 8) | next 8 bits'.
+	Distance_t m_Distance[64];
+	Length_t   m_Length3[8];   // 3 bit length codes (0 escapes to m_Length4).
+	Length_t   m_Length4[16];  // 4 bit length codes.
+	uint8_t    m_LongLiteral[2]; // LUT_4E0: literal length that announces a long literal run.
+};
+
+static const RPakDecodeTables_t* RTech_GetDecodeTables(void)
+{
+	alignas(64) static RPakDecodeTables_t s_Tables;
+	static const bool s_bInitialized = []()
+	{
+		for (size_t i = 0; i < 512; i++)
+		{
+			s_Tables.m_Token[i].m_nLength = LUT_0[i];
+			s_Tables.m_Token[i].m_nBits = LUT_200[i];
+		}
+		for (size_t i = 0; i < 64; i++)
+		{
+			s_Tables.m_Distance[i].m_nLow = LUT_400[i];
+			s_Tables.m_Distance[i].m_nBits = LUT_440[i];
+		}
+		for (size_t i = 0; i < 8; i++)
+		{
+			s_Tables.m_Length3[i].m_nBase = LUT_4D0[i];
+			s_Tables.m_Length3[i].m_nBits = LUT_4D8[i];
+		}
+		for (size_t i = 0; i < 16; i++)
+		{
+			s_Tables.m_Length4[i].m_nBase = LUT_480[i];
+			s_Tables.m_Length4[i].m_nBits = LUT_4C0[i];
+		}
+		s_Tables.m_LongLiteral[0] = LUT_4E0[0];
+		s_Tables.m_LongLiteral[1] = LUT_4E0[1];
+		return true;
+	}();
+
+	return &s_Tables;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: copies exactly 'nLength' bytes between non-overlapping buffers
+//-----------------------------------------------------------------------------
+static FORCEINLINE void RTech_CopyLiteral(uint8_t* pDst, const uint8_t* pSrc, size_t nLength)
+{
+	if (nLength >= 16)
+	{
+		uint8_t* pEnd = pDst + nLength - 16;
+		const uint8_t* pSrcEnd = pSrc + nLength - 16;
+
+		while (pDst + 32 <= pEnd)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst), _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 16), _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + 16)));
+			pDst += 32;
+			pSrc += 32;
+		}
+		while (pDst < pEnd)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst), _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc)));
+			pDst += 16;
+			pSrc += 16;
+		}
+		// Overlapping tail store; the source doesn't alias the destination so this is exact.
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pEnd), _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrcEnd)));
+	}
+	else if (nLength >= 8)
+	{
+		*reinterpret_cast<uint64_t*>(pDst) = *reinterpret_cast<const uint64_t*>(pSrc);
+		*reinterpret_cast<uint64_t*>(pDst + nLength - 8) = *reinterpret_cast<const uint64_t*>(pSrc + nLength - 8);
+	}
+	else if (nLength >= 4)
+	{
+		*reinterpret_cast<uint32_t*>(pDst) = *reinterpret_cast<const uint32_t*>(pSrc);
+		*reinterpret_cast<uint32_t*>(pDst + nLength - 4) = *reinterpret_cast<const uint32_t*>(pSrc + nLength - 4);
+	}
+	else if (nLength)
+	{
+		pDst[0] = pSrc[0];
+		pDst[nLength >> 1] = pSrc[nLength >> 1];
+		pDst[nLength - 1] = pSrc[nLength - 1];
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: copies a match of 'nLength' bytes from 'nDistance' bytes back, 
+//          writing the same bytes as the 8 byte step loop of the reference 
+//          decoder (i.e. rounded up to a multiple of 8)
+//-----------------------------------------------------------------------------
+static FORCEINLINE void RTech_CopyMatch(uint8_t* pDst, size_t nDistance, size_t nLength)
+{
+	const uint8_t* pSrc = pDst - nDistance;
+	const size_t nTotal = (nLength + 7) & ~size_t(7);
+	size_t i = 0;
+
+	if (nDistance >= 16) // Every 16 byte read only touches bytes that are already final.
+	{
+		for (; i + 32 <= nTotal; i += 32)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i + 16), _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i + 16)));
+		}
+		if (i + 16 <= nTotal)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i)));
+			i += 16;
+		}
+	}
+	for (; i < nTotal; i += 8)
+	{
+		*reinterpret_cast<uint64_t*>(pDst + i) = *reinterpret_cast<const uint64_t*>(pSrc + i);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: fills 'nLength' bytes (rounded up to a multiple of 8) with one byte
+//-----------------------------------------------------------------------------
+static FORCEINLINE void RTech_FillMatch(uint8_t* pDst, uint8_t nValue, size_t nLength)
+{
+	const size_t nTotal = (nLength + 7) & ~size_t(7);
+	const __m128i vValue = _mm_set1_epi8(static_cast<char>(nValue));
+	size_t i = 0;
+
+	for (; i + 16 <= nTotal; i += 16)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), vValue);
+	}
+	if (i < nTotal)
+	{
+		*reinterpret_cast<uint64_t*>(pDst + i) = 0x101010101010101ull * nValue;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: decompress input data; same format and output as the reference 
+//          decoder, restructured for throughput. Only handles linear input 
+//          and output buffers, masked (ring) buffers use the reference.
+//-----------------------------------------------------------------------------
+uint8_t RTech_DecompressPakFile(RPakDecompState_t* state, uint64_t inLen, uint64_t outLen)
+{
+	if (state->m_nMask != UINT64_MAX || state->m_nOutMask != UINT64_MAX)
+		return RTech_DecompressPakFileRef(state, inLen, outLen);
+
+	if (inLen < state->m_nLengthNeeded)
+		return 0;
+
+	uint64_t outPos = state->m_nDecompPosition;
+	if (outLen < state->m_nInvMaskOut + (outPos & ~state->m_nInvMaskOut) + 1 && outLen < state->m_nDecompSize)
+		return 0;
+
+	const RPakDecodeTables_t* const pTables = RTech_GetDecodeTables();
+	const uint8_t* const pIn = reinterpret_cast<const uint8_t*>(state->m_nInputBuf);
+	uint8_t* const pOut = reinterpret_cast<uint8_t*>(state->m_nOut);
+
+	const uint64_t nInvMaskIn = state->m_nInvMaskIn;
+	const uint64_t nInvMaskOut = state->m_nInvMaskOut;
+	const uint64_t nDecompSize = state->m_nDecompSize;
+
+	uint32_t bitOff = state->byte_bit_offset; // Bits consumed since the last refill (+ sub-byte remainder).
+	uint64_t bits = state->byte;              // Bit buffer, next bit is the LSB.
+	uint64_t inPos = state->input_byte_pos;
+	uint32_t ctx = state->dword6C;            // 1 if the previous token was a literal run.
+
+	uint64_t inLimit = state->qword70;
+	if (state->m_nCompressedStreamSize < inLimit)
+		inLimit = state->m_nCompressedStreamSize;
+
+	// Refill: splice the next 8 input bytes above the remaining bits, then 
+	// advance by the whole bytes consumed. No branches, bitOff is never 0 here.
+#define RPAK_REFILL()                                                          \
+	{                                                                          \
+		const uint64_t nFill = (*reinterpret_cast<const uint64_t*>(pIn + inPos) << (64 - (uint8_t)bitOff)) | bits; \
+		inPos += bitOff >> 3;                                                  \
+		bitOff &= 7;                                                           \
+		bits = (UINT64_MAX >> bitOff) & nFill;                                 \
+	}
+
+	if (bitOff)
+		RPAK_REFILL();
+
+	for (;;)
+	{
+		const RPakDecodeTables_t::Token_t token = pTables->m_Token[(uint8_t)bits | (ctx << 8)];
+		const uint32_t prevCtx = ctx;
+
+		bitOff += token.m_nBits;
+		bits >>= token.m_nBits;
+
+		if (token.m_nLength < 0) // Literal run.
+		{
+			uint32_t nLength = -(int32_t)token.m_nLength;
+			ctx = 1;
+
+			if (nLength == pTables->m_LongLiteral[prevCtx])
+			{
+				if ((~inPos & nInvMaskIn) < 0xF
+					|| (nInvMaskOut & ~outPos) < 0xF
+					|| nDecompSize - outPos < 0x10)
+				{
+					nLength = 1;
+				}
+
+				const RPakDecodeTables_t::Length_t* pLength = &pTables->m_Length3[bits & 7];
+				bits >>= 3;
+
+				if (!pLength->m_nBase && !pLength->m_nBits) // 3 bit code 0 escapes to a 4 bit code.
+				{
+					pLength = &pTables->m_Length4[bits & 15];
+					bits >>= 4;
+					bitOff += 4;
+				}
+
+				bitOff += pLength->m_nBits + 3;
+				nLength += pLength->m_nBase + (uint32_t)(bits & ((1ull << pLength->m_nBits) - 1));
+				bits >>= pLength->m_nBits;
+
+				RTech_CopyLiteral(pOut + outPos, pIn + inPos, nLength);
+			}
+			else
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + outPos), _mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + inPos)));
+			}
+
+			inPos += nLength;
+			outPos += nLength;
+		}
+		else // Match.
+		{
+			ctx = 0;
+
+			const uint32_t nCode = bits & 0xF;
+			const uint32_t nSelShift = (nCode == 15) ? 6 : 4;
+			const uint32_t nExtra = (uint32_t)(bits >> 4) & ((nCode == 15) ? 3 : 0);
+			const RPakDecodeTables_t::Distance_t dist = pTables->m_Distance[((uint32_t)bits >> nSelShift) & 0x3F];
+
+			const uint32_t nHigh = 1u << (nCode + nExtra);
+			const uint32_t nLowShift = nSelShift + dist.m_nBits;
+
+			const uint32_t nDistance = 16 * (nHigh + ((nHigh - 1) & (uint32_t)(bits >> nLowShift))) + dist.m_nLow - 16;
+
+			bitOff += nLowShift + nCode + nExtra;
+			bits >>= nLowShift + nCode + nExtra;
+
+			uint8_t* const pDst = pOut + outPos;
+
+			if (token.m_nLength == 17) // Long match, length follows.
+			{
+				uint32_t nBase;
+				uint32_t nLengthBits;
+				uint64_t lengthBits;
+
+				if (bits & 7)
+				{
+					nBase = pTables->m_Length3[bits & 7].m_nBase;
+					nLengthBits = pTables->m_Length3[bits & 7].m_nBits;
+					lengthBits = bits >> 3;
+				}
+				else
+				{
+					bitOff += 4;
+					nBase = pTables->m_Length4[(bits >> 3) & 15].m_nBase;
+					nLengthBits = pTables->m_Length4[(bits >> 3) & 15].m_nBits;
+					lengthBits = bits >> 7;
+
+					// The longest codes can run past the bit buffer, pull in one more byte.
+					if (bitOff + nLengthBits >= 0x3D)
+					{
+						lengthBits |= (uint64_t)pIn[inPos++] << (61 - (uint8_t)bitOff);
+						bitOff -= 8;
+					}
+				}
+
+				bitOff += nLengthBits + 3;
+				bits = lengthBits >> nLengthBits;
+
+				const uint64_t nLength = ((uint32_t)lengthBits & ((1u << nLengthBits) - 1)) + nBase + 17;
+				outPos += nLength;
+
+				if (nDistance < 8)
+				{
+					const uint32_t nShortLength = (uint32_t)nLength - 13;
+					outPos -= 13;
+
+					if (nDistance == 1)
+					{
+						RTech_FillMatch(pDst, pDst[-1], nShortLength);
+					}
+					else
+					{
+						for (uint32_t i = 0; i < nShortLength; i++)
+							pDst[i] = pDst[(int64_t)i - nDistance];
+					}
+				}
+				else
+				{
+					RTech_CopyMatch(pDst, nDistance, (uint32_t)nLength);
+				}
+			}
+			else
+			{
+				const uint64_t* pSrc = reinterpret_cast<const uint64_t*>(pDst - nDistance);
+
+				outPos += token.m_nLength;
+				*reinterpret_cast<uint64_t*>(pDst) = pSrc[0];
+				*reinterpret_cast<uint64_t*>(pDst + 8) = pSrc[1];
+			}
+		}
+
+		if (inPos < inLimit)
+		{
+			RPAK_REFILL();
+			continue;
+		}
+
+		// End of the current input window; either the stream is done, the 
+		// next stream block starts, or we need to move to the next window.
+		if (outPos == state->m_nDecompStreamSize)
+		{
+			if (outPos == nDecompSize)
+			{
+				state->input_byte_pos = inPos;
+				state->m_nDecompPosition = outPos;
+				return 1;
+			}
+
+			const uint64_t nHeaderSkip = state->header_skip_bytes_bs;
+			const uint64_t nAlign = nInvMaskIn & -(int64_t)inPos;
+
+			bits >>= 1;
+			++bitOff;
+
+			if (nHeaderSkip > nAlign)
+			{
+				inPos += nAlign;
+				if (inPos > state->qword70)
+					state->qword70 = nInvMaskIn + state->qword70 + 1;
+			}
+
+			const uint64_t nBlockHeader = *reinterpret_cast<const uint64_t*>(pIn + inPos) & ((1LL << (8 * (uint8_t)nHeaderSkip)) - 1);
+			inPos += nHeaderSkip;
+
+			uint64_t nStreamDecompSize = outPos + nInvMaskOut + 1;
+			const uint64_t nLengthNeeded = nBlockHeader + state->m_nLengthNeeded;
+			const uint64_t nStreamCompSize = nBlockHeader + state->m_nCompressedStreamSize;
+
+			state->m_nLengthNeeded = nLengthNeeded;
+			state->m_nCompressedStreamSize = nStreamCompSize;
+
+			if (nStreamDecompSize >= nDecompSize)
+			{
+				nStreamDecompSize = nDecompSize;
+				state->m_nCompressedStreamSize = nHeaderSkip + nStreamCompSize;
+			}
+
+			state->m_nDecompStreamSize = nStreamDecompSize;
+
+			if (inLen < nLengthNeeded || outLen < nStreamDecompSize)
+			{
+				if (inPos >= state->qword70)
+				{
+					inPos = ~nInvMaskIn & (inPos + 7);
+					state->qword70 = state->qword70 + nInvMaskIn + 1;
+				}
+
+				state->dword6C = ctx;
+				state->input_byte_pos = inPos;
+				state->m_nDecompPosition = outPos;
+				state->byte = bits;
+				state->byte_bit_offset = bitOff;
+
+				return 0;
+			}
+		}
+
+		inLimit = state->qword70;
+		if (inPos >= inLimit)
+		{
+			inPos = ~nInvMaskIn & (inPos + 7);
+			inLimit += nInvMaskIn + 1;
+			state->qword70 = inLimit;
+		}
+		if (state->m_nCompressedStreamSize < inLimit)
+			inLimit = state->m_nCompressedStreamSize;
+
+		RPAK_REFILL();
+	}
+
+#undef RPAK_REFILL
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: reads and validates the header of a compressed pak
+// Input  : *pInput - 
+//          nInputSize - 
+//          &header - 
+//          bVerifySize - 
+// Output : PAK_DECOMP_SUCCESS if the pak can be decompressed
+//-----------------------------------------------------------------------------
+RPakDecompStatus_t RTech_ReadPakHeader(const uint8_t* pInput, uint64_t nInputSize, RPakHeader_t& header, bool bVerifySize)
+{
+	if (nInputSize < sizeof(RPakHeader_t))
+	{
+		return RPakDecompStatus_t::PAK_DECOMP_SIZE_MISMATCH;
+	}
+
+	memcpy(&header, pInput, sizeof(RPakHeader_t));
+
+	if (header.m_nMagic != RPAKHEADER)
+	{
+		return RPakDecompStatus_t::PAK_DECOMP_INVALID_MAGIC;
+	}
+	if ((header.m_nFlags[1] & 1) != 1)
+	{
+		return RPakDecompStatus_t::PAK_DECOMP_NOT_COMPRESSED;
+	}
+	if (bVerifySize && header.m_nSizeDisk != nInputSize)
+	{
+		return RPakDecompStatus_t::PAK_DECOMP_SIZE_MISMATCH;
+	}
+
+	return RPakDecompStatus_t::PAK_DECOMP_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: decompresses a pak from memory into memory
+// Input  : *pInput - compressed pak, must have RPAK_DECOMP_PADDING bytes of slack
+//          nInputSize - size of the compressed pak without the slack
+//          *pOutput - at least 'm_nSizeMemory + RPAK_DECOMP_PADDING' bytes
+//          nOutputSize - 
+//          &result - 
+//          nFlags - 
+// Output : PAK_DECOMP_SUCCESS on success
+//-----------------------------------------------------------------------------
+RPakDecompStatus_t RTech_DecompressPak(uint8_t* pInput, uint64_t nInputSize, uint8_t* pOutput, uint64_t nOutputSize, RPakDecompResult_t& result, int nFlags)
+{
+	RPakHeader_t& header = result.m_Header;
+	result.m_nInputSize = nInputSize;
+
+	result.m_nStatus = RTech_ReadPakHeader(pInput, nInputSize, header, (nFlags & PAK_DECOMP_VERIFY_SIZE) != 0);
+	if (result.m_nStatus != RPakDecompStatus_t::PAK_DECOMP_SUCCESS)
+	{
+		return result.m_nStatus;
+	}
+
+	if (nOutputSize < header.m_nSizeMemory + RPAK_DECOMP_PADDING)
+	{
+		result.m_nStatus = RPakDecompStatus_t::PAK_DECOMP_SIZE_MISMATCH;
+		return result.m_nStatus;
+	}
+
+	RPakDecompState_t state;
+	const uint64_t nDecompSize = RTech_DecompressPakFileInit(&state, pInput, nInputSize, NULL, sizeof(RPakHeader_t));
+
+	// The decoder never checks the output bounds, the header has to be trusted.
+	if (nDecompSize > header.m_nSizeMemory || ((nFlags & PAK_DECOMP_VERIFY_SIZE) && nDecompSize != header.m_nSizeMemory))
+	{
+		result.m_nDecompSize = nDecompSize;
+		result.m_nStatus = RPakDecompStatus_t::PAK_DECOMP_SIZE_MISMATCH;
+		return result.m_nStatus;
+	}
+
+	state.m_nOutMask = UINT64_MAX;
+	state.m_nOut = uint64_t(pOutput);
+
+	const uint8_t nDecompResult = (nFlags & PAK_DECOMP_REFERENCE)
+		? RTech_DecompressPakFileRef(&state, nInputSize, header.m_nSizeMemory)
+		: RTech_DecompressPakFile(&state, nInputSize, header.m_nSizeMemory);
+
+	if (nDecompResult != 1)
+	{
+		result.m_nStatus = RPakDecompStatus_t::PAK_DECOMP_FAILED;
+		return result.m_nStatus;
+	}
+
+	result.m_nDecompSize = state.m_nDecompSize;
+
+	RPakHeader_t outHeader = header;
+	outHeader.m_nFlags[1] = 0x0; // Set compressed flag to false for the decompressed pak file.
+	outHeader.m_nSizeDisk = outHeader.m_nSizeMemory; // Equal compressed size with decompressed.
+
+	if (outHeader.m_nPatchIndex > 0) // Check if its an patch rpak.
+	{
+		// Loop through all the structs and patch their compress size.
+		for (uint64_t i = 1, patch_offset = 0x88; i <= outHeader.m_nPatchIndex
+			&& patch_offset + sizeof(RPakPatchCompressedHeader_t) <= result.m_nDecompSize; i++, patch_offset += sizeof(RPakPatchCompressedHeader_t))
+		{
+			RPakPatchCompressedHeader_t* patch_header = reinterpret_cast<RPakPatchCompressedHeader_t*>(pOutput + patch_offset);
+			patch_header->m_nSizeDisk = patch_header->m_nSizeMemory; // Fix size for decompress.
+		}
+	}
+
+	memcpy(pOutput, &outHeader, sizeof(RPakHeader_t)); // Overwrite first 0x80 bytes which are NULL with the header data.
+
+	if (nFlags & PAK_DECOMP_COMPUTE_CRC)
+	{
+		result.m_nCrc32 = crc32::update(NULL, pOutput, result.m_nDecompSize);
+	}
+
+	return result.m_nStatus;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: decompresses a pak file on disk, the output is decoded straight 
+//          into a mapped view of the output file
+// Input  : &svPathIn - 
+//          &svPathOut - 
+//          &result - 
+//          nFlags - 
+// Output : PAK_DECOMP_SUCCESS on success
+//-----------------------------------------------------------------------------
+RPakDecompStatus_t RTech_DecompressPakToFile(const string& svPathIn, const string& svPathOut, RPakDecompResult_t& result, int nFlags)
+{
+	result = RPakDecompResult_t();
+
+	std::ifstream iStream(svPathIn, std::ios::binary | std::ios::ate);
+	if (!iStream.is_open())
+	{
+		result.m_nStatus = RPakDecompStatus_t::PAK_DECOMP_OPEN_FAILED;
+		return result.m_nStatus;
+	}
+
+	const uint64_t nInputSize = static_cast<uint64_t>(iStream.tellg());
+	vector<uint8_t> vInput(nInputSize + RPAK_DECOMP_PADDING, 0);
+
+	iStream.seekg(0, std::ios::beg);
+	if (!iStream.read(reinterpret_cast<char*>(vInput.data()), nInputSize))
+	{
+		result.m_nStatus = RPakDecompStatus_t::PAK_DECOMP_OPEN_FAILED;
+		return result.m_nStatus;
+	}
+	iStream.close();
+
+	result.m_nInputSize = nInputSize;
+	result.m_nStatus = RTech_ReadPakHeader(vInput.data(), nInputSize, result.m_Header, (nFlags & PAK_DECOMP_VERIFY_SIZE) != 0);
+
+	if (result.m_nStatus != RPakDecompStatus_t::PAK_DECOMP_SUCCESS)
+	{
+		return result.m_nStatus;
+	}
+
+	std::error_code ec;
+	fs::create_directories(fs::path(svPathOut).parent_path(), ec);
+
+	const uint64_t nOutputSize = result.m_Header.m_nSizeMemory + RPAK_DECOMP_PADDING;
+	CMappedFile outFile;
+
+	if (!outFile.Create(svPathOut, nOutputSize))
+	{
+		result.m_nStatus = RPakDecompStatus_t::PAK_DECOMP_WRITE_FAILED;
+		return result.m_nStatus;
+	}
+
+	if (RTech_DecompressPak(vInput.data(), nInputSize, outFile.GetWritableData(), nOutputSize, result, nFlags) != RPakDecompStatus_t::PAK_DECOMP_SUCCESS)
+	{
+		outFile.Close();
+		fs::remove(svPathOut, ec);
+
+		return result.m_nStatus;
+	}
+
+	if (!outFile.Commit(result.m_nDecompSize))
+	{
+		fs::remove(svPathOut, ec);
+		result.m_nStatus = RPakDecompStatus_t::PAK_DECOMP_WRITE_FAILED;
+	}
+
+	return result.m_nStatus;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: decompresses a batch of pak files in parallel
+// Input  : &vJobs - 
+//          nThreads - worker count, <= 0 for one per hardware thread
+//          nFlags - 
+//          fnOnComplete - optional, called once per finished job (serialized)
+// Output : number of successfully decompressed paks
+//-----------------------------------------------------------------------------
+size_t RTech_DecompressPakBatch(vector<RPakDecompJob_t>& vJobs, int nThreads, int nFlags, const std::function<void(const RPakDecompJob_t&)>& fnOnComplete)
+{
+	if (vJobs.empty())
+	{
+		return 0;
+	}
+
+	if (nThreads <= 0)
+	{
+		nThreads = static_cast<int>(std::thread::hardware_concurrency());
+	}
+	nThreads = static_cast<int>(std::min<size_t>(std::max<int>(nThreads, 1), vJobs.size()));
+
+	std::atomic<size_t> nNextJob(0);
+	std::atomic<size_t> nSucceeded(0);
+	std::mutex completeMutex;
+
+	auto fnWorker = [&]()
+	{
+		for (size_t i = nNextJob++; i < vJobs.size(); i = nNextJob++)
+		{
+			RPakDecompJob_t& job = vJobs[i];
+
+			if (RTech_DecompressPakToFile(job.m_svPathIn, job.m_svPathOut, job.m_Result, nFlags) == RPakDecompStatus_t::PAK_DECOMP_SUCCESS)
+			{
+				nSucceeded++;
+			}
+			if (fnOnComplete)
+			{
+				std::lock_guard<std::mutex> lock(completeMutex);
+				fnOnComplete(job);
+			}
+		}
+	};
+
+	vector<std::thread> vWorkers;
+	for (int i = 1; i < nThreads; i++)
+	{
+		vWorkers.emplace_back(fnWorker);
+	}
+
+	fnWorker();
+
+	for (std::thread& worker : vWorkers)
+	{
+		worker.join();
+	}
+
+	return nSucceeded;
+}
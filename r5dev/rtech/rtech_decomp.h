@@ -0,0 +1,160 @@
+#pragma once
+
+#define RPAKHEADER	(('k'<<24)+('a'<<16)+('P'<<8)+'R')
+#define RPAK_DECOMP_PADDING 0x40 // Slack past the end of the input and output buffers, the decoder reads and writes in qwords.
+
+/*unk_141313180*/
+// LUT_0 redacted now, split LUT into multiple parts.
+#pragma warning( push )
+#pragma warning( disable : 4309)
+#pragma warning( disable : 4838)
+inline std::array<int8_t, 512> LUT_0
+	{
+		4, 254, 252, 8, 4, 239, 17, 249, 4, 253, 252, 7, 4, 5, 255, 244, 4, 254, 252, 16, 4, 239, 17, 246, 4, 253, 252, 251, 4, 6, 255, 11, 4, 254, 252, 8, 4, 239, 17, 248, 4, 253, 252, 12, 4, 5, 255, 247, 4, 254, 252, 16, 4, 239, 17, 245, 4, 253, 252, 250, 4, 6, 255, 243, 4, 254, 252, 8, 4, 239, 17, 249, 4, 253, 252, 7, 4, 5, 255, 244, 4, 254, 252, 16, 4, 239, 17, 246, 4, 253, 252, 251, 4, 6, 255, 14, 4, 254, 252, 8, 4, 239, 17, 248, 4, 253, 252, 12, 4, 5, 255, 9, 4, 254, 252, 16, 4, 239, 17, 245, 4, 253, 252, 250, 4, 6, 255, 241, 4, 254, 252, 8, 4, 239, 17, 249, 4, 253, 252, 7, 4, 5, 255, 244, 4, 254, 252, 16, 4, 239, 17, 246, 4, 253, 252, 251, 4, 6, 255, 13, 4, 254, 252, 8, 4, 239, 17, 248, 4, 253, 252, 12, 4, 5, 255, 247, 4, 254, 252, 16, 4, 239, 17, 245, 4, 253, 252, 250, 4, 6, 255, 242, 4, 254, 252, 8, 4, 239, 17, 249, 4, 253, 252, 7, 4, 5, 255, 244, 4, 254, 252, 16, 4, 239, 17, 246, 4, 253, 252, 251, 4, 6, 255, 15, 4, 254, 252, 8, 4, 239, 17, 248, 4, 253, 252, 12, 4, 5, 255, 10, 4, 254, 252, 16, 4, 239, 17, 245, 4, 253, 252, 250, 4, 6, 255, 240, 4, 5, 4, 6, 4, 5, 4, 7, 4, 5, 4, 6, 4, 5, 4, 17, 4, 5, 4, 6, 4, 5, 4, 8, 4, 5, 4, 6, 4, 5, 4, 12, 4, 5, 4, 6, 4, 5, 4, 7, 4, 5, 4, 6, 4, 5, 4, 9, 4, 5, 4, 6, 4, 5, 4, 8, 4, 5, 4, 6, 4, 5, 4, 14, 4, 5, 4, 6, 4, 5, 4, 7, 4, 5, 4, 6, 4, 5, 4, 17, 4, 5, 4, 6, 4, 5, 4, 8, 4, 5, 4, 6, 4, 5, 4, 11, 4, 5, 4, 6, 4, 5, 4, 7, 4, 5, 4, 6, 4, 5, 4, 10, 4, 5, 4, 6, 4, 5, 4, 8, 4, 5, 4, 6, 4, 5, 4, 16, 4, 5, 4, 6, 4, 5, 4, 7, 4, 5, 4, 6, 4, 5, 4, 17, 4, 5, 4, 6, 4, 5, 4, 8, 4, 5, 4, 6, 4, 5, 4, 12, 4, 5, 4, 6, 4, 5, 4, 7, 4, 5, 4, 6, 4, 5, 4, 9, 4, 5, 4, 6, 4, 5, 4, 8, 4, 5, 4, 6, 4, 5, 4, 15, 4, 5, 4, 6, 4, 5, 4, 7, 4, 5, 4, 6, 4, 5, 4, 17, 4, 5, 4, 6, 4, 5, 4, 8, 4, 5, 4, 6, 4, 5, 4, 13, 4, 5, 4, 6, 4, 5, 4, 7, 4, 5, 4, 6, 4, 5, 4, 10, 4, 5, 4, 6, 4, 5, 4, 8, 4, 5, 4, 6, 4, 5, 4, 255
+	};
+inline std::array<uint8_t, 512> LUT_200
+	{
+		2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 6, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 8, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 7, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 8, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 6, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 8, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 8, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 8, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 6, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 8, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 7, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 8, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 6, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 8, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 8, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 8, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 6, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 7, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 7, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 8, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 6, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 8, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 7, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 8, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 6, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 7, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 7, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 8, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 6, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 8, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 7, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 8
+	};
+inline std::array<uint8_t, 0x40> LUT_400
+	{
+		0, 8, 0, 4, 0, 8, 0, 6, 0, 8, 0, 1, 0, 8, 0, 11, 0, 8, 0, 12, 0, 8, 0, 9, 0, 8, 0, 3, 0, 8, 0, 14, 0, 8, 0, 4, 0, 8, 0, 7, 0, 8, 0, 2, 0, 8, 0, 13, 0, 8, 0, 12, 0, 8, 0, 10, 0, 8, 0, 5, 0, 8, 0, 15
+	};
+inline std::array<uint8_t, 0x40> LUT_440
+	{
+		1, 2, 1, 5, 1, 2, 1, 6, 1, 2, 1, 6, 1, 2, 1, 6, 1, 2, 1, 5, 1, 2, 1, 6, 1, 2, 1, 6, 1, 2, 1, 6, 1, 2, 1, 5, 1, 2, 1, 6, 1, 2, 1, 6, 1, 2, 1, 6, 1, 2, 1, 5, 1, 2, 1, 6, 1, 2, 1, 6, 1, 2, 1, 6
+	};
+inline std::array<uint32_t, 16> LUT_480
+	{
+		74, 106, 138, 170, 202, 234, 266, 298, 330, 362, 394, 426, 938, 1450, 9642, 140714
+	};
+inline std::array<uint8_t, 16> LUT_4C0
+	{
+		5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 9, 9, 13, 17, 21
+	};
+inline std::array<uint8_t, 8> LUT_4D0
+	{
+		0, 0, 2, 4, 6, 8, 10, 42
+	};
+inline std::array<uint8_t, 8> LUT_4D8
+	{
+		0, 1, 1, 1, 1, 1, 5, 5
+	};
+inline std::array<uint8_t, 32> LUT_4E0
+	{
+		17, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+	};
+#pragma warning( pop ) 
+
+struct RPakHeader_t
+{
+	uint32_t m_nMagic;                     // 'RPak'
+	uint16_t m_nVersion;                   // R2 = '7' R5 = '8'
+	uint8_t  m_nFlags[0x2];                //
+	uint8_t  m_nHash0[0x8];                //
+	uint8_t  m_nHash1[0x8];                //
+	uint64_t m_nSizeDisk;                  // Compressed size
+	uint64_t m_nEmbeddedStarpakOffset;     //
+	uint8_t  unk0[0x8];                    //
+	uint64_t m_nSizeMemory;                // Decompressed size
+	uint64_t m_nEmbeddedStarpakSize;       //
+	uint8_t  unk1[0x8];                    //
+
+	uint16_t m_nStarpakReferenceSize;      //
+	uint16_t m_nStarpakOptReferenceSize;   //
+	uint16_t m_nVirtualSegmentCount;       // * 0x10
+	uint16_t m_nMemPageCount;              // * 0xC
+
+	uint32_t m_nPatchIndex;                //
+
+	uint32_t m_nDescriptorCount;           //
+	uint32_t m_nAssetEntryCount;           // File entry count
+	uint32_t m_nGuidDescriptorCount;       //
+	uint32_t m_nRelationsCounts;           //
+
+	uint8_t  unk2[0x10];                   //
+	uint32_t m_nMemPageOffset;             // Size not verified. Offsets every page by x amount, if not 0 start of first page has data corresponding for 'patching some page'
+	uint8_t  unk3[0x8];                    //
+};
+
+struct __declspec(align(8)) RPakPatchCompressedHeader_t
+{
+	uint64_t m_nSizeDisk;
+	uint64_t m_nSizeMemory;
+};
+
+struct __declspec(align(8)) RPakDecompState_t
+{
+	uint64_t m_nInputBuf;
+	uint64_t m_nOut;
+	uint64_t m_nMask;
+	uint64_t m_nOutMask;
+	uint64_t m_nTotalFileLen;
+	uint64_t m_nDecompSize;
+	uint64_t m_nInvMaskIn;
+	uint64_t m_nInvMaskOut;
+	uint32_t header_skip_bytes_bs;
+	uint32_t dword44;
+	uint64_t input_byte_pos;
+	uint64_t m_nDecompPosition;
+	uint64_t m_nLengthNeeded;
+	uint64_t byte;
+	uint32_t byte_bit_offset;
+	uint32_t dword6C;
+	uint64_t qword70;
+	uint64_t m_nCompressedStreamSize;
+	uint64_t m_nDecompStreamSize;
+};
+
+enum class RPakDecompStatus_t : int32_t
+{
+	PAK_DECOMP_SUCCESS = 0,
+	PAK_DECOMP_OPEN_FAILED,
+	PAK_DECOMP_INVALID_MAGIC,
+	PAK_DECOMP_NOT_COMPRESSED,
+	PAK_DECOMP_SIZE_MISMATCH,
+	PAK_DECOMP_FAILED,
+	PAK_DECOMP_WRITE_FAILED
+};
+
+const std::map<RPakDecompStatus_t, string> RPakDecompStatusToString {
+	{ RPakDecompStatus_t::PAK_DECOMP_SUCCESS,        "PAK_DECOMP_SUCCESS" },
+	{ RPakDecompStatus_t::PAK_DECOMP_OPEN_FAILED,    "PAK_DECOMP_OPEN_FAILED" },
+	{ RPakDecompStatus_t::PAK_DECOMP_INVALID_MAGIC,  "PAK_DECOMP_INVALID_MAGIC" },
+	{ RPakDecompStatus_t::PAK_DECOMP_NOT_COMPRESSED, "PAK_DECOMP_NOT_COMPRESSED" },
+	{ RPakDecompStatus_t::PAK_DECOMP_SIZE_MISMATCH,  "PAK_DECOMP_SIZE_MISMATCH" },
+	{ RPakDecompStatus_t::PAK_DECOMP_FAILED,         "PAK_DECOMP_FAILED" },
+	{ RPakDecompStatus_t::PAK_DECOMP_WRITE_FAILED,   "PAK_DECOMP_WRITE_FAILED" },
+};
+
+enum RPakDecompFlags_t : int32_t
+{
+	PAK_DECOMP_VERIFY_SIZE = 1 << 0, // Check disk and memory sizes against the pak header.
+	PAK_DECOMP_COMPUTE_CRC = 1 << 1, // Calculate the crc32 of the decompressed pak.
+	PAK_DECOMP_REFERENCE   = 1 << 2  // Use the reference decoder instead of the optimized one.
+};
+
+struct RPakDecompResult_t
+{
+	RPakDecompStatus_t m_nStatus    {}; // Result of the operation.
+	RPakHeader_t       m_Header     {}; // Header as read from the compressed pak.
+	uint64_t           m_nInputSize {}; // Size of the compressed pak on disk.
+	uint64_t           m_nDecompSize{}; // Size produced by the decoder.
+	uint32_t           m_nCrc32     {}; // Crc32 of the decompressed pak (PAK_DECOMP_COMPUTE_CRC only).
+};
+
+struct RPakDecompJob_t
+{
+	string             m_svPathIn   {}; // Compressed pak file.
+	string             m_svPathOut  {}; // Decompressed pak file.
+	RPakDecompResult_t m_Result     {}; // Filled in once the job finished.
+};
+
+uint64_t RTech_DecompressPakFileInit(RPakDecompState_t* state, uint8_t* fileBuffer, uint64_t fileSize, uint64_t offNoHeader, uint64_t headerSize);
+uint8_t RTech_DecompressPakFile(RPakDecompState_t* state, uint64_t inLen, uint64_t outLen);
+uint8_t RTech_DecompressPakFileRef(RPakDecompState_t* state, uint64_t inLen, uint64_t outLen);
+
+RPakDecompStatus_t RTech_ReadPakHeader(const uint8_t* pInput, uint64_t nInputSize, RPakHeader_t& header, bool bVerifySize);
+RPakDecompStatus_t RTech_DecompressPak(uint8_t* pInput, uint64_t nInputSize, uint8_t* pOutput, uint64_t nOutputSize, RPakDecompResult_t& result, int nFlags);
+RPakDecompStatus_t RTech_DecompressPakToFile(const string& svPathIn, const string& svPathOut, RPakDecompResult_t& result, int nFlags);
+size_t RTech_DecompressPakBatch(vector<RPakDecompJob_t>& vJobs, int nThreads, int nFlags, const std::function<void(const RPakDecompJob_t&)>& fnOnComplete = nullptr);
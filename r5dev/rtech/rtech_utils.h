@@ -2,55 +2,11 @@
 #include "tier0/jobthread.h"
 #include "vpklib/packedstore.h"
 #include "rtech/rtech_game.h"
+#include "rtech/rtech_decomp.h"
 
 #define PAK_PARAM_SIZE    0xB0
 #define DCMP_BUF_SIZE 0x400000
 
-#define RPAKHEADER	(('k'<<24)+('a'<<16)+('P'<<8)+'R')
-
-/*unk_141313180*/
-// LUT_0 redacted now, split LUT into multiple parts.
-#pragma warning( push )
-#pragma warning( disable : 4309)
-#pragma warning( disable : 4838)
-inline std::array<int8_t, 512> LUT_0
-	{
-		4, 254, 252, 8, 4, 239, 17, 249, 4, 253, 252, 7, 4, 5, 255, 244, 4, 254, 252, 16, 4, 239, 17, 246, 4, 253, 252, 251, 4, 6, 255, 11, 4, 254, 252, 8, 4, 239, 17, 248, 4, 253, 252, 12, 4, 5, 255, 247, 4, 254, 252, 16, 4, 239, 17, 245, 4, 253, 252, 250, 4, 6, 255, 243, 4, 254, 252, 8, 4, 239, 17, 249, 4, 253, 252, 7, 4, 5, 255, 244, 4, 254, 252, 16, 4, 239, 17, 246, 4, 253, 252, 251, 4, 6, 255, 14, 4, 254, 252, 8, 4, 239, 17, 248, 4, 253, 252, 12, 4, 5, 255, 9, 4, 254, 252, 16, 4, 239, 17, 245, 4, 253, 252, 250, 4, 6, 255, 241, 4, 254, 252, 8, 4, 239, 17, 249, 4, 253, 252, 7, 4, 5, 255, 244, 4, 254, 252, 16, 4, 239, 17, 246, 4, 253, 252, 251, 4, 6, 255, 13, 4, 254, 252, 8, 4, 239, 17, 248, 4, 253, 252, 12, 4, 5, 255, 247, 4, 254, 252, 16, 4, 239, 17, 245, 4, 253, 252, 250, 4, 6, 255, 242, 4, 254, 252, 8, 4, 239, 17, 249, 4, 253, 252, 7, 4, 5, 255, 244, 4, 254, 252, 16, 4, 239, 17, 246, 4, 253, 252, 251, 4, 6, 255, 15, 4, 254, 252, 8, 4, 239, 17, 248, 4, 253, 252, 12, 4, 5, 255, 10, 4, 254, 252, 16, 4, 239, 17, 245, 4, 253, 252, 250, 4, 6, 255, 240, 4, 5, 4, 6, 4, 5, 4, 7, 4, 5, 4, 6, 4, 5, 4, 17, 4, 5, 4, 6, 4, 5, 4, 8, 4, 5, 4, 6, 4, 5, 4, 12, 4, 5, 4, 6, 4, 5, 4, 7, 4, 5, 4, 6, 4, 5, 4, 9, 4, 5, 4, 6, 4, 5, 4, 8, 4, 5, 4, 6, 4, 5, 4, 14, 4, 5, 4, 6, 4, 5, 4, 7, 4, 5, 4, 6, 4, 5, 4, 17, 4, 5, 4, 6, 4, 5, 4, 8, 4, 5, 4, 6, 4, 5, 4, 11, 4, 5, 4, 6, 4, 5, 4, 7, 4, 5, 4, 6, 4, 5, 4, 10, 4, 5, 4, 6, 4, 5, 4, 8, 4, 5, 4, 6, 4, 5, 4, 16, 4, 5, 4, 6, 4, 5, 4, 7, 4, 5, 4, 6, 4, 5, 4, 17, 4, 5, 4, 6, 4, 5, 4, 8, 4, 5, 4, 6, 4, 5, 4, 12, 4, 5, 4, 6, 4, 5, 4, 7, 4, 5, 4, 6, 4, 5, 4, 9, 4, 5, 4, 6, 4, 5, 4, 8, 4, 5, 4, 6, 4, 5, 4, 15, 4, 5, 4, 6, 4, 5, 4, 7, 4, 5, 4, 6, 4, 5, 4, 17, 4, 5, 4, 6, 4, 5, 4, 8, 4, 5, 4, 6, 4, 5, 4, 13, 4, 5, 4, 6, 4, 5, 4, 7, 4, 5, 4, 6, 4, 5, 4, 10, 4, 5, 4, 6, 4, 5, 4, 8, 4, 5, 4, 6, 4, 5, 4, 255
-	};
-inline std::array<uint8_t, 512> LUT_200
-	{
-		2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 6, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 8, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 7, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 8, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 6, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 8, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 8, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 8, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 6, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 8, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 7, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 8, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 6, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 8, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 8, 2, 4, 3, 5, 2, 4, 4, 6, 2, 4, 3, 6, 2, 5, 4, 8, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 6, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 7, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 7, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 8, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 6, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 8, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 7, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 8, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 6, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 7, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 7, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 8, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 6, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 8, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 7, 1, 2, 1, 3, 1, 2, 1, 5, 1, 2, 1, 3, 1, 2, 1, 8
-	};
-inline std::array<uint8_t, 0x40> LUT_400
-	{
-		0, 8, 0, 4, 0, 8, 0, 6, 0, 8, 0, 1, 0, 8, 0, 11, 0, 8, 0, 12, 0, 8, 0, 9, 0, 8, 0, 3, 0, 8, 0, 14, 0, 8, 0, 4, 0, 8, 0, 7, 0, 8, 0, 2, 0, 8, 0, 13, 0, 8, 0, 12, 0, 8, 0, 10, 0, 8, 0, 5, 0, 8, 0, 15
-	};
-inline std::array<uint8_t, 0x40> LUT_440
-	{
-		1, 2, 1, 5, 1, 2, 1, 6, 1, 2, 1, 6, 1, 2, 1, 6, 1, 2, 1, 5, 1, 2, 1, 6, 1, 2, 1, 6, 1, 2, 1, 6, 1, 2, 1, 5, 1, 2, 1, 6, 1, 2, 1, 6, 1, 2, 1, 6, 1, 2, 1, 5, 1, 2, 1, 6, 1, 2, 1, 6, 1, 2, 1, 6
-	};
-inline std::array<uint32_t, 16> LUT_480
-	{
-		74, 106, 138, 170, 202, 234, 266, 298, 330, 362, 394, 426, 938, 1450, 9642, 140714
-	};
-inline std::array<uint8_t, 16> LUT_4C0
-	{
-		5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 9, 9, 13, 17, 21
-	};
-inline std::array<uint8_t, 8> LUT_4D0
-	{
-		0, 0, 2, 4, 6, 8, 10, 42
-	};
-inline std::array<uint8_t, 8> LUT_4D8
-	{
-		0, 1, 1, 1, 1, 1, 5, 5
-	};
-inline std::array<uint8_t, 32> LUT_4E0
-	{
-		17, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-	};
-#pragma warning( pop ) 
-
 enum class RPakStatus_t : int32_t
 {
 	PAK_STATUS_FREED = 0,
@@ -112,66 +68,6 @@ struct RPakUnknownStruct_t
 	// End size unknown.
 };
 
-struct RPakHeader_t
-{
-	uint32_t m_nMagic;                     // 'RPak'
-	uint16_t m_nVersion;                   // R2 = '7' R5 = '8'
-	uint8_t  m_nFlags[0x2];                //
-	uint8_t  m_nHash0[0x8];                //
-	uint8_t  m_nHash1[0x8];                //
-	uint64_t m_nSizeDisk;                  // Compressed size
-	uint64_t m_nEmbeddedStarpakOffset;     //
-	uint8_t  unk0[0x8];                    //
-	uint64_t m_nSizeMemory;                // Decompressed size
-	uint64_t m_nEmbeddedStarpakSize;       //
-	uint8_t  unk1[0x8];                    //
-
-	uint16_t m_nStarpakReferenceSize;      //
-	uint16_t m_nStarpakOptReferenceSize;   //
-	uint16_t m_nVirtualSegmentCount;       // * 0x10
-	uint16_t m_nMemPageCount;              // * 0xC
-
-	uint32_t m_nPatchIndex;                //
-
-	uint32_t m_nDescriptorCount;           //
-	uint32_t m_nAssetEntryCount;           // File entry count
-	uint32_t m_nGuidDescriptorCount;       //
-	uint32_t m_nRelationsCounts;           //
-
-	uint8_t  unk2[0x10];                   //
-	uint32_t m_nMemPageOffset;             // Size not verified. Offsets every page by x amount, if not 0 start of first page has data corresponding for 'patching some page'
-	uint8_t  unk3[0x8];                    //
-};
-
-struct __declspec(align(8)) RPakPatchCompressedHeader_t
-{
-	uint64_t m_nSizeDisk;
-	uint64_t m_nSizeMemory;
-};
-
-struct __declspec(align(8)) RPakDecompState_t
-{
-	uint64_t m_nInputBuf;
-	uint64_t m_nOut;
-	uint64_t m_nMask;
-	uint64_t m_nOutMask;
-	uint64_t m_nTotalFileLen;
-	uint64_t m_nDecompSize;
-	uint64_t m_nInvMaskIn;
-	uint64_t m_nInvMaskOut;
-	uint32_t header_skip_bytes_bs;
-	uint32_t dword44;
-	uint64_t input_byte_pos;
-	uint64_t m_nDecompPosition;
-	uint64_t m_nLengthNeeded;
-	uint64_t byte;
-	uint32_t byte_bit_offset;
-	uint32_t dword6C;
-	uint64_t qword70;
-	uint64_t m_nCompressedStreamSize;
-	uint64_t m_nDecompStreamSize;
-};
-
 #if not defined DEDICATED
 struct RTechTextureInfo_t
 {
@@ -480,8 +376,6 @@ class RTech
 {
 public:
 	uint64_t __fastcall StringToGuid(const char* pData);
-	uint8_t __fastcall DecompressPakFile(RPakDecompState_t* state, uint64_t inLen, uint64_t outLen);
-	uint64_t __fastcall DecompressPakFileInit(RPakDecompState_t* state, uint8_t* fileBuffer, uint64_t fileSize, uint64_t offNoHeader, uint64_t headerSize);
 	RPakLoadedInfo_t* GetPakLoadedInfo(RPakHandle_t nPakId);
 	RPakLoadedInfo_t* GetPakLoadedInfo(const char* szPakName);
 
@@ -88,6 +88,550 @@ PLATFORM_INTERFACE void AssertValidWStringPtr(const wchar_t* ptr, int maxchar/*
 	Assert(ptr);
 #endif
 }
+//-----------------------------------------------------------------------------
+// Asynchronous log queue: DevMsg/Warning/Error format on the calling thread
+// and push the line into a bounded multi-producer ring, a single consumer
+// thread does the ANSI stripping and fans the line out to all sinks.
+//-----------------------------------------------------------------------------
+#define LOG_QUEUE_CAPACITY    1024 // Must be a power of two.
+#define LOG_QUEUE_TEXT_SIZE   4096
+#define LOG_QUEUE_ERROR_SPINS 64   // Times an error line retries a full queue before it gets dropped.
+
+enum class LogType_t : int
+{
+	LOG_INFO = 0,
+	LOG_WARNING,
+	LOG_ERROR,
+	LOG_TYPE_COUNT
+};
+
+struct LogMessage_t
+{
+	double    m_flTime;
+	eDLL_T    m_nContext;
+	LogType_t m_nType;
+	bool      m_bPostInit;
+	char      m_szText[LOG_QUEUE_TEXT_SIZE];
+};
+
+class CLogQueue
+{
+public:
+	CLogQueue(void);
+
+	void Init(void);
+	void Shutdown(void);
+
+	bool Push(const LogMessage_t& msg);
+	void Flush(void);
+
+	bool IsRunning(void) const { return m_bRunning.load(std::memory_order_acquire); }
+	uint64_t GetDropCount(LogType_t nType) const { return m_nDropped[static_cast<int>(nType)].load(std::memory_order_relaxed); }
+
+private:
+	struct Cell_t
+	{
+		std::atomic<size_t> m_nSequence;
+		LogMessage_t        m_Message;
+	};
+
+	bool Pop(LogMessage_t& msg);
+	void Drain(void);
+	void ReportDrops(void);
+	void ThreadMain(void);
+
+	alignas(64) std::atomic<size_t> m_nEnqueuePos;
+	alignas(64) std::atomic<size_t> m_nDequeuePos; // Only advanced under m_ConsumeMutex.
+	alignas(64) std::atomic<bool>   m_bSleeping;
+	std::atomic<bool>               m_bRunning;
+	std::atomic<uint64_t>           m_nDropped[static_cast<int>(LogType_t::LOG_TYPE_COUNT)];
+	uint64_t                        m_nReportedDrops;
+
+	HANDLE                          m_hWakeEvent;
+	std::mutex                      m_ConsumeMutex;
+	Cell_t                          m_Cells[LOG_QUEUE_CAPACITY];
+};
+
+static CLogQueue s_LogQueue;
+
+//-----------------------------------------------------------------------------
+// Purpose: strips all ANSI escape sequences ('\033[' up to and including 'm')
+//          in place, sequences that aren't terminated on the same line are kept
+// Input  : &svText - 
+//-----------------------------------------------------------------------------
+static void Log_StripAnsi(string& svText)
+{
+	size_t nIn = svText.find('\033');
+	if (nIn == string::npos)
+	{
+		return;
+	}
+
+	const size_t nLen = svText.size();
+	size_t nOut = nIn;
+
+	while (nIn < nLen)
+	{
+		if (svText[nIn] == '\033' && nIn + 1 < nLen && svText[nIn + 1] == '[')
+		{
+			size_t nEnd = nIn + 2;
+			while (nEnd < nLen && svText[nEnd] != 'm' && svText[nEnd] != '\n' && svText[nEnd] != '\r')
+			{
+				nEnd++;
+			}
+
+			if (nEnd < nLen && svText[nEnd] == 'm')
+			{
+				nIn = nEnd + 1;
+				continue;
+			}
+		}
+
+		svText[nOut++] = svText[nIn++];
+	}
+
+	svText.resize(nOut);
+}
+
+#ifndef DEDICATED
+//-----------------------------------------------------------------------------
+// Purpose: returns the in-game console color for the log context
+// Input  : context - 
+//-----------------------------------------------------------------------------
+static ImVec4 Log_GetContextColor(eDLL_T context)
+{
+	switch (context)
+	{
+	case eDLL_T::SERVER:
+		return ImVec4(0.23f, 0.47f, 0.85f, 1.00f);
+	case eDLL_T::CLIENT:
+		return ImVec4(0.46f, 0.46f, 0.46f, 1.00f);
+	case eDLL_T::UI:
+		return ImVec4(0.59f, 0.35f, 0.46f, 1.00f);
+	case eDLL_T::ENGINE:
+		return ImVec4(0.70f, 0.70f, 0.70f, 1.00f);
+	case eDLL_T::FS:
+		return ImVec4(0.32f, 0.64f, 0.72f, 1.00f);
+	case eDLL_T::RTECH:
+		return ImVec4(0.36f, 0.70f, 0.35f, 1.00f);
+	case eDLL_T::MS:
+		return ImVec4(0.75f, 0.41f, 0.67f, 1.00f);
+	case eDLL_T::NETCON:
+		return ImVec4(0.81f, 0.81f, 0.81f, 1.00f);
+	case eDLL_T::COMMON:
+		return ImVec4(1.00f, 0.80f, 0.60f, 1.00f);
+	default:
+		return ImVec4(0.81f, 0.81f, 0.81f, 1.00f);
+	}
+}
+#endif // !DEDICATED
+
+//-----------------------------------------------------------------------------
+// Purpose: writes a formatted log line to all sinks
+// Input  : &msg - 
+//          *pvRConLines - if set, lines for RCON are collected here instead of queued one by one
+//-----------------------------------------------------------------------------
+static void Log_Dispatch(const LogMessage_t& msg, vector<std::pair<string, int>>* pvRConLines)
+{
+	static std::shared_ptr<spdlog::logger> iconsole = spdlog::get("game_console");
+	static std::shared_ptr<spdlog::logger> wconsole = spdlog::get("win_console");
+	static std::shared_ptr<spdlog::logger> sqlogger[static_cast<int>(LogType_t::LOG_TYPE_COUNT)] =
+	{
+		spdlog::get("sdk_info"),
+		spdlog::get("sdk_warn"),
+		spdlog::get("sdk_error")
+	};
+
+	static string svOut;
+	static string svAnsiOut;
+
+	char szUpTime[32];
+	if (msg.m_bPostInit)
+	{
+		snprintf(szUpTime, sizeof(szUpTime), "[%.3f] ", msg.m_flTime);
+	}
+	else
+	{
+		szUpTime[0] = '\0';
+	}
+
+	std::lock_guard<std::mutex> l(s_LogMutex);
+	const int nContext = static_cast<int>(msg.m_nContext);
+
+	svOut = szUpTime;
+	svOut.append(sDLL_T[nContext]);
+	svOut.append(msg.m_szText);
+	Log_StripAnsi(svOut);
+
+	if (svOut.back() != '\n')
+	{
+		svOut.append("\n");
+	}
+
+	const string* pRConOut = &svOut;
+	if (!g_bSpdLog_UseAnsiClr)
+	{
+		wconsole->debug(svOut);
+	}
+	else
+	{
+		svAnsiOut = szUpTime;
+		svAnsiOut.append(sANSI_DLL_T[nContext]);
+
+		if (msg.m_nType == LogType_t::LOG_WARNING)
+		{
+			svAnsiOut.append(g_svYellowF);
+		}
+		else if (msg.m_nType == LogType_t::LOG_ERROR)
+		{
+			svAnsiOut.append(g_svRedF);
+		}
+		svAnsiOut.append(msg.m_szText);
+
+		if (svAnsiOut.back() != '\n')
+		{
+			svAnsiOut.append("\n");
+		}
+		wconsole->debug(svAnsiOut);
+		pRConOut = &svAnsiOut;
+	}
+
+#ifdef DEDICATED
+	if (pvRConLines)
+	{
+		pvRConLines->emplace_back(*pRConOut, nContext);
+	}
+	else // Sent by the main thread, the RCON server takes its own lock to send.
+	{
+		vector<std::pair<string, int>> vLines{ { *pRConOut, nContext } };
+		RCONServer()->QueueLogs(vLines);
+	}
+#else
+	NOTE_UNUSED(pRConOut);
+	NOTE_UNUSED(pvRConLines);
+#endif // DEDICATED
+
+	sqlogger[static_cast<int>(msg.m_nType)]->debug(svOut);
+
+#ifndef DEDICATED
+	iconsole->info(svOut);
+
+	if (msg.m_bPostInit)
+	{
+		switch (msg.m_nType)
+		{
+		case LogType_t::LOG_WARNING:
+			g_pConsole->AddLog(ConLog_t(g_spd_sys_w_oss.str(), ImVec4(1.00f, 1.00f, 0.00f, 0.80f)));
+			g_pLogSystem.AddLog(EGlobalContext_t::WARNING_C, g_spd_sys_w_oss.str());
+			break;
+		case LogType_t::LOG_ERROR:
+			g_pConsole->AddLog(ConLog_t(g_spd_sys_w_oss.str(), ImVec4(1.00f, 0.00f, 0.00f, 1.00f)));
+			g_pLogSystem.AddLog(EGlobalContext_t::ERROR_C, g_spd_sys_w_oss.str());
+			break;
+		default:
+			g_pConsole->AddLog(ConLog_t(g_spd_sys_w_oss.str(), Log_GetContextColor(msg.m_nContext)));
+			g_pLogSystem.AddLog(static_cast<EGlobalContext_t>(msg.m_nContext), g_spd_sys_w_oss.str());
+			break;
+		}
+	}
+
+	g_spd_sys_w_oss.str("");
+	g_spd_sys_w_oss.clear();
+#endif // !DEDICATED
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: 
+//-----------------------------------------------------------------------------
+CLogQueue::CLogQueue(void)
+	: m_nEnqueuePos(0)
+	, m_nDequeuePos(0)
+	, m_bSleeping(false)
+	, m_bRunning(false)
+	, m_nReportedDrops(0)
+	, m_hWakeEvent(NULL)
+{
+	for (size_t i = 0; i < LOG_QUEUE_CAPACITY; i++)
+	{
+		m_Cells[i].m_nSequence.store(i, std::memory_order_relaxed);
+	}
+	for (std::atomic<uint64_t>& nDropped : m_nDropped)
+	{
+		nDropped.store(0, std::memory_order_relaxed);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: starts the consumer thread, lines logged before this are written
+//          on the calling thread
+//-----------------------------------------------------------------------------
+void CLogQueue::Init(void)
+{
+	if (m_bRunning.load(std::memory_order_acquire))
+	{
+		return;
+	}
+
+	m_hWakeEvent = CreateEventA(NULL, FALSE, FALSE, NULL);
+	if (!m_hWakeEvent)
+	{
+		return;
+	}
+
+	m_bRunning.store(true, std::memory_order_release);
+
+	// Detached, this is also called from DllMain where waiting on a thread deadlocks.
+	std::thread([this]() { this->ThreadMain(); }).detach();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: stops the consumer thread and writes out all pending lines
+//-----------------------------------------------------------------------------
+void CLogQueue::Shutdown(void)
+{
+	if (!m_bRunning.exchange(false, std::memory_order_acq_rel))
+	{
+		return;
+	}
+
+	SetEvent(m_hWakeEvent);
+	this->Flush();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: pushes a line into the ring without blocking
+// Input  : &msg - 
+// Output : false if the ring was full and the line has been dropped
+//-----------------------------------------------------------------------------
+bool CLogQueue::Push(const LogMessage_t& msg)
+{
+	int nSpins = (msg.m_nType == LogType_t::LOG_ERROR) ? LOG_QUEUE_ERROR_SPINS : 0;
+	size_t nPos = m_nEnqueuePos.load(std::memory_order_relaxed);
+
+	for (;;)
+	{
+		Cell_t& cell = m_Cells[nPos & (LOG_QUEUE_CAPACITY - 1)];
+		const size_t nSequence = cell.m_nSequence.load(std::memory_order_acquire);
+		const intptr_t nDiff = static_cast<intptr_t>(nSequence) - static_cast<intptr_t>(nPos);
+
+		if (nDiff == 0)
+		{
+			if (m_nEnqueuePos.compare_exchange_weak(nPos, nPos + 1, std::memory_order_relaxed))
+			{
+				LogMessage_t& dest = cell.m_Message;
+
+				dest.m_flTime = msg.m_flTime;
+				dest.m_nContext = msg.m_nContext;
+				dest.m_nType = msg.m_nType;
+				dest.m_bPostInit = msg.m_bPostInit;
+				strncpy_s(dest.m_szText, msg.m_szText, _TRUNCATE);
+
+				cell.m_nSequence.store(nPos + 1, std::memory_order_release);
+				break;
+			}
+		}
+		else if (nDiff < 0) // Full.
+		{
+			if (nSpins-- <= 0)
+			{
+				m_nDropped[static_cast<int>(msg.m_nType)].fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+
+			std::this_thread::yield();
+			nPos = m_nEnqueuePos.load(std::memory_order_relaxed);
+		}
+		else
+		{
+			nPos = m_nEnqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+
+	if (m_bSleeping.exchange(false, std::memory_order_acq_rel))
+	{
+		SetEvent(m_hWakeEvent);
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: pops the oldest line (m_ConsumeMutex must be held)
+// Input  : &msg - 
+// Output : false if the ring is empty
+//-----------------------------------------------------------------------------
+bool CLogQueue::Pop(LogMessage_t& msg)
+{
+	const size_t nPos = m_nDequeuePos.load(std::memory_order_relaxed);
+	Cell_t& cell = m_Cells[nPos & (LOG_QUEUE_CAPACITY - 1)];
+	const size_t nSequence = cell.m_nSequence.load(std::memory_order_acquire);
+
+	if (nSequence != nPos + 1)
+	{
+		return false; // Empty, or the producer of this cell hasn't finished writing yet.
+	}
+
+	msg.m_flTime = cell.m_Message.m_flTime;
+	msg.m_nContext = cell.m_Message.m_nContext;
+	msg.m_nType = cell.m_Message.m_nType;
+	msg.m_bPostInit = cell.m_Message.m_bPostInit;
+	strncpy_s(msg.m_szText, cell.m_Message.m_szText, _TRUNCATE);
+
+	cell.m_nSequence.store(nPos + LOG_QUEUE_CAPACITY, std::memory_order_release);
+	m_nDequeuePos.store(nPos + 1, std::memory_order_relaxed);
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: writes all queued lines to the sinks, RCON lines are handed over
+//          to the RCON server in one batch
+//-----------------------------------------------------------------------------
+void CLogQueue::Drain(void)
+{
+	static LogMessage_t msg; // Only used under m_ConsumeMutex, too large for the stack of every caller.
+	vector<std::pair<string, int>> vRConLines;
+
+	std::lock_guard<std::mutex> l(m_ConsumeMutex);
+	while (this->Pop(msg))
+	{
+		Log_Dispatch(msg, &vRConLines);
+	}
+	this->ReportDrops();
+
+#ifdef DEDICATED
+	if (!vRConLines.empty())
+	{
+		RCONServer()->QueueLogs(vRConLines);
+	}
+#endif // DEDICATED
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: writes all queued lines on the calling thread
+//-----------------------------------------------------------------------------
+void CLogQueue::Flush(void)
+{
+	this->Drain();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: logs how many lines were dropped since the last report
+//          (m_ConsumeMutex must be held)
+//-----------------------------------------------------------------------------
+void CLogQueue::ReportDrops(void)
+{
+	const uint64_t nInfo = this->GetDropCount(LogType_t::LOG_INFO);
+	const uint64_t nWarning = this->GetDropCount(LogType_t::LOG_WARNING);
+	const uint64_t nError = this->GetDropCount(LogType_t::LOG_ERROR);
+	const uint64_t nTotal = nInfo + nWarning + nError;
+
+	if (nTotal == m_nReportedDrops)
+	{
+		return;
+	}
+
+	static LogMessage_t msg;
+	msg.m_flTime = Plat_FloatTime();
+	msg.m_nContext = eDLL_T::COMMON;
+	msg.m_nType = LogType_t::LOG_WARNING;
+	msg.m_bPostInit = g_bSpdLog_PostInit;
+
+	snprintf(msg.m_szText, sizeof(msg.m_szText), "Log queue overflow: dropped %llu lines (total: %llu info, %llu warning, %llu error)\n",
+		nTotal - m_nReportedDrops, nInfo, nWarning, nError);
+
+	m_nReportedDrops = nTotal;
+	Log_Dispatch(msg, nullptr);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: consumer thread
+//-----------------------------------------------------------------------------
+void CLogQueue::ThreadMain(void)
+{
+	while (m_bRunning.load(std::memory_order_acquire))
+	{
+		this->Drain();
+
+		m_bSleeping.store(true, std::memory_order_seq_cst);
+
+		// Recheck after announcing we sleep, a producer that didn't see the flag has published already.
+		const size_t nPos = m_nEnqueuePos.load(std::memory_order_seq_cst);
+		if (nPos != m_nDequeuePos.load(std::memory_order_relaxed))
+		{
+			m_bSleeping.store(false, std::memory_order_relaxed);
+			continue;
+		}
+
+		WaitForSingleObject(m_hWakeEvent, 100);
+		m_bSleeping.store(false, std::memory_order_relaxed);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: formats the line on the calling thread and queues it, or writes it
+//          right away if the consumer thread isn't running
+// Input  : nType - 
+//          context - 
+//          *fmt - 
+//          args - 
+//-----------------------------------------------------------------------------
+static void Log_Queue(LogType_t nType, eDLL_T context, const char* fmt, va_list args)
+{
+	static thread_local LogMessage_t msg;
+
+	msg.m_flTime = Plat_FloatTime();
+	msg.m_nContext = context;
+	msg.m_nType = nType;
+	msg.m_bPostInit = g_bSpdLog_PostInit;
+
+	vsnprintf(msg.m_szText, sizeof(msg.m_szText), fmt, args);
+	msg.m_szText[sizeof(msg.m_szText) - 1] = '\0';
+
+	if (s_LogQueue.IsRunning())
+	{
+		s_LogQueue.Push(msg);
+	}
+	else
+	{
+		Log_Dispatch(msg, nullptr);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: starts the asynchronous log queue
+//-----------------------------------------------------------------------------
+void LogQueue_Init(void)
+{
+	s_LogQueue.Init();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: stops the asynchronous log queue, later lines are written synchronously
+// Note   : the RCON server doesn't run another frame after this, so lines
+//          written from here on never reach the net consoles.
+//-----------------------------------------------------------------------------
+void LogQueue_Shutdown(void)
+{
+	s_LogQueue.Shutdown();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: writes all queued lines on the calling thread
+//-----------------------------------------------------------------------------
+void LogQueue_Flush(void)
+{
+	s_LogQueue.Flush();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: returns the number of lines dropped because the queue was full
+//-----------------------------------------------------------------------------
+uint64_t LogQueue_GetDropCount(void)
+{
+	return s_LogQueue.GetDropCount(LogType_t::LOG_INFO)
+		+ s_LogQueue.GetDropCount(LogType_t::LOG_WARNING)
+		+ s_LogQueue.GetDropCount(LogType_t::LOG_ERROR);
+}
 
 //-----------------------------------------------------------------------------
 // Purpose: Netconsole log
@@ -99,7 +643,6 @@ void NetMsg(EGlobalContext_t context, const char* fmt, ...)
 #ifndef DEDICATED
 	static char szBuf[4096] = {};
 	static std::string svOut;
-	static std::regex rxAnsiExp("\\\033\\[.*?m");
 	static std::shared_ptr<spdlog::logger> iconsole = spdlog::get("game_console");
 	static std::shared_ptr<spdlog::logger> wconsole = spdlog::get("win_console");
 	static std::shared_ptr<spdlog::logger> ntlogger = spdlog::get("net_con");
@@ -160,11 +703,11 @@ void NetMsg(EGlobalContext_t context, const char* fmt, ...)
 		if (g_bSpdLog_UseAnsiClr)
 		{
 			wconsole->debug(svOut);
-			svOut = std::regex_replace(svOut, rxAnsiExp, "");
+			Log_StripAnsi(svOut);
 		}
 		else
 		{
-			svOut = std::regex_replace(svOut, rxAnsiExp, "");
+			Log_StripAnsi(svOut);
 			wconsole->debug(svOut);
 		}
 
@@ -221,49 +764,17 @@ void NetMsg(EGlobalContext_t context, const char* fmt, ...)
 		}
 		else
 		{
-			switch (static_cast<eDLL_T>(context))
-			{
-			case eDLL_T::SERVER:
-				color = ImVec4(0.23f, 0.47f, 0.85f, 1.00f);
-				break;
-			case eDLL_T::CLIENT:
-				color = ImVec4(0.46f, 0.46f, 0.46f, 1.00f);
-				break;
-			case eDLL_T::UI:
-				color = ImVec4(0.59f, 0.35f, 0.46f, 1.00f);
-				break;
-			case eDLL_T::ENGINE:
-				color = ImVec4(0.70f, 0.70f, 0.70f, 1.00f);
-				break;
-			case eDLL_T::FS:
-				color = ImVec4(0.32f, 0.64f, 0.72f, 1.00f);
-				break;
-			case eDLL_T::RTECH:
-				color = ImVec4(0.36f, 0.70f, 0.35f, 1.00f);
-				break;
-			case eDLL_T::MS:
-				color = ImVec4(0.75f, 0.41f, 0.67f, 1.00f);
-				break;
-			case eDLL_T::NETCON:
-				color = ImVec4(0.81f, 0.81f, 0.81f, 1.00f);
-				break;
-			case eDLL_T::COMMON:
-				color = ImVec4(1.00f, 0.80f, 0.60f, 1.00f);
-				break;
-			default:
-				color = ImVec4(0.81f, 0.81f, 0.81f, 1.00f);
-				break;
-			}
+			color = Log_GetContextColor(static_cast<eDLL_T>(context));
 		}
 
 		if (g_bSpdLog_UseAnsiClr)
 		{
 			wconsole->debug(svOut);
-			svOut = std::regex_replace(svOut, rxAnsiExp, "");
+			Log_StripAnsi(svOut);
 		}
 		else
 		{
-			svOut = std::regex_replace(svOut, rxAnsiExp, "");
+			Log_StripAnsi(svOut);
 			wconsole->debug(svOut);
 		}
 
@@ -289,115 +800,10 @@ void NetMsg(EGlobalContext_t context, const char* fmt, ...)
 //-----------------------------------------------------------------------------
 void DevMsg(eDLL_T context, const char* fmt, ...)
 {
-	static char szBuf[4096] = {};
-
-	static std::string svOut;
-	static std::string svAnsiOut;
-
-	static std::regex rxAnsiExp("\\\033\\[.*?m");
-
-	static std::shared_ptr<spdlog::logger> iconsole = spdlog::get("game_console");
-	static std::shared_ptr<spdlog::logger> wconsole = spdlog::get("win_console");
-	static std::shared_ptr<spdlog::logger> sqlogger = spdlog::get("sdk_info");
-
-	s_LogMutex.lock();
-	const char* pszUpTime = Plat_GetProcessUpTime();
-
-	{/////////////////////////////
-		va_list args{};
-		va_start(args, fmt);
-
-		vsnprintf(szBuf, sizeof(szBuf), fmt, args);
-
-		szBuf[sizeof(szBuf) - 1] = '\0';
-		va_end(args);
-	}/////////////////////////////
-
-	svOut = g_bSpdLog_PostInit ? pszUpTime : "";
-	svOut.append(sDLL_T[static_cast<int>(context)]);
-	svOut.append(szBuf);
-	svOut = std::regex_replace(svOut, rxAnsiExp, "");
-
-	if (svOut.back() != '\n')
-	{
-		svOut.append("\n");
-	}
-
-	if (!g_bSpdLog_UseAnsiClr)
-	{
-		wconsole->debug(svOut);
-#ifdef DEDICATED
-		RCONServer()->Send(svOut, "", sv_rcon::response_t::SERVERDATA_RESPONSE_CONSOLE_LOG, static_cast<int>(context));
-#endif // DEDICATED
-	}
-	else
-	{
-		svAnsiOut = g_bSpdLog_PostInit ? pszUpTime : "";
-		svAnsiOut.append(sANSI_DLL_T[static_cast<int>(context)]);
-		svAnsiOut.append(szBuf);
-
-		if (svAnsiOut.back() != '\n')
-		{
-			svAnsiOut.append("\n");
-		}
-		wconsole->debug(svAnsiOut);
-#ifdef DEDICATED
-		RCONServer()->Send(svAnsiOut, "", sv_rcon::response_t::SERVERDATA_RESPONSE_CONSOLE_LOG, static_cast<int>(context));
-#endif // DEDICATED
-	}
-
-	sqlogger->debug(svOut);
-
-#ifndef DEDICATED
-	iconsole->info(svOut);
-
-	EGlobalContext_t tLog = static_cast<EGlobalContext_t>(context);
-	ImVec4 color;
-
-	switch (context)
-	{
-	case eDLL_T::SERVER:
-		color = ImVec4(0.23f, 0.47f, 0.85f, 1.00f);
-		break;
-	case eDLL_T::CLIENT:
-		color = ImVec4(0.46f, 0.46f, 0.46f, 1.00f);
-		break;
-	case eDLL_T::UI:
-		color = ImVec4(0.59f, 0.35f, 0.46f, 1.00f);
-		break;
-	case eDLL_T::ENGINE:
-		color = ImVec4(0.70f, 0.70f, 0.70f, 1.00f);
-		break;
-	case eDLL_T::FS:
-		color = ImVec4(0.32f, 0.64f, 0.72f, 1.00f);
-		break;
-	case eDLL_T::RTECH:
-		color = ImVec4(0.36f, 0.70f, 0.35f, 1.00f);
-		break;
-	case eDLL_T::MS:
-		color = ImVec4(0.75f, 0.41f, 0.67f, 1.00f);
-		break;
-	case eDLL_T::NETCON:
-		color = ImVec4(0.81f, 0.81f, 0.81f, 1.00f);
-		break;
-	case eDLL_T::COMMON:
-		color = ImVec4(1.00f, 0.80f, 0.60f, 1.00f);
-		break;
-	default:
-		color = ImVec4(0.81f, 0.81f, 0.81f, 1.00f);
-		break;
-	}
-
-	if (g_bSpdLog_PostInit)
-	{
-		g_pConsole->AddLog(ConLog_t(g_spd_sys_w_oss.str(), color));
-		g_pLogSystem.AddLog(tLog, g_spd_sys_w_oss.str());
-	}
-
-	g_spd_sys_w_oss.str("");
-	g_spd_sys_w_oss.clear();
-#endif // !DEDICATED
-	s_LogMutex.unlock();
+	va_list args{};
+	va_start(args, fmt);
+	Log_Queue(LogType_t::LOG_INFO, context, fmt, args);
+	va_end(args);
 }
 
 //-----------------------------------------------------------------------------
@@ -407,78 +813,10 @@ void DevMsg(eDLL_T context, const char* fmt, ...)
 //-----------------------------------------------------------------------------
 void Warning(eDLL_T context, const char* fmt, ...)
 {
-	static char szBuf[4096] = {};
-
-	static std::string svOut;
-	static std::string svAnsiOut;
-
-	static std::regex rxAnsiExp("\\\033\\[.*?m");
-
-	static std::shared_ptr<spdlog::logger> iconsole = spdlog::get("game_console");
-	static std::shared_ptr<spdlog::logger> wconsole = spdlog::get("win_console");
-	static std::shared_ptr<spdlog::logger> sqlogger = spdlog::get("sdk_warn");
-
-	s_LogMutex.lock();
-	const char* pszUpTime = Plat_GetProcessUpTime();
-
-	{/////////////////////////////
-		va_list args{};
-		va_start(args, fmt);
-
-		vsnprintf(szBuf, sizeof(szBuf), fmt, args);
-
-		szBuf[sizeof(szBuf) - 1] = '\0';
-		va_end(args);
-	}/////////////////////////////
-
-	svOut = g_bSpdLog_PostInit ? pszUpTime : "";
-	svOut.append(sDLL_T[static_cast<int>(context)]);
-	svOut.append(szBuf);
-	svOut = std::regex_replace(svOut, rxAnsiExp, "");
-
-	if (svOut.back() != '\n')
-	{
-		svOut.append("\n");
-	}
-
-	if (!g_bSpdLog_UseAnsiClr)
-	{
-		wconsole->debug(svOut);
-#ifdef DEDICATED
-		RCONServer()->Send(svOut, "", sv_rcon::response_t::SERVERDATA_RESPONSE_CONSOLE_LOG, static_cast<int>(context));
-#endif // DEDICATED
-	}
-	else
-	{
-		svAnsiOut = g_bSpdLog_PostInit ? pszUpTime : "";
-		svAnsiOut.append(sANSI_DLL_T[static_cast<int>(context)]);
-		svAnsiOut.append(g_svYellowF);
-		svAnsiOut.append(szBuf);
-
-		if (svAnsiOut.back() != '\n')
-		{
-			svAnsiOut.append("\n");
-		}
-		wconsole->debug(svAnsiOut);
-#ifdef DEDICATED
-		RCONServer()->Send(svAnsiOut, "", sv_rcon::response_t::SERVERDATA_RESPONSE_CONSOLE_LOG, static_cast<int>(context));
-#endif // DEDICATED
-	}
-
-	sqlogger->debug(svOut);
-#ifndef DEDICATED
-	iconsole->info(svOut);
-
-	if (g_bSpdLog_PostInit)
-	{
-		g_pConsole->AddLog(ConLog_t(g_spd_sys_w_oss.str(), ImVec4(1.00f, 1.00f, 0.00f, 0.80f)));
-		g_pLogSystem.AddLog(EGlobalContext_t::WARNING_C, g_spd_sys_w_oss.str());
-	}
-
-	g_spd_sys_w_oss.str("");
-	g_spd_sys_w_oss.clear();
-#endif // !DEDICATED
-	s_LogMutex.unlock();
+	va_list args{};
+	va_start(args, fmt);
+	Log_Queue(LogType_t::LOG_WARNING, context, fmt, args);
+	va_end(args);
 }
 
 //-----------------------------------------------------------------------------
@@ -489,84 +827,42 @@ void Warning(eDLL_T context, const char* fmt, ...)
 //-----------------------------------------------------------------------------
 void Error(eDLL_T context, UINT code, const char* fmt, ...)
 {
-	static char szBuf[4096] = {};
-
-	static std::string svOut;
-	static std::string svAnsiOut;
+	if (!code)
+	{
+		va_list args{};
+		va_start(args, fmt);
+		Log_Queue(LogType_t::LOG_ERROR, context, fmt, args);
+		va_end(args);
 
-	static std::regex rxAnsiExp("\\\033\\[.*?m");
+		return;
+	}
 
-	static std::shared_ptr<spdlog::logger> iconsole = spdlog::get("game_console");
-	static std::shared_ptr<spdlog::logger> wconsole = spdlog::get("win_console");
-	static std::shared_ptr<spdlog::logger> sqlogger = spdlog::get("sdk_error");
+	// Fatal, write everything out on this thread before terminating.
+	static thread_local LogMessage_t msg;
 
-	s_LogMutex.lock();
-	const char* pszUpTime = Plat_GetProcessUpTime();
+	msg.m_flTime = Plat_FloatTime();
+	msg.m_nContext = context;
+	msg.m_nType = LogType_t::LOG_ERROR;
+	msg.m_bPostInit = g_bSpdLog_PostInit;
 
 	{/////////////////////////////
 		va_list args{};
 		va_start(args, fmt);
 
-		vsnprintf(szBuf, sizeof(szBuf), fmt, args);
+		vsnprintf(msg.m_szText, sizeof(msg.m_szText), fmt, args);
 
-		szBuf[sizeof(szBuf) - 1] = '\0';
+		msg.m_szText[sizeof(msg.m_szText) - 1] = '\0';
 		va_end(args);
 	}/////////////////////////////
 
-	svOut = g_bSpdLog_PostInit ? pszUpTime : "";
-	svOut.append(sDLL_T[static_cast<int>(context)]);
-	svOut.append(szBuf);
-	svOut = std::regex_replace(svOut, rxAnsiExp, "");
-
-	if (svOut.back() != '\n')
-	{
-		svOut.append("\n");
-	}
-
-	if (!g_bSpdLog_UseAnsiClr)
-	{
-		wconsole->debug(svOut);
-#ifdef DEDICATED
-		RCONServer()->Send(svOut, "", sv_rcon::response_t::SERVERDATA_RESPONSE_CONSOLE_LOG, static_cast<int>(context));
-#endif // DEDICATED
-	}
-	else
-	{
-		svAnsiOut = g_bSpdLog_PostInit ? pszUpTime : "";
-		svAnsiOut.append(sANSI_DLL_T[static_cast<int>(context)]);
-		svAnsiOut.append(g_svRedF);
-		svAnsiOut.append(szBuf);
-
-		if (svAnsiOut.back() != '\n')
-		{
-			svAnsiOut.append("\n");
-		}
-		wconsole->debug(svAnsiOut);
-#ifdef DEDICATED
-		RCONServer()->Send(svAnsiOut, "", sv_rcon::response_t::SERVERDATA_RESPONSE_CONSOLE_LOG, static_cast<int>(context));
-#endif // DEDICATED
-	}
-
-	sqlogger->debug(svOut);
+	s_LogQueue.Flush();
+	Log_Dispatch(msg, nullptr);
 
-#ifndef DEDICATED
-	iconsole->info(svOut);
-
-	if (g_bSpdLog_PostInit)
-	{
-		g_pConsole->AddLog(ConLog_t(g_spd_sys_w_oss.str(), ImVec4(1.00f, 0.00f, 0.00f, 1.00f)));
-		g_pLogSystem.AddLog(EGlobalContext_t::ERROR_C, g_spd_sys_w_oss.str());
-	}
+	char szUpTime[32];
+	snprintf(szUpTime, sizeof(szUpTime), "[%.3f] ", msg.m_flTime);
 
-	g_spd_sys_w_oss.str("");
-	g_spd_sys_w_oss.clear();
-#endif // !DEDICATED
-	if (code) // Terminate the process if an exit code was passed.
+	if (MessageBoxA(NULL, fmt::format("{:s}- {:s}", szUpTime, msg.m_szText).c_str(), "SDK Error", MB_ICONERROR | MB_OK))
 	{
-		if (MessageBoxA(NULL, fmt::format("{:s}- {:s}", pszUpTime, szBuf).c_str(), "SDK Error", MB_ICONERROR | MB_OK))
-		{
-			TerminateProcess(GetCurrentProcess(), code);
-		}
+		TerminateProcess(GetCurrentProcess(), code);
 	}
-	s_LogMutex.unlock();
-}
\ No newline at end of file
+}
@@ -83,6 +83,13 @@ PLATFORM_INTERFACE void DevMsg(eDLL_T context, const char* fmt, ...) FMTFUNCTION
 PLATFORM_INTERFACE void Warning(eDLL_T context, const char* fmt, ...) FMTFUNCTION(1, 2);
 PLATFORM_INTERFACE void Error(eDLL_T context, UINT code, const char* fmt, ...) FMTFUNCTION(1, 2);
 
+// DevMsg, Warning and Error are written by a background thread once the
+// queue has been started, lines are dropped when the queue is full.
+void LogQueue_Init(void);
+void LogQueue_Shutdown(void);
+void LogQueue_Flush(void);
+uint64_t LogQueue_GetDropCount(void);
+
 // You can use this macro like a runtime assert macro.
 // If the condition fails, then Error is called with the message. This macro is called
 // like AssertMsg, where msg must be enclosed in parenthesis:
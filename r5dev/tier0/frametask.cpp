@@ -7,27 +7,126 @@
 //=============================================================================//
 #include "core/stdafx.h"
 #include "tier0/frametask.h"
+#include "public/utility/benchmark.h"
+
+//-----------------------------------------------------------------------------
+// Purpose: comparator for the timed task heap, earliest due time on top
+//-----------------------------------------------------------------------------
+static bool FrameTask_DueLater(const ScheduledTasks_s* a, const ScheduledTasks_s* b)
+{
+    return a->m_flDueTime > b->m_flDueTime;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: 
+//-----------------------------------------------------------------------------
+CFrameTask::CFrameTask()
+    : m_pSubmitted(nullptr)
+    , m_nFrame(0)
+{
+    memset(m_Wheel, 0, sizeof(m_Wheel));
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: frees the tasks that never ran
+//-----------------------------------------------------------------------------
+CFrameTask::~CFrameTask()
+{
+    FreeList(m_pSubmitted.exchange(nullptr));
+
+    for (Slot_s& slot : m_Wheel)
+    {
+        FreeList(slot.m_pHead);
+    }
+    for (ScheduledTasks_s* pTask : m_TimedTasks)
+    {
+        delete pTask;
+    }
+}
 
 //-----------------------------------------------------------------------------
 // Purpose: run frame task and process queued calls
 //-----------------------------------------------------------------------------
 void CFrameTask::RunFrame()
 {
-    std::lock_guard<std::mutex> l(m_Mutex);
-    for (auto& delay : m_ScheduledTasks)
+    m_nFrame++;
+
+    // Take over everything dispatched since the last frame, the stack is
+    // newest first so reverse it to schedule in dispatch order.
+    ScheduledTasks_s* pSubmitted = m_pSubmitted.exchange(nullptr, std::memory_order_acquire);
+    ScheduledTasks_s* pOrdered = nullptr;
+
+    while (pSubmitted)
+    {
+        ScheduledTasks_s* pNext = pSubmitted->m_pNext;
+        pSubmitted->m_pNext = pOrdered;
+        pOrdered = pSubmitted;
+        pSubmitted = pNext;
+    }
+    while (pOrdered)
+    {
+        ScheduledTasks_s* pNext = pOrdered->m_pNext;
+        Schedule(pOrdered);
+        pOrdered = pNext;
+    }
+
+    // Unlink the tasks due this frame, tasks for a later lap around the
+    // wheel stay in the slot.
+    Slot_s& slot = m_Wheel[m_nFrame & (FRAMETASK_WHEEL_SIZE - 1)];
+
+    ScheduledTasks_s* pDueHead = nullptr;
+    ScheduledTasks_s* pDueTail = nullptr;
+    ScheduledTasks_s* pPrev = nullptr;
+
+    for (ScheduledTasks_s* pTask = slot.m_pHead; pTask;)
     {
-        delay.m_nDelayedFrames = (std::max)(delay.m_nDelayedFrames - 1, 0);
-        if (delay.m_nDelayedFrames == 0)
+        ScheduledTasks_s* pNext = pTask->m_pNext;
+        if (pTask->m_nDueFrame == m_nFrame)
         {
-            delay.m_rFunctor();
+            if (pPrev)
+                pPrev->m_pNext = pNext;
+            else
+                slot.m_pHead = pNext;
+
+            pTask->m_pNext = nullptr;
+            if (pDueTail)
+                pDueTail->m_pNext = pTask;
+            else
+                pDueHead = pTask;
+            pDueTail = pTask;
         }
+        else
+        {
+            pPrev = pTask;
+        }
+        pTask = pNext;
+    }
+    slot.m_pTail = pPrev;
+
+    while (pDueHead)
+    {
+        ScheduledTasks_s* pNext = pDueHead->m_pNext;
+
+        pDueHead->m_rFunctor();
+        delete pDueHead;
+
+        pDueHead = pNext;
     }
 
-    auto newEnd = std::remove_if(m_ScheduledTasks.begin(), m_ScheduledTasks.end(), [](const ScheduledTasks_s& delay)
+    if (!m_TimedTasks.empty())
+    {
+        const double flTime = GetTime();
+
+        while (!m_TimedTasks.empty() && m_TimedTasks.front()->m_flDueTime <= flTime)
         {
-            return delay.m_nDelayedFrames == 0;
-        });
-    m_ScheduledTasks.erase(newEnd, m_ScheduledTasks.end());
+            std::pop_heap(m_TimedTasks.begin(), m_TimedTasks.end(), FrameTask_DueLater);
+            ScheduledTasks_s* pTask = m_TimedTasks.back();
+            m_TimedTasks.pop_back();
+
+            pTask->m_rFunctor();
+            delete pTask;
+        }
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -46,8 +145,179 @@ bool CFrameTask::IsFinished() const
 //-----------------------------------------------------------------------------
 void CFrameTask::Dispatch(std::function<void()> functor, int frames)
 {
-    std::lock_guard<std::mutex> l(m_Mutex);
-    m_ScheduledTasks.emplace_back(frames, functor);
+    Submit(new ScheduledTasks_s((std::max)(frames, 0), std::move(functor)));
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: adds function to list, to be called on the first frame after
+//          'seconds' have passed.
+// Input  : functor - 
+//          seconds - 
+//-----------------------------------------------------------------------------
+void CFrameTask::DispatchDelayed(std::function<void()> functor, double seconds)
+{
+    ScheduledTasks_s* pTask = new ScheduledTasks_s(-1, std::move(functor));
+    pTask->m_flDueTime = GetTime() + seconds;
+
+    Submit(pTask);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: pushes a task on the submission stack, safe from any thread
+// Input  : *pTask - 
+//-----------------------------------------------------------------------------
+void CFrameTask::Submit(ScheduledTasks_s* pTask)
+{
+    ScheduledTasks_s* pHead = m_pSubmitted.load(std::memory_order_relaxed);
+    do
+    {
+        pTask->m_pNext = pHead;
+    } while (!m_pSubmitted.compare_exchange_weak(pHead, pTask, std::memory_order_release, std::memory_order_relaxed));
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: places a submitted task in the wheel or the timed heap, the
+//          frame delay counts from the frame being run (main thread only)
+// Input  : *pTask - 
+//-----------------------------------------------------------------------------
+void CFrameTask::Schedule(ScheduledTasks_s* pTask)
+{
+    pTask->m_pNext = nullptr;
+
+    if (pTask->m_nDelayedFrames < 0)
+    {
+        m_TimedTasks.push_back(pTask);
+        std::push_heap(m_TimedTasks.begin(), m_TimedTasks.end(), FrameTask_DueLater);
+
+        return;
+    }
+
+    // A delay of 0 or 1 runs this frame.
+    pTask->m_nDueFrame = m_nFrame + (std::max)(pTask->m_nDelayedFrames, 1) - 1;
+
+    Slot_s& slot = m_Wheel[pTask->m_nDueFrame & (FRAMETASK_WHEEL_SIZE - 1)];
+    if (slot.m_pTail)
+        slot.m_pTail->m_pNext = pTask;
+    else
+        slot.m_pHead = pTask;
+    slot.m_pTail = pTask;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: frees a linked list of tasks
+// Input  : *pTask - 
+//-----------------------------------------------------------------------------
+void CFrameTask::FreeList(ScheduledTasks_s* pTask)
+{
+    while (pTask)
+    {
+        ScheduledTasks_s* pNext = pTask->m_pNext;
+        delete pTask;
+        pTask = pNext;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: returns the steady clock time in seconds
+//-----------------------------------------------------------------------------
+double CFrameTask::GetTime()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: dispatches tasks spread over many frames, plus some on a deadline,
+//          to a separate scheduler and checks that each runs once, on time
+// Input  : &bench - 
+//          nTasks - 
+//          nFrames - 
+// Output : true if every task ran once on its frame or after its deadline
+//-----------------------------------------------------------------------------
+bool CFrameTask::Benchmark(CBenchmark& bench, int nTasks, int nFrames)
+{
+    const int nTimedTasks = std::max<int>(nTasks / 100, 1);
+    const double flMaxDelay = 0.05; // Seconds.
+
+    std::mt19937 rng(BENCH_RANDOM_SEED);
+    std::unique_ptr<CFrameTask> pScheduler(new CFrameTask()); // Tasks dispatched to g_TaskScheduler would run in the game's frames.
+
+    std::vector<int> vDueFrame(nTasks);
+    std::vector<int> vRanFrame(nTasks, 0);
+    std::vector<int> vRunCount(nTasks, 0);
+    std::vector<double> vDueTime(nTimedTasks);
+    std::vector<double> vRanTime(nTimedTasks, 0.0);
+
+    int nFrame = 0;
+    int nTimedDone = 0;
+
+    const double flDispatchTime = CBenchmark::Time([&]()
+        {
+            for (int i = 0; i < nTasks; i++)
+            {
+                const int nDelay = static_cast<int>(rng() % (nFrames + 1)); // 0 and 1 both run on the next frame.
+                vDueFrame[i] = std::max<int>(nDelay, 1);
+
+                pScheduler->Dispatch([i, &nFrame, &vRanFrame, &vRunCount]()
+                    {
+                        vRanFrame[i] = nFrame;
+                        vRunCount[i]++;
+                    }, nDelay);
+            }
+        });
+
+    for (int i = 0; i < nTimedTasks; i++)
+    {
+        const double flDelay = flMaxDelay * (rng() % 1001) / 1000.0;
+        vDueTime[i] = GetTime() + flDelay; // Read before the scheduler reads it, so never later than its deadline.
+
+        pScheduler->DispatchDelayed([i, &nTimedDone, &vRanTime]()
+            {
+                vRanTime[i] = GetTime();
+                nTimedDone++;
+            }, flDelay);
+    }
+
+    double flTotalTime = 0.0;
+    double flFirstTime = 0.0;
+    double flMaxTime = 0.0;
+
+    for (nFrame = 1; nFrame <= nFrames; nFrame++)
+    {
+        const double flFrameTime = CBenchmark::Time([&]() { pScheduler->RunFrame(); });
+        if (nFrame == 1)
+            flFirstTime = flFrameTime; // Takes over every dispatched task.
+        else
+            flMaxTime = std::max<double>(flMaxTime, flFrameTime);
+
+        flTotalTime += flFrameTime;
+    }
+
+    // Let the remaining deadlines pass.
+    const double flGiveUpTime = GetTime() + flMaxDelay + 1.0;
+    while (nTimedDone < nTimedTasks && GetTime() < flGiveUpTime)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        pScheduler->RunFrame();
+        nFrame++;
+    }
+
+    for (int i = 0; i < nTasks; i++)
+    {
+        bench.Verify(vRunCount[i] == 1 && vRanFrame[i] == vDueFrame[i], "Task '%d' ran '%d' time(s), last on frame '%d' instead of '%d'",
+            i, vRunCount[i], vRanFrame[i], vDueFrame[i]);
+    }
+    for (int i = 0; i < nTimedTasks; i++)
+    {
+        bench.Verify(vRanTime[i] != 0.0 && vRanTime[i] >= vDueTime[i], "Timed task '%d' %s",
+            i, vRanTime[i] != 0.0 ? "ran before its deadline" : "never ran");
+    }
+
+    bench.Msg("Frame task benchmark: '%d' tasks over '%d' frames, '%d' timed", nTasks, nFrames, nTimedTasks);
+    bench.Msg("Dispatch: '%.3f' ms ('%.3f' us per task)", flDispatchTime * 1e3, flDispatchTime * 1e6 / nTasks);
+    bench.Msg("Frames  : '%.3f' ms first, '%.3f' ms average after, '%.3f' ms max after",
+        flFirstTime * 1e3, nFrames > 1 ? (flTotalTime - flFirstTime) * 1e3 / (nFrames - 1) : 0.0, flMaxTime * 1e3);
+
+    return bench.Summarize("tasks", "their due frame or deadline");
 }
 
 //-----------------------------------------------------------------------------
@@ -3,25 +3,54 @@
 
 #include "public/iframetask.h"
 
+#define FRAMETASK_WHEEL_SIZE 256 // Slots in the timing wheel, must be a power of two.
+
+class CBenchmark;
+
 //=============================================================================//
 // This class is set up to run before each frame (main thread).
-// Committed tasks are scheduled to execute after 'i' frames.
+// Committed tasks are scheduled to execute after 'i' frames, or after a
+// number of seconds.
 // ----------------------------------------------------------------------------
 // A use case for scheduling tasks in the main thread would be (for example)
 // calling 'KeyValues::ParsePlaylists(...)' from the render thread.
+// ----------------------------------------------------------------------------
+// Tasks can be dispatched from any thread without locking; they are pushed
+// on an atomic stack that the main thread takes over at the start of each
+// frame. Frame delayed tasks are hashed into a timing wheel on their due
+// frame, so a frame only walks the tasks in its own slot. Tasks run outside
+// of the scheduler state and may dispatch new tasks.
 //=============================================================================//
 class CFrameTask : public IFrameTask
 {
 public:
-    virtual ~CFrameTask() {}
+    CFrameTask();
+    virtual ~CFrameTask();
     virtual void RunFrame();
     virtual bool IsFinished() const;
 
     void Dispatch(std::function<void()> functor, int frames);
+    void DispatchDelayed(std::function<void()> functor, double seconds);
+
+    static bool Benchmark(CBenchmark& bench, int nTasks, int nFrames);
 
 private:
-    mutable std::mutex m_Mutex;
-    std::list<ScheduledTasks_s> m_ScheduledTasks;
+    struct Slot_s
+    {
+        ScheduledTasks_s* m_pHead;
+        ScheduledTasks_s* m_pTail;
+    };
+
+    void Submit(ScheduledTasks_s* pTask);
+    void Schedule(ScheduledTasks_s* pTask);
+    static void FreeList(ScheduledTasks_s* pTask);
+
+    static double GetTime();
+
+    std::atomic<ScheduledTasks_s*> m_pSubmitted;  // Newest first.
+    Slot_s m_Wheel[FRAMETASK_WHEEL_SIZE];
+    std::vector<ScheduledTasks_s*> m_TimedTasks;  // Min heap on 'm_flDueTime'.
+    uint64_t m_nFrame;                            // Frames run so far.
 };
 
 extern std::list<IFrameTask*> g_FrameTasks;
@@ -0,0 +1,432 @@
+//=============================================================================//
+//
+// Purpose: Work-stealing thread pool
+//
+//=============================================================================//
+#include "core/stdafx.h"
+#include "tier0/cputopology.h"
+#include "tier0/threadpool.h"
+
+// Queue owned by the current thread, or the shared queue for threads that
+// aren't workers of the pool.
+static thread_local CThreadPool* s_pWorkerPool = nullptr;
+static thread_local size_t       s_nWorkerIndex = 0;
+
+//-----------------------------------------------------------------------------
+// Purpose: 
+// Input  : *pPool - nullptr for the process wide pool
+//-----------------------------------------------------------------------------
+CTaskGroup::CTaskGroup(CThreadPool* pPool)
+	: m_pPool(pPool ? pPool : g_pThreadPool)
+	, m_nPending(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: tasks reference the group, so it can't go away before them
+//-----------------------------------------------------------------------------
+CTaskGroup::~CTaskGroup(void)
+{
+	Wait();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: queues a task in this group
+// Input  : fnTask - 
+//-----------------------------------------------------------------------------
+void CTaskGroup::Run(std::function<void()> fnTask)
+{
+	m_nPending.fetch_add(1, std::memory_order_relaxed);
+	m_pPool->Submit(this, std::move(fnTask));
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: runs queued tasks until all tasks of this group have finished
+//-----------------------------------------------------------------------------
+void CTaskGroup::Wait(void)
+{
+	while (m_nPending.load())
+	{
+		if (!m_pPool->TryRunTask())
+		{
+			m_pPool->WaitForGroup(this); // Remaining tasks are running elsewhere.
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: adds a task to the graph
+// Input  : fnTask - 
+// Output : index of the task
+//-----------------------------------------------------------------------------
+size_t CTaskGraph::AddTask(std::function<void()> fnTask)
+{
+	std::unique_ptr<Node_t> pNode(new Node_t());
+	pNode->m_fnTask = std::move(fnTask);
+	pNode->m_nPredecessors = 0;
+	pNode->m_nRemaining = 0;
+
+	m_vNodes.push_back(std::move(pNode));
+	return m_vNodes.size() - 1;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: makes a task wait for another one
+// Input  : nBefore - 
+//          nAfter - 
+//-----------------------------------------------------------------------------
+void CTaskGraph::AddDependency(size_t nBefore, size_t nAfter)
+{
+	Assert(nBefore < m_vNodes.size() && nAfter < m_vNodes.size() && nBefore != nAfter);
+
+	m_vNodes[nBefore]->m_vSuccessors.push_back(nAfter);
+	m_vNodes[nAfter]->m_nPredecessors++;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: runs all tasks in dependency order and waits for them, the
+//          dependencies must not form a cycle
+// Input  : *pPool - nullptr for the process wide pool
+//-----------------------------------------------------------------------------
+void CTaskGraph::Execute(CThreadPool* pPool)
+{
+	CTaskGroup group(pPool);
+
+	for (std::unique_ptr<Node_t>& pNode : m_vNodes)
+	{
+		pNode->m_nRemaining.store(pNode->m_nPredecessors, std::memory_order_relaxed);
+	}
+	for (size_t i = 0; i < m_vNodes.size(); i++)
+	{
+		if (!m_vNodes[i]->m_nPredecessors)
+		{
+			group.Run([this, &group, i]() { RunNode(group, i); });
+		}
+	}
+
+	group.Wait();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: runs a task and queues the successors it was the last wait of
+// Input  : &group - 
+//          nIndex - 
+//-----------------------------------------------------------------------------
+void CTaskGraph::RunNode(CTaskGroup& group, size_t nIndex)
+{
+	Node_t* pNode = m_vNodes[nIndex].get();
+	pNode->m_fnTask();
+
+	for (size_t nSuccessor : pNode->m_vSuccessors)
+	{
+		if (m_vNodes[nSuccessor]->m_nRemaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			group.Run([this, &group, nSuccessor]() { RunNode(group, nSuccessor); });
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: 
+//-----------------------------------------------------------------------------
+CThreadPool::CThreadPool(void)
+	: m_nQueued(0)
+	, m_nSleeping(0)
+	, m_nWaiting(0)
+	, m_bShutdown(false)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: the workers reference the pool, so they are joined here
+//-----------------------------------------------------------------------------
+CThreadPool::~CThreadPool(void)
+{
+	Stop(true);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: starts the workers, only has effect before the pool is used
+// Input  : nWorkers - 0 for one per physical core but the first
+//-----------------------------------------------------------------------------
+void CThreadPool::Init(size_t nWorkers)
+{
+	std::call_once(m_InitFlag, &CThreadPool::StartWorkers, this, nWorkers);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: signals the workers to stop without waiting for them, this is
+//          called from DllMain where waiting on a thread deadlocks. Tasks
+//          still queued are left to the threads waiting on their groups
+//-----------------------------------------------------------------------------
+void CThreadPool::Shutdown(void)
+{
+	Stop(false);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: signals the workers to stop
+// Input  : bJoin - wait for the workers, otherwise detach them; the pool
+//                  must then outlive them, as the process wide one does
+//-----------------------------------------------------------------------------
+void CThreadPool::Stop(bool bJoin)
+{
+	{
+		std::lock_guard<std::mutex> l(m_SleepMutex);
+		m_bShutdown = true;
+	}
+	m_SleepCondition.notify_all();
+
+	for (std::thread& thread : m_vThreads)
+	{
+		if (!thread.joinable())
+			continue;
+
+		if (bJoin)
+			thread.join();
+		else
+			thread.detach();
+	}
+	m_vThreads.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: runs 'fnBody' over [nBegin, nEnd) in chunks of 'nGrain' elements,
+//          chunks are handed out one at a time so uneven chunks balance out.
+//          The calling thread processes chunks too
+// Input  : nBegin - 
+//          nEnd - 
+//          nGrain - elements per chunk, 0 for the default
+//          &fnBody - void(size_t nStart, size_t nEnd)
+//-----------------------------------------------------------------------------
+void CThreadPool::ParallelFor(size_t nBegin, size_t nEnd, size_t nGrain, const std::function<void(size_t nStart, size_t nEnd)>& fnBody)
+{
+	if (nBegin >= nEnd)
+		return;
+
+	if (!nGrain)
+		nGrain = GetDefaultGrain(nEnd - nBegin);
+
+	const size_t nChunks = (nEnd - nBegin + nGrain - 1) / nGrain;
+	if (nChunks == 1)
+	{
+		fnBody(nBegin, nEnd);
+		return;
+	}
+
+	std::atomic<size_t> nNextChunk(0);
+	auto fnWork = [&]()
+	{
+		for (size_t i; (i = nNextChunk.fetch_add(1, std::memory_order_relaxed)) < nChunks;)
+		{
+			const size_t nStart = nBegin + i * nGrain;
+			fnBody(nStart, std::min<size_t>(nStart + nGrain, nEnd));
+		}
+	};
+
+	CTaskGroup group(this);
+	const size_t nHelpers = std::min<size_t>(GetWorkerCount(), nChunks - 1);
+
+	for (size_t i = 0; i < nHelpers; i++)
+	{
+		group.Run(fnWork);
+	}
+
+	fnWork();
+	group.Wait();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: 
+//-----------------------------------------------------------------------------
+size_t CThreadPool::GetWorkerCount(void)
+{
+	Init();
+	return m_vThreads.size();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: gets a chunk size that gives every thread a few chunks to balance
+// Input  : nCount - 
+//-----------------------------------------------------------------------------
+size_t CThreadPool::GetDefaultGrain(size_t nCount)
+{
+	return std::max<size_t>(nCount / ((GetWorkerCount() + 1) * 8), 1);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: queues a task, workers push on their own queue
+// Input  : *pGroup - 
+//          fnTask - 
+//-----------------------------------------------------------------------------
+void CThreadPool::Submit(CTaskGroup* pGroup, std::function<void()> fnTask)
+{
+	Init();
+
+	const size_t nQueue = (s_pWorkerPool == this) ? s_nWorkerIndex : m_vQueues.size() - 1;
+	{
+		Queue_t& queue = *m_vQueues[nQueue];
+		std::lock_guard<std::mutex> l(queue.m_Mutex);
+		queue.m_Tasks.push_back(Task_t{ std::move(fnTask), pGroup });
+	}
+	m_nQueued.fetch_add(1);
+
+	const bool bSleeping = m_nSleeping.load() != 0;
+	const bool bWaiting = m_nWaiting.load() != 0;
+
+	if (bSleeping || bWaiting)
+	{
+		{
+			std::lock_guard<std::mutex> l(m_SleepMutex);
+		}
+		if (bSleeping)
+			m_SleepCondition.notify_one();
+		if (bWaiting) // A waiting thread can run it as well.
+			m_WaitCondition.notify_one();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: runs one queued task, preferring the own queue of the calling
+//          worker over the shared queue over stealing from other workers
+// Output : true if a task ran, false if all queues were empty
+//-----------------------------------------------------------------------------
+bool CThreadPool::TryRunTask(void)
+{
+	if (!m_nQueued.load(std::memory_order_relaxed))
+		return false;
+
+	const size_t nShared = m_vQueues.size() - 1;
+	const size_t nSelf = (s_pWorkerPool == this) ? s_nWorkerIndex : nShared;
+
+	Task_t task;
+	bool bFound = PopTask(nSelf, true, task) || (nSelf != nShared && PopTask(nShared, false, task));
+
+	for (size_t i = 1; !bFound && i <= nShared; i++)
+	{
+		const size_t nVictim = (nSelf + i) % (nShared + 1);
+		if (nVictim != nShared)
+		{
+			bFound = PopTask(nVictim, false, task);
+		}
+	}
+
+	if (!bFound)
+		return false;
+
+	task.m_fnTask();
+
+	// The group may be gone as soon as its count drops to zero, so the
+	// waiting thread is woken through the pool.
+	if (task.m_pGroup->m_nPending.fetch_sub(1) == 1 && m_nWaiting.load())
+	{
+		{
+			std::lock_guard<std::mutex> l(m_SleepMutex);
+		}
+		m_WaitCondition.notify_all();
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: takes a task from a queue
+// Input  : nQueue - 
+//          bBack - newest task if true, oldest otherwise
+//          &outTask - 
+//-----------------------------------------------------------------------------
+bool CThreadPool::PopTask(size_t nQueue, bool bBack, Task_t& outTask)
+{
+	Queue_t& queue = *m_vQueues[nQueue];
+	std::lock_guard<std::mutex> l(queue.m_Mutex);
+
+	if (queue.m_Tasks.empty())
+		return false;
+
+	if (bBack)
+	{
+		outTask = std::move(queue.m_Tasks.back());
+		queue.m_Tasks.pop_back();
+	}
+	else
+	{
+		outTask = std::move(queue.m_Tasks.front());
+		queue.m_Tasks.pop_front();
+	}
+
+	m_nQueued.fetch_sub(1, std::memory_order_relaxed);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: sleeps until the group has finished or a task has been queued
+// Input  : *pGroup - 
+//-----------------------------------------------------------------------------
+void CThreadPool::WaitForGroup(const CTaskGroup* pGroup)
+{
+	std::unique_lock<std::mutex> l(m_SleepMutex);
+	m_nWaiting.fetch_add(1);
+	m_WaitCondition.wait(l, [this, pGroup] { return !pGroup->m_nPending.load() || m_nQueued.load(); });
+	m_nWaiting.fetch_sub(1);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: creates the queues and the workers
+// Input  : nWorkers - 0 for one per physical core but the first
+//-----------------------------------------------------------------------------
+void CThreadPool::StartWorkers(size_t nWorkers)
+{
+	CpuTopology topology;
+	const size_t nCores = topology.NumberOfProcessCores();
+
+	if (!nWorkers)
+	{
+		nWorkers = std::max<size_t>(nCores, 2) - 1;
+	}
+
+	for (size_t i = 0; i <= nWorkers; i++)
+	{
+		m_vQueues.push_back(std::unique_ptr<Queue_t>(new Queue_t()));
+	}
+
+	for (size_t i = 0; i < nWorkers; i++)
+	{
+		// Leave core 0 to the frame thread, share the rest if there are
+		// more workers than cores.
+		const uintptr_t nAffinityMask = (nCores > 1)
+			? topology.CoreAffinityMask(static_cast<DWORD>(1 + i % (nCores - 1)))
+			: 0;
+
+		m_vThreads.push_back(std::thread(&CThreadPool::WorkerThread, this, i, nAffinityMask));
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: runs tasks, sleeps while all queues are empty
+// Input  : nIndex - 
+//          nAffinityMask - 0 to run on any core
+//-----------------------------------------------------------------------------
+void CThreadPool::WorkerThread(size_t nIndex, uintptr_t nAffinityMask)
+{
+	s_pWorkerPool = this;
+	s_nWorkerIndex = nIndex;
+
+	if (nAffinityMask)
+	{
+		SetThreadAffinityMask(GetCurrentThread(), nAffinityMask);
+	}
+
+	while (!m_bShutdown.load(std::memory_order_relaxed))
+	{
+		if (TryRunTask())
+			continue;
+
+		std::unique_lock<std::mutex> l(m_SleepMutex);
+		m_nSleeping.fetch_add(1);
+		m_SleepCondition.wait(l, [this] { return m_bShutdown.load() || m_nQueued.load(); });
+		m_nSleeping.fetch_sub(1);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+CThreadPool* g_pThreadPool = new CThreadPool();
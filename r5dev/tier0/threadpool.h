@@ -0,0 +1,166 @@
+#ifndef TIER0_THREADPOOL_H
+#define TIER0_THREADPOOL_H
+
+#include <deque>
+
+class CThreadPool;
+
+//-----------------------------------------------------------------------------
+// Counts the tasks of one fork/join region. Waiting on the group runs queued
+// tasks on the calling thread until all of the group's tasks have finished,
+// so groups may be nested and waited on from inside pool tasks. Once nothing
+// is left to run, the waiting thread sleeps until the group is done or more
+// tasks are queued.
+//-----------------------------------------------------------------------------
+class CTaskGroup
+{
+public:
+	CTaskGroup(CThreadPool* pPool = nullptr);
+	~CTaskGroup(void);
+
+	void Run(std::function<void()> fnTask);
+	void Wait(void);
+
+private:
+	friend class CThreadPool;
+
+	CThreadPool*        m_pPool;
+	std::atomic<size_t> m_nPending;
+};
+
+//-----------------------------------------------------------------------------
+// Set of tasks with dependencies, each task is queued as soon as all of the
+// tasks it depends on have finished. A graph can be executed repeatedly.
+//-----------------------------------------------------------------------------
+class CTaskGraph
+{
+public:
+	size_t AddTask(std::function<void()> fnTask);
+	void   AddDependency(size_t nBefore, size_t nAfter);
+	void   Execute(CThreadPool* pPool = nullptr);
+
+	size_t GetTaskCount(void) const { return m_vNodes.size(); }
+
+private:
+	struct Node_t
+	{
+		std::function<void()> m_fnTask;
+		vector<size_t>        m_vSuccessors;
+		size_t                m_nPredecessors;
+		std::atomic<size_t>   m_nRemaining; // Predecessors yet to finish this execution.
+	};
+
+	void RunNode(CTaskGroup& group, size_t nIndex);
+
+	vector<std::unique_ptr<Node_t>> m_vNodes;
+};
+
+//-----------------------------------------------------------------------------
+// Process wide work-stealing thread pool. Every worker owns a task queue it
+// pushes and pops at the back, idle workers steal from the front of the
+// others. Tasks submitted from threads outside the pool go in a shared queue.
+// Workers are pinned to the physical cores after the first one, which is
+// left to the frame thread. The workers are started on first use.
+//-----------------------------------------------------------------------------
+class CThreadPool
+{
+public:
+	CThreadPool(void);
+	~CThreadPool(void);
+
+	void Init(size_t nWorkers = 0);
+	void Shutdown(void);
+
+	void ParallelFor(size_t nBegin, size_t nEnd, size_t nGrain, const std::function<void(size_t nStart, size_t nEnd)>& fnBody);
+
+	template <typename T, typename MapFn, typename ReduceFn>
+	T ParallelReduce(size_t nBegin, size_t nEnd, size_t nGrain, T identity, MapFn&& fnMap, ReduceFn&& fnReduce);
+
+	size_t GetWorkerCount(void);
+	size_t GetDefaultGrain(size_t nCount);
+
+private:
+	friend class CTaskGroup;
+
+	struct Task_t
+	{
+		std::function<void()> m_fnTask;
+		CTaskGroup*           m_pGroup;
+	};
+
+	struct Queue_t
+	{
+		std::mutex         m_Mutex;
+		std::deque<Task_t> m_Tasks;
+	};
+
+	void Submit(CTaskGroup* pGroup, std::function<void()> fnTask);
+	bool TryRunTask(void);
+	bool PopTask(size_t nQueue, bool bBack, Task_t& outTask);
+	void WaitForGroup(const CTaskGroup* pGroup);
+	void Stop(bool bJoin);
+
+	void StartWorkers(size_t nWorkers);
+	void WorkerThread(size_t nIndex, uintptr_t nAffinityMask);
+
+	vector<std::unique_ptr<Queue_t>> m_vQueues; // One per worker, the last one is shared.
+	vector<std::thread>              m_vThreads;
+
+	std::once_flag                   m_InitFlag;
+	std::mutex                       m_SleepMutex;
+	std::condition_variable          m_SleepCondition;
+	std::condition_variable          m_WaitCondition; // Threads in CTaskGroup::Wait, kept by the pool as it outlives the groups.
+	std::atomic<size_t>              m_nQueued;
+	std::atomic<size_t>              m_nSleeping;
+	std::atomic<size_t>              m_nWaiting;
+	std::atomic<bool>                m_bShutdown;
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: reduces a range in parallel, the partial results of the chunks
+//          are combined in range order so the result doesn't depend on
+//          scheduling
+// Input  : nBegin - 
+//          nEnd - 
+//          nGrain - elements per chunk, 0 for the default
+//          identity - 
+//          fnMap - T(size_t nStart, size_t nEnd)
+//          fnReduce - T(const T& a, const T& b)
+//-----------------------------------------------------------------------------
+template <typename T, typename MapFn, typename ReduceFn>
+T CThreadPool::ParallelReduce(size_t nBegin, size_t nEnd, size_t nGrain, T identity, MapFn&& fnMap, ReduceFn&& fnReduce)
+{
+	if (nBegin >= nEnd)
+		return identity;
+
+	if (!nGrain)
+		nGrain = GetDefaultGrain(nEnd - nBegin);
+
+	struct Partial_t // Not a vector<T>, as vector<bool> can't be written concurrently.
+	{
+		T m_Value;
+	};
+
+	const size_t nChunks = (nEnd - nBegin + nGrain - 1) / nGrain;
+	vector<Partial_t> vPartials(nChunks, Partial_t{ identity });
+
+	ParallelFor(0, nChunks, 1, [&](size_t nFirst, size_t nLast)
+		{
+			for (size_t i = nFirst; i < nLast; i++)
+			{
+				const size_t nStart = nBegin + i * nGrain;
+				vPartials[i].m_Value = fnMap(nStart, std::min<size_t>(nStart + nGrain, nEnd));
+			}
+		});
+
+	T result = identity;
+	for (const Partial_t& partial : vPartials)
+	{
+		result = fnReduce(result, partial.m_Value);
+	}
+	return result;
+}
+
+extern CThreadPool* g_pThreadPool;
+
+#endif // TIER0_THREADPOOL_H
@@ -86,6 +86,7 @@ void ConVar::Init(void) const
 #ifndef CLIENT_DLL
 	ai_ainDumpOnLoad             = ConVar::Create("ai_ainDumpOnLoad"            , "0", FCVAR_DEVELOPMENTONLY, "Dumps AIN data from node graphs loaded from the disk on load.", false, 0.f, false, 0.f, nullptr, nullptr);
 	ai_ainDebugConnect           = ConVar::Create("ai_ainDebugConnect"          , "0", FCVAR_DEVELOPMENTONLY, "Debug AIN node connections.", false, 0.f, false, 0.f, nullptr, nullptr);
+	ai_ainDebugWrite             = ConVar::Create("ai_ainDebugWrite"            , "0", FCVAR_DEVELOPMENTONLY, "Logs every node, link and cluster written to AIN files on build.", false, 0.f, false, 0.f, nullptr, nullptr);
 	ai_script_nodes_draw_range   = ConVar::Create("ai_script_nodes_draw_range"  , "0", FCVAR_DEVELOPMENTONLY, "Debug draw AIN script nodes ranging from shift index to this cvar.", false, 0.f, false, 0.f, nullptr, nullptr);
 	ai_script_nodes_draw_nearest = ConVar::Create("ai_script_nodes_draw_nearest", "0", FCVAR_DEVELOPMENTONLY, "Debug draw AIN script node links to nearest node (build order is used if null).", false, 0.f, false, 0.f, nullptr, nullptr);
 
@@ -103,7 +104,7 @@ void ConVar::Init(void) const
 	sv_showconnecting  = ConVar::Create("sv_showconnecting" , "1", FCVAR_RELEASE, "Logs information about the connecting client to the console.", false, 0.f, false, 0.f, nullptr, nullptr);
 	sv_pylonVisibility = ConVar::Create("sv_pylonVisibility", "0", FCVAR_RELEASE, "Determines the visibility to the Pylon master server.", false, 0.f, false, 0.f, nullptr, "0 = Offline, 1 = Hidden, 2 = Public.");
 	sv_pylonRefreshRate   = ConVar::Create("sv_pylonRefreshRate"  , "5.0", FCVAR_RELEASE, "Pylon host refresh rate (seconds).", true, 2.f, true, 8.f, nullptr, nullptr);
-	sv_banlistRefreshRate = ConVar::Create("sv_banlistRefreshRate", "1.0", FCVAR_RELEASE, "Banned list refresh rate (seconds).", true, 1.f, false, 0.f, nullptr, nullptr);
+	sv_banlistRefreshRate = ConVar::Create("sv_banlistRefreshRate", "1.0", FCVAR_RELEASE, "Deprecated and ignored, refused clients are removed on the next frame; will be removed in a future release.", true, 1.f, false, 0.f, nullptr, nullptr);
 	sv_statusRefreshRate  = ConVar::Create("sv_statusRefreshRate" , "0.5", FCVAR_RELEASE, "Server status refresh rate (seconds).", false, 0.f, false, 0.f, nullptr, nullptr);
 	sv_autoReloadRate     = ConVar::Create("sv_autoReloadRate"    , "0"  , FCVAR_RELEASE, "Time in seconds between each server auto-reload (disabled if null). ", true, 0.f, false, 0.f, nullptr, nullptr);
 	sv_quota_stringCmdsPerSecond = ConVar::Create("sv_quota_stringCmdsPerSecond", "16", FCVAR_RELEASE, "How many string commands per second clients are allowed to submit, 0 to disallow all string commands.", true, 0.f, false, 0.f, nullptr, nullptr);
@@ -189,6 +190,8 @@ void ConVar::Init(void) const
 	fs_packedstore_entryblock_stats  = ConVar::Create("fs_packedstore_entryblock_stats"       , "0", FCVAR_DEVELOPMENTONLY, "Logs the stats of each file entry in the VPK during decompression ( !slower! ).", false, 0.f, false, 0.f, nullptr, nullptr);
 	fs_packedstore_workspace         = ConVar::Create("fs_packedstore_workspace"  , "platform/vpk/", FCVAR_DEVELOPMENTONLY, "Determines the current VPK workspace.", false, 0.f, false, 0.f, nullptr, nullptr);
 	fs_packedstore_compression_level = ConVar::Create("fs_packedstore_compression_level", "default", FCVAR_DEVELOPMENTONLY, "Determines the VPK compression level.", false, 0.f, false, 0.f, nullptr, "fastest faster default better uber");
+	fs_packedstore_max_threads       = ConVar::Create("fs_packedstore_max_threads"      , "0"      , FCVAR_DEVELOPMENTONLY, "Number of worker threads used for VPK packing and unpacking ( 0 = serial, -1 = hardware concurrency ).", true, -1.f, true, 64.f, nullptr, nullptr);
+	fs_packedstore_incremental       = ConVar::Create("fs_packedstore_incremental"      , "0"      , FCVAR_DEVELOPMENTONLY, "Reuses unchanged entries from the previous VPK build instead of recompressing them.", false, 0.f, false, 0.f, nullptr, nullptr);
 	//-------------------------------------------------------------------------
 	// MATERIALSYSTEM                                                         |
 #ifndef DEDICATED
@@ -211,6 +214,9 @@ void ConVar::Init(void) const
 	pylon_matchmaking_hostname = ConVar::Create("pylon_matchmaking_hostname", "ms.r5reloaded.com", FCVAR_RELEASE        , "Holds the pylon matchmaking hostname.", false, 0.f, false, 0.f, &MP_HostName_Changed_f, nullptr);
 	pylon_host_update_interval = ConVar::Create("pylon_host_update_interval", "5"                , FCVAR_RELEASE        , "Length of time in seconds between each status update interval to master server.", true, 5.f, false, 0.f, nullptr, nullptr);
 	pylon_showdebuginfo        = ConVar::Create("pylon_showdebuginfo"       , "0"                , FCVAR_RELEASE, "Shows debug output for pylon.", false, 0.f, false, 0.f, nullptr, nullptr);
+	pylon_bancache_size        = ConVar::Create("pylon_bancache_size"       , "4096"             , FCVAR_RELEASE        , "Max number of master server ban verdicts to cache.", true, 0.f, false, 0.f, nullptr, "0 = disabled.");
+	pylon_bancache_clean_ttl   = ConVar::Create("pylon_bancache_clean_ttl"  , "300"              , FCVAR_RELEASE        , "Length of time in seconds a clean master server ban verdict is cached.", true, 0.f, false, 0.f, nullptr, nullptr);
+	pylon_bancache_banned_ttl  = ConVar::Create("pylon_bancache_banned_ttl" , "600"              , FCVAR_RELEASE        , "Length of time in seconds a banned master server ban verdict is cached.", true, 0.f, false, 0.f, nullptr, nullptr);
 	//-------------------------------------------------------------------------
 	// RTECH API                                                              |
 	rtech_debug = ConVar::Create("rtech_debug", "0", FCVAR_DEVELOPMENTONLY, "Shows debug output for the RTech system.", false, 0.f, false, 0.f, nullptr, nullptr);
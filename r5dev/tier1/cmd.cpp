@@ -332,6 +332,9 @@ void ConCommand::Init(void)
 #ifndef CLIENT_DLL
 	ConCommand::Create("reload_playlists", "Reloads the playlists file.", FCVAR_RELEASE, Host_ReloadPlaylists_f, nullptr);
 #endif // !CLIENT_DLL
+	ConCommand::Create("host_frametask_bench", "Benchmarks and verifies the frame task scheduler | Usage: host_frametask_bench [tasks] [frames].", FCVAR_DEVELOPMENTONLY, Host_FrameTaskBench_f, nullptr);
+	ConCommand::Create("host_sigscan_bench", "Benchmarks and verifies the batched signature scanner on the game's code section | Usage: host_sigscan_bench [signatures] [iterations].", FCVAR_DEVELOPMENTONLY, Host_SigScanBench_f, nullptr);
+	ConCommand::Create("host_checksum_bench", "Benchmarks and verifies the crc32 and adler32 kernels on 1 KiB, 1 MiB and 1 GiB buffers | Usage: host_checksum_bench [largest size in MiB].", FCVAR_DEVELOPMENTONLY, Host_ChecksumBench_f, nullptr);
 	//-------------------------------------------------------------------------
 	// SERVER DLL                                                             |
 #ifndef CLIENT_DLL
@@ -342,6 +345,12 @@ void ConCommand::Init(void)
 	ConCommand::Create("sv_banid", "Bans a client from the server by handle, nucleus id or ip address | Usage: sv_banid \"<HandleID>\"/\"<NucleusID>/<IPAddress>\".", FCVAR_RELEASE, Host_BanID_f, nullptr);
 	ConCommand::Create("sv_unban", "Unbans a client from the server by nucleus id or ip address | Usage: sv_unban \"<NucleusID>\"/\"<IPAddress>\".", FCVAR_RELEASE, Host_Unban_f, nullptr);
 	ConCommand::Create("sv_reloadbanlist", "Reloads the banned list.", FCVAR_RELEASE, Host_ReloadBanList_f, nullptr);
+	ConCommand::Create("sv_importbanlist", "Replaces the banned list with the one in 'banlist.json'.", FCVAR_RELEASE, Host_ImportBanList_f, nullptr);
+	ConCommand::Create("sv_exportbanlist", "Writes the banned list to 'banlist.json'.", FCVAR_RELEASE, Host_ExportBanList_f, nullptr);
+	ConCommand::Create("sv_banlist_bench", "Benchmarks and verifies banned list lookups on a generated list | Usage: sv_banlist_bench [entries] [lookups].", FCVAR_DEVELOPMENTONLY, Host_BanListBench_f, nullptr);
+	ConCommand::Create("pylon_bancache_stats", "Prints the master server ban verdict cache counters.", FCVAR_RELEASE, Pylon_BanCacheStats_f, nullptr);
+	ConCommand::Create("pylon_bancache_clear", "Drops all cached master server ban verdicts.", FCVAR_RELEASE, Pylon_BanCacheClear_f, nullptr);
+	ConCommand::Create("ai_nodegrid_bench", "Benchmarks and verifies the AI node grid on the loaded network | Usage: ai_nodegrid_bench [queries].", FCVAR_DEVELOPMENTONLY, AI_NodeGridBench_f, nullptr);
 #endif // !CLIENT_DLL
 #ifndef DEDICATED
 	//-------------------------------------------------------------------------
@@ -359,7 +368,9 @@ void ConCommand::Init(void)
 	// FILESYSTEM API                                                         |
 	ConCommand::Create("fs_vpk_mount",  "Mounts a VPK file for FileSystem usage.", FCVAR_DEVELOPMENTONLY, VPK_Mount_f, nullptr);
 	ConCommand::Create("fs_vpk_build",  "Builds a VPK file from current workspace.", FCVAR_DEVELOPMENTONLY, VPK_Pack_f, nullptr);
+	ConCommand::Create("fs_vpk_build_verify", "Builds a VPK file from current workspace serially and in parallel and compares the output | Usage: fs_vpk_build_verify <locale> <context> <level_name> [manifest_only].", FCVAR_DEVELOPMENTONLY, VPK_PackVerify_f, nullptr);
 	ConCommand::Create("fs_vpk_unpack", "Unpacks all files from a VPK file.", FCVAR_DEVELOPMENTONLY, VPK_Unpack_f, nullptr);
+	ConCommand::Create("fs_vpk_dir_bench", "Benchmarks VPK directory file parsing.", FCVAR_DEVELOPMENTONLY, VPK_DirBench_f, nullptr);
 	//-------------------------------------------------------------------------
 	// RTECH API                                                              |
 	ConCommand::Create("rtech_strtoguid", "Calculates the GUID from input data.", FCVAR_DEVELOPMENTONLY, RTech_StringToGUID_f, nullptr);
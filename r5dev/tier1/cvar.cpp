@@ -48,6 +48,7 @@ ConVar* stream_overlay_mode                = nullptr;
 #ifndef CLIENT_DLL
 ConVar* ai_ainDumpOnLoad                   = nullptr;
 ConVar* ai_ainDebugConnect                 = nullptr;
+ConVar* ai_ainDebugWrite                   = nullptr;
 ConVar* ai_script_nodes_draw               = nullptr;
 ConVar* ai_script_nodes_draw_range         = nullptr;
 ConVar* ai_script_nodes_draw_nearest       = nullptr;
@@ -67,7 +68,7 @@ ConVar* navmesh_draw_poly_bounds_inner     = nullptr;
 ConVar* sv_showconnecting                  = nullptr;
 ConVar* sv_pylonVisibility                 = nullptr;
 ConVar* sv_pylonRefreshRate                = nullptr;
-ConVar* sv_banlistRefreshRate              = nullptr;
+ConVar* sv_banlistRefreshRate              = nullptr; // Deprecated, kept so configs that set it still load.
 ConVar* sv_statusRefreshRate               = nullptr;
 ConVar* sv_forceChatToTeamOnly             = nullptr;
 
@@ -160,6 +161,8 @@ ConVar* fs_show_warning_output             = nullptr;
 ConVar* fs_packedstore_entryblock_stats    = nullptr;
 ConVar* fs_packedstore_workspace           = nullptr;
 ConVar* fs_packedstore_compression_level   = nullptr;
+ConVar* fs_packedstore_max_threads         = nullptr;
+ConVar* fs_packedstore_incremental         = nullptr;
 //-----------------------------------------------------------------------------
 // MATERIALSYSTEM                                                             |
 #ifndef DEDICATED
@@ -182,6 +185,9 @@ ConVar* net_processTimeBudget              = nullptr;
 ConVar* pylon_matchmaking_hostname         = nullptr;
 ConVar* pylon_host_update_interval         = nullptr;
 ConVar* pylon_showdebuginfo                = nullptr;
+ConVar* pylon_bancache_size                = nullptr;
+ConVar* pylon_bancache_clean_ttl           = nullptr;
+ConVar* pylon_bancache_banned_ttl          = nullptr;
 //-----------------------------------------------------------------------------
 // RTECH API                                                                  |
 ConVar* rtech_debug                        = nullptr;
@@ -45,6 +45,7 @@ extern ConVar* stream_overlay_mode;
 #ifndef CLIENT_DLL
 extern ConVar* ai_ainDumpOnLoad;
 extern ConVar* ai_ainDebugConnect;
+extern ConVar* ai_ainDebugWrite;
 extern ConVar* ai_script_nodes_draw;
 extern ConVar* ai_script_nodes_draw_range;
 extern ConVar* ai_script_nodes_draw_nearest;
@@ -156,6 +157,8 @@ extern ConVar* fs_show_warning_output;
 extern ConVar* fs_packedstore_entryblock_stats;
 extern ConVar* fs_packedstore_workspace;
 extern ConVar* fs_packedstore_compression_level;
+extern ConVar* fs_packedstore_max_threads;
+extern ConVar* fs_packedstore_incremental;
 //-------------------------------------------------------------------------
 // MATERIALSYSTEM                                                         |
 #ifndef DEDICATED
@@ -178,6 +181,9 @@ extern ConVar* net_processTimeBudget;
 extern ConVar* pylon_matchmaking_hostname;
 extern ConVar* pylon_host_update_interval;
 extern ConVar* pylon_showdebuginfo;
+extern ConVar* pylon_bancache_size;
+extern ConVar* pylon_bancache_clean_ttl;
+extern ConVar* pylon_bancache_banned_ttl;
 //-------------------------------------------------------------------------
 // RTECH API                                                              |
 extern ConVar* rtech_debug;
@@ -0,0 +1,99 @@
+//===========================================================================//
+//
+// Purpose: Length-prefixed frame decoder for net console streams.
+//
+//===========================================================================//
+
+#include "core/stdafx.h"
+#include "public/utility/benchmark.h"
+#include "tier2/framedecoder.h"
+
+//-----------------------------------------------------------------------------
+// Purpose: feeds a stream of random frames split at random points through the
+//          frame decoder, verifies every frame and reports the throughput
+// Input  : &bench - 
+//          nIterations - 
+// Output : true if every frame was decoded intact, false otherwise
+//-----------------------------------------------------------------------------
+bool NetCon_BenchmarkDecoder(CBenchmark& bench, int nIterations)
+{
+	std::mt19937 rng(BENCH_RANDOM_SEED);
+
+	// Mostly log line sized frames with some empty and some large ones,
+	// empty frames are skipped by the decoder so they aren't expected back.
+	std::vector<std::pair<size_t, int>> vFrames; // Offset of the payload in the stream and its size.
+	std::string svStream;
+
+	while (svStream.size() < 64 * 1024 * 1024)
+	{
+		const int nPick = rng() % 100;
+		const int nSize = nPick < 2 ? 0 : nPick < 97 ? 16 + rng() % 512 : 4096 + rng() % (256 * 1024);
+
+		svStream.push_back(static_cast<char>(nSize >> 24));
+		svStream.push_back(static_cast<char>(nSize >> 16));
+		svStream.push_back(static_cast<char>(nSize >> 8 ));
+		svStream.push_back(static_cast<char>(nSize));
+
+		if (nSize)
+		{
+			vFrames.emplace_back(svStream.size(), nSize);
+		}
+		for (int i = 0; i < nSize; i++)
+		{
+			svStream.push_back(static_cast<char>(rng()));
+		}
+	}
+
+	const double flMiB = svStream.size() / (1024.0 * 1024.0);
+	double flTotal = 0.0;
+
+	for (int i = 0; i < nIterations; i++)
+	{
+		// Recv sized chunks, with every fourth pass split into tiny pieces to
+		// exercise size fields and payloads spanning reads.
+		const size_t nMaxChunk = (i % 4 == 3) ? 7 : 8192;
+
+		std::vector<size_t> vSplits;
+		for (size_t nPos = 0; nPos < svStream.size(); nPos += 1 + rng() % nMaxChunk)
+		{
+			vSplits.push_back(nPos);
+		}
+		vSplits.push_back(svStream.size());
+
+		CConnectedNetConsoleData data;
+		size_t nFrame = 0;
+		bool bIntact = true;
+
+		const double flElapsed = CBenchmark::Time([&]()
+			{
+				for (size_t j = 0; j + 1 < vSplits.size(); j++)
+				{
+					const NetConFrameStatus_t nStatus = NetCon_DecodeFrames(&data, &svStream[vSplits[j]], static_cast<int>(vSplits[j + 1] - vSplits[j]), INT_MAX,
+						[&](const char* pFrame, int nFrameLen)
+						{
+							if (nFrame >= vFrames.size() || vFrames[nFrame].second != nFrameLen
+								|| memcmp(pFrame, &svStream[vFrames[nFrame].first], nFrameLen) != 0)
+							{
+								bIntact = false;
+								return false;
+							}
+							nFrame++;
+							return true;
+						});
+
+					if (nStatus != NetConFrameStatus_t::NETCON_FRAME_SUCCESS)
+					{
+						bIntact = false;
+						break;
+					}
+				}
+			});
+
+		flTotal += flElapsed;
+		bench.Verify(bIntact && nFrame == vFrames.size(), "Pass '%d' stopped at frame '%zu' of '%zu'", i, nFrame, vFrames.size());
+		bench.Msg("Pass '%d': '%zu' frames in '%zu' reads, '%.1f' MiB/s", i, vFrames.size(), vSplits.size() - 1, flMiB / flElapsed);
+	}
+
+	bench.Msg("Average '%.1f' MiB/s over '%d' pass(es)", flMiB * nIterations / flTotal, nIterations);
+	return bench.Summarize("passes", "the encoded frames");
+}
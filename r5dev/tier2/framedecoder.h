@@ -0,0 +1,138 @@
+//===========================================================================//
+//
+// Purpose: Length-prefixed frame decoder for net console streams.
+//
+//===========================================================================//
+#pragma once
+#include "common/igameserverdata.h"
+
+class CBenchmark;
+
+enum class NetConFrameStatus_t : int
+{
+	NETCON_FRAME_SUCCESS = 0,  // All input has been consumed.
+	NETCON_FRAME_ABORTED,      // The frame callback asked to stop.
+	NETCON_FRAME_INVALID_SIZE  // Size prefix is negative or too large, the stream is out of sync.
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: decodes frames of a 4 byte big endian size followed by the payload
+//          from a stream that may be split at any byte. Frames that are fully
+//          contained in the input are passed straight from the input buffer,
+//          only frames spanning reads are gathered in 'm_RecvBuffer'. Empty
+//          frames are skipped
+// Input  : *pData - connection holding the partial frame state
+//          *pRecvBuf - 
+//          nRecvLen - 
+//          fnMaxSize - int(void), largest payload size accepted, queried for
+//                      every frame so a limit raised by a frame applies to the next
+//          fnFrame - bool(const char* pFrame, int nFrameLen), return false to stop
+// Output : NETCON_FRAME_INVALID_SIZE leaves the offending size in 'm_nPayloadLen'
+//-----------------------------------------------------------------------------
+template <typename MaxSizeCallback, typename FrameCallback>
+NetConFrameStatus_t NetCon_DecodeFrames(CConnectedNetConsoleData* pData, const char* pRecvBuf, int nRecvLen, MaxSizeCallback&& fnMaxSize, FrameCallback&& fnFrame)
+{
+	while (nRecvLen > 0)
+	{
+		if (!pData->m_nPayloadLen) // Size field.
+		{
+			const uint8_t* pHeader;
+			if (!pData->m_nPayloadRead && nRecvLen >= static_cast<int>(sizeof(int)))
+			{
+				pHeader = reinterpret_cast<const uint8_t*>(pRecvBuf);
+
+				pRecvBuf += sizeof(int);
+				nRecvLen -= sizeof(int);
+			}
+			else // Split across reads.
+			{
+				if (pData->m_RecvBuffer.size() < sizeof(int))
+				{
+					pData->m_RecvBuffer.resize(sizeof(int));
+				}
+
+				const int nCopy = std::min<int>(static_cast<int>(sizeof(int)) - pData->m_nPayloadRead, nRecvLen);
+				memcpy(&pData->m_RecvBuffer[pData->m_nPayloadRead], pRecvBuf, nCopy);
+
+				pData->m_nPayloadRead += nCopy;
+				pRecvBuf += nCopy;
+				nRecvLen -= nCopy;
+
+				if (pData->m_nPayloadRead < static_cast<int>(sizeof(int)))
+				{
+					break;
+				}
+				pHeader = pData->m_RecvBuffer.data();
+			}
+
+			const int nSize = static_cast<int>(
+				pHeader[0] << 24 |
+				pHeader[1] << 16 |
+				pHeader[2] << 8  |
+				pHeader[3]);
+			pData->m_nPayloadRead = 0;
+
+			if (nSize < 0 || nSize > fnMaxSize())
+			{
+				pData->m_nPayloadLen = nSize;
+				return NetConFrameStatus_t::NETCON_FRAME_INVALID_SIZE;
+			}
+
+			if (!nSize) // Nothing to deliver.
+			{
+				continue;
+			}
+
+			if (nSize <= nRecvLen) // Whole payload is in this read.
+			{
+				const char* pFrame = pRecvBuf;
+
+				pRecvBuf += nSize;
+				nRecvLen -= nSize;
+
+				if (!fnFrame(pFrame, nSize))
+				{
+					return NetConFrameStatus_t::NETCON_FRAME_ABORTED;
+				}
+				continue;
+			}
+
+			pData->m_nPayloadLen = nSize;
+			pData->m_RecvBuffer.resize(nSize);
+		}
+
+		// Payload split across reads.
+		const int nCopy = std::min<int>(pData->m_nPayloadLen - pData->m_nPayloadRead, nRecvLen);
+		memcpy(&pData->m_RecvBuffer[pData->m_nPayloadRead], pRecvBuf, nCopy);
+
+		pData->m_nPayloadRead += nCopy;
+		pRecvBuf += nCopy;
+		nRecvLen -= nCopy;
+
+		if (pData->m_nPayloadRead == pData->m_nPayloadLen)
+		{
+			const int nSize = pData->m_nPayloadLen;
+
+			pData->m_nPayloadLen = 0;
+			pData->m_nPayloadRead = 0;
+
+			if (!fnFrame(reinterpret_cast<const char*>(pData->m_RecvBuffer.data()), nSize))
+			{
+				return NetConFrameStatus_t::NETCON_FRAME_ABORTED;
+			}
+		}
+	}
+
+	return NetConFrameStatus_t::NETCON_FRAME_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: decodes frames with a fixed size limit, see above
+//-----------------------------------------------------------------------------
+template <typename FrameCallback>
+NetConFrameStatus_t NetCon_DecodeFrames(CConnectedNetConsoleData* pData, const char* pRecvBuf, int nRecvLen, int nMaxSize, FrameCallback&& fnFrame)
+{
+	return NetCon_DecodeFrames(pData, pRecvBuf, nRecvLen, [nMaxSize]() { return nMaxSize; }, std::forward<FrameCallback>(fnFrame));
+}
+
+bool NetCon_BenchmarkDecoder(CBenchmark& bench, int nIterations);
@@ -42,8 +42,9 @@ void CSocketCreator::RunFrame(void)
 
 //-----------------------------------------------------------------------------
 // Purpose: handle a new connection
+// Output : accepted socket index, SOCKET_ERROR (-1) if none was accepted
 //-----------------------------------------------------------------------------
-void CSocketCreator::ProcessAccept(void)
+int CSocketCreator::ProcessAccept(void)
 {
 	sockaddr_storage inClient{};
 	int nLengthAddr = sizeof(inClient);
@@ -58,19 +59,19 @@ void CSocketCreator::ProcessAccept(void)
 			printf("Socket ProcessAccept Error: %s\n", NET_ErrorString(WSAGetLastError()));
 #endif // !NETCONSOLE
 		}
-		return;
+		return SOCKET_ERROR;
 	}
 
 	if (!ConfigureListenSocket(newSocket))
 	{
 		::closesocket(newSocket);
-		return;
+		return SOCKET_ERROR;
 	}
 
 	CNetAdr2 netAdr2;
 	netAdr2.SetFromSockadr(&inClient);
 
-	OnSocketAccepted(newSocket, netAdr2);
+	return OnSocketAccepted(newSocket, netAdr2);
 }
 
 //-----------------------------------------------------------------------------
@@ -379,3 +380,39 @@ CConnectedNetConsoleData* CSocketCreator::GetAcceptedSocketData(int nIndex) cons
 {
 	return m_hAcceptedSockets[nIndex].m_pData;
 }
+
+//-----------------------------------------------------------------------------
+// Purpose: returns the index of an accepted socket
+// Input  : hSocket - 
+// Output : accepted socket index, SOCKET_ERROR (-1) if not found
+//-----------------------------------------------------------------------------
+int CSocketCreator::FindAcceptedSocket(SocketHandle_t hSocket) const
+{
+	for (size_t i = 0; i < m_hAcceptedSockets.size(); i++)
+	{
+		if (m_hAcceptedSockets[i].m_hSocket == hSocket)
+		{
+			return static_cast<int>(i);
+		}
+	}
+	return SOCKET_ERROR;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: fills the poll set with the listen socket and all accepted
+//          sockets, waiting for incoming connections and data
+// Input  : &vPollFds - 
+//-----------------------------------------------------------------------------
+void CSocketCreator::GetPollSet(std::vector<WSAPOLLFD>& vPollFds) const
+{
+	vPollFds.clear();
+
+	if (IsListening())
+	{
+		vPollFds.push_back({ static_cast<SOCKET>(m_hListenSocket), POLLRDNORM, 0 });
+	}
+	for (const AcceptedSocket_t& accepted : m_hAcceptedSockets)
+	{
+		vPollFds.push_back({ static_cast<SOCKET>(accepted.m_hSocket), POLLRDNORM, 0 });
+	}
+}
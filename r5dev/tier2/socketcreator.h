@@ -12,7 +12,7 @@ public:
 	~CSocketCreator(void);
 
 	void RunFrame(void);
-	void ProcessAccept(void);
+	int ProcessAccept(void);
 
 	bool ConfigureListenSocket(int iSocket);
 	bool ConfigureConnectSocket(SocketHandle_t hSocket);
@@ -35,6 +35,9 @@ public:
 	SocketHandle_t GetAcceptedSocketHandle(int nIndex) const;
 	const CNetAdr2& GetAcceptedSocketAddress(int nIndex) const;
 	CConnectedNetConsoleData* GetAcceptedSocketData(int nIndex) const;
+	int FindAcceptedSocket(SocketHandle_t hSocket) const;
+
+	void GetPollSet(std::vector<WSAPOLLFD>& vPollFds) const;
 
 public:
 	struct AcceptedSocket_t
@@ -53,6 +56,6 @@ public:
 private:
 	enum
 	{
-		SOCKET_TCP_MAX_ACCEPTS = 2
+		SOCKET_TCP_MAX_ACCEPTS = 64 // Backlog of pending connections, accepted sockets are limited by 'sv_rcon_maxsockets'.
 	};
 };
@@ -7,10 +7,10 @@
 * ╚═╝  ╚═╝ ╚═╝      ╚═══╝  ╚═╝     ╚═╝  ╚═╝    ╚══════╝╚═╝╚═════╝  *
 *******************************************************************/
 #include "core/stdafx.h"
+#include "tier0/threadpool.h"
 #include "tier1/cvar.h"
 #include "mathlib/adler32.h"
 #include "mathlib/crc32.h"
-#include "mathlib/sha1.h"
 #include "vpklib/packedstore.h"
 
 //-----------------------------------------------------------------------------
@@ -115,6 +115,20 @@ lzham_compress_level CPackedStore::GetCompressionLevel(void) const
 		return lzham_compress_level::LZHAM_COMP_LEVEL_DEFAULT;
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: gets the number of worker threads used for packing and unpacking
+// output : int
+//-----------------------------------------------------------------------------
+int CPackedStore::GetWorkerThreadCount(void) const
+{
+	const int nThreads = fs_packedstore_max_threads->GetInt();
+
+	if (nThreads < 0)
+		return std::max<int>(std::thread::hardware_concurrency(), 1);
+	else
+		return nThreads;
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: obtains and returns the entry block to the vector
 // Input  : *pReader - 
@@ -278,6 +292,44 @@ nlohmann::json CPackedStore::GetManifest(const string& svWorkSpace, const string
 	return jsOut;
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: gets the manifest values for specified entry (defaults if absent)
+// Input  : &jManifest -
+//          &svEntryPath -
+// Output : VPKKeyValues_t
+//-----------------------------------------------------------------------------
+VPKKeyValues_t CPackedStore::GetEntryValues(const nlohmann::json& jManifest, const string& svEntryPath) const
+{
+	VPKKeyValues_t vKeyValues;
+	vKeyValues.m_iPreloadSize    = 0i16;
+	vKeyValues.m_nLoadFlags      = static_cast<uint32_t>(EPackedLoadFlags::LOAD_VISIBLE) | static_cast<uint32_t>(EPackedLoadFlags::LOAD_CACHE);
+	vKeyValues.m_nTextureFlags   = static_cast<uint16_t>(EPackedTextureFlags::TEXTURE_DEFAULT); // !TODO: Reverse these.
+	vKeyValues.m_bUseCompression = true;
+	vKeyValues.m_bUseDataSharing = true;
+
+	if (!jManifest.is_null())
+	{
+		try
+		{
+			const auto it = jManifest.find(svEntryPath);
+			if (it != jManifest.end() && !it->is_null())
+			{
+				const nlohmann::json& jEntry = *it;
+				vKeyValues.m_iPreloadSize    = jEntry.at("preloadSize").get<uint32_t>();
+				vKeyValues.m_nLoadFlags      = jEntry.at("loadFlags").get<uint32_t>();
+				vKeyValues.m_nTextureFlags   = jEntry.at("textureFlags").get<uint16_t>();
+				vKeyValues.m_bUseCompression = jEntry.at("useCompression").get<bool>();
+				vKeyValues.m_bUseDataSharing = jEntry.at("useDataSharing").get<bool>();
+			}
+		}
+		catch (const std::exception& ex)
+		{
+			Warning(eDLL_T::FS, "Exception while reading VPK control file: '%s'\n", ex.what());
+		}
+	}
+	return vKeyValues;
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: gets the contents from the global ignore list (.vpkignore)
 // Input  : &svWorkSpace - 
@@ -373,22 +425,23 @@ VPKPair_t CPackedStore::BuildFileName(string svLanguage, string svContext, const
 
 //-----------------------------------------------------------------------------
 // Purpose: builds the VPK manifest file
-// Input  : &vBlock - 
+// Input  : &vDir - 
 //          &svWorkSpace - 
 //          &svManifestName - 
 //-----------------------------------------------------------------------------
-void CPackedStore::BuildManifest(const vector<VPKEntryBlock_t>& vBlock, const string& svWorkSpace, const string& svManifestName) const
+void CPackedStore::BuildManifest(const VPKDir_t& vDir, const string& svWorkSpace, const string& svManifestName) const
 {
 	nlohmann::json jEntry;
 
-	for (size_t i = 0; i < vBlock.size(); i++)
+	for (size_t i = 0; i < vDir.GetEntryCount(); i++)
 	{
-		jEntry[vBlock[i].m_svEntryPath] =
+		const VPKChunkDescriptor_t vChunk = vDir.GetChunkCount(i) ? vDir.GetChunk(i, 0) : VPKChunkDescriptor_t();
+		jEntry[vDir.GetEntryPath(i)] =
 		{
-			{ "preloadSize", vBlock[i].m_iPreloadSize },
-			{ "loadFlags", vBlock[i].m_vChunks[0].m_nLoadFlags },
-			{ "textureFlags", vBlock[i].m_vChunks[0].m_nTextureFlags },
-			{ "useCompression", vBlock[i].m_vChunks[0].m_nCompressedSize != vBlock[i].m_vChunks[0].m_nUncompressedSize },
+			{ "preloadSize", vDir.m_pTable->m_vEntryPreload[i] },
+			{ "loadFlags", vChunk.m_nLoadFlags },
+			{ "textureFlags", vChunk.m_nTextureFlags },
+			{ "useCompression", vChunk.m_nCompressedSize != vChunk.m_nUncompressedSize },
 			{ "useDataSharing", true }
 		};
 	}
@@ -440,10 +493,31 @@ void CPackedStore::ValidateCRC32PostDecomp(const string& svAssetFile)
 //          &svPathIn - 
 //          &svPathOut - 
 //          bManifestOnly - 
+//          nThreads - number of compression workers (<= 1 packs serially)
+//          bIncremental - reuse unchanged entries from the previous build
 //-----------------------------------------------------------------------------
-void CPackedStore::PackAll(const VPKPair_t& vPair, const string& svPathIn, const string& svPathOut, bool bManifestOnly)
+void CPackedStore::PackAll(const VPKPair_t& vPair, const string& svPathIn, const string& svPathOut, bool bManifestOnly, int nThreads, bool bIncremental)
 {
-	CIOStream writer(svPathOut + vPair.m_svBlockName, CIOStream::Mode_t::WRITE);
+	const string svBlockFile = svPathOut + vPair.m_svBlockName;
+
+	VPKPrevBuild_t vPrevBuild;
+	if (bIncremental)
+	{
+		OpenPreviousBuild(vPrevBuild, svPathOut + vPair.m_svDirectoryName, svBlockFile);
+	}
+
+	// The previous build stays in place until the new archive is complete,
+	// so a pack that is aborted partway leaves it intact.
+	const string svWriteFile = vPrevBuild.m_Archive.IsOpen() ? svBlockFile + ".tmp" : svBlockFile;
+
+	CIOStream writer(svWriteFile, CIOStream::Mode_t::WRITE);
+	m_ChunkIndex.Init(svWriteFile);
+
+	if (vPrevBuild.m_Archive.IsOpen())
+	{
+		m_ChunkIndex.Seed(vPrevBuild.m_vDir);
+		DevMsg(eDLL_T::FS, "Seeded chunk index with '%zu' chunks from the previous build\n", m_ChunkIndex.GetPreviousCount());
+	}
 
 	vector<string> vPaths;
 	vector<VPKEntryBlock_t> vEntryBlocks;
@@ -463,52 +537,40 @@ void CPackedStore::PackAll(const VPKPair_t& vPair, const string& svPathIn, const
 	uint64_t nSharedTotal = 0i64;
 	uint32_t nSharedCount = 0i32;
 
-	for (size_t i = 0; i < vPaths.size(); i++)
+	if (nThreads > 1)
+	{
+		PackEntriesParallel(writer, vEntryBlocks, vPaths, jManifest, svPathIn, vPrevBuild, nThreads, nSharedTotal, nSharedCount);
+	}
+	else for (size_t i = 0; i < vPaths.size(); i++)
 	{
 		CIOStream reader(vPaths[i], CIOStream::Mode_t::READ);
 		if (reader.IsReadable())
 		{
 			string svDestPath = StringReplaceC(vPaths[i], svPathIn, "");
-			uint16_t iPreloadSize  = 0i16;
-			uint32_t nLoadFlags    = static_cast<uint32_t>(EPackedLoadFlags::LOAD_VISIBLE) | static_cast<uint32_t>(EPackedLoadFlags::LOAD_CACHE);
-			uint16_t nTextureFlags = static_cast<uint16_t>(EPackedTextureFlags::TEXTURE_DEFAULT); // !TODO: Reverse these.
-			bool bUseCompression   = true;
-			bool bUseDataSharing   = true;
+			const VPKKeyValues_t vKeyValues = GetEntryValues(jManifest, svDestPath);
 
-			if (!jManifest.is_null())
-			{
-				try
-				{
-					nlohmann::json jEntry = jManifest[svDestPath];
-					if (!jEntry.is_null())
-					{
-						iPreloadSize    = jEntry.at("preloadSize").get<uint32_t>();
-						nLoadFlags      = jEntry.at("loadFlags").get<uint32_t>();
-						nTextureFlags   = jEntry.at("textureFlags").get<uint16_t>();
-						bUseCompression = jEntry.at("useCompression").get<bool>();
-						bUseDataSharing = jEntry.at("useDataSharing").get<bool>();
-					}
-				}
-				catch (const std::exception& ex)
-				{
-					Warning(eDLL_T::FS, "Exception while reading VPK control file: '%s'\n", ex.what());
-				}
-			}
-			DevMsg(eDLL_T::FS, "Packing entry '%zu' ('%s')\n", i, svDestPath.c_str());
+			vEntryBlocks.push_back(VPKEntryBlock_t(reader.GetVector(), writer.GetPosition(), vKeyValues.m_iPreloadSize, 0, vKeyValues.m_nLoadFlags, vKeyValues.m_nTextureFlags, svDestPath));
+			VPKEntryBlock_t vPrevBlock;
+			const VPKEntryBlock_t* pPrevBlock = GetReusableEntry(vPrevBuild, vEntryBlocks[i], vKeyValues, vPrevBlock) ? &vPrevBlock : nullptr;
 
-			vEntryBlocks.push_back(VPKEntryBlock_t(reader.GetVector(), writer.GetPosition(), iPreloadSize, 0, nLoadFlags, nTextureFlags, svDestPath));
+			DevMsg(eDLL_T::FS, "%s entry '%zu' ('%s')\n", pPrevBlock ? "Reusing" : "Packing", i, svDestPath.c_str());
 			for (size_t j = 0; j < vEntryBlocks[i].m_vChunks.size(); j++)
 			{
 				uint8_t* pSrc  = new uint8_t[vEntryBlocks[i].m_vChunks[j].m_nUncompressedSize];
 				uint8_t* pDest = new uint8_t[vEntryBlocks[i].m_vChunks[j].m_nUncompressedSize];
 
 				bool bShared = false;
-				bool bCompressed = bUseCompression;
 
 				reader.Read(*pSrc, vEntryBlocks[i].m_vChunks[j].m_nUncompressedSize);
 				vEntryBlocks[i].m_vChunks[j].m_nArchiveOffset = writer.GetPosition();
 
-				if (bUseCompression)
+				if (pPrevBlock) // Copy the chunk as-is from the previous build.
+				{
+					const VPKChunkDescriptor_t& vPrevChunk = pPrevBlock->m_vChunks[j];
+					vEntryBlocks[i].m_vChunks[j].m_nCompressedSize = vPrevChunk.m_nCompressedSize;
+					memcpy(pDest, vPrevBuild.m_Archive.GetData() + vPrevChunk.m_nArchiveOffset, vPrevChunk.m_nCompressedSize);
+				}
+				else if (vKeyValues.m_bUseCompression)
 				{
 					m_lzCompStatus = lzham_compress_memory(&m_lzCompParams, pDest, 
 						&vEntryBlocks[i].m_vChunks[j].m_nCompressedSize, pSrc, 
@@ -529,24 +591,20 @@ void CPackedStore::PackAll(const VPKPair_t& vPair, const string& svPathIn, const
 				}
 				vEntryBlocks[i].m_vChunks[j].m_bIsCompressed = vEntryBlocks[i].m_vChunks[j].m_nCompressedSize != vEntryBlocks[i].m_vChunks[j].m_nUncompressedSize;
 
-				if (bUseDataSharing)
+				if (vKeyValues.m_bUseDataSharing)
 				{
-					string svEntryHash = sha1(string(reinterpret_cast<char*>(pDest), vEntryBlocks[i].m_vChunks[j].m_nCompressedSize));
-
-					if (auto it{ m_mChunkHashMap.find(svEntryHash) }; it != std::end(m_mChunkHashMap))
+					VPKChunkHash_t vHash;
+					const bool bFound = pPrevBlock
+						? m_ChunkIndex.FindOrAddPrevious(writer, pDest, vEntryBlocks[i].m_vChunks[j].m_nCompressedSize, pPrevBlock->m_vChunks[j].m_nArchiveOffset, vEntryBlocks[i].m_vChunks[j].m_nArchiveOffset, vHash)
+						: m_ChunkIndex.FindOrAdd(writer, pDest, vEntryBlocks[i].m_vChunks[j].m_nCompressedSize, vEntryBlocks[i].m_vChunks[j].m_nArchiveOffset, vHash);
+					if (bFound)
 					{
-						DevMsg(eDLL_T::FS, "Mapping chunk '%zu' ('%s') to existing chunk at '0x%llx'\n", j, svEntryHash.c_str(), it->second.m_nArchiveOffset);
+						DevMsg(eDLL_T::FS, "Mapping chunk '%zu' ('%016llx%016llx') to existing chunk at '0x%llx'\n", j, vHash.m_nHigh, vHash.m_nLow, vEntryBlocks[i].m_vChunks[j].m_nArchiveOffset);
 
-						vEntryBlocks[i].m_vChunks[j].m_nArchiveOffset = it->second.m_nArchiveOffset;
-						nSharedTotal += it->second.m_nCompressedSize;
+						nSharedTotal += vEntryBlocks[i].m_vChunks[j].m_nCompressedSize;
 						nSharedCount++;
 						bShared = true;
 					}
-					else // Add entry to hashmap.
-					{
-						m_mChunkHashMap.insert({ svEntryHash, vEntryBlocks[i].m_vChunks[j] });
-						bShared = false;
-					}
 				}
 				if (!bShared)
 				{
@@ -559,18 +617,451 @@ void CPackedStore::PackAll(const VPKPair_t& vPair, const string& svPathIn, const
 		}
 	}
 	DevMsg(eDLL_T::FS, "*** Build block totaling '%zu' bytes with '%zu' shared bytes among '%lu' chunks\n", writer.GetPosition(), nSharedTotal, nSharedCount);
-	m_mChunkHashMap.clear();
+	writer.Close();
+	m_ChunkIndex.Clear(); // Also drops the chunks seeded from the previous directory.
+	ClosePreviousBuild(vPrevBuild); // Unmaps the previous build before it's replaced.
+
+	if (svWriteFile != svBlockFile)
+	{
+		std::error_code ec;
+		fs::rename(svWriteFile, svBlockFile, ec);
+
+		if (ec) // Keep the previous directory, it still matches the previous archive.
+		{
+			Warning(eDLL_T::FS, "Unable to replace archive '%s': %s (new archive left at '%s')\n", svBlockFile.c_str(), ec.message().c_str(), svWriteFile.c_str());
+			return;
+		}
+	}
 
 	VPKDir_t vDir = VPKDir_t();
 	vDir.Build(svPathOut + vPair.m_svDirectoryName, vEntryBlocks);
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: packs the workspace serially and in parallel and compares the 
+//          two builds byte for byte
+// Input  : &vPair - 
+//          &svPathIn - 
+//          &svPathOut - receives the builds in 'serial/' and 'parallel/'
+//          bManifestOnly - 
+//          nThreads - number of compression workers for the parallel build
+// Output : true if the archive and directory files are identical
+//-----------------------------------------------------------------------------
+bool CPackedStore::VerifyPackAll(const VPKPair_t& vPair, const string& svPathIn, const string& svPathOut, bool bManifestOnly, int nThreads)
+{
+	const string svSerialPath = svPathOut + "serial/";
+	const string svParallelPath = svPathOut + "parallel/";
+
+	std::error_code ec;
+	fs::create_directories(svSerialPath, ec);
+	fs::create_directories(svParallelPath, ec);
+
+	PackAll(vPair, svPathIn, svSerialPath, bManifestOnly, 1, false);
+	PackAll(vPair, svPathIn, svParallelPath, bManifestOnly, std::max<int>(nThreads, 2), false);
+
+	bool bIdentical = true;
+	for (const string& svFileName : { vPair.m_svBlockName, vPair.m_svDirectoryName })
+	{
+		CMappedFile serial;
+		CMappedFile parallel;
+
+		if (!serial.Open(svSerialPath + svFileName) || !parallel.Open(svParallelPath + svFileName))
+		{
+			Warning(eDLL_T::FS, "Unable to open both builds of '%s'\n", svFileName.c_str());
+			bIdentical = false;
+			continue;
+		}
+
+		const size_t nSize = std::min<size_t>(serial.GetSize(), parallel.GetSize());
+		const size_t nOffset = std::mismatch(serial.GetData(), serial.GetData() + nSize, parallel.GetData()).first - serial.GetData();
+
+		if (nOffset != nSize || serial.GetSize() != parallel.GetSize())
+		{
+			Warning(eDLL_T::FS, "'%s' differs between the serial and parallel build at offset '0x%zX' ('%zu' vs '%zu' bytes)\n",
+				svFileName.c_str(), nOffset, serial.GetSize(), parallel.GetSize());
+			bIdentical = false;
+		}
+	}
+
+	return bIdentical;
+}
+
+//-----------------------------------------------------------------------------
+// Pack pipeline state (see 'CPackedStore::PackEntriesParallel')
+//-----------------------------------------------------------------------------
+struct VPKPackEntry_t
+{
+	CIOStream       m_Reader;       // Holds the entry data until the last chunk is committed.
+	VPKEntryBlock_t m_vBlock;       // Entry block (chunk offsets are assigned by the writer).
+	VPKKeyValues_t  m_vKeyValues;   // Manifest values for this entry.
+	size_t          m_nIndex;       // Index of the entry in the path list.
+	const VPKEntryBlock_t* m_pPrevBlock; // Unchanged entry from the previous build, if any.
+	VPKEntryBlock_t m_vPrevBlock;   // Storage for the previous entry block.
+
+	VPKPackEntry_t(const string& svPath, const string& svEntryPath, const VPKKeyValues_t& vKeyValues, size_t nIndex)
+		: m_Reader(svPath, CIOStream::Mode_t::READ)
+		, m_vBlock(m_Reader.GetVector(), 0, vKeyValues.m_iPreloadSize, 0, vKeyValues.m_nLoadFlags, vKeyValues.m_nTextureFlags, svEntryPath)
+		, m_vKeyValues(vKeyValues)
+		, m_nIndex(nIndex)
+		, m_pPrevBlock(nullptr)
+	{}
+};
+
+struct VPKPackChunk_t
+{
+	VPKPackEntry_t* m_pEntry; // Owning entry.
+	size_t          m_nChunk; // Chunk index within the entry.
+	bool            m_bDone;  // Set by the worker once the slot buffer holds the output.
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: compresses entries on a worker pool and commits them in order
+// Input  : &writer - 
+//          &vEntryBlocks - 
+//          &vPaths - 
+//          &jManifest - 
+//          &svPathIn - 
+//          &vPrevBuild - 
+//          nThreads - 
+//          &nSharedTotal - 
+//          &nSharedCount - 
+// Note   : a reader thread loads entries ahead (bounded by the slot count), 
+//          workers compress chunks into reusable slot buffers, and the calling 
+//          thread writes chunks back in sequence order. Deduplication and 
+//          offset assignment only happen on the calling thread, so the archive 
+//          and directory are byte for byte identical to the serial path.
+//-----------------------------------------------------------------------------
+void CPackedStore::PackEntriesParallel(CIOStream& writer, vector<VPKEntryBlock_t>& vEntryBlocks, const vector<string>& vPaths, const nlohmann::json& jManifest,
+	const string& svPathIn, const VPKPrevBuild_t& vPrevBuild, int nThreads, uint64_t& nSharedTotal, uint32_t& nSharedCount)
+{
+	const size_t nSlots = static_cast<size_t>(nThreads) * 2;
+	const size_t nReadAheadMax = nSlots * ENTRY_MAX_LEN;
+
+	vector<vector<uint8_t>> vSlots(nSlots, vector<uint8_t>(ENTRY_MAX_LEN));
+
+	// Same parameters as the serial path, the helper thread count also
+	// decides how LZHAM partitions its parse jobs.
+	const lzham_compress_params& lzCompParams = m_lzCompParams;
+	vector<std::unique_ptr<VPKPackEntry_t>> vEntries;
+	vector<VPKPackChunk_t> vChunks;
+
+	std::mutex mutex;
+	std::condition_variable cvReader;
+	std::condition_variable cvWorker;
+	std::condition_variable cvWriter;
+
+	size_t nNextChunk        = 0; // Next chunk to be claimed by a worker.
+	size_t nCommitted        = 0; // Chunks written to the archive so far.
+	size_t nEntriesCommitted = 0; // Entries whose last chunk has been written.
+	size_t nBytesPending     = 0; // Entry bytes loaded but not yet committed.
+	bool   bReaderDone       = false;
+
+	std::thread reader([&]()
+	{
+		for (size_t i = 0; i < vPaths.size(); i++)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				cvReader.wait(lock, [&] { return nBytesPending < nReadAheadMax; });
+			}
+
+			const string svDestPath = StringReplaceC(vPaths[i], svPathIn, "");
+			std::unique_ptr<VPKPackEntry_t> pEntry = std::make_unique<VPKPackEntry_t>(vPaths[i], svDestPath, GetEntryValues(jManifest, svDestPath), i);
+
+			if (!pEntry->m_Reader.IsReadable())
+			{
+				continue;
+			}
+			pEntry->m_pPrevBlock = GetReusableEntry(vPrevBuild, pEntry->m_vBlock, pEntry->m_vKeyValues, pEntry->m_vPrevBlock) ? &pEntry->m_vPrevBlock : nullptr;
+
+			DevMsg(eDLL_T::FS, "%s entry '%zu' ('%s')\n", pEntry->m_pPrevBlock ? "Reusing" : "Packing", i, svDestPath.c_str());
+			{
+				std::lock_guard<std::mutex> l(mutex);
+				for (size_t j = 0; j < pEntry->m_vBlock.m_vChunks.size(); j++)
+				{
+					vChunks.push_back({ pEntry.get(), j, false });
+				}
+				nBytesPending += pEntry->m_Reader.GetSize();
+				vEntries.push_back(std::move(pEntry));
+			}
+			cvWorker.notify_all();
+			cvWriter.notify_one(); // Empty entries are committed without any chunk.
+		}
+		{
+			std::lock_guard<std::mutex> l(mutex);
+			bReaderDone = true;
+		}
+		cvWorker.notify_all();
+		cvWriter.notify_one();
+	});
+
+	vector<std::thread> vWorkers;
+	for (int t = 0; t < nThreads; t++)
+	{
+		vWorkers.push_back(std::thread([&]()
+		{
+			for (;;)
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				cvWorker.wait(lock, [&] { return (nNextChunk < vChunks.size() && nNextChunk < nCommitted + nSlots)
+					|| (bReaderDone && nNextChunk == vChunks.size()); });
+
+				if (nNextChunk == vChunks.size())
+				{
+					return; // Reader is done and all chunks are claimed.
+				}
+
+				const size_t nSeq = nNextChunk++;
+				VPKPackEntry_t* pEntry = vChunks[nSeq].m_pEntry;
+				const size_t j = vChunks[nSeq].m_nChunk;
+				lock.unlock();
+
+				VPKChunkDescriptor_t& vChunk = pEntry->m_vBlock.m_vChunks[j];
+				const uint8_t* pSrc = pEntry->m_Reader.GetData() + j * ENTRY_MAX_LEN;
+				uint8_t* pDest = vSlots[nSeq % nSlots].data();
+
+				if (pEntry->m_pPrevBlock) // Copy the chunk as-is from the previous build.
+				{
+					const VPKChunkDescriptor_t& vPrevChunk = pEntry->m_pPrevBlock->m_vChunks[j];
+					vChunk.m_nCompressedSize = vPrevChunk.m_nCompressedSize;
+					memcpy(pDest, vPrevBuild.m_Archive.GetData() + vPrevChunk.m_nArchiveOffset, vPrevChunk.m_nCompressedSize);
+				}
+				else if (pEntry->m_vKeyValues.m_bUseCompression)
+				{
+					lzham_uint32 nAdler32 = 0;
+					lzham_uint32 nCrc32 = 0;
+
+					const lzham_compress_status_t lzCompStatus = lzham_compress_memory(&lzCompParams, pDest,
+						&vChunk.m_nCompressedSize, pSrc, vChunk.m_nUncompressedSize, &nAdler32, &nCrc32);
+					if (lzCompStatus != lzham_compress_status_t::LZHAM_COMP_STATUS_SUCCESS)
+					{
+						Warning(eDLL_T::FS, "Status '%d' for chunk '%zu' within entry '%zu' in block '%hu' (chunk packed without compression)\n",
+							lzCompStatus, j, pEntry->m_nIndex, pEntry->m_vBlock.m_iPackFileIndex);
+
+						vChunk.m_nCompressedSize = vChunk.m_nUncompressedSize;
+						memmove(pDest, pSrc, vChunk.m_nUncompressedSize);
+					}
+				}
+				else // Write data uncompressed.
+				{
+					vChunk.m_nCompressedSize = vChunk.m_nUncompressedSize;
+					memmove(pDest, pSrc, vChunk.m_nUncompressedSize);
+				}
+				vChunk.m_bIsCompressed = vChunk.m_nCompressedSize != vChunk.m_nUncompressedSize;
+
+				lock.lock();
+				vChunks[nSeq].m_bDone = true;
+				lock.unlock();
+				cvWriter.notify_one();
+			}
+		}));
+	}
+
+	for (;;) // Commit chunks in sequence order.
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		cvWriter.wait(lock, [&] { return (nCommitted < vChunks.size() && vChunks[nCommitted].m_bDone)
+			|| (nEntriesCommitted < vEntries.size() && vEntries[nEntriesCommitted]->m_vBlock.m_vChunks.empty())
+			|| (bReaderDone && nCommitted == vChunks.size()); });
+
+		// Entries without chunks (empty files) are complete as soon as every
+		// entry before them is, and precede any chunk that isn't committed yet.
+		if (nEntriesCommitted < vEntries.size() && vEntries[nEntriesCommitted]->m_vBlock.m_vChunks.empty())
+		{
+			vEntryBlocks.push_back(std::move(vEntries[nEntriesCommitted]->m_vBlock));
+			vEntries[nEntriesCommitted++].reset();
+			continue;
+		}
+
+		if (nCommitted == vChunks.size())
+		{
+			break;
+		}
+
+		const size_t nSeq = nCommitted;
+		VPKPackEntry_t* pEntry = vChunks[nSeq].m_pEntry;
+		const size_t j = vChunks[nSeq].m_nChunk;
+		lock.unlock();
+
+		VPKChunkDescriptor_t& vChunk = pEntry->m_vBlock.m_vChunks[j];
+		const uint8_t* pDest = vSlots[nSeq % nSlots].data();
+		bool bShared = false;
+
+		vChunk.m_nArchiveOffset = writer.GetPosition();
+
+		if (pEntry->m_vKeyValues.m_bUseDataSharing)
+		{
+			VPKChunkHash_t vHash;
+			const bool bFound = pEntry->m_pPrevBlock
+				? m_ChunkIndex.FindOrAddPrevious(writer, pDest, vChunk.m_nCompressedSize, pEntry->m_pPrevBlock->m_vChunks[j].m_nArchiveOffset, vChunk.m_nArchiveOffset, vHash)
+				: m_ChunkIndex.FindOrAdd(writer, pDest, vChunk.m_nCompressedSize, vChunk.m_nArchiveOffset, vHash);
+			if (bFound)
+			{
+				DevMsg(eDLL_T::FS, "Mapping chunk '%zu' ('%016llx%016llx') to existing chunk at '0x%llx'\n", j, vHash.m_nHigh, vHash.m_nLow, vChunk.m_nArchiveOffset);
+
+				nSharedTotal += vChunk.m_nCompressedSize;
+				nSharedCount++;
+				bShared = true;
+			}
+		}
+		if (!bShared)
+		{
+			writer.Write(pDest, vChunk.m_nCompressedSize);
+		}
+
+		const bool bLastChunk = (j == pEntry->m_vBlock.m_vChunks.size() - 1);
+		if (bLastChunk)
+		{
+			vEntryBlocks.push_back(std::move(pEntry->m_vBlock));
+		}
+
+		lock.lock();
+		nCommitted++;
+		if (bLastChunk)
+		{
+			nBytesPending -= pEntry->m_Reader.GetSize();
+			vEntries[nEntriesCommitted++].reset(); // Entries complete in order; release the data.
+		}
+		lock.unlock();
+
+		cvWorker.notify_all();
+		if (bLastChunk)
+		{
+			cvReader.notify_one();
+		}
+	}
+
+	reader.join();
+	for (std::thread& worker : vWorkers)
+	{
+		worker.join();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: opens the previous build for incremental packing
+// Input  : &vPrevBuild - 
+//          &svDirectoryFile - 
+//          &svBlockFile - 
+// Output : true if the previous build can be reused, false otherwise
+// Note   : the previous archive is mapped in place, the new archive is written
+//          next to it and only replaces it once complete.
+//-----------------------------------------------------------------------------
+bool CPackedStore::OpenPreviousBuild(VPKPrevBuild_t& vPrevBuild, const string& svDirectoryFile, const string& svBlockFile) const
+{
+	if (!fs::exists(svDirectoryFile) || !fs::exists(svBlockFile))
+	{
+		DevMsg(eDLL_T::FS, "No previous build found for '%s' (packing all entries)\n", svDirectoryFile.c_str());
+		return false;
+	}
+
+	vPrevBuild.m_vDir = VPKDir_t(svDirectoryFile);
+	if (vPrevBuild.m_vDir.m_vHeader.m_nHeaderMarker != VPK_HEADER_MARKER ||
+		vPrevBuild.m_vDir.m_vHeader.m_nMajorVersion != VPK_MAJOR_VERSION ||
+		vPrevBuild.m_vDir.m_vHeader.m_nMinorVersion != VPK_MINOR_VERSION)
+	{
+		Warning(eDLL_T::FS, "Unsupported previous VPK directory file '%s' (packing all entries)\n", svDirectoryFile.c_str());
+		return false;
+	}
+
+	if (!vPrevBuild.m_Archive.Open(svBlockFile))
+	{
+		Warning(eDLL_T::FS, "Unable to map previous archive '%s' (packing all entries)\n", svBlockFile.c_str());
+		return false;
+	}
+
+	vPrevBuild.m_mEntries.reserve(vPrevBuild.m_vDir.GetEntryCount());
+	for (size_t i = 0; i < vPrevBuild.m_vDir.GetEntryCount(); i++)
+	{
+		vPrevBuild.m_mEntries.insert({ vPrevBuild.m_vDir.GetEntryPath(i), i });
+	}
+
+	DevMsg(eDLL_T::FS, "Loaded previous build '%s' with '%zu' entries\n", svDirectoryFile.c_str(), vPrevBuild.m_mEntries.size());
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: releases the previous build
+// Input  : &vPrevBuild - 
+// Note   : the directory file stays mapped (read share only) for as long as
+//          its table is referenced, it has to be released before the new
+//          directory file is written to the same path
+//-----------------------------------------------------------------------------
+void CPackedStore::ClosePreviousBuild(VPKPrevBuild_t& vPrevBuild) const
+{
+	vPrevBuild.m_Archive.Close();
+	vPrevBuild.m_mEntries.clear();
+	vPrevBuild.m_vDir = VPKDir_t();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: gets the previous entry block if the entry is unchanged
+// Input  : &vPrevBuild - 
+//          &vBlock - 
+//          &vKeyValues - 
+//          &vPrevBlock - receives the previous entry block
+// Output : true if the entry can be reused, false if it has to be packed
+//-----------------------------------------------------------------------------
+bool CPackedStore::GetReusableEntry(const VPKPrevBuild_t& vPrevBuild, const VPKEntryBlock_t& vBlock, const VPKKeyValues_t& vKeyValues, VPKEntryBlock_t& vPrevBlock) const
+{
+	if (!vPrevBuild.m_Archive.IsOpen())
+	{
+		return false;
+	}
+
+	const auto it = vPrevBuild.m_mEntries.find(vBlock.m_svEntryPath);
+	if (it == vPrevBuild.m_mEntries.end())
+	{
+		return false; // New entry.
+	}
+
+	const VPKDir_t& vPrevDir = vPrevBuild.m_vDir;
+	const size_t nEntry = it->second;
+
+	if (vPrevDir.GetEntryCRC(nEntry)       != vBlock.m_nFileCRC ||
+		vPrevDir.GetPackFileIndex(nEntry)  != 0                 || // Only the first archive is produced by 'PackAll'.
+		vPrevDir.GetChunkCount(nEntry)     != vBlock.m_vChunks.size())
+	{
+		return false; // Modified entry.
+	}
+
+	vPrevBlock = vPrevDir.GetEntryBlock(nEntry);
+	if (vPrevBlock.m_iPreloadSize != vBlock.m_iPreloadSize)
+	{
+		return false; // Modified manifest values.
+	}
+
+	for (size_t j = 0; j < vBlock.m_vChunks.size(); j++)
+	{
+		const VPKChunkDescriptor_t& vPrevChunk = vPrevBlock.m_vChunks[j];
+		const VPKChunkDescriptor_t& vChunk = vBlock.m_vChunks[j];
+
+		if (vPrevChunk.m_nUncompressedSize != vChunk.m_nUncompressedSize ||
+			vPrevChunk.m_nLoadFlags        != vChunk.m_nLoadFlags        ||
+			vPrevChunk.m_nTextureFlags     != vChunk.m_nTextureFlags)
+		{
+			return false; // Modified entry or manifest values.
+		}
+		if (vPrevChunk.m_bIsCompressed && !vKeyValues.m_bUseCompression)
+		{
+			return false; // Compression has been disabled for this entry.
+		}
+		if (vPrevChunk.m_nCompressedSize > vPrevChunk.m_nUncompressedSize ||
+			vPrevChunk.m_nArchiveOffset + vPrevChunk.m_nCompressedSize > vPrevBuild.m_Archive.GetSize())
+		{
+			return false; // Corrupt descriptor.
+		}
+	}
+	return true;
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: extracts all files from specified VPK file
 // Input  : &vDir - 
 //          &svPathOut - 
+//          nThreads - number of decompression workers (<= 1 unpacks serially)
 //-----------------------------------------------------------------------------
-void CPackedStore::UnpackAll(const VPKDir_t& vDir, const string& svPathOut)
+void CPackedStore::UnpackAll(const VPKDir_t& vDir, const string& svPathOut, int nThreads)
 {
 	if (vDir.m_vHeader.m_nHeaderMarker != VPK_HEADER_MARKER ||
 		vDir.m_vHeader.m_nMajorVersion != VPK_MAJOR_VERSION ||
@@ -579,78 +1070,414 @@ void CPackedStore::UnpackAll(const VPKDir_t& vDir, const string& svPathOut)
 		Error(eDLL_T::FS, NO_ERROR, "Unsupported VPK directory file (invalid header criteria)\n");
 		return;
 	}
-	BuildManifest(vDir.m_vEntryBlocks, svPathOut, GetSourceName(vDir.m_svDirPath));
+	BuildManifest(vDir, svPathOut, GetSourceName(vDir.m_svDirPath));
+
+	vector<vector<size_t>> vArchiveEntries(vDir.m_vPackFile.size());
+	for (size_t j = 0; j < vDir.GetEntryCount(); j++) // Group entries by archive in a single pass.
+	{
+		const uint16_t iPackFileIndex = vDir.GetPackFileIndex(j);
+		if (iPackFileIndex < vArchiveEntries.size())
+		{
+			vArchiveEntries[iPackFileIndex].push_back(j);
+		}
+	}
 
 	for (size_t i = 0; i < vDir.m_vPackFile.size(); i++)
 	{
+		if (vArchiveEntries[i].empty())
+		{
+			continue;
+		}
+
 		fs::path fspVpkPath(vDir.m_svDirPath);
 		string svPath = fspVpkPath.parent_path().u8string() + '\\' + vDir.m_vPackFile[i];
-		CIOStream iStream(svPath, CIOStream::Mode_t::READ); // Create stream to read from each archive.
+		CMappedFile archive(svPath); // Map each archive once; workers read chunks straight from the view.
 
-		for ( size_t j = 0; j < vDir.m_vEntryBlocks.size(); j++)
+		if (!archive.IsOpen())
 		{
-			if (vDir.m_vEntryBlocks[j].m_iPackFileIndex != static_cast<uint16_t>(i))
+			Error(eDLL_T::FS, NO_ERROR, "Unable to map archive '%s'\n", svPath.c_str());
+			continue;
+		}
+
+		std::atomic<size_t> nNextEntry = 0;
+		auto fnWorker = [&]()
+		{
+			vector<uint8_t> vOutput; // Reused for every entry this worker extracts.
+			for (size_t n; (n = nNextEntry++) < vArchiveEntries[i].size();)
 			{
-				goto escape;
+				UnpackEntry(archive, vDir.GetEntryBlock(vArchiveEntries[i][n]), vArchiveEntries[i][n], i, svPathOut, vOutput);
 			}
-			else // Chunk belongs to this block.
+		};
+
+		if (nThreads > 1)
+		{
+			CTaskGroup group; // The calling thread is one of the workers.
+			for (int t = 1; t < nThreads; t++)
 			{
-				string svFilePath = CreateDirectories(svPathOut + vDir.m_vEntryBlocks[j].m_svEntryPath);
-				CIOStream oStream(svFilePath, CIOStream::Mode_t::WRITE);
+				group.Run(fnWorker);
+			}
 
-				if (!oStream.IsWritable())
-				{
-					Error(eDLL_T::FS, NO_ERROR, "Unable to write file '%s'\n", svFilePath.c_str());
-					continue;
-				}
-				DevMsg(eDLL_T::FS, "Unpacking entry '%zu' from block '%zu' ('%s')\n", j, i, vDir.m_vEntryBlocks[j].m_svEntryPath.c_str());
+			fnWorker();
+			group.Wait();
+		}
+		else
+		{
+			fnWorker();
+		}
+	}
+}
 
-				for (VPKChunkDescriptor_t vChunk : vDir.m_vEntryBlocks[j].m_vChunks)
-				{
-					m_nChunkCount++;
+//-----------------------------------------------------------------------------
+// Purpose: decompresses a single entry from a mapped archive and writes it
+// Input  : &archive - 
+//          &vEntry - 
+//          nEntry - 
+//          nArchive - 
+//          &svPathOut - 
+//          &vOutput - scratch buffer, grown as needed
+//-----------------------------------------------------------------------------
+void CPackedStore::UnpackEntry(const CMappedFile& archive, const VPKEntryBlock_t& vEntry, size_t nEntry, size_t nArchive, const string& svPathOut, vector<uint8_t>& vOutput) const
+{
+	string svFilePath = CreateDirectories(svPathOut + vEntry.m_svEntryPath);
+	CIOStream oStream(svFilePath, CIOStream::Mode_t::WRITE);
 
-					uint8_t* pCompressedData = new uint8_t[vChunk.m_nCompressedSize];
+	if (!oStream.IsWritable())
+	{
+		Error(eDLL_T::FS, NO_ERROR, "Unable to write file '%s'\n", svFilePath.c_str());
+		return;
+	}
+	DevMsg(eDLL_T::FS, "Unpacking entry '%zu' from block '%zu' ('%s')\n", nEntry, nArchive, vEntry.m_svEntryPath.c_str());
 
-					iStream.SetPosition(vChunk.m_nArchiveOffset);
-					iStream.Read(*pCompressedData, vChunk.m_nCompressedSize);
+	size_t nEntrySize = 0;
+	for (const VPKChunkDescriptor_t& vChunk : vEntry.m_vChunks)
+	{
+		nEntrySize += vChunk.m_nUncompressedSize;
+	}
+	if (vOutput.size() < nEntrySize)
+	{
+		vOutput.resize(nEntrySize);
+	}
 
-					if (vChunk.m_bIsCompressed)
-					{
-						uint8_t* pLzOutputBuf = new uint8_t[vChunk.m_nUncompressedSize];
-						m_lzDecompStatus = lzham_decompress_memory(&m_lzDecompParams, pLzOutputBuf, 
-							&vChunk.m_nUncompressedSize, pCompressedData, 
-							vChunk.m_nCompressedSize, &m_nAdler32_Internal, &m_nCrc32_Internal);
+	size_t nWritten = 0;
+	for (size_t k = 0; k < vEntry.m_vChunks.size(); k++)
+	{
+		const VPKChunkDescriptor_t& vChunk = vEntry.m_vChunks[k];
+		if (vChunk.m_nArchiveOffset + vChunk.m_nCompressedSize > archive.GetSize())
+		{
+			Error(eDLL_T::FS, NO_ERROR, "Chunk '%zu' within entry '%zu' in block '%hu' exceeds archive bounds (chunk not decompressed)\n",
+				k, nEntry, vEntry.m_iPackFileIndex);
+			continue;
+		}
 
-						if (m_lzDecompStatus != lzham_decompress_status_t::LZHAM_DECOMP_STATUS_SUCCESS)
-						{
-							Error(eDLL_T::FS, NO_ERROR, "Status '%d' for chunk '%zu' within entry '%zu' in block '%hu' (chunk not decompressed)\n",
-								m_lzDecompStatus, m_nChunkCount, i, vDir.m_vEntryBlocks[j].m_iPackFileIndex);
-						}
-						else // If successfully decompressed, write to file.
-						{
-							oStream.Write(pLzOutputBuf, vChunk.m_nUncompressedSize);
-						}
-						delete[] pLzOutputBuf;
-					}
-					else // If not compressed, write raw data into output file.
-					{
-						oStream.Write(pCompressedData, vChunk.m_nUncompressedSize);
-					}
-					delete[] pCompressedData;
-				}
+		const uint8_t* pCompressedData = archive.GetData() + vChunk.m_nArchiveOffset;
+		if (vChunk.m_bIsCompressed)
+		{
+			size_t nDecompSize = vChunk.m_nUncompressedSize;
+			lzham_uint32 nAdler32 = 0;
+			lzham_uint32 nCrc32 = 0;
 
-				if (m_nChunkCount == vDir.m_vEntryBlocks[j].m_vChunks.size()) // Only validate after last entry in block had been written.
-				{
-					m_nChunkCount = 0;
-					m_nCrc32_Internal = vDir.m_vEntryBlocks[j].m_nFileCRC;
+			const lzham_decompress_status_t lzDecompStatus = lzham_decompress_memory(&m_lzDecompParams, vOutput.data() + nWritten,
+				&nDecompSize, pCompressedData, vChunk.m_nCompressedSize, &nAdler32, &nCrc32);
 
-					oStream.Flush();
-					ValidateCRC32PostDecomp(svFilePath);
-					//ValidateAdler32PostDecomp(svFilePath);
-				}
-			}escape:;
+			if (lzDecompStatus != lzham_decompress_status_t::LZHAM_DECOMP_STATUS_SUCCESS)
+			{
+				Error(eDLL_T::FS, NO_ERROR, "Status '%d' for chunk '%zu' within entry '%zu' in block '%hu' (chunk not decompressed)\n",
+					lzDecompStatus, k, nEntry, vEntry.m_iPackFileIndex);
+			}
+			else // If successfully decompressed, keep it.
+			{
+				nWritten += nDecompSize;
+			}
+		}
+		else // If not compressed, copy raw data into output buffer.
+		{
+			memcpy(vOutput.data() + nWritten, pCompressedData, vChunk.m_nUncompressedSize);
+			nWritten += vChunk.m_nUncompressedSize;
+		}
+	}
+
+	oStream.Write(vOutput.data(), nWritten);
+
+	const uint32_t nCrc32 = crc32::update(NULL, vOutput.data(), nWritten); // Validate from memory instead of re-reading the file.
+	if (nCrc32 != vEntry.m_nFileCRC)
+	{
+		Warning(eDLL_T::FS, "Computed checksum '0x%lX' doesn't match expected checksum '0x%lX'. File may be corrupt!\n", nCrc32, vEntry.m_nFileCRC);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: hashes a chunk in place (MurmurHash3_x64_128, seed 0)
+// Input  : *pData - 
+//          nSize - 
+// Output : 128-bit fingerprint
+//-----------------------------------------------------------------------------
+VPKChunkHash_t VPKChunkHash_t::Compute(const uint8_t* pData, size_t nSize)
+{
+	const uint64_t c1 = 0x87C37B91114253D5ull;
+	const uint64_t c2 = 0x4CF5AD432745937Full;
+
+	auto Rotl = [](uint64_t nValue, int nShift) { return (nValue << nShift) | (nValue >> (64 - nShift)); };
+	auto Mix = [](uint64_t k)
+	{
+		k ^= k >> 33;
+		k *= 0xFF51AFD7ED558CCDull;
+		k ^= k >> 33;
+		k *= 0xC4CEB9FE1A85EC53ull;
+		k ^= k >> 33;
+		return k;
+	};
+
+	uint64_t h1 = 0;
+	uint64_t h2 = 0;
+	size_t i = 0;
+
+	for (; i + 16 <= nSize; i += 16)
+	{
+		uint64_t k1, k2;
+		memcpy(&k1, pData + i, sizeof(k1));
+		memcpy(&k2, pData + i + 8, sizeof(k2));
+
+		h1 ^= Rotl(k1 * c1, 31) * c2;
+		h1 = (Rotl(h1, 27) + h2) * 5 + 0x52DCE729;
+
+		h2 ^= Rotl(k2 * c2, 33) * c1;
+		h2 = (Rotl(h2, 31) + h1) * 5 + 0x38495AB5;
+	}
+
+	const size_t nTail = nSize - i;
+	if (nTail)
+	{
+		uint64_t nBlock[2] = { 0, 0 }; // Zero padding doesn't change the tail mix.
+		memcpy(nBlock, pData + i, nTail);
+
+		if (nTail > 8)
+		{
+			h2 ^= Rotl(nBlock[1] * c2, 33) * c1;
+		}
+		h1 ^= Rotl(nBlock[0] * c1, 31) * c2;
+	}
+
+	h1 ^= nSize;
+	h2 ^= nSize;
+
+	h1 += h2;
+	h2 += h1;
+
+	h1 = Mix(h1);
+	h2 = Mix(h2);
+
+	h1 += h2;
+	h2 += h1;
+
+	return { h1, h2 };
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: 'CVPKChunkIndex' constructor
+//-----------------------------------------------------------------------------
+CVPKChunkIndex::CVPKChunkIndex(void)
+	: m_nCount(0)
+	, m_nCollisions(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: starts indexing chunks written to the archive at given path
+// Input  : &svArchivePath - 
+//-----------------------------------------------------------------------------
+void CVPKChunkIndex::Init(const string& svArchivePath)
+{
+	Clear();
+
+	m_svArchivePath = svArchivePath;
+	m_vSlots.resize(1024);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: seeds the index with the chunks of the previous build, chunks the
+//          previous directory shares between entries stay shared when they
+//          are reused, without hashing or reading them back again
+// Input  : &vPrevDir - 
+//-----------------------------------------------------------------------------
+void CVPKChunkIndex::Seed(const VPKDir_t& vPrevDir)
+{
+	for (size_t i = 0; i < vPrevDir.GetEntryCount(); i++)
+	{
+		for (size_t j = 0; j < vPrevDir.GetChunkCount(i); j++)
+		{
+			m_mPrevious.insert({ vPrevDir.GetChunk(i, j).m_nArchiveOffset, { UINT64_MAX, {} } });
+		}
+	}
+
+	// Most of the previous chunks end up in this archive, size the table
+	// for them up front.
+	while (m_mPrevious.size() * 2 > m_vSlots.size())
+	{
+		Grow();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: releases the table and closes the archive reader
+//-----------------------------------------------------------------------------
+void CVPKChunkIndex::Clear(void)
+{
+	if (m_Reader.is_open())
+	{
+		m_Reader.close();
+	}
+
+	m_svArchivePath.clear();
+	m_vSlots.clear();
+	m_vSlots.shrink_to_fit();
+	m_mPrevious.clear();
+	m_vCompare.clear();
+	m_vCompare.shrink_to_fit();
+
+	m_nCount = 0;
+	m_nCollisions = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: looks up a chunk by content, adds it if it isn't in the archive yet
+// Input  : &writer - stream the archive is being written with
+//          *pData - 
+//          nSize - 
+//          &nArchiveOffset - offset the chunk will be written at if new
+//          &outHash - 
+// Output : true and the offset of the existing chunk if found, false otherwise
+//-----------------------------------------------------------------------------
+bool CVPKChunkIndex::FindOrAdd(CIOStream& writer, const uint8_t* pData, uint64_t nSize, uint64_t& nArchiveOffset, VPKChunkHash_t& outHash)
+{
+	outHash = VPKChunkHash_t::Compute(pData, nSize);
+
+	if ((m_nCount + 1) * 2 > m_vSlots.size())
+	{
+		Grow();
+	}
+
+	const size_t nMask = m_vSlots.size() - 1;
+	size_t nIndex = static_cast<size_t>(outHash.m_nLow) & nMask;
+
+	for (; m_vSlots[nIndex].m_bUsed; nIndex = (nIndex + 1) & nMask)
+	{
+		const Slot_t& slot = m_vSlots[nIndex];
+		if (slot.m_Hash != outHash || slot.m_nSize != nSize)
+		{
+			continue;
+		}
+
+		if (IsWrittenChunk(writer, pData, nSize, slot.m_nArchiveOffset))
+		{
+			nArchiveOffset = slot.m_nArchiveOffset;
+			return true;
+		}
+		m_nCollisions++; // Keep probing, the chunk is added next to it.
+	}
+
+	Slot_t& slot = m_vSlots[nIndex];
+
+	slot.m_Hash = outHash;
+	slot.m_nArchiveOffset = nArchiveOffset;
+	slot.m_nSize = nSize;
+	slot.m_bUsed = true;
+
+	m_nCount++;
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: looks up a chunk reused from the previous build, a previous chunk
+//          that has already been written maps straight to its new offset
+// Input  : &writer - stream the archive is being written with
+//          *pData - 
+//          nSize - 
+//          nPrevOffset - offset of the chunk in the previous archive
+//          &nArchiveOffset - offset the chunk will be written at if new
+//          &outHash - 
+// Output : true and the offset of the existing chunk if found, false otherwise
+//-----------------------------------------------------------------------------
+bool CVPKChunkIndex::FindOrAddPrevious(CIOStream& writer, const uint8_t* pData, uint64_t nSize, uint64_t nPrevOffset, uint64_t& nArchiveOffset, VPKChunkHash_t& outHash)
+{
+	const auto it = m_mPrevious.find(nPrevOffset);
+	if (it != m_mPrevious.end() && it->second.m_nArchiveOffset != UINT64_MAX)
+	{
+		outHash = it->second.m_Hash;
+		nArchiveOffset = it->second.m_nArchiveOffset;
+		return true;
+	}
+
+	const bool bFound = FindOrAdd(writer, pData, nSize, nArchiveOffset, outHash);
+	if (it != m_mPrevious.end())
+	{
+		it->second = { nArchiveOffset, outHash };
+	}
+	return bFound;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: compares a chunk against the bytes written at given archive offset
+// Input  : &writer - 
+//          *pData - 
+//          nSize - 
+//          nArchiveOffset - 
+// Output : true if equal, false otherwise
+//-----------------------------------------------------------------------------
+bool CVPKChunkIndex::IsWrittenChunk(CIOStream& writer, const uint8_t* pData, uint64_t nSize, uint64_t nArchiveOffset)
+{
+	if (!nSize)
+	{
+		return true;
+	}
+
+	writer.Flush(); // The chunk may still be in the writer's buffer.
+
+	if (!m_Reader.is_open())
+	{
+		m_Reader.open(m_svArchivePath, std::ios::binary);
+		if (!m_Reader.is_open())
+		{
+			Warning(eDLL_T::FS, "Unable to read back archive '%s'; chunk not shared\n", m_svArchivePath.c_str());
+			return false;
 		}
 	}
+
+	m_vCompare.resize(nSize);
+
+	m_Reader.clear();
+	m_Reader.seekg(nArchiveOffset);
+	m_Reader.read(reinterpret_cast<char*>(m_vCompare.data()), nSize);
+
+	if (static_cast<uint64_t>(m_Reader.gcount()) != nSize)
+	{
+		return false;
+	}
+	return memcmp(m_vCompare.data(), pData, nSize) == 0;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: doubles the table and reinserts the indexed chunks
+//-----------------------------------------------------------------------------
+void CVPKChunkIndex::Grow(void)
+{
+	vector<Slot_t> vOldSlots(std::max<size_t>(m_vSlots.size() * 2, 1024));
+	vOldSlots.swap(m_vSlots);
+
+	const size_t nMask = m_vSlots.size() - 1;
+	for (const Slot_t& slot : vOldSlots)
+	{
+		if (!slot.m_bUsed)
+		{
+			continue;
+		}
+
+		size_t nIndex = static_cast<size_t>(slot.m_Hash.m_nLow) & nMask;
+		while (m_vSlots[nIndex].m_bUsed)
+		{
+			nIndex = (nIndex + 1) & nMask;
+		}
+		m_vSlots[nIndex] = slot;
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -743,24 +1570,25 @@ VPKChunkDescriptor_t::VPKChunkDescriptor_t(uint32_t nLoadFlags, uint16_t nTextur
 //-----------------------------------------------------------------------------
 VPKDir_t::VPKDir_t(const string& svPath)
 {
-	CIOStream reader(svPath, CIOStream::Mode_t::READ);
-
-	reader.Read<uint32_t>(this->m_vHeader.m_nHeaderMarker);
-	reader.Read<uint16_t>(this->m_vHeader.m_nMajorVersion);  //
-	reader.Read<uint16_t>(this->m_vHeader.m_nMinorVersion);  //
-	reader.Read<uint32_t>(this->m_vHeader.m_nDirectorySize); //
-	reader.Read<uint32_t>(this->m_nFileDataSize);            //
-
-	this->m_vEntryBlocks = g_pPackedStore->GetEntryBlocks(&reader);
-	this->m_svDirPath = svPath; // Set path to vpk directory file.
-
-	for (VPKEntryBlock_t vEntry : this->m_vEntryBlocks)
+	std::shared_ptr<VPKDirTable_t> pTable = std::make_shared<VPKDirTable_t>();
+	if (pTable->Init(svPath))
 	{
-		if (vEntry.m_iPackFileIndex > this->m_iPackFileCount)
+		this->m_vHeader.m_nHeaderMarker  = pTable->m_vHeader.m_nHeaderMarker;
+		this->m_vHeader.m_nMajorVersion  = pTable->m_vHeader.m_nMajorVersion;
+		this->m_vHeader.m_nMinorVersion  = pTable->m_vHeader.m_nMinorVersion;
+		this->m_vHeader.m_nDirectorySize = pTable->m_vHeader.m_nDirectorySize;
+		this->m_nFileDataSize            = pTable->m_vHeader.m_nSignatureSize;
+
+		for (uint16_t iPackFileIndex : pTable->m_vEntryPackFile)
 		{
-			this->m_iPackFileCount = vEntry.m_iPackFileIndex;
+			if (iPackFileIndex > this->m_iPackFileCount)
+			{
+				this->m_iPackFileCount = iPackFileIndex;
+			}
 		}
+		this->m_pTable = std::move(pTable);
 	}
+	this->m_svDirPath = svPath; // Set path to vpk directory file.
 
 	for (uint16_t i = 0; i < this->m_iPackFileCount + 1; i++)
 	{
@@ -769,6 +1597,203 @@ VPKDir_t::VPKDir_t(const string& svPath)
 	}
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: maps the directory file and walks the tree in place
+// Input  : &svPath - 
+// Output : true on success, false otherwise
+//-----------------------------------------------------------------------------
+bool VPKDirTable_t::Init(const string& svPath)
+{
+	if (!m_File.Open(svPath))
+	{
+		return false;
+	}
+
+	const uint8_t* pData = m_File.GetData();
+	const size_t nSize = m_File.GetSize();
+
+	if (nSize < sizeof(VPKDirHeader_t) || nSize > UINT32_MAX)
+	{
+		Error(eDLL_T::FS, NO_ERROR, "Unsupported VPK directory file '%s' (invalid size '%zu')\n", svPath.c_str(), nSize);
+		return false;
+	}
+	memcpy(&m_vHeader, pData, sizeof(VPKDirHeader_t));
+
+	size_t nPos = sizeof(VPKDirHeader_t);
+	bool bOverrun = false;
+
+	// Returns the length of the string at the cursor and advances past it.
+	auto NextString = [&](uint32_t& nOffset) -> size_t
+	{
+		const void* pEnd = memchr(pData + nPos, '\0', nSize - nPos);
+		if (!pEnd)
+		{
+			bOverrun = true;
+			return 0;
+		}
+		const size_t nLen = reinterpret_cast<const uint8_t*>(pEnd) - (pData + nPos);
+		nOffset = static_cast<uint32_t>(nPos);
+		nPos += nLen + 1;
+		return nLen;
+	};
+
+	const size_t nEstimate = nSize / 64; // Rough lower bound for the number of entries.
+	m_vEntryDir.reserve(nEstimate);
+	m_vEntryName.reserve(nEstimate);
+	m_vEntryCRC.reserve(nEstimate);
+	m_vEntryPreload.reserve(nEstimate);
+	m_vEntryPackFile.reserve(nEstimate);
+	m_vEntryChunks.reserve(nEstimate);
+	m_vEntryChunkCount.reserve(nEstimate);
+
+	uint32_t nExtension, nPath, nName;
+	while (NextString(nExtension) != 0)
+	{
+		while (NextString(nPath) != 0)
+		{
+			const uint32_t nDir = static_cast<uint32_t>(m_vDirPath.size());
+			m_vDirExtension.push_back(nExtension);
+			m_vDirPath.push_back(nPath);
+
+			while (NextString(nName) != 0)
+			{
+				if (nPos + sizeof(uint32_t) + sizeof(uint16_t) * 2 > nSize)
+				{
+					bOverrun = true;
+					break;
+				}
+
+				uint32_t nFileCRC;
+				uint16_t iPreloadSize, iPackFileIndex;
+				memcpy(&nFileCRC, pData + nPos, sizeof(uint32_t));           nPos += sizeof(uint32_t);
+				memcpy(&iPreloadSize, pData + nPos, sizeof(uint16_t));       nPos += sizeof(uint16_t);
+				memcpy(&iPackFileIndex, pData + nPos, sizeof(uint16_t));     nPos += sizeof(uint16_t);
+
+				const uint32_t nChunks = static_cast<uint32_t>(nPos);
+				uint32_t nChunkCount = 0;
+				uint16_t nTerminator = 0;
+
+				do // Skip over the chunk descriptors; they're decoded on demand.
+				{
+					if (nPos + VPK_CHUNK_DESCRIPTOR_SIZE + sizeof(uint16_t) > nSize)
+					{
+						bOverrun = true;
+						break;
+					}
+					nPos += VPK_CHUNK_DESCRIPTOR_SIZE;
+					memcpy(&nTerminator, pData + nPos, sizeof(uint16_t));
+					nPos += sizeof(uint16_t);
+					nChunkCount++;
+				} while (nTerminator != UINT16_MAX);
+
+				if (bOverrun)
+				{
+					break;
+				}
+
+				m_vEntryDir.push_back(nDir);
+				m_vEntryName.push_back(nName);
+				m_vEntryCRC.push_back(nFileCRC);
+				m_vEntryPreload.push_back(iPreloadSize);
+				m_vEntryPackFile.push_back(iPackFileIndex);
+				m_vEntryChunks.push_back(nChunks);
+				m_vEntryChunkCount.push_back(nChunkCount);
+			}
+			if (bOverrun)
+			{
+				break;
+			}
+		}
+		if (bOverrun)
+		{
+			break;
+		}
+	}
+
+	if (bOverrun)
+	{
+		Error(eDLL_T::FS, NO_ERROR, "Truncated VPK directory file '%s' (tree exceeds file at '0x%zx')\n", svPath.c_str(), nPos);
+		return false;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: materializes the path of an entry
+// Input  : nEntry - 
+// Output : string
+//-----------------------------------------------------------------------------
+string VPKDirTable_t::GetEntryPath(size_t nEntry) const
+{
+	const uint32_t nDir = m_vEntryDir[nEntry];
+	string svEntryPath = g_pPackedStore->FormatEntryPath(GetString(m_vDirPath[nDir]), GetString(m_vEntryName[nEntry]), GetString(m_vDirExtension[nDir]));
+
+	StringReplace(svEntryPath, "\\", "/"); // Flip windows-style backslash to forward slash.
+	StringReplace(svEntryPath, " /", "" ); // Remove space character representing VPK root.
+
+	return svEntryPath;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: decodes a chunk descriptor of an entry
+// Input  : nEntry - 
+//          nChunk - 
+// Output : VPKChunkDescriptor_t
+//-----------------------------------------------------------------------------
+VPKChunkDescriptor_t VPKDirTable_t::GetChunk(size_t nEntry, size_t nChunk) const
+{
+	const uint8_t* pDesc = m_File.GetData() + m_vEntryChunks[nEntry] + nChunk * (VPK_CHUNK_DESCRIPTOR_SIZE + sizeof(uint16_t));
+	VPKChunkDescriptor_t vChunk;
+
+	memcpy(&vChunk.m_nLoadFlags,        pDesc,      sizeof(uint32_t)); //
+	memcpy(&vChunk.m_nTextureFlags,     pDesc + 4,  sizeof(uint16_t)); //
+	memcpy(&vChunk.m_nArchiveOffset,    pDesc + 6,  sizeof(uint64_t)); //
+	memcpy(&vChunk.m_nCompressedSize,   pDesc + 14, sizeof(uint64_t)); //
+	memcpy(&vChunk.m_nUncompressedSize, pDesc + 22, sizeof(uint64_t)); //
+	vChunk.m_bIsCompressed = (vChunk.m_nCompressedSize != vChunk.m_nUncompressedSize);
+
+	return vChunk;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: materializes a full entry block
+// Input  : nEntry - 
+// Output : VPKEntryBlock_t
+//-----------------------------------------------------------------------------
+VPKEntryBlock_t VPKDirTable_t::GetEntryBlock(size_t nEntry) const
+{
+	VPKEntryBlock_t vBlock;
+
+	vBlock.m_nFileCRC       = m_vEntryCRC[nEntry];
+	vBlock.m_iPreloadSize   = m_vEntryPreload[nEntry];
+	vBlock.m_iPackFileIndex = m_vEntryPackFile[nEntry];
+	vBlock.m_svEntryPath    = GetEntryPath(nEntry);
+
+	vBlock.m_vChunks.reserve(m_vEntryChunkCount[nEntry]);
+	for (uint32_t i = 0; i < m_vEntryChunkCount[nEntry]; i++)
+	{
+		vBlock.m_vChunks.push_back(GetChunk(nEntry, i));
+	}
+	return vBlock;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: gets the heap memory used by the table (excluding the mapped file)
+// Output : size_t
+//-----------------------------------------------------------------------------
+size_t VPKDirTable_t::GetMemoryFootprint(void) const
+{
+	return m_vDirExtension.capacity()  * sizeof(uint32_t)
+		+ m_vDirPath.capacity()        * sizeof(uint32_t)
+		+ m_vEntryDir.capacity()       * sizeof(uint32_t)
+		+ m_vEntryName.capacity()      * sizeof(uint32_t)
+		+ m_vEntryCRC.capacity()       * sizeof(uint32_t)
+		+ m_vEntryPreload.capacity()   * sizeof(uint16_t)
+		+ m_vEntryPackFile.capacity()  * sizeof(uint16_t)
+		+ m_vEntryChunks.capacity()    * sizeof(uint32_t)
+		+ m_vEntryChunkCount.capacity()* sizeof(uint32_t);
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: builds the vpk directory file
 // Input  : &svDirectoryFile - 
@@ -1,5 +1,6 @@
 #pragma once
 #include "public/utility/binstream.h"
+#include "public/utility/mappedfile.h"
 #include "thirdparty/lzham/include/lzham.h"
 
 constexpr unsigned int VPK_HEADER_MARKER = 0x55AA1234;
@@ -7,6 +8,7 @@ constexpr unsigned int VPK_MAJOR_VERSION = 2;
 constexpr unsigned int VPK_MINOR_VERSION = 3;
 constexpr unsigned int VPK_DICT_SIZE = 20;
 constexpr int ENTRY_MAX_LEN = 1024 * 1024;
+constexpr size_t VPK_CHUNK_DESCRIPTOR_SIZE = 30; // On-disk size of a chunk descriptor (excluding the terminator).
 
 const vector<string> DIR_CONTEXT = { "server", "client" };
 const vector<string> DIR_LOCALE  = { "english", "french", "german", "italian", "japanese", "korean", "polish", "portuguese", "russian", "spanish", "tchinese" };
@@ -83,6 +85,7 @@ struct VPKEntryBlock_t
 	vector<VPKChunkDescriptor_t> m_vChunks       {}; // Vector of all the chunks of a given entry (chunks have a size limit of 1 MiB, anything over this limit is fragmented into smaller chunks).
 	string                       m_svEntryPath   {}; // Path to entry within vpk.
 
+	VPKEntryBlock_t(){};
 	VPKEntryBlock_t(CIOStream* pReader, string svEntryPath);
 	VPKEntryBlock_t(const vector<uint8_t>& vData, int64_t nOffset, uint16_t nPreloadData, uint16_t nArchiveIndex, uint32_t nEntryFlags, uint16_t nTextureFlags, const string& svEntryPath);
 };
@@ -96,11 +99,48 @@ struct VPKDirHeader_t
 	uint32_t                     m_nSignatureSize{}; // Directory signature.
 };
 
+//-----------------------------------------------------------------------------
+// Flat structure-of-arrays view of a directory file. The tree is walked in 
+// place on a mapped view of the file; extension/path pairs are interned once 
+// per directory and all strings point into the mapped file. Entry paths and 
+// chunk descriptors are only materialized on demand.
+//-----------------------------------------------------------------------------
+struct VPKDirTable_t
+{
+	VPKDirHeader_t               m_vHeader       {}; // Dir header.
+	CMappedFile                  m_File          {}; // Mapped directory file.
+
+	vector<uint32_t>             m_vDirExtension {}; // Per directory: file offset of the extension string.
+	vector<uint32_t>             m_vDirPath      {}; // Per directory: file offset of the path string.
+
+	vector<uint32_t>             m_vEntryDir     {}; // Per entry: directory index.
+	vector<uint32_t>             m_vEntryName    {}; // Per entry: file offset of the name string.
+	vector<uint32_t>             m_vEntryCRC     {}; // Per entry: crc32 for the uncompressed entry.
+	vector<uint16_t>             m_vEntryPreload {}; // Per entry: preload bytes.
+	vector<uint16_t>             m_vEntryPackFile{}; // Per entry: index of the pack file that contains this entry.
+	vector<uint32_t>             m_vEntryChunks  {}; // Per entry: file offset of the first chunk descriptor.
+	vector<uint32_t>             m_vEntryChunkCount{}; // Per entry: number of chunk descriptors.
+
+	bool Init(const string& svPath);
+
+	size_t GetEntryCount(void) const { return m_vEntryName.size(); }
+	const char* GetString(uint32_t nOffset) const { return reinterpret_cast<const char*>(m_File.GetData() + nOffset); }
+
+	string GetEntryPath(size_t nEntry) const;
+	VPKChunkDescriptor_t GetChunk(size_t nEntry, size_t nChunk) const;
+	VPKEntryBlock_t GetEntryBlock(size_t nEntry) const;
+	size_t GetMemoryFootprint(void) const;
+};
+
+//-----------------------------------------------------------------------------
+// Directory file backed by a shared 'VPKDirTable_t'; copies share the table 
+// and entry blocks are materialized per call, nothing is built up front.
+//-----------------------------------------------------------------------------
 struct VPKDir_t
 {
 	VPKDirHeader_t               m_vHeader       {}; // Dir header.
 	uint32_t                     m_nFileDataSize {}; // File data section size.
-	vector<VPKEntryBlock_t>      m_vEntryBlocks  {}; // Vector of entry blocks.
+	std::shared_ptr<const VPKDirTable_t> m_pTable{}; // Entry table (null if the file couldn't be parsed).
 	uint16_t                     m_iPackFileCount{}; // Highest archive index (archive count-1).
 	vector<string>               m_vPackFile     {}; // Vector of archive file names.
 	string                       m_svDirPath     {}; // Path to vpk_dir file.
@@ -108,9 +148,95 @@ struct VPKDir_t
 	VPKDir_t(const string& svPath);
 	VPKDir_t() { m_vHeader.m_nHeaderMarker = VPK_HEADER_MARKER; m_vHeader.m_nMajorVersion = VPK_MAJOR_VERSION; m_vHeader.m_nMinorVersion = VPK_MINOR_VERSION; };
 
+	size_t GetEntryCount(void) const { return m_pTable ? m_pTable->GetEntryCount() : 0; }
+	string GetEntryPath(size_t nEntry) const { return m_pTable->GetEntryPath(nEntry); }
+	uint32_t GetEntryCRC(size_t nEntry) const { return m_pTable->m_vEntryCRC[nEntry]; }
+	uint16_t GetPackFileIndex(size_t nEntry) const { return m_pTable->m_vEntryPackFile[nEntry]; }
+	size_t GetChunkCount(size_t nEntry) const { return m_pTable->m_vEntryChunkCount[nEntry]; }
+	VPKChunkDescriptor_t GetChunk(size_t nEntry, size_t nChunk) const { return m_pTable->GetChunk(nEntry, nChunk); }
+	VPKEntryBlock_t GetEntryBlock(size_t nEntry) const { return m_pTable->GetEntryBlock(nEntry); }
+
 	void Build(const string& svDirectoryFile, const vector<VPKEntryBlock_t>& vEntryBlocks);
 };
 
+struct VPKKeyValues_t
+{
+	uint16_t m_iPreloadSize    {}; // Preload bytes.
+	uint32_t m_nLoadFlags      {}; // Load flags.
+	uint16_t m_nTextureFlags   {}; // Texture flags.
+	bool     m_bUseCompression {}; // Whether chunks should be compressed.
+	bool     m_bUseDataSharing {}; // Whether chunks should be deduplicated.
+};
+
+struct VPKPrevBuild_t
+{
+	VPKDir_t                     m_vDir          {}; // Directory of the previous build.
+	CMappedFile                  m_Archive       {}; // Archive of the previous build.
+	unordered_map<string, size_t> m_mEntries     {}; // Previous entry indices by entry path.
+};
+
+//-----------------------------------------------------------------------------
+// 128-bit fingerprint of the packed bytes of a chunk (MurmurHash3 x64).
+//-----------------------------------------------------------------------------
+struct VPKChunkHash_t
+{
+	uint64_t m_nLow;
+	uint64_t m_nHigh;
+
+	bool operator==(const VPKChunkHash_t& other) const { return m_nLow == other.m_nLow && m_nHigh == other.m_nHigh; }
+	bool operator!=(const VPKChunkHash_t& other) const { return !(*this == other); }
+
+	static VPKChunkHash_t Compute(const uint8_t* pData, size_t nSize);
+};
+
+//-----------------------------------------------------------------------------
+// Index of the chunks written to an archive, used for data sharing. The
+// fingerprints are stored in an open addressing table; a fingerprint match
+// is only trusted after comparing against the bytes already in the archive.
+//-----------------------------------------------------------------------------
+class CVPKChunkIndex
+{
+public:
+	CVPKChunkIndex(void);
+
+	void Init(const string& svArchivePath);
+	void Seed(const VPKDir_t& vPrevDir);
+	void Clear(void);
+
+	bool FindOrAdd(CIOStream& writer, const uint8_t* pData, uint64_t nSize, uint64_t& nArchiveOffset, VPKChunkHash_t& outHash);
+	bool FindOrAddPrevious(CIOStream& writer, const uint8_t* pData, uint64_t nSize, uint64_t nPrevOffset, uint64_t& nArchiveOffset, VPKChunkHash_t& outHash);
+
+	size_t GetCount(void) const { return m_nCount; }
+	size_t GetCollisionCount(void) const { return m_nCollisions; }
+	size_t GetPreviousCount(void) const { return m_mPrevious.size(); }
+
+private:
+	struct Slot_t
+	{
+		VPKChunkHash_t m_Hash;
+		uint64_t       m_nArchiveOffset;
+		uint64_t       m_nSize;
+		bool           m_bUsed;
+	};
+
+	struct PrevChunk_t
+	{
+		uint64_t       m_nArchiveOffset; // Offset in this archive, UINT64_MAX until written.
+		VPKChunkHash_t m_Hash;
+	};
+
+	bool IsWrittenChunk(CIOStream& writer, const uint8_t* pData, uint64_t nSize, uint64_t nArchiveOffset);
+	void Grow(void);
+
+	vector<Slot_t>  m_vSlots;        // Power of two sized, at most half full.
+	unordered_map<uint64_t, PrevChunk_t> m_mPrevious; // Previous build chunk offset -> chunk in this archive.
+	size_t          m_nCount;
+	size_t          m_nCollisions;   // Fingerprint matches that weren't the same bytes.
+	string          m_svArchivePath;
+	ifstream        m_Reader;        // Reads back written chunks to confirm matches.
+	vector<uint8_t> m_vCompare;
+};
+
 struct VPKPair_t
 {
 	string m_svBlockName;
@@ -126,6 +252,7 @@ public:
 	VPKDir_t GetDirectoryFile(string svDirectoryFile) const;
 	string GetPackFile(const string& svPackDirFile, uint16_t iArchiveIndex) const;
 	lzham_compress_level GetCompressionLevel(void) const;
+	int GetWorkerThreadCount(void) const;
 
 	vector<VPKEntryBlock_t> GetEntryBlocks(CIOStream* pReader) const;
 	vector<string> GetEntryPaths(const string& svPathIn) const;
@@ -135,21 +262,32 @@ public:
 	string GetSourceName(const string& svDirectoryName) const;
 
 	nlohmann::json GetManifest(const string& svWorkSpace, const string& svManifestName) const;
+	VPKKeyValues_t GetEntryValues(const nlohmann::json& jManifest, const string& svEntryPath) const;
 	vector<string> GetIgnoreList(const string& svWorkSpace) const;
 
 	string FormatEntryPath(string svName, const string& svPath, const string& svExtension) const;
 	string StripLocalePrefix(const string& svDirectoryFile) const;
 
 	VPKPair_t BuildFileName(string svLanguage, string svContext, const string& svPakName, int nPatch) const;
-	void BuildManifest(const vector<VPKEntryBlock_t>& vBlock, const string& svWorkSpace, const string& svManifestName) const;
+	void BuildManifest(const VPKDir_t& vDir, const string& svWorkSpace, const string& svManifestName) const;
 
-	void PackAll(const VPKPair_t& vPair, const string& svPathIn, const string& svPathOut, bool bManifestOnly);
-	void UnpackAll(const VPKDir_t& vDir, const string& svPathOut = "");
+	void PackAll(const VPKPair_t& vPair, const string& svPathIn, const string& svPathOut, bool bManifestOnly, int nThreads = 0, bool bIncremental = false);
+	bool VerifyPackAll(const VPKPair_t& vPair, const string& svPathIn, const string& svPathOut, bool bManifestOnly, int nThreads);
+	void UnpackAll(const VPKDir_t& vDir, const string& svPathOut = "", int nThreads = 0);
 
 	void ValidateAdler32PostDecomp(const string& svDirAsset);
 	void ValidateCRC32PostDecomp(const string& svDirAsset);
 
 private:
+	void PackEntriesParallel(CIOStream& writer, vector<VPKEntryBlock_t>& vEntryBlocks, const vector<string>& vPaths, const nlohmann::json& jManifest,
+		const string& svPathIn, const VPKPrevBuild_t& vPrevBuild, int nThreads, uint64_t& nSharedTotal, uint32_t& nSharedCount);
+
+	bool OpenPreviousBuild(VPKPrevBuild_t& vPrevBuild, const string& svDirectoryFile, const string& svBlockFile) const;
+	void ClosePreviousBuild(VPKPrevBuild_t& vPrevBuild) const;
+	bool GetReusableEntry(const VPKPrevBuild_t& vPrevBuild, const VPKEntryBlock_t& vBlock, const VPKKeyValues_t& vKeyValues, VPKEntryBlock_t& vPrevBlock) const;
+	void UnpackEntry(const CMappedFile& archive, const VPKEntryBlock_t& vEntry, size_t nEntry, size_t nArchive,
+		const string& svPathOut, vector<uint8_t>& vOutput) const;
+
 	size_t                       m_nChunkCount      {}; // Entry per-block incrementor.
 	lzham_uint32                 m_nAdler32_Internal{}; // Internal operation Adler32 file checksum.
 	lzham_uint32                 m_nAdler32         {}; // Pre/post operation Adler32 file checksum.
@@ -159,7 +297,7 @@ private:
 	lzham_compress_status_t      m_lzCompStatus     {}; // LZham compression status.
 	lzham_decompress_params      m_lzDecompParams   {}; // LZham decompression parameters.
 	lzham_decompress_status_t    m_lzDecompStatus   {}; // LZham decompression status.
-	std::unordered_map<string, VPKChunkDescriptor_t> m_mChunkHashMap{};
+	CVPKChunkIndex               m_ChunkIndex       {}; // Chunks written to the archive being packed.
 };
 ///////////////////////////////////////////////////////////////////////////////
 extern CPackedStore* g_pPackedStore;
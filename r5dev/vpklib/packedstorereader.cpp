@@ -0,0 +1,318 @@
+//=============================================================================//
+//
+// Purpose: read-only random access into VPK files
+//
+//=============================================================================//
+#include "core/stdafx.h"
+#include "vpklib/packedstorereader.h"
+
+//-----------------------------------------------------------------------------
+// Purpose: constructor
+// Input  : nCacheBudget - maximum decompressed bytes to cache
+//-----------------------------------------------------------------------------
+CPackedStoreReader::CPackedStoreReader(size_t nCacheBudget)
+	: m_lzDecompParams()
+	, m_nCacheSize(0)
+	, m_nCacheBudget(nCacheBudget)
+{
+	m_lzDecompParams.m_dict_size_log2   = VPK_DICT_SIZE;
+	m_lzDecompParams.m_decompress_flags = lzham_decompress_flags::LZHAM_DECOMP_FLAG_OUTPUT_UNBUFFERED;
+	m_lzDecompParams.m_struct_size      = sizeof(lzham_decompress_params);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: destructor
+//-----------------------------------------------------------------------------
+CPackedStoreReader::~CPackedStoreReader()
+{
+	Shutdown();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: loads the directory file and builds the entry index
+// Input  : &svDirectoryFile - 
+// Output : true on success, false otherwise
+//-----------------------------------------------------------------------------
+bool CPackedStoreReader::Init(const string& svDirectoryFile)
+{
+	Shutdown();
+	std::lock_guard<std::mutex> l(m_Mutex);
+
+	m_vDir = g_pPackedStore->GetDirectoryFile(svDirectoryFile);
+	if (m_vDir.m_vHeader.m_nHeaderMarker != VPK_HEADER_MARKER ||
+		m_vDir.m_vHeader.m_nMajorVersion != VPK_MAJOR_VERSION ||
+		m_vDir.m_vHeader.m_nMinorVersion != VPK_MINOR_VERSION)
+	{
+		Error(eDLL_T::FS, NO_ERROR, "Unsupported VPK directory file '%s' (invalid header criteria)\n", svDirectoryFile.c_str());
+		return false;
+	}
+
+	m_mEntries.reserve(m_vDir.GetEntryCount());
+	for (size_t i = 0; i < m_vDir.GetEntryCount(); i++)
+	{
+		m_mEntries.insert({ m_vDir.GetEntryPath(i), i });
+	}
+	m_vBlocks.resize(m_vDir.GetEntryCount());
+	m_vArchives.resize(m_vDir.m_vPackFile.size());
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: unmaps all archives and clears the index and cache
+//-----------------------------------------------------------------------------
+void CPackedStoreReader::Shutdown(void)
+{
+	std::lock_guard<std::mutex> l(m_Mutex);
+
+	m_CacheList.clear();
+	m_mCacheMap.clear();
+	m_nCacheSize = 0;
+
+	m_vArchives.clear();
+	m_mEntries.clear();
+	m_vBlocks.clear();
+	m_vDir = VPKDir_t();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: looks up an entry by path
+// Input  : &svEntryPath - 
+// Output : const VPKEntryBlock_t* (nullptr if not found)
+//-----------------------------------------------------------------------------
+const VPKEntryBlock_t* CPackedStoreReader::Open(const string& svEntryPath) const
+{
+	std::lock_guard<std::mutex> l(m_Mutex);
+
+	const auto it = m_mEntries.find(ConvertToUnixPath(svEntryPath));
+	if (it == m_mEntries.end())
+	{
+		return nullptr;
+	}
+
+	std::unique_ptr<const VPKEntryBlock_t>& pBlock = m_vBlocks[it->second];
+	if (!pBlock)
+	{
+		pBlock = std::make_unique<const VPKEntryBlock_t>(m_vDir.GetEntryBlock(it->second));
+	}
+	return pBlock.get();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: gets the uncompressed size of an entry
+// Input  : *pEntry - 
+// Output : size_t
+//-----------------------------------------------------------------------------
+size_t CPackedStoreReader::Size(const VPKEntryBlock_t* pEntry) const
+{
+	size_t nSize = 0;
+	for (const VPKChunkDescriptor_t& vChunk : pEntry->m_vChunks)
+	{
+		nSize += vChunk.m_nUncompressedSize;
+	}
+	return nSize;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: reads a byte range from an entry, decompressing only the chunks 
+//          overlapping the range
+// Input  : *pEntry - 
+//          *pBuffer - 
+//          nOffset - offset into the uncompressed entry
+//          nSize - number of bytes to read
+// Output : number of bytes read
+//-----------------------------------------------------------------------------
+size_t CPackedStoreReader::Read(const VPKEntryBlock_t* pEntry, void* pBuffer, size_t nOffset, size_t nSize)
+{
+	const CMappedFile* pArchive = GetArchive(pEntry->m_iPackFileIndex);
+	if (!pArchive)
+	{
+		return 0;
+	}
+
+	uint8_t* pOutput = reinterpret_cast<uint8_t*>(pBuffer);
+	size_t nRead = 0;
+	size_t nChunkStart = 0;
+
+	for (const VPKChunkDescriptor_t& vChunk : pEntry->m_vChunks)
+	{
+		const size_t nChunkEnd = nChunkStart + vChunk.m_nUncompressedSize;
+		if (nSize == 0)
+		{
+			break;
+		}
+		if (nOffset >= nChunkEnd) // Range starts after this chunk.
+		{
+			nChunkStart = nChunkEnd;
+			continue;
+		}
+
+		const size_t nChunkOffset = nOffset - nChunkStart;
+		const size_t nCopySize = std::min<size_t>(nSize, vChunk.m_nUncompressedSize - nChunkOffset);
+
+		if (vChunk.m_bIsCompressed)
+		{
+			const ChunkData_t pData = GetChunk(pArchive, pEntry->m_iPackFileIndex, vChunk);
+			if (!pData)
+			{
+				break;
+			}
+			memcpy(pOutput + nRead, pData->data() + nChunkOffset, nCopySize);
+		}
+		else // Stored uncompressed; copy straight from the mapped archive.
+		{
+			if (vChunk.m_nArchiveOffset + vChunk.m_nUncompressedSize > pArchive->GetSize())
+			{
+				Error(eDLL_T::FS, NO_ERROR, "Chunk at '0x%llx' exceeds archive bounds in block '%hu'\n", vChunk.m_nArchiveOffset, pEntry->m_iPackFileIndex);
+				break;
+			}
+			memcpy(pOutput + nRead, pArchive->GetData() + vChunk.m_nArchiveOffset + nChunkOffset, nCopySize);
+		}
+
+		nRead += nCopySize;
+		nOffset += nCopySize;
+		nSize -= nCopySize;
+		nChunkStart = nChunkEnd;
+	}
+	return nRead;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: reads the whole entry
+// Input  : *pEntry - 
+//          &vOutput - 
+// Output : true on success, false otherwise
+//-----------------------------------------------------------------------------
+bool CPackedStoreReader::ReadAll(const VPKEntryBlock_t* pEntry, vector<uint8_t>& vOutput)
+{
+	vOutput.resize(Size(pEntry));
+	return Read(pEntry, vOutput.data(), 0, vOutput.size()) == vOutput.size();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: sets the decompressed chunk cache budget
+// Input  : nCacheBudget - 
+//-----------------------------------------------------------------------------
+void CPackedStoreReader::SetCacheBudget(size_t nCacheBudget)
+{
+	std::lock_guard<std::mutex> l(m_Mutex);
+
+	m_nCacheBudget = nCacheBudget;
+	EvictChunks();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: gets the number of decompressed bytes currently cached
+// Output : size_t
+//-----------------------------------------------------------------------------
+size_t CPackedStoreReader::GetCacheSize(void) const
+{
+	std::lock_guard<std::mutex> l(m_Mutex);
+	return m_nCacheSize;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: gets the mapped archive, mapping it on first use
+// Input  : iPackFileIndex - 
+// Output : const CMappedFile* (nullptr if the archive can't be mapped)
+//-----------------------------------------------------------------------------
+const CMappedFile* CPackedStoreReader::GetArchive(uint16_t iPackFileIndex)
+{
+	std::lock_guard<std::mutex> l(m_Mutex);
+
+	if (iPackFileIndex >= m_vArchives.size())
+	{
+		Error(eDLL_T::FS, NO_ERROR, "Archive index '%hu' out of range\n", iPackFileIndex);
+		return nullptr;
+	}
+
+	if (!m_vArchives[iPackFileIndex])
+	{
+		fs::path fspVpkPath(m_vDir.m_svDirPath);
+		const string svPath = fspVpkPath.parent_path().u8string() + '\\' + m_vDir.m_vPackFile[iPackFileIndex];
+
+		std::unique_ptr<CMappedFile> pArchive = std::make_unique<CMappedFile>(svPath);
+		if (!pArchive->IsOpen())
+		{
+			Error(eDLL_T::FS, NO_ERROR, "Unable to map archive '%s'\n", svPath.c_str());
+			return nullptr;
+		}
+		m_vArchives[iPackFileIndex] = std::move(pArchive);
+	}
+	return m_vArchives[iPackFileIndex].get();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: gets a decompressed chunk from the cache, decompressing on a miss
+// Input  : *pArchive - 
+//          iPackFileIndex - 
+//          &vChunk - 
+// Output : ChunkData_t (nullptr on failure)
+//-----------------------------------------------------------------------------
+CPackedStoreReader::ChunkData_t CPackedStoreReader::GetChunk(const CMappedFile* pArchive, uint16_t iPackFileIndex, const VPKChunkDescriptor_t& vChunk)
+{
+	const uint64_t nKey = (static_cast<uint64_t>(iPackFileIndex) << 48) | vChunk.m_nArchiveOffset;
+	{
+		std::lock_guard<std::mutex> l(m_Mutex);
+
+		const auto it = m_mCacheMap.find(nKey);
+		if (it != m_mCacheMap.end())
+		{
+			m_CacheList.splice(m_CacheList.begin(), m_CacheList, it->second); // Mark as most recently used.
+			return it->second->m_pData;
+		}
+	}
+
+	if (vChunk.m_nArchiveOffset + vChunk.m_nCompressedSize > pArchive->GetSize())
+	{
+		Error(eDLL_T::FS, NO_ERROR, "Chunk at '0x%llx' exceeds archive bounds in block '%hu'\n", vChunk.m_nArchiveOffset, iPackFileIndex);
+		return nullptr;
+	}
+
+	// Decompress outside of the lock so other readers aren't stalled.
+	std::shared_ptr<vector<uint8_t>> pData = std::make_shared<vector<uint8_t>>(vChunk.m_nUncompressedSize);
+	size_t nDecompSize = vChunk.m_nUncompressedSize;
+
+	const lzham_decompress_status_t lzDecompStatus = lzham_decompress_memory(&m_lzDecompParams, pData->data(), &nDecompSize,
+		pArchive->GetData() + vChunk.m_nArchiveOffset, vChunk.m_nCompressedSize, nullptr, nullptr);
+
+	if (lzDecompStatus != lzham_decompress_status_t::LZHAM_DECOMP_STATUS_SUCCESS || nDecompSize != vChunk.m_nUncompressedSize)
+	{
+		Error(eDLL_T::FS, NO_ERROR, "Status '%d' for chunk at '0x%llx' in block '%hu' (chunk not decompressed)\n",
+			lzDecompStatus, vChunk.m_nArchiveOffset, iPackFileIndex);
+		return nullptr;
+	}
+
+	std::lock_guard<std::mutex> l(m_Mutex);
+
+	const auto it = m_mCacheMap.find(nKey);
+	if (it != m_mCacheMap.end()) // Another thread decompressed it in the meantime.
+	{
+		m_CacheList.splice(m_CacheList.begin(), m_CacheList, it->second);
+		return it->second->m_pData;
+	}
+
+	m_CacheList.push_front({ nKey, pData });
+	m_mCacheMap.insert({ nKey, m_CacheList.begin() });
+	m_nCacheSize += pData->size();
+
+	EvictChunks();
+	return pData;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: evicts least recently used chunks until the cache fits the budget
+// Note   : the caller must hold the mutex; readers keep evicted chunks alive 
+//          through their own reference until they're done copying.
+//-----------------------------------------------------------------------------
+void CPackedStoreReader::EvictChunks(void)
+{
+	while (m_nCacheSize > m_nCacheBudget && !m_CacheList.empty())
+	{
+		const CachedChunk_t& vChunk = m_CacheList.back();
+
+		m_nCacheSize -= vChunk.m_pData->size();
+		m_mCacheMap.erase(vChunk.m_nKey);
+		m_CacheList.pop_back();
+	}
+}
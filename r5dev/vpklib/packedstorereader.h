@@ -0,0 +1,58 @@
+#ifndef PACKEDSTOREREADER_H
+#define PACKEDSTOREREADER_H
+#include "vpklib/packedstore.h"
+
+constexpr size_t VPK_READER_CACHE_BUDGET = 64 * 1024 * 1024; // Default budget for decompressed chunks (64 MiB).
+
+//-----------------------------------------------------------------------------
+// Read-only random access into a VPK without extracting it. Only the chunks 
+// overlapping a requested byte range are decompressed; decompressed chunks 
+// are kept in an LRU cache bounded by a memory budget.
+//-----------------------------------------------------------------------------
+class CPackedStoreReader
+{
+public:
+	CPackedStoreReader(size_t nCacheBudget = VPK_READER_CACHE_BUDGET);
+	~CPackedStoreReader();
+
+	bool Init(const string& svDirectoryFile);
+	void Shutdown(void);
+
+	const VPKEntryBlock_t* Open(const string& svEntryPath) const;
+	size_t Size(const VPKEntryBlock_t* pEntry) const;
+	size_t Read(const VPKEntryBlock_t* pEntry, void* pBuffer, size_t nOffset, size_t nSize);
+	bool ReadAll(const VPKEntryBlock_t* pEntry, vector<uint8_t>& vOutput);
+
+	void SetCacheBudget(size_t nCacheBudget);
+	size_t GetCacheSize(void) const;
+
+	const VPKDir_t& GetDirectory(void) const { return m_vDir; }
+
+private:
+	typedef std::shared_ptr<const vector<uint8_t>> ChunkData_t;
+
+	struct CachedChunk_t
+	{
+		uint64_t    m_nKey;  // Archive index and offset of the chunk.
+		ChunkData_t m_pData; // Decompressed chunk data.
+	};
+
+	const CMappedFile* GetArchive(uint16_t iPackFileIndex);
+	ChunkData_t GetChunk(const CMappedFile* pArchive, uint16_t iPackFileIndex, const VPKChunkDescriptor_t& vChunk);
+	void EvictChunks(void);
+
+	VPKDir_t                                 m_vDir;           // Directory file.
+	unordered_map<string, size_t>            m_mEntries;       // Entry indices by entry path.
+	mutable vector<std::unique_ptr<const VPKEntryBlock_t>> m_vBlocks; // Entry blocks, materialized on first open.
+	vector<std::unique_ptr<CMappedFile>>     m_vArchives;      // Lazily mapped archives.
+	lzham_decompress_params                  m_lzDecompParams; // LZham decompression parameters.
+
+	std::list<CachedChunk_t>                 m_CacheList;      // Cached chunks, most recently used first.
+	unordered_map<uint64_t, std::list<CachedChunk_t>::iterator> m_mCacheMap;
+	size_t                                   m_nCacheSize;     // Decompressed bytes currently cached.
+	size_t                                   m_nCacheBudget;   // Maximum decompressed bytes to cache.
+
+	mutable std::mutex                       m_Mutex;
+};
+
+#endif // PACKEDSTOREREADER_H
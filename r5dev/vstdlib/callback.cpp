@@ -7,6 +7,9 @@
 #include "core/stdafx.h"
 #include "windows/id3dx.h"
 #include "tier0/fasttimer.h"
+#include "tier0/frametask.h"
+#include "public/utility/benchmark.h"
+#include "public/utility/sigscan.h"
 #include "tier1/cvar.h"
 #include "tier1/IConVar.h"
 #ifdef DEDICATED
@@ -38,9 +41,13 @@
 #endif // !DEDICATED
 #ifndef CLIENT_DLL
 #include "networksystem/bansystem.h"
+#include "networksystem/pylon.h"
+#include "game/server/ai_network.h"
+#include "game/server/ai_nodegrid.h"
 #endif // !CLIENT_DLL
 #include "public/worldsize.h"
 #include "mathlib/crc32.h"
+#include "mathlib/adler32.h"
 #include "mathlib/mathlib.h"
 #include "vstdlib/completion.h"
 #include "vstdlib/callback.h"
@@ -52,6 +59,20 @@
 #include "game/client/view.h"
 #endif // !DEDICATED
 
+//-----------------------------------------------------------------------------
+// Purpose: prints benchmark results to the console
+// Input  : context - 
+//-----------------------------------------------------------------------------
+static BenchPrintFn_t Bench_GetPrinter(eDLL_T context)
+{
+	return [context](bool bWarning, const char* pszLine)
+	{
+		if (bWarning)
+			Warning(context, "%s\n", pszLine);
+		else
+			DevMsg(context, "%s\n", pszLine);
+	};
+}
 
 /*
 =====================
@@ -180,6 +201,94 @@ void Host_ReloadBanList_f(const CCommand& args)
 	g_pBanSystem->Load(); // Reload banned list.
 }
 
+/*
+=====================
+Host_ImportBanList_f
+=====================
+*/
+void Host_ImportBanList_f(const CCommand& args)
+{
+	g_pBanSystem->ImportJson();
+}
+
+/*
+=====================
+Host_ExportBanList_f
+=====================
+*/
+void Host_ExportBanList_f(const CCommand& args)
+{
+	g_pBanSystem->ExportJson();
+}
+
+/*
+=====================
+Host_BanListBench_f
+
+  Builds a separate banned list of
+  random addresses, NucleusIDs and
+  prefixes, and times its lookups
+  against a linear scan of the same
+  entries, which must agree
+=====================
+*/
+void Host_BanListBench_f(const CCommand& args)
+{
+	const size_t nEntries = args.ArgC() >= 2 ? std::max<int>(atoi(args.Arg(1)), 1) : 100000;
+	const size_t nLookups = args.ArgC() >= 3 ? std::max<int>(atoi(args.Arg(2)), 1) : 100000;
+
+	CBenchmark bench(Bench_GetPrinter(eDLL_T::SERVER));
+	CBanSystem::Benchmark(bench, nEntries, nLookups);
+}
+
+/*
+=====================
+Pylon_BanCacheStats_f
+=====================
+*/
+void Pylon_BanCacheStats_f(const CCommand& args)
+{
+	const BanVerdictCacheStats_t stats = g_pMasterServer->GetBanVerdictCache().GetStats();
+	const size_t nLookups = stats.m_nHits + stats.m_nMisses;
+
+	DevMsg(eDLL_T::SERVER, "Ban verdict cache: '%zu' entries, '%zu' hits, '%zu' misses (%.1f%% hit rate), '%zu' evictions, '%zu' expirations\n",
+		stats.m_nEntries, stats.m_nHits, stats.m_nMisses, nLookups ? stats.m_nHits * 100.0 / nLookups : 0.0, stats.m_nEvictions, stats.m_nExpirations);
+}
+
+/*
+=====================
+Pylon_BanCacheClear_f
+=====================
+*/
+void Pylon_BanCacheClear_f(const CCommand& args)
+{
+	g_pMasterServer->GetBanVerdictCache().Clear();
+}
+
+/*
+=====================
+AI_NodeGridBench_f
+
+  Times the script node grid against 
+  the linear scan on the loaded network 
+  and verifies every grid query
+=====================
+*/
+void AI_NodeGridBench_f(const CCommand& args)
+{
+	const CAI_Network* pNetwork = g_pAINetwork ? *g_pAINetwork : nullptr;
+	if (!pNetwork || !g_pAINetworkIndex->IsBuiltFor(pNetwork))
+	{
+		Warning(eDLL_T::SERVER, "No indexed AI network is loaded\n");
+		return;
+	}
+
+	const int nQueries = args.ArgC() > 1 ? std::max<int>(atoi(args.Arg(1)), 1) : 10000;
+
+	CBenchmark bench(Bench_GetPrinter(eDLL_T::SERVER));
+	g_pAINetworkIndex->Benchmark(bench, nQueries);
+}
+
 /*
 =====================
 Host_ReloadPlaylists_f
@@ -407,11 +516,18 @@ void RTech_Decompress_f(const CCommand& args)
 
 	DevMsg(eDLL_T::RTECH, " |-+ Processing: '%s'\n", pakNameIn.c_str());
 
-	CIOStream reader(pakNameIn, CIOStream::Mode_t::READ);
+	RPakDecompResult_t result;
+	RTech_DecompressPakToFile(pakNameIn, pakNameOut, result, PAK_DECOMP_VERIFY_SIZE | PAK_DECOMP_COMPUTE_CRC);
 
-	RPakHeader_t rheader = reader.Read<RPakHeader_t>();
+	const RPakHeader_t& rheader = result.m_Header;
 	uint16_t flags = (rheader.m_nFlags[0] << 8) | rheader.m_nFlags[1];
 
+	if (result.m_nStatus == RPakDecompStatus_t::PAK_DECOMP_OPEN_FAILED)
+	{
+		Error(eDLL_T::RTECH, NO_ERROR, "%s - pak file '%s' could not be read!\n", __FUNCTION__, pakNameIn.c_str());
+		return;
+	}
+
 	DevMsg(eDLL_T::RTECH, " | |-+ Header ------------------------------------------------\n");
 	DevMsg(eDLL_T::RTECH, " | | |-- Magic    : '%08X'\n", rheader.m_nMagic);
 	DevMsg(eDLL_T::RTECH, " | | |-- Version  : '%hu'\n", rheader.m_nVersion);
@@ -423,66 +539,30 @@ void RTech_Decompress_f(const CCommand& args)
 	DevMsg(eDLL_T::RTECH, " | | |-- Size decp: '%llu'\n", rheader.m_nSizeMemory);
 	DevMsg(eDLL_T::RTECH, " | | |-- Ratio    : '%.02f'\n", (rheader.m_nSizeDisk * 100.f) / rheader.m_nSizeMemory);
 
-	if (rheader.m_nMagic != RPAKHEADER)
+	switch (result.m_nStatus)
 	{
+	case RPakDecompStatus_t::PAK_DECOMP_INVALID_MAGIC:
 		Error(eDLL_T::RTECH, NO_ERROR, "%s - pak file '%s' has invalid magic!\n", __FUNCTION__, pakNameIn.c_str());
 		return;
-	}
-	if ((rheader.m_nFlags[1] & 1) != 1)
-	{
+	case RPakDecompStatus_t::PAK_DECOMP_NOT_COMPRESSED:
 		Error(eDLL_T::RTECH, NO_ERROR, "%s - pak file '%s' already decompressed!\n", __FUNCTION__, pakNameIn.c_str());
 		return;
-	}
-	if (rheader.m_nSizeDisk != reader.GetSize())
-	{
-		Error(eDLL_T::RTECH, NO_ERROR, "%s - pak file '%s' decompressed size '%zu' doesn't match expected value '%llu'!\n", __FUNCTION__, pakNameIn.c_str(), reader.GetSize(), rheader.m_nSizeMemory);
+	case RPakDecompStatus_t::PAK_DECOMP_SIZE_MISMATCH:
+		Error(eDLL_T::RTECH, NO_ERROR, "%s - pak file '%s' size mismatch (disk: '%llu' file: '%llu' calculated: '%llu' expected: '%llu')!\n",
+			__FUNCTION__, pakNameIn.c_str(), rheader.m_nSizeDisk, result.m_nInputSize, result.m_nDecompSize, rheader.m_nSizeMemory);
 		return;
-	}
-
-	RPakDecompState_t state;
-	uint64_t decompSize = g_pRTech->DecompressPakFileInit(&state, const_cast<uint8_t*>(reader.GetData()), reader.GetSize(), NULL, sizeof(RPakHeader_t));
-
-	if (decompSize == rheader.m_nSizeDisk)
-	{
-		Error(eDLL_T::RTECH, NO_ERROR, "%s - calculated size: '%llu' expected: '%llu'!\n", __FUNCTION__, decompSize, rheader.m_nSizeMemory);
+	case RPakDecompStatus_t::PAK_DECOMP_FAILED:
+		Error(eDLL_T::RTECH, NO_ERROR, "%s - decompression failed for '%s'!\n", __FUNCTION__, pakNameIn.c_str());
 		return;
-	}
-	else
-	{
-		DevMsg(eDLL_T::RTECH, " | | |-- Calculated size: '%llu'\n", decompSize);
-	}
-
-	vector<uint8_t> pakBuf(rheader.m_nSizeMemory, 0);
-
-	state.m_nOutMask = UINT64_MAX;
-	state.m_nOut = uint64_t(pakBuf.data());
-
-	uint8_t decompResult = g_pRTech->DecompressPakFile(&state, reader.GetSize(), pakBuf.size());
-	if (decompResult != 1)
-	{
-		Error(eDLL_T::RTECH, NO_ERROR, "%s - decompression failed for '%s' return value: '%hu'!\n", __FUNCTION__, pakNameIn.c_str(), decompResult);
+	case RPakDecompStatus_t::PAK_DECOMP_WRITE_FAILED:
+		Error(eDLL_T::RTECH, NO_ERROR, "%s - unable to write '%s' (read-only?)\n", __FUNCTION__, pakNameOut.c_str());
 		return;
+	default:
+		break;
 	}
 
-	rheader.m_nFlags[1] = 0x0; // Set compressed flag to false for the decompressed pak file.
-	rheader.m_nSizeDisk = rheader.m_nSizeMemory; // Equal compressed size with decompressed.
-
-	CIOStream writer(pakNameOut, CIOStream::Mode_t::WRITE);
-
-	if (rheader.m_nPatchIndex > 0) // Check if its an patch rpak.
-	{
-		// Loop through all the structs and patch their compress size.
-		for (uint32_t i = 1, patch_offset = 0x88; i <= rheader.m_nPatchIndex; i++, patch_offset += sizeof(RPakPatchCompressedHeader_t))
-		{
-			RPakPatchCompressedHeader_t* patch_header = (RPakPatchCompressedHeader_t*)((uintptr_t)pakBuf.data() + patch_offset);
-			patch_header->m_nSizeDisk = patch_header->m_nSizeMemory; // Fix size for decompress.
-		}
-	}
-
-	memcpy_s(pakBuf.data(), state.m_nDecompSize, &rheader, sizeof(RPakHeader_t)); // Overwrite first 0x80 bytes which are NULL with the header data.
-	writer.Write(pakBuf.data(), state.m_nDecompSize);
-
-	DevMsg(eDLL_T::RTECH, " | | |-- CRC32          : '%08X'\n", crc32::update(NULL, pakBuf.data(), state.m_nDecompSize));
+	DevMsg(eDLL_T::RTECH, " | | |-- Calculated size: '%llu'\n", result.m_nDecompSize);
+	DevMsg(eDLL_T::RTECH, " | | |-- CRC32          : '%08X'\n", result.m_nCrc32);
 	DevMsg(eDLL_T::RTECH, " |-+ Decompressed rpak to: '%s'\n", pakNameOut.c_str());
 	DevMsg(eDLL_T::RTECH, "--------------------------------------------------------------\n");
 }
@@ -506,9 +586,11 @@ void VPK_Pack_f(const CCommand& args)
 	g_pPackedStore->InitLzCompParams();
 	VPKPair_t vPair = g_pPackedStore->BuildFileName(args.Arg(1), args.Arg(2), args.Arg(3), NULL);
 
-	DevMsg(eDLL_T::FS, "*** Starting VPK build command for: '%s'\n", vPair.m_svDirectoryName.c_str());
+	const int nThreads = g_pPackedStore->GetWorkerThreadCount();
+
+	DevMsg(eDLL_T::FS, "*** Starting VPK build command for: '%s' (%d worker threads)\n", vPair.m_svDirectoryName.c_str(), nThreads);
 
-	std::thread th([&] { g_pPackedStore->PackAll(vPair, fs_packedstore_workspace->GetString(), "vpk/", (args.ArgC() > 4)); });
+	std::thread th([&] { g_pPackedStore->PackAll(vPair, fs_packedstore_workspace->GetString(), "vpk/", (args.ArgC() > 4), nThreads, fs_packedstore_incremental->GetBool()); });
 	th.join();
 
 	std::chrono::milliseconds msEnd = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch());
@@ -518,6 +600,41 @@ void VPK_Pack_f(const CCommand& args)
 	DevMsg(eDLL_T::FS, "\n");
 }
 
+/*
+=====================
+VPK_PackVerify_f
+
+  Builds the VPK files serially and
+  in parallel into '\vpk\verify' and
+  compares the output byte for byte.
+=====================
+*/
+void VPK_PackVerify_f(const CCommand& args)
+{
+	if (args.ArgC() < 4)
+	{
+		return;
+	}
+
+	g_pPackedStore->InitLzCompParams();
+	VPKPair_t vPair = g_pPackedStore->BuildFileName(args.Arg(1), args.Arg(2), args.Arg(3), NULL);
+
+	const int nThreads = g_pPackedStore->GetWorkerThreadCount();
+	bool bIdentical = false;
+
+	std::thread th([&] { bIdentical = g_pPackedStore->VerifyPackAll(vPair, fs_packedstore_workspace->GetString(), "vpk/verify/", (args.ArgC() > 4), nThreads); });
+	th.join();
+
+	if (bIdentical)
+	{
+		DevMsg(eDLL_T::FS, "Serial and parallel ('%d' worker threads) builds of '%s' are identical\n", std::max<int>(nThreads, 2), vPair.m_svDirectoryName.c_str());
+	}
+	else
+	{
+		Warning(eDLL_T::FS, "Serial and parallel builds of '%s' differ\n", vPair.m_svDirectoryName.c_str());
+	}
+}
+
 /*
 =====================
 VPK_Unpack_f
@@ -539,7 +656,8 @@ void VPK_Unpack_f(const CCommand& args)
 	VPKDir_t vpk = g_pPackedStore->GetDirectoryFile(args.Arg(1));
 	g_pPackedStore->InitLzDecompParams();
 
-	std::thread th([&] { g_pPackedStore->UnpackAll(vpk, ConvertToWinPath(fs_packedstore_workspace->GetString())); });
+	const int nThreads = g_pPackedStore->GetWorkerThreadCount();
+	std::thread th([&] { g_pPackedStore->UnpackAll(vpk, ConvertToWinPath(fs_packedstore_workspace->GetString()), nThreads); });
 	th.join();
 
 	std::chrono::milliseconds msEnd = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch());
@@ -549,6 +667,177 @@ void VPK_Unpack_f(const CCommand& args)
 	DevMsg(eDLL_T::FS, "\n");
 }
 
+/*
+=====================
+VPK_DirBench_f
+
+  Parses input VPK directory file
+  with both the flat table and the
+  legacy stream parser and reports
+  timings and memory footprints
+=====================
+*/
+void VPK_DirBench_f(const CCommand& args)
+{
+	if (args.ArgC() < 2)
+	{
+		return;
+	}
+
+	CFastTimer timer;
+	VPKDirTable_t vTable;
+
+	timer.Start();
+	if (!vTable.Init(args.Arg(1)))
+	{
+		Warning(eDLL_T::FS, "Unable to parse VPK directory file '%s'\n", args.Arg(1));
+		return;
+	}
+	timer.End();
+	const double flTableTime = timer.GetDuration().GetMillisecondsF();
+
+	timer.Start();
+	const VPKDir_t vDir(args.Arg(1));
+	timer.End();
+	const double flDirTime = timer.GetDuration().GetMillisecondsF();
+
+	// Legacy 'VPKDir_t' open: stream the header and every entry block, then
+	// resolve the archive names.
+	timer.Start();
+	CIOStream reader(args.Arg(1), CIOStream::Mode_t::READ);
+	VPKDirHeader_t vHeader;
+
+	reader.Read<uint32_t>(vHeader.m_nHeaderMarker);
+	reader.Read<uint16_t>(vHeader.m_nMajorVersion);
+	reader.Read<uint16_t>(vHeader.m_nMinorVersion);
+	reader.Read<uint32_t>(vHeader.m_nDirectorySize);
+	reader.Read<uint32_t>(vHeader.m_nSignatureSize);
+
+	vector<VPKEntryBlock_t> vBlocks = g_pPackedStore->GetEntryBlocks(&reader);
+	uint16_t iPackFileCount = 0;
+
+	for (const VPKEntryBlock_t& vBlock : vBlocks)
+	{
+		iPackFileCount = std::max<uint16_t>(iPackFileCount, vBlock.m_iPackFileIndex);
+	}
+
+	vector<string> vPackFile;
+	for (uint16_t i = 0; i < iPackFileCount + 1; i++)
+	{
+		vPackFile.push_back(g_pPackedStore->GetPackFile(args.Arg(1), i));
+	}
+	timer.End();
+	const double flLegacyTime = timer.GetDuration().GetMillisecondsF();
+
+	size_t nLegacyFootprint = vBlocks.capacity() * sizeof(VPKEntryBlock_t);
+	size_t nMismatches = vBlocks.size() != vTable.GetEntryCount() ? 1 : 0;
+
+	for (size_t i = 0; i < vBlocks.size(); i++)
+	{
+		const VPKEntryBlock_t& vBlock = vBlocks[i];
+		nLegacyFootprint += vBlock.m_svEntryPath.capacity() + vBlock.m_vChunks.capacity() * sizeof(VPKChunkDescriptor_t);
+
+		if (i < vTable.GetEntryCount() && vTable.GetEntryPath(i) != vBlock.m_svEntryPath)
+		{
+			nMismatches++;
+		}
+	}
+
+	DevMsg(eDLL_T::FS, "*** VPK directory parse benchmark for: '%s'\n", args.Arg(1));
+	DevMsg(eDLL_T::FS, " |-- Table : '%zu' entries in '%.3f' ms ('%zu' bytes)\n", vTable.GetEntryCount(), flTableTime, vTable.GetMemoryFootprint());
+	DevMsg(eDLL_T::FS, " |-- Dir   : '%zu' entries in '%.3f' ms ('%zu' archives)\n", vDir.GetEntryCount(), flDirTime, vDir.m_vPackFile.size());
+	DevMsg(eDLL_T::FS, " |-- Legacy: '%zu' entries in '%.3f' ms ('%zu' bytes, '%zu' archives)\n", vBlocks.size(), flLegacyTime, nLegacyFootprint, vPackFile.size());
+	DevMsg(eDLL_T::FS, " |-- Path mismatches: '%zu'\n", nMismatches);
+}
+
+/*
+=====================
+Host_FrameTaskBench_f
+
+  Dispatches tasks spread over many
+  frames, plus some on a deadline,
+  to a separate scheduler and checks
+  that each runs once, on time
+=====================
+*/
+void Host_FrameTaskBench_f(const CCommand& args)
+{
+	const int nTasks = args.ArgC() >= 2 ? std::max<int>(atoi(args.Arg(1)), 1) : 100000;
+	const int nFrames = args.ArgC() >= 3 ? std::max<int>(atoi(args.Arg(2)), 1) : 600;
+
+	CBenchmark bench(Bench_GetPrinter(eDLL_T::ENGINE));
+	CFrameTask::Benchmark(bench, nTasks, nFrames);
+}
+
+/*
+=====================
+Host_SigScanBench_f
+
+  Samples signatures from the game's
+  code section and verifies the batched
+  scanner against a linear scan
+=====================
+*/
+void Host_SigScanBench_f(const CCommand& args)
+{
+	const size_t nSignatures = args.ArgC() >= 2 ? std::max<int>(atoi(args.Arg(1)), 1) : 1000;
+	const int nIterations = args.ArgC() >= 3 ? std::max<int>(atoi(args.Arg(2)), 1) : 5;
+
+	const CModule::ModuleSections_t& codeSection = g_GameDll.m_ExecutableCode;
+	if (!codeSection.IsSectionValid())
+	{
+		Warning(eDLL_T::ENGINE, "Game module has no code section\n");
+		return;
+	}
+
+	CBenchmark bench(Bench_GetPrinter(eDLL_T::ENGINE));
+	CSigScanner::Benchmark(bench, reinterpret_cast<const uint8_t*>(codeSection.m_pSectionBase), codeSection.m_nSectionSize, nSignatures, nIterations);
+}
+
+/*
+=====================
+Host_ChecksumBench_f
+
+  Measures every crc32 and adler32
+  kernel the processor supports and
+  verifies them against the reference
+  routines
+=====================
+*/
+void Host_ChecksumBench_f(const CCommand& args)
+{
+	const size_t nMaxSize = size_t(args.ArgC() >= 2 ? std::max<int>(atoi(args.Arg(1)), 1) : 1024) << 20;
+	const size_t nMinBytes = size_t(256) << 20; // Small buffers are repeated up to this many bytes per run.
+
+	const size_t nSizes[] = { size_t(1) << 10, size_t(1) << 20, size_t(1) << 30 };
+	const char* const pszSizes[] = { "1 KiB", "1 MiB", "1 GiB" };
+
+	size_t nBufferSize = 0;
+	for (size_t nSize : nSizes)
+	{
+		if (nSize <= nMaxSize)
+			nBufferSize = nSize;
+	}
+
+	vector<uint8_t> vBuffer(nBufferSize);
+	std::mt19937 rng(BENCH_RANDOM_SEED);
+	for (uint8_t& c : vBuffer)
+	{
+		c = static_cast<uint8_t>(rng());
+	}
+
+	CBenchmark bench(Bench_GetPrinter(eDLL_T::ENGINE));
+	for (size_t i = 0; i < std::size(nSizes) && nSizes[i] <= nBufferSize; i++)
+	{
+		const size_t nRepeats = std::max<size_t>(nMinBytes / nSizes[i], 1);
+
+		crc32::benchmark(bench, vBuffer.data(), nSizes[i], nRepeats, pszSizes[i]);
+		adler32::benchmark(bench, vBuffer.data(), nSizes[i], nRepeats, pszSizes[i]);
+	}
+
+	bench.Summarize("checksum kernels", "their reference routines");
+}
+
 /*
 =====================
 VPK_Mount_f
@@ -22,6 +22,12 @@ void Host_Ban_f(const CCommand& args);
 void Host_BanID_f(const CCommand& args);
 void Host_Unban_f(const CCommand& args);
 void Host_ReloadBanList_f(const CCommand& args);
+void Host_ImportBanList_f(const CCommand& args);
+void Host_ExportBanList_f(const CCommand& args);
+void Host_BanListBench_f(const CCommand& args);
+void Pylon_BanCacheStats_f(const CCommand& args);
+void Pylon_BanCacheClear_f(const CCommand& args);
+void AI_NodeGridBench_f(const CCommand& args);
 void Host_ReloadPlaylists_f(const CCommand& args);
 void Host_Changelevel_f(const CCommand& args);
 #endif // !CLIENT_DLL
@@ -32,8 +38,10 @@ void Pak_Swap_f(const CCommand& args);
 void RTech_StringToGUID_f(const CCommand& args);
 void RTech_Decompress_f(const CCommand& args);
 void VPK_Pack_f(const CCommand& args);
+void VPK_PackVerify_f(const CCommand& args);
 void VPK_Unpack_f(const CCommand& args);
 void VPK_Mount_f(const CCommand& args);
+void VPK_DirBench_f(const CCommand& args);
 void NET_SetKey_f(const CCommand& args);
 void NET_GenerateKey_f(const CCommand& args);
 void NET_UseRandomKeyChanged_f(IConVar* pConVar, const char* pOldString, float flOldValue);
@@ -56,6 +64,9 @@ void Capsule_f(const CCommand& args);
 #if !defined (GAMEDLL_S0) && !defined (GAMEDLL_S1)
 void BHit_f(const CCommand& args);
 #endif // !GAMEDLL_S0 && !GAMEDLL_S1
+void Host_FrameTaskBench_f(const CCommand& args);
+void Host_SigScanBench_f(const CCommand& args);
+void Host_ChecksumBench_f(const CCommand& args);
 
 void CVHelp_f(const CCommand& args);
 void CVList_f(const CCommand& args);